@@ -19,6 +19,7 @@
 #include "asylo/crypto/ecdsa_p256_sha256_signing_key.h"
 
 #include <openssl/bio.h>
+#include <openssl/bn.h>
 #include <openssl/bytestring.h>
 #include <openssl/crypto.h>
 #include <openssl/ec_key.h>
@@ -29,12 +30,18 @@
 #include <openssl/pem.h>
 #include <openssl/x509.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "asylo/crypto/algorithms.pb.h"
 #include "asylo/crypto/bignum_util.h"
 #include "asylo/crypto/keys.pb.h"
@@ -42,14 +49,168 @@
 #include "asylo/crypto/signing_key.h"
 #include "asylo/crypto/util/bssl_util.h"
 #include "asylo/crypto/util/byte_container_view.h"
+#include "asylo/platform/common/fork_generation.h"
+#include "asylo/util/cleansing_types.h"
+#include "asylo/util/logging.h"
 #include "asylo/util/status.h"
 #include "asylo/util/status_macros.h"
+#include "asylo/util/thread.h"
 
 namespace asylo {
 namespace {
 
 constexpr int32_t kSignatureParamSize = 32;
 
+// The size of a precomputed nonce entry, which holds k^-1 mod n in Montgomery
+// form followed by r, each as a kSignatureParamSize-byte big-endian integer.
+constexpr size_t kNonceEntrySize = 2 * kSignatureParamSize;
+
+// The maximum number of nonces generated by the refill thread between updates
+// of the nonce pool. All nonces in a batch share a single modular inversion.
+constexpr size_t kRefillBatchSize = 32;
+
+// A scalar modulo the order n of the P256 group, as four 64-bit limbs with the
+// least significant limb first. Unlike BIGNUM arithmetic, whose running time
+// depends on the bit lengths of the operands, the scalar functions below
+// perform the same sequence of operations for any secret input.
+using Scalar = std::array<uint64_t, 4>;
+
+// The group order n.
+constexpr Scalar kOrder = {0xf3b9cac2fc632551, 0xbce6faada7179e84,
+                           0xffffffffffffffff, 0xffffffff00000000};
+
+// -n^-1 mod 2^64, used in Montgomery reduction.
+constexpr uint64_t kOrderMontgomeryFactor = 0xccd1c8aaee00bc4f;
+
+// R^2 mod n, where R = 2^256, used to convert scalars to Montgomery form.
+constexpr Scalar kOrderRSquared = {0x83244c95be79eea2, 0x4699799c49bd6fa6,
+                                   0x2845b2392b6bec59, 0x66e12d94f3d95620};
+
+// Sets |out| to the 32-byte big-endian integer at |in|.
+void ScalarFromBytes(const uint8_t *in, Scalar *out) {
+  for (int i = 0; i < 4; ++i) {
+    uint64_t limb = 0;
+    for (int j = 0; j < 8; ++j) {
+      limb = (limb << 8) | in[(3 - i) * 8 + j];
+    }
+    (*out)[i] = limb;
+  }
+}
+
+// Writes |scalar| to |out| as a 32-byte big-endian integer.
+void ScalarToBytes(const Scalar &scalar, uint8_t *out) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      out[(3 - i) * 8 + j] = static_cast<uint8_t>(scalar[i] >> (56 - 8 * j));
+    }
+  }
+}
+
+// Sets |out| to |bignum|, which must be less than n. BN_bn2bin_padded() runs in
+// time independent of the value of a BIGNUM of fixed width, such as the private
+// scalar of an EC_KEY, which is always held at the width of the group order.
+bool ScalarFromBignum(const BIGNUM *bignum, Scalar *out) {
+  uint8_t bytes[kSignatureParamSize];
+  if (!BN_bn2bin_padded(bytes, sizeof(bytes), bignum)) {
+    return false;
+  }
+  ScalarFromBytes(bytes, out);
+  OPENSSL_cleanse(bytes, sizeof(bytes));
+  return true;
+}
+
+// Sets |out| to (|carry| * 2^256 + |value|) mod n, which must be less than 2n.
+// The subtraction of n is always computed and then selected with a mask.
+void ScalarReduce(uint64_t carry, const Scalar &value, Scalar *out) {
+  Scalar difference;
+  uint64_t borrow = 0;
+  for (int i = 0; i < 4; ++i) {
+    unsigned __int128 limb =
+        static_cast<unsigned __int128>(value[i]) - kOrder[i] - borrow;
+    difference[i] = static_cast<uint64_t>(limb);
+    borrow = static_cast<uint64_t>(limb >> 64) & 1;
+  }
+
+  // Keep |value| only if subtracting n underflowed and there was no carry.
+  uint64_t keep_value = 0 - (borrow & (carry ^ 1));
+  for (int i = 0; i < 4; ++i) {
+    (*out)[i] = (value[i] & keep_value) | (difference[i] & ~keep_value);
+  }
+}
+
+// Sets |out| to |a| + |b| mod n, for |a| and |b| less than n.
+void ScalarAdd(const Scalar &a, const Scalar &b, Scalar *out) {
+  Scalar sum;
+  uint64_t carry = 0;
+  for (int i = 0; i < 4; ++i) {
+    unsigned __int128 limb =
+        static_cast<unsigned __int128>(a[i]) + b[i] + carry;
+    sum[i] = static_cast<uint64_t>(limb);
+    carry = static_cast<uint64_t>(limb >> 64);
+  }
+  ScalarReduce(carry, sum, out);
+}
+
+// Sets |out| to |a| * |b| * R^-1 mod n, for |a| and |b| less than n, using
+// word-by-word Montgomery multiplication. |out| may alias either input.
+void ScalarMontgomeryMultiply(const Scalar &a, const Scalar &b, Scalar *out) {
+  uint64_t t[6] = {0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < 4; ++i) {
+    // t += a * b[i]
+    uint64_t carry = 0;
+    for (int j = 0; j < 4; ++j) {
+      unsigned __int128 limb =
+          static_cast<unsigned __int128>(a[j]) * b[i] + t[j] + carry;
+      t[j] = static_cast<uint64_t>(limb);
+      carry = static_cast<uint64_t>(limb >> 64);
+    }
+    unsigned __int128 top = static_cast<unsigned __int128>(t[4]) + carry;
+    t[4] = static_cast<uint64_t>(top);
+    t[5] = static_cast<uint64_t>(top >> 64);
+
+    // t = (t + m * n) / 2^64, where m is chosen so that the division is exact.
+    uint64_t m = t[0] * kOrderMontgomeryFactor;
+    unsigned __int128 limb =
+        static_cast<unsigned __int128>(m) * kOrder[0] + t[0];
+    carry = static_cast<uint64_t>(limb >> 64);
+    for (int j = 1; j < 4; ++j) {
+      limb = static_cast<unsigned __int128>(m) * kOrder[j] + t[j] + carry;
+      t[j - 1] = static_cast<uint64_t>(limb);
+      carry = static_cast<uint64_t>(limb >> 64);
+    }
+    top = static_cast<unsigned __int128>(t[4]) + carry;
+    t[3] = static_cast<uint64_t>(top);
+    t[4] = t[5] + static_cast<uint64_t>(top >> 64);
+  }
+  ScalarReduce(t[4], {t[0], t[1], t[2], t[3]}, out);
+  OPENSSL_cleanse(t, sizeof(t));
+}
+
+// Sets |out| to the Montgomery form |a| * R mod n of |a|, which must be less
+// than n.
+void ScalarToMontgomery(const Scalar &a, Scalar *out) {
+  ScalarMontgomeryMultiply(a, kOrderRSquared, out);
+}
+
+// Sets |out| to a^-1 * R mod n given the Montgomery form |a| of a non-zero a.
+// Since n is prime, a^-1 = a^(n - 2) mod n. The exponent is public, so the
+// sequence of multiplications does not depend on |a|.
+void ScalarInvertMontgomery(const Scalar &a, Scalar *out) {
+  Scalar exponent = kOrder;
+  exponent[0] -= 2;
+
+  Scalar result;
+  ScalarToMontgomery({1, 0, 0, 0}, &result);
+  for (int bit = 255; bit >= 0; --bit) {
+    ScalarMontgomeryMultiply(result, result, &result);
+    if ((exponent[bit / 64] >> (bit % 64)) & 1) {
+      ScalarMontgomeryMultiply(result, a, &result);
+    }
+  }
+  *out = result;
+  OPENSSL_cleanse(result.data(), sizeof(result));
+}
+
 // Returns an EC_KEY containing the public key corresponding to |private_key|.
 StatusOr<bssl::UniquePtr<EC_KEY>> CreatePublicKeyFromPrivateKey(
     const EC_KEY *private_key) {
@@ -73,6 +234,50 @@ Status DoSha256Hash(ByteContainerView message, std::vector<uint8_t> *digest) {
   return hasher.CumulativeHash(digest);
 }
 
+// Writes the DER encoding of |ecdsa_sig| to |signature|.
+Status EcdsaSigToDer(const ECDSA_SIG &ecdsa_sig,
+                     std::vector<uint8_t> *signature) {
+  int length = i2d_ECDSA_SIG(&ecdsa_sig, /*outp=*/nullptr);
+  if (length <= 0) {
+    return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+  }
+  signature->resize(length);
+  uint8_t *signature_data = signature->data();
+  if (i2d_ECDSA_SIG(&ecdsa_sig, &signature_data) != length) {
+    return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+  }
+  return Status::OkStatus();
+}
+
+// Writes the R and S values of |ecdsa_sig| to |signature|.
+Status EcdsaSigToSignature(const ECDSA_SIG &ecdsa_sig, Signature *signature) {
+  const BIGNUM *r_bignum;
+  const BIGNUM *s_bignum;
+  ECDSA_SIG_get0(&ecdsa_sig, &r_bignum, &s_bignum);
+  if (r_bignum == nullptr || s_bignum == nullptr) {
+    return Status(error::GoogleError::INTERNAL, "Could not parse signature");
+  }
+
+  std::pair<asylo::Sign, std::vector<uint8_t>> r;
+  std::pair<asylo::Sign, std::vector<uint8_t>> s;
+  ASYLO_ASSIGN_OR_RETURN(
+      r, PaddedBigEndianBytesFromBignum(*r_bignum, kSignatureParamSize));
+  ASYLO_ASSIGN_OR_RETURN(
+      s, PaddedBigEndianBytesFromBignum(*s_bignum, kSignatureParamSize));
+  if (r.first == asylo::Sign::kNegative || s.first == asylo::Sign::kNegative) {
+    return Status(error::GoogleError::INTERNAL,
+                  "Neither R nor S should be negative");
+  }
+
+  EcdsaSignature ecdsa_signature;
+  ecdsa_signature.set_r(r.second.data(), r.second.size());
+  ecdsa_signature.set_s(s.second.data(), s.second.size());
+
+  signature->set_signature_scheme(SignatureScheme::ECDSA_P256_SHA256);
+  *signature->mutable_ecdsa_signature() = std::move(ecdsa_signature);
+  return Status::OkStatus();
+}
+
 Status CheckKeyProtoValues(const AsymmetricSigningKeyProto &key_proto,
                            AsymmetricSigningKeyProto::KeyType expected_type) {
   if (key_proto.key_type() != expected_type) {
@@ -283,6 +488,330 @@ EcdsaP256Sha256VerifyingKey::EcdsaP256Sha256VerifyingKey(
     bssl::UniquePtr<EC_KEY> public_key)
     : public_key_(std::move(public_key)) {}
 
+// EcdsaP256Sha256SigningKey::PrecomputedSigner
+
+// Signs message digests using nonces that are generated ahead of time. For a
+// nonce k, the signer keeps k^-1 mod n and r = x(k * G) mod n, so producing a
+// signature s = k^-1 * (e + r * d) mod n only requires two Montgomery
+// multiplications and a modular addition. All arithmetic on secret scalars is
+// fixed-width and constant-time, and the private scalar d and all nonce
+// material are zeroized when no longer needed.
+//
+// Pooled nonces are discarded when the fork generation changes, so that a
+// child enclave restored from a snapshot never reuses a nonce of its parent.
+class EcdsaP256Sha256SigningKey::PrecomputedSigner {
+ public:
+  // Creates a signer for |private_key| whose background thread keeps up to
+  // |pool_size| nonces ready for use.
+  static StatusOr<std::unique_ptr<PrecomputedSigner>> Create(
+      const EC_KEY *private_key, size_t pool_size) {
+    auto signer =
+        absl::WrapUnique<PrecomputedSigner>(new PrecomputedSigner(pool_size));
+    ASYLO_RETURN_IF_ERROR(signer->Init(private_key));
+    PrecomputedSigner *signer_ptr = signer.get();
+    signer->refill_thread_ =
+        absl::make_unique<Thread>([signer_ptr] { signer_ptr->RefillLoop(); });
+    return std::move(signer);
+  }
+
+  PrecomputedSigner(const PrecomputedSigner &other) = delete;
+  PrecomputedSigner &operator=(const PrecomputedSigner &other) = delete;
+
+  ~PrecomputedSigner() {
+    if (refill_thread_) {
+      {
+        absl::MutexLock lock(&mu_);
+        stopping_ = true;
+      }
+      refill_thread_->Join();
+    }
+    OPENSSL_cleanse(private_scalar_.data(), sizeof(private_scalar_));
+  }
+
+  // Signs each of the SHA-256 |digests|.
+  StatusOr<std::vector<bssl::UniquePtr<ECDSA_SIG>>> SignDigests(
+      absl::Span<const std::vector<uint8_t>> digests) {
+    CleansingVector<uint8_t> entries;
+    size_t taken = TakeNonces(digests.size(), &entries);
+    ASYLO_RETURN_IF_ERROR(GenerateNonces(digests.size() - taken, &entries));
+
+    std::vector<bssl::UniquePtr<ECDSA_SIG>> signatures(digests.size());
+    for (size_t i = 0; i < digests.size(); ++i) {
+      ASYLO_RETURN_IF_ERROR(SignDigest(
+          digests[i], &entries[i * kNonceEntrySize], &signatures[i]));
+
+      // A zero S value can only occur with negligible probability, in which
+      // case the signature is retried with a fresh nonce.
+      while (!signatures[i]) {
+        CleansingVector<uint8_t> retry_entry;
+        ASYLO_RETURN_IF_ERROR(GenerateNonces(/*count=*/1, &retry_entry));
+        ASYLO_RETURN_IF_ERROR(
+            SignDigest(digests[i], retry_entry.data(), &signatures[i]));
+      }
+    }
+    return std::move(signatures);
+  }
+
+ private:
+  explicit PrecomputedSigner(size_t pool_size)
+      : pool_size_(pool_size),
+        pool_generation_(GetForkGeneration()),
+        stopping_(false) {
+    pool_.reserve(pool_size_ * kNonceEntrySize);
+  }
+
+  // Sets up the curve parameters and the Montgomery form of the private scalar
+  // of |private_key|.
+  Status Init(const EC_KEY *private_key) {
+    group_.reset(EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1));
+    if (!group_) {
+      return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+    }
+
+    Scalar private_scalar;
+    if (!ScalarFromBignum(EC_KEY_get0_private_key(private_key),
+                          &private_scalar)) {
+      return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+    }
+    ScalarToMontgomery(private_scalar, &private_scalar_);
+    OPENSSL_cleanse(private_scalar.data(), sizeof(private_scalar));
+    return Status::OkStatus();
+  }
+
+  // Appends |count| freshly generated nonce entries to |entries|. The
+  // inverses of all |count| nonces are computed with a single modular
+  // exponentiation using Montgomery's simultaneous inversion.
+  Status GenerateNonces(size_t count, CleansingVector<uint8_t> *entries) const {
+    if (count == 0) {
+      return Status::OkStatus();
+    }
+
+    const BIGNUM *order = EC_GROUP_get0_order(group_.get());
+    bssl::UniquePtr<BN_CTX> context(BN_CTX_new());
+    bssl::UniquePtr<BIGNUM> x(BN_new());
+    bssl::UniquePtr<BIGNUM> r(BN_new());
+    if (!context || !x || !r) {
+      return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+    }
+
+    // The Montgomery forms of each nonce and of the running products of the
+    // nonces, and the corresponding r values.
+    CleansingVector<Scalar> nonces;
+    CleansingVector<Scalar> products;
+    std::vector<Scalar> r_values;
+    nonces.reserve(count);
+    products.reserve(count);
+    r_values.reserve(count);
+    while (nonces.size() < count) {
+      // Key generation draws a non-zero k and computes k * G in constant time,
+      // and keeps k at the full width of the group order.
+      bssl::UniquePtr<EC_KEY> nonce_key(
+          EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+      if (!nonce_key || !EC_KEY_generate_key(nonce_key.get()) ||
+          !EC_POINT_get_affine_coordinates_GFp(
+              group_.get(), EC_KEY_get0_public_key(nonce_key.get()), x.get(),
+              /*y=*/nullptr, context.get()) ||
+          !BN_nnmod(r.get(), x.get(), order, context.get())) {
+        return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+      }
+      if (BN_is_zero(r.get())) {
+        continue;
+      }
+
+      Scalar nonce;
+      Scalar r_value;
+      if (!ScalarFromBignum(EC_KEY_get0_private_key(nonce_key.get()),
+                            &nonce) ||
+          !ScalarFromBignum(r.get(), &r_value)) {
+        return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+      }
+      ScalarToMontgomery(nonce, &nonce);
+      Scalar product = nonce;
+      if (!products.empty()) {
+        ScalarMontgomeryMultiply(products.back(), nonce, &product);
+      }
+      nonces.push_back(nonce);
+      products.push_back(product);
+      r_values.push_back(r_value);
+      OPENSSL_cleanse(nonce.data(), sizeof(nonce));
+      OPENSSL_cleanse(product.data(), sizeof(product));
+    }
+
+    // Invert the product of all nonces, then peel off one nonce at a time to
+    // recover the inverse of each.
+    Scalar inverse;
+    ScalarInvertMontgomery(products.back(), &inverse);
+
+    size_t offset = entries->size();
+    entries->resize(offset + count * kNonceEntrySize);
+    for (size_t i = count; i-- > 0;) {
+      Scalar nonce_inverse = inverse;
+      if (i > 0) {
+        ScalarMontgomeryMultiply(inverse, products[i - 1], &nonce_inverse);
+        ScalarMontgomeryMultiply(inverse, nonces[i], &inverse);
+      }
+
+      uint8_t *entry = &(*entries)[offset + i * kNonceEntrySize];
+      ScalarToBytes(nonce_inverse, entry);
+      ScalarToBytes(r_values[i], entry + kSignatureParamSize);
+      OPENSSL_cleanse(nonce_inverse.data(), sizeof(nonce_inverse));
+    }
+    OPENSSL_cleanse(inverse.data(), sizeof(inverse));
+    return Status::OkStatus();
+  }
+
+  // Moves up to |count| pooled nonce entries to the end of |entries| and
+  // returns the number of entries moved.
+  size_t TakeNonces(size_t count, CleansingVector<uint8_t> *entries) {
+    absl::MutexLock lock(&mu_);
+    DiscardPoolIfForked();
+    size_t taken = std::min(count, pool_.size() / kNonceEntrySize);
+    if (taken == 0) {
+      return 0;
+    }
+    size_t remaining = pool_.size() - taken * kNonceEntrySize;
+    entries->insert(entries->end(), pool_.begin() + remaining, pool_.end());
+    OPENSSL_cleanse(&pool_[remaining], taken * kNonceEntrySize);
+    pool_.resize(remaining);
+    return taken;
+  }
+
+  // Zeroizes the pool if the enclave has been restored as a forked child since
+  // the pooled nonces were generated.
+  void DiscardPoolIfForked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    uint64_t generation = GetForkGeneration();
+    if (generation == pool_generation_) {
+      return;
+    }
+    OPENSSL_cleanse(pool_.data(), pool_.size());
+    pool_.clear();
+    pool_generation_ = generation;
+  }
+
+  // Computes the signature of |digest| using the nonce entry at |entry|. Sets
+  // |signature| to nullptr if the resulting S value is zero.
+  Status SignDigest(const std::vector<uint8_t> &digest, const uint8_t *entry,
+                    bssl::UniquePtr<ECDSA_SIG> *signature) const {
+    // The digest is as long as the group order, so needs no truncation, and is
+    // less than 2n, so a single conditional subtraction reduces it.
+    Scalar e;
+    ScalarFromBytes(digest.data(), &e);
+    ScalarReduce(/*carry=*/0, e, &e);
+    Scalar nonce_inverse;
+    ScalarFromBytes(entry, &nonce_inverse);
+    Scalar r_value;
+    ScalarFromBytes(entry + kSignatureParamSize, &r_value);
+
+    // Multiplying by an operand in Montgomery form yields a product in the
+    // normal representation, so s = k^-1 * (e + r * d) mod n needs no further
+    // conversions.
+    Scalar s_value;
+    ScalarMontgomeryMultiply(r_value, private_scalar_, &s_value);
+    ScalarAdd(s_value, e, &s_value);
+    ScalarMontgomeryMultiply(s_value, nonce_inverse, &s_value);
+    OPENSSL_cleanse(nonce_inverse.data(), sizeof(nonce_inverse));
+
+    uint8_t s_bytes[kSignatureParamSize];
+    ScalarToBytes(s_value, s_bytes);
+    bssl::UniquePtr<BIGNUM> r(BN_bin2bn(entry + kSignatureParamSize,
+                                        kSignatureParamSize, /*ret=*/nullptr));
+    bssl::UniquePtr<BIGNUM> s(
+        BN_bin2bn(s_bytes, sizeof(s_bytes), /*ret=*/nullptr));
+    if (!r || !s) {
+      return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+    }
+
+    signature->reset();
+    if (BN_is_zero(s.get())) {
+      return Status::OkStatus();
+    }
+
+    bssl::UniquePtr<ECDSA_SIG> ecdsa_sig(ECDSA_SIG_new());
+    if (!ecdsa_sig ||
+        ECDSA_SIG_set0(ecdsa_sig.get(), r.get(), s.get()) != 1) {
+      return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+    }
+    r.release();
+    s.release();
+    *signature = std::move(ecdsa_sig);
+    return Status::OkStatus();
+  }
+
+  // Keeps the nonce pool filled until the signer is destroyed. Once woken, the
+  // thread refills the pool completely so that the cost of each inversion is
+  // shared by a full batch of nonces.
+  void RefillLoop() {
+    while (true) {
+      {
+        absl::MutexLock lock(&mu_);
+        mu_.Await(absl::Condition(this, &PrecomputedSigner::RefillNeeded));
+      }
+
+      while (true) {
+        size_t count;
+        uint64_t generation;
+        {
+          absl::MutexLock lock(&mu_);
+          if (stopping_) {
+            return;
+          }
+          DiscardPoolIfForked();
+          count = std::min(kRefillBatchSize,
+                           pool_size_ - pool_.size() / kNonceEntrySize);
+          generation = pool_generation_;
+        }
+        if (count == 0) {
+          break;
+        }
+
+        CleansingVector<uint8_t> entries;
+        Status status = GenerateNonces(count, &entries);
+        if (!status.ok()) {
+          // Signing falls back to generating nonces inline.
+          LOG(ERROR) << "Failed to precompute ECDSA nonces: " << status;
+          return;
+        }
+
+        absl::MutexLock lock(&mu_);
+        DiscardPoolIfForked();
+        if (generation == pool_generation_) {
+          pool_.insert(pool_.end(), entries.begin(), entries.end());
+        }
+      }
+    }
+  }
+
+  // Returns true if the refill thread should wake up, which is when the
+  // signer is being destroyed or the pool is at most half full.
+  bool RefillNeeded() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stopping_ || pool_.size() / kNonceEntrySize <= pool_size_ / 2;
+  }
+
+  // The NIST P256 group.
+  bssl::UniquePtr<EC_GROUP> group_;
+
+  // The private scalar d in Montgomery form.
+  Scalar private_scalar_;
+
+  // The maximum number of nonces held in pool_.
+  const size_t pool_size_;
+
+  absl::Mutex mu_;
+
+  // Concatenated nonce entries of kNonceEntrySize bytes each. Entries are
+  // taken from the end and zeroized in place.
+  CleansingVector<uint8_t> pool_ ABSL_GUARDED_BY(mu_);
+
+  // The fork generation in which the entries in pool_ were generated.
+  uint64_t pool_generation_ ABSL_GUARDED_BY(mu_);
+
+  // Whether the refill thread should exit.
+  bool stopping_ ABSL_GUARDED_BY(mu_);
+
+  // The thread that refills pool_.
+  std::unique_ptr<Thread> refill_thread_;
+};
+
 // EcdsaP256Sha256SigningKey
 
 StatusOr<std::unique_ptr<EcdsaP256Sha256SigningKey>>
@@ -437,6 +966,13 @@ EcdsaP256Sha256SigningKey::GetVerifyingKey() const {
 
 Status EcdsaP256Sha256SigningKey::Sign(ByteContainerView message,
                                        std::vector<uint8_t> *signature) const {
+  if (precomputed_signer_) {
+    std::vector<bssl::UniquePtr<ECDSA_SIG>> ecdsa_sigs;
+    ASYLO_ASSIGN_OR_RETURN(ecdsa_sigs,
+                           SignMessages(absl::MakeConstSpan(&message, 1)));
+    return EcdsaSigToDer(*ecdsa_sigs.front(), signature);
+  }
+
   std::vector<uint8_t> digest;
   ASYLO_RETURN_IF_ERROR(DoSha256Hash(message, &digest));
 
@@ -452,6 +988,13 @@ Status EcdsaP256Sha256SigningKey::Sign(ByteContainerView message,
 
 Status EcdsaP256Sha256SigningKey::Sign(ByteContainerView message,
                                        Signature *signature) const {
+  if (precomputed_signer_) {
+    std::vector<bssl::UniquePtr<ECDSA_SIG>> ecdsa_sigs;
+    ASYLO_ASSIGN_OR_RETURN(ecdsa_sigs,
+                           SignMessages(absl::MakeConstSpan(&message, 1)));
+    return EcdsaSigToSignature(*ecdsa_sigs.front(), signature);
+  }
+
   std::vector<uint8_t> digest;
   ASYLO_RETURN_IF_ERROR(DoSha256Hash(message, &digest));
 
@@ -460,31 +1003,7 @@ Status EcdsaP256Sha256SigningKey::Sign(ByteContainerView message,
   if (ecdsa_sig == nullptr) {
     return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
   }
-  const BIGNUM *r_bignum;
-  const BIGNUM *s_bignum;
-  ECDSA_SIG_get0(ecdsa_sig.get(), &r_bignum, &s_bignum);
-  if (r_bignum == nullptr || s_bignum == nullptr) {
-    return Status(error::GoogleError::INTERNAL, "Could not parse signature");
-  }
-
-  std::pair<asylo::Sign, std::vector<uint8_t>> r;
-  std::pair<asylo::Sign, std::vector<uint8_t>> s;
-  ASYLO_ASSIGN_OR_RETURN(
-      r, PaddedBigEndianBytesFromBignum(*r_bignum, kSignatureParamSize));
-  ASYLO_ASSIGN_OR_RETURN(
-      s, PaddedBigEndianBytesFromBignum(*s_bignum, kSignatureParamSize));
-  if (r.first == asylo::Sign::kNegative || s.first == asylo::Sign::kNegative) {
-    return Status(error::GoogleError::INTERNAL,
-                  "Neither R nor S should be negative");
-  }
-
-  EcdsaSignature ecdsa_signature;
-  ecdsa_signature.set_r(r.second.data(), r.second.size());
-  ecdsa_signature.set_s(s.second.data(), s.second.size());
-
-  signature->set_signature_scheme(GetSignatureScheme());
-  *signature->mutable_ecdsa_signature() = std::move(ecdsa_signature);
-  return Status::OkStatus();
+  return EcdsaSigToSignature(*ecdsa_sig, signature);
 }
 
 Status EcdsaP256Sha256SigningKey::SignX509(X509 *x509) const {
@@ -498,9 +1017,75 @@ Status EcdsaP256Sha256SigningKey::SignX509(X509 *x509) const {
   return Status::OkStatus();
 }
 
+Status EcdsaP256Sha256SigningKey::EnablePrecomputedSigning(size_t pool_size) {
+  if (pool_size == 0) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Nonce pool size must be positive");
+  }
+
+  // Stop the refill thread of any existing signer before starting a new one.
+  precomputed_signer_.reset();
+  ASYLO_ASSIGN_OR_RETURN(
+      precomputed_signer_,
+      PrecomputedSigner::Create(private_key_.get(), pool_size));
+  return Status::OkStatus();
+}
+
+Status EcdsaP256Sha256SigningKey::SignBatch(
+    absl::Span<const ByteContainerView> messages,
+    std::vector<std::vector<uint8_t>> *signatures) const {
+  std::vector<bssl::UniquePtr<ECDSA_SIG>> ecdsa_sigs;
+  ASYLO_ASSIGN_OR_RETURN(ecdsa_sigs, SignMessages(messages));
+
+  signatures->resize(ecdsa_sigs.size());
+  for (size_t i = 0; i < ecdsa_sigs.size(); ++i) {
+    ASYLO_RETURN_IF_ERROR(EcdsaSigToDer(*ecdsa_sigs[i], &(*signatures)[i]));
+  }
+  return Status::OkStatus();
+}
+
+Status EcdsaP256Sha256SigningKey::SignBatch(
+    absl::Span<const ByteContainerView> messages,
+    std::vector<Signature> *signatures) const {
+  std::vector<bssl::UniquePtr<ECDSA_SIG>> ecdsa_sigs;
+  ASYLO_ASSIGN_OR_RETURN(ecdsa_sigs, SignMessages(messages));
+
+  signatures->resize(ecdsa_sigs.size());
+  for (size_t i = 0; i < ecdsa_sigs.size(); ++i) {
+    ASYLO_RETURN_IF_ERROR(
+        EcdsaSigToSignature(*ecdsa_sigs[i], &(*signatures)[i]));
+  }
+  return Status::OkStatus();
+}
+
 EcdsaP256Sha256SigningKey::EcdsaP256Sha256SigningKey(
     bssl::UniquePtr<EC_KEY> private_key, bssl::UniquePtr<EC_KEY> public_key)
     : private_key_(std::move(private_key)),
       public_key_(std::move(public_key)) {}
 
+EcdsaP256Sha256SigningKey::~EcdsaP256Sha256SigningKey() = default;
+
+StatusOr<std::vector<bssl::UniquePtr<ECDSA_SIG>>>
+EcdsaP256Sha256SigningKey::SignMessages(
+    absl::Span<const ByteContainerView> messages) const {
+  std::vector<std::vector<uint8_t>> digests(messages.size());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    ASYLO_RETURN_IF_ERROR(DoSha256Hash(messages[i], &digests[i]));
+  }
+
+  if (precomputed_signer_) {
+    return precomputed_signer_->SignDigests(digests);
+  }
+
+  std::vector<bssl::UniquePtr<ECDSA_SIG>> signatures(digests.size());
+  for (size_t i = 0; i < digests.size(); ++i) {
+    signatures[i].reset(ECDSA_do_sign(digests[i].data(), digests[i].size(),
+                                      private_key_.get()));
+    if (!signatures[i]) {
+      return Status(error::GoogleError::INTERNAL, BsslLastErrorString());
+    }
+  }
+  return std::move(signatures);
+}
+
 }  // namespace asylo
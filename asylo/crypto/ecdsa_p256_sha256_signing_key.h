@@ -21,14 +21,19 @@
 
 #include <openssl/base.h>
 #include <openssl/ec.h>
+#include <openssl/ecdsa.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "asylo/crypto/keys.pb.h"
 #include "asylo/crypto/signing_key.h"
 #include "asylo/crypto/util/byte_container_view.h"
+#include "asylo/util/status.h"
 #include "asylo/util/statusor.h"
 
 namespace asylo {
@@ -103,6 +108,8 @@ class EcdsaP256Sha256SigningKey : public SigningKey {
   static StatusOr<std::unique_ptr<EcdsaP256Sha256SigningKey>> Create(
       bssl::UniquePtr<EC_KEY> private_key);
 
+  ~EcdsaP256Sha256SigningKey() override;
+
   // From SigningKey.
 
   SignatureScheme GetSignatureScheme() const override;
@@ -120,16 +127,52 @@ class EcdsaP256Sha256SigningKey : public SigningKey {
 
   Status SignX509(X509 *x509) const override;
 
+  // Enables precomputed signing. A background thread generates per-signature
+  // nonces k together with the corresponding r = x(k * G) mod n into a pool of
+  // at most |pool_size| entries, so that Sign() and SignBatch() only perform
+  // the scalar arithmetic that depends on the message. If the pool runs dry,
+  // nonces are generated on the calling thread instead. Within an enclave, the
+  // background thread occupies one enclave thread for the lifetime of this
+  // key. A child enclave restored from a fork() snapshot discards the pool it
+  // inherited, so that parent and child never sign with the same nonce.
+  //
+  // Must not be called concurrently with any signing operation on this key.
+  Status EnablePrecomputedSigning(size_t pool_size);
+
+  // Signs each of |messages| and writes the DER-encoded signatures to
+  // |signatures|, in the same order. If precomputed signing is enabled,
+  // nonces for the entire batch are taken from the pool at once, and any that
+  // must be generated inline share a single modular inversion.
+  Status SignBatch(absl::Span<const ByteContainerView> messages,
+                   std::vector<std::vector<uint8_t>> *signatures) const;
+
+  // Signs each of |messages| and writes the signatures to |signatures|, in
+  // the same order.
+  Status SignBatch(absl::Span<const ByteContainerView> messages,
+                   std::vector<Signature> *signatures) const;
+
  private:
+  // Generates, pools, and signs with precomputed nonces. Defined in the
+  // implementation file.
+  class PrecomputedSigner;
+
   EcdsaP256Sha256SigningKey(bssl::UniquePtr<EC_KEY> private_key,
                             bssl::UniquePtr<EC_KEY> public_key);
 
+  // Signs each of |messages| with nonces from |precomputed_signer_|, or with
+  // ECDSA_do_sign() if precomputed signing is not enabled.
+  StatusOr<std::vector<bssl::UniquePtr<ECDSA_SIG>>> SignMessages(
+      absl::Span<const ByteContainerView> messages) const;
+
   // An ECDSA P256 private key.
   bssl::UniquePtr<EC_KEY> private_key_;
 
   // An ECDSA P256 public key that can verify signatures produced by
   // private_key_.
   bssl::UniquePtr<EC_KEY> public_key_;
+
+  // The signer used when precomputed signing is enabled, or nullptr.
+  std::unique_ptr<PrecomputedSigner> precomputed_signer_;
 };
 
 }  // namespace asylo
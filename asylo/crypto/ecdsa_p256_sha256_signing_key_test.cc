@@ -36,11 +36,13 @@
 #include "absl/flags/flag.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "asylo/crypto/fake_signing_key.h"
 #include "asylo/crypto/keys.pb.h"
 #include "asylo/crypto/signing_key.h"
 #include "asylo/crypto/util/byte_container_util.h"
 #include "asylo/crypto/util/byte_container_view.h"
+#include "asylo/platform/common/fork_generation.h"
 #include "asylo/util/logging.h"
 #include "asylo/test/util/proto_matchers.h"
 #include "asylo/test/util/status_matchers.h"
@@ -58,6 +60,9 @@ using ::testing::Not;
 const int kBadGroup = NID_secp224r1;
 const int kMessageSize = 1000;
 
+// The number of nonces kept ready when precomputed signing is enabled.
+const size_t kNoncePoolSize = 16;
+
 constexpr char kTestSigningKeyDer[] =
     "30770201010420fe1dd5d79b11d1ba5f2f7be044d8b7eefc2396f77e903ca91fce637a525f"
     "e830a00a06082a8648ce3d030107a14403420004eaeda5103e89194f43bfe0d844f3e79f00"
@@ -694,6 +699,111 @@ TEST_F(EcdsaP256Sha256SigningKeyTest, SignAndVerifySignatureOverloads) {
   EXPECT_THAT(verifying_key->Verify(message, signature), Not(IsOk()));
 }
 
+// Returns |count| random messages of kMessageSize bytes.
+std::vector<std::vector<uint8_t>> RandomMessages(int count) {
+  std::vector<std::vector<uint8_t>> messages(count);
+  for (auto &message : messages) {
+    message.resize(kMessageSize);
+    CHECK(RAND_bytes(message.data(), kMessageSize));
+  }
+  return messages;
+}
+
+// Verifies that signatures produced with precomputed nonces can be verified,
+// including once the nonce pool has been exhausted.
+TEST_F(EcdsaP256Sha256SigningKeyTest, PrecomputedSignAndVerify) {
+  ASYLO_ASSERT_OK(signing_key_->EnablePrecomputedSigning(kNoncePoolSize));
+
+  std::unique_ptr<VerifyingKey> verifying_key;
+  ASYLO_ASSERT_OK_AND_ASSIGN(verifying_key, signing_key_->GetVerifyingKey());
+
+  for (const auto &message : RandomMessages(3 * kNoncePoolSize)) {
+    std::vector<uint8_t> der_signature;
+    ASYLO_ASSERT_OK(signing_key_->Sign(message, &der_signature));
+    ASYLO_EXPECT_OK(verifying_key->Verify(message, der_signature));
+
+    Signature signature;
+    ASYLO_ASSERT_OK(signing_key_->Sign(message, &signature));
+    ASYLO_EXPECT_OK(verifying_key->Verify(message, signature));
+
+    signature.mutable_ecdsa_signature()->mutable_s()->back() ^= 1;
+    EXPECT_THAT(verifying_key->Verify(message, signature), Not(IsOk()));
+  }
+}
+
+// Verifies that each precomputed signature uses a fresh nonce.
+TEST_F(EcdsaP256Sha256SigningKeyTest, PrecomputedSignaturesUseFreshNonces) {
+  ASYLO_ASSERT_OK(signing_key_->EnablePrecomputedSigning(kNoncePoolSize));
+
+  std::string message(absl::HexStringToBytes(kTestMessageHex));
+  Signature signature1;
+  Signature signature2;
+  ASYLO_ASSERT_OK(signing_key_->Sign(message, &signature1));
+  ASYLO_ASSERT_OK(signing_key_->Sign(message, &signature2));
+  EXPECT_NE(signature1.ecdsa_signature().r(),
+            signature2.ecdsa_signature().r());
+}
+
+// Verifies that precomputed signing keeps producing valid signatures after the
+// enclave is restored as a forked child, which discards the inherited pool.
+TEST_F(EcdsaP256Sha256SigningKeyTest, PrecomputedSignAndVerifyAfterFork) {
+  ASYLO_ASSERT_OK(signing_key_->EnablePrecomputedSigning(kNoncePoolSize));
+
+  std::unique_ptr<VerifyingKey> verifying_key;
+  ASYLO_ASSERT_OK_AND_ASSIGN(verifying_key, signing_key_->GetVerifyingKey());
+
+  std::vector<std::vector<uint8_t>> messages =
+      RandomMessages(2 * kNoncePoolSize);
+  for (size_t i = 0; i < messages.size(); ++i) {
+    if (i == kNoncePoolSize) {
+      AdvanceForkGeneration();
+    }
+    Signature signature;
+    ASYLO_ASSERT_OK(signing_key_->Sign(messages[i], &signature));
+    ASYLO_EXPECT_OK(verifying_key->Verify(messages[i], signature));
+  }
+}
+
+// Verifies that precomputed signing cannot be enabled with an empty pool.
+TEST_F(EcdsaP256Sha256SigningKeyTest, EnablePrecomputedSigningEmptyPoolFails) {
+  EXPECT_THAT(signing_key_->EnablePrecomputedSigning(/*pool_size=*/0),
+              StatusIs(error::GoogleError::INVALID_ARGUMENT));
+}
+
+// Verifies that every signature produced by SignBatch() can be verified, both
+// with and without precomputed signing.
+TEST_F(EcdsaP256Sha256SigningKeyTest, SignBatchAndVerify) {
+  std::unique_ptr<VerifyingKey> verifying_key;
+  ASYLO_ASSERT_OK_AND_ASSIGN(verifying_key, signing_key_->GetVerifyingKey());
+
+  std::vector<std::vector<uint8_t>> messages =
+      RandomMessages(2 * kNoncePoolSize);
+  std::vector<ByteContainerView> message_views(messages.cbegin(),
+                                               messages.cend());
+  for (bool precomputed : {false, true}) {
+    if (precomputed) {
+      ASYLO_ASSERT_OK(signing_key_->EnablePrecomputedSigning(kNoncePoolSize));
+    }
+
+    std::vector<std::vector<uint8_t>> der_signatures;
+    ASYLO_ASSERT_OK(signing_key_->SignBatch(message_views, &der_signatures));
+    ASSERT_EQ(der_signatures.size(), messages.size());
+
+    std::vector<Signature> signatures;
+    ASYLO_ASSERT_OK(signing_key_->SignBatch(message_views, &signatures));
+    ASSERT_EQ(signatures.size(), messages.size());
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+      ASYLO_EXPECT_OK(verifying_key->Verify(messages[i], der_signatures[i]));
+      ASYLO_EXPECT_OK(verifying_key->Verify(messages[i], signatures[i]));
+    }
+  }
+
+  std::vector<Signature> signatures;
+  ASYLO_ASSERT_OK(signing_key_->SignBatch({}, &signatures));
+  EXPECT_TRUE(signatures.empty());
+}
+
 // Verify that SerializeToDer() and CreateFromDer() from a serialized key are
 // working correctly, and that an EcdsaP256Sha256SigningKey restored from a
 // serialized version of another EcdsaP256Sha256SigningKey can verify a
@@ -40,6 +40,11 @@ ABSL_FLAG(int32_t, server_lifetime, -1,
 // available port.
 ABSL_FLAG(int32_t, port, 0, "Port that the server listens to");
 
+// Default value 0 serves the synchronous service.
+ABSL_FLAG(int32_t, num_polling_threads, 0,
+          "Number of completion-queue polling threads of an asynchronous "
+          "server");
+
 constexpr char kServerAddress[] = "[::1]";
 
 int main(int argc, char *argv[]) {
@@ -59,6 +64,8 @@ int main(int argc, char *argv[]) {
                           ? absl::GetFlag(FLAGS_server_lifetime)
                           : absl::GetFlag(FLAGS_server_max_lifetime));
   config.SetExtension(examples::grpc_server::port, absl::GetFlag(FLAGS_port));
+  config.SetExtension(examples::grpc_server::num_polling_threads,
+                      absl::GetFlag(FLAGS_num_polling_threads));
   *load_config.mutable_config() = config;
 
   // Create an SgxLoadConfig object.
@@ -20,12 +20,14 @@
 #include <memory>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "asylo/examples/grpc_server/grpc_server_config.pb.h"
 #include "asylo/examples/grpc_server/translator_server_impl.h"
+#include "asylo/grpc/util/async_grpc_service.h"
 #include "asylo/trusted_application.h"
 #include "asylo/util/status.h"
 #include "include/grpcpp/grpcpp.h"
@@ -39,7 +41,9 @@ namespace grpc_server {
 // An enclave that runs a TranslatorServerImpl. We override the methods of
 // TrustedApplication as follows:
 //
-// * Initialize starts the gRPC server.
+// * Initialize starts the gRPC server, serving either the synchronous service
+//   or, if the num_polling_threads extension is positive, the asynchronous
+//   service from that many completion-queue polling threads.
 // * Run waits for the server to receive the shutdown RPC or for the provided
 //   timeout to expire.
 // * Finalize shuts down the server.
@@ -52,7 +56,8 @@ namespace grpc_server {
 // example, so it is fine to rely on a non-secure source of time here.
 class GrpcServerEnclave final : public asylo::TrustedApplication {
  public:
-  GrpcServerEnclave() : service_(&shutdown_requested_) {}
+  GrpcServerEnclave()
+      : service_(&shutdown_requested_), async_service_(&shutdown_requested_) {}
 
   asylo::Status Initialize(const asylo::EnclaveConfig &enclave_config)
       LOCKS_EXCLUDED(server_mutex_) override;
@@ -73,6 +78,12 @@ class GrpcServerEnclave final : public asylo::TrustedApplication {
   // The translation service.
   TranslatorServerImpl service_;
 
+  // The asynchronous translation service, and the completion queues and
+  // threads serving it when it is used.
+  TranslatorAsyncServerImpl async_service_;
+  std::unique_ptr<asylo::CompletionQueuePoller> poller_
+      GUARDED_BY(server_mutex_);
+
   // An object that gets notified when the server receives a shutdown RPC.
   absl::Notification shutdown_requested_;
 
@@ -128,14 +139,25 @@ asylo::Status GrpcServerEnclave::Initialize(
       ::grpc::InsecureServerCredentials(), &selected_port);
 
   // Add the translator service to the server.
-  builder.RegisterService(&service_);
+  int num_polling_threads = enclave_config.GetExtension(num_polling_threads);
+  if (num_polling_threads > 0) {
+    builder.RegisterService(async_service_.GetService());
+    poller_ = absl::make_unique<asylo::CompletionQueuePoller>(
+        num_polling_threads, &builder);
+  } else {
+    builder.RegisterService(&service_);
+  }
 
   // Start the server.
   server_ = builder.BuildAndStart();
   if (!server_) {
+    poller_ = nullptr;
     return asylo::Status(asylo::error::GoogleError::INTERNAL,
                          "Failed to start server");
   }
+  if (poller_) {
+    poller_->Start(&async_service_, asylo::MethodLimits());
+  }
 
   LOG(INFO) << "Server started on port " << selected_port;
 
@@ -163,6 +185,7 @@ asylo::Status GrpcServerEnclave::Finalize(
     // Give all outstanding RPC calls 500 milliseconds to complete.
     server_->Shutdown(std::chrono::system_clock::now() +
                       std::chrono::milliseconds(500));
+    poller_ = nullptr;
     server_.reset(nullptr);
   }
 
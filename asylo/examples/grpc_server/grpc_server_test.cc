@@ -49,6 +49,11 @@ ABSL_FLAG(std::string, enclave_path, "",
 ABSL_FLAG(int32_t, server_max_lifetime, 10,
           "The number of seconds to allow the server to run for this test");
 
+// The number of client threads, and the number of RPCs each sends, in the
+// concurrent client tests.
+constexpr int kConcurrentClients = 8;
+constexpr int kRequestsPerClient = 16;
+
 // A regex matching the log message that contains the port.
 constexpr char kPortMessageRegex[] = "Server started on port [0-9]+";
 
@@ -113,6 +118,11 @@ class ServerEnclaveExecTester : public asylo::experimental::ExecTester {
 };
 
 class GrpcServerTest : public ::testing::Test {
+ protected:
+  // The number of completion-queue polling threads to serve the asynchronous
+  // service from, or zero for the synchronous service.
+  virtual int NumPollingThreads() const { return 0; }
+
  public:
   // Spawns the enclave loader subprocess and waits for it to log the port
   // number. Fails if the log message is never seen.
@@ -125,6 +135,7 @@ class GrpcServerTest : public ::testing::Test {
         absl::StrCat("--enclave_path=", absl::GetFlag(FLAGS_enclave_path)),
         absl::StrCat("--server_max_lifetime=",
                      absl::GetFlag(FLAGS_server_max_lifetime)),
+        absl::StrCat("--num_polling_threads=", NumPollingThreads()),
     });
 
     server_port_found_ = false;
@@ -201,6 +212,24 @@ class GrpcServerTest : public ::testing::Test {
     return asylo::Status(status);
   }
 
+  // Sends kRequestsPerClient GetTranslation RPCs from each of
+  // kConcurrentClients threads at once and checks every translation.
+  void RunConcurrentClients() {
+    std::vector<std::thread> clients;
+    for (int i = 0; i < kConcurrentClients; ++i) {
+      clients.emplace_back([this] {
+        for (int j = 0; j < kRequestsPerClient; ++j) {
+          std::string translation;
+          ASSERT_THAT(MakeRpc("asylo", &translation), IsOk());
+          EXPECT_EQ(translation, "sanctuary");
+        }
+      });
+    }
+    for (auto &client : clients) {
+      client.join();
+    }
+  }
+
  private:
   // Waits for server_thread_ to either set server_port_ or terminate, then
   // returns the value of server_port_.
@@ -258,6 +287,29 @@ TEST_F(GrpcServerTest, OrkutTranslationNotFound) {
                                "No known translation for \"orkut\""));
 }
 
+TEST_F(GrpcServerTest, ConcurrentClients) { RunConcurrentClients(); }
+
+// Runs the same server with the asynchronous service.
+class AsyncGrpcServerTest : public GrpcServerTest {
+ protected:
+  int NumPollingThreads() const override { return 2; }
+};
+
+TEST_F(AsyncGrpcServerTest, AsyloTranslatesToSanctuary) {
+  std::string asylo_translation;
+  ASSERT_THAT(MakeRpc("asylo", &asylo_translation), IsOk());
+  EXPECT_EQ(asylo_translation, "sanctuary");
+}
+
+TEST_F(AsyncGrpcServerTest, OrkutTranslationNotFound) {
+  std::string orkut_translation;
+  asylo::Status status = MakeRpc("orkut", &orkut_translation);
+  EXPECT_THAT(status, StatusIs(asylo::error::INVALID_ARGUMENT,
+                               "No known translation for \"orkut\""));
+}
+
+TEST_F(AsyncGrpcServerTest, ConcurrentClients) { RunConcurrentClients(); }
+
 }  // namespace
 }  // namespace grpc_server
 }  // namespace examples
@@ -69,5 +69,32 @@ TranslatorServerImpl::TranslatorServerImpl(
   return ::grpc::Status::OK;
 }
 
+TranslatorAsyncServerImpl::TranslatorAsyncServerImpl(
+    absl::Notification *shutdown_requested)
+    : handlers_(shutdown_requested) {}
+
+void TranslatorAsyncServerImpl::RequestCalls(
+    ::grpc::ServerCompletionQueue *cq, const asylo::MethodLimits &limits) {
+  asylo::AsyncUnaryCall<Translator::AsyncService, GetTranslationRequest,
+                        GetTranslationResponse>::
+      Request(&service_, &Translator::AsyncService::RequestGetTranslation,
+              [this](::grpc::ServerContext *context,
+                     const GetTranslationRequest &request,
+                     GetTranslationResponse *response) {
+                return handlers_.GetTranslation(context, &request, response);
+              },
+              cq,
+              limits.Get("/examples.grpc_server.Translator/GetTranslation"));
+  asylo::AsyncUnaryCall<Translator::AsyncService, ShutdownRequest,
+                        ShutdownResponse>::
+      Request(&service_, &Translator::AsyncService::RequestShutdown,
+              [this](::grpc::ServerContext *context,
+                     const ShutdownRequest &request,
+                     ShutdownResponse *response) {
+                return handlers_.Shutdown(context, &request, response);
+              },
+              cq, limits.Get("/examples.grpc_server.Translator/Shutdown"));
+}
+
 }  // namespace grpc_server
 }  // namespace examples
@@ -26,6 +26,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
 #include "asylo/examples/grpc_server/translator_server.grpc.pb.h"
+#include "asylo/grpc/util/async_grpc_service.h"
 #include "include/grpcpp/grpcpp.h"
 #include "include/grpcpp/server.h"
 
@@ -36,7 +37,7 @@ class TranslatorServerImpl final : public Translator::Service {
  public:
   explicit TranslatorServerImpl(absl::Notification *shutdown_requested);
 
- private:
+  // The handlers are public so that TranslatorAsyncServerImpl can share them.
   ::grpc::Status GetTranslation(::grpc::ServerContext *context,
                                 const GetTranslationRequest *request,
                                 GetTranslationResponse *response) override;
@@ -46,6 +47,7 @@ class TranslatorServerImpl final : public Translator::Service {
                           ShutdownResponse *response)
       ABSL_LOCKS_EXCLUDED(shutdown_requested_mutex_) override;
 
+ private:
   // A map from words to their translations.
   absl::flat_hash_map<std::string, std::string> translation_map_;
 
@@ -58,6 +60,24 @@ class TranslatorServerImpl final : public Translator::Service {
       ABSL_GUARDED_BY(shutdown_requested_mutex_);
 };
 
+// The translation service implemented with the asynchronous gRPC API, for
+// serving from a fixed set of completion-queue polling threads.
+class TranslatorAsyncServerImpl final : public asylo::AsyncGrpcService {
+ public:
+  explicit TranslatorAsyncServerImpl(absl::Notification *shutdown_requested);
+
+  ::grpc::Service *GetService() override { return &service_; }
+
+  void RequestCalls(::grpc::ServerCompletionQueue *cq,
+                    const asylo::MethodLimits &limits) override;
+
+ private:
+  Translator::AsyncService service_;
+
+  // Handles the calls.
+  TranslatorServerImpl handlers_;
+};
+
 }  // namespace grpc_server
 }  // namespace examples
 
@@ -53,9 +53,10 @@ ClientEkepHandshaker::ClientEkepHandshaker(const EkepHandshakerOptions &options)
       self_assertions_(options.self_assertions),
       accepted_peer_assertions_(options.accepted_peer_assertions),
       available_cipher_suites_({CURVE25519_SHA256}),
-      available_record_protocols_({ALTSRP_AES128_GCM}),
+      available_record_protocols_({ALTSRP_AES256_GCM, ALTSRP_AES128_GCM}),
       available_ekep_versions_({"EKEP v1"}),
       additional_authenticated_data_(options.additional_authenticated_data),
+      max_record_frame_size_(options.max_record_frame_size),
       selected_cipher_suite_(UNKNOWN_HANDSHAKE_CIPHER),
       selected_record_protocol_(UNKNOWN_RECORD_PROTOCOL),
       expected_message_type_(SERVER_PRECOMMIT),
@@ -218,6 +219,19 @@ Status ClientEkepHandshaker::HandleServerPrecommit(
                                RecordProtocol_Name(record_protocol)));
   }
 
+  // Verify that the server selected a record frame size that the client
+  // supports.
+  size_t record_frame_size = server_precommit.selected_record_frame_size();
+  bool frame_size_valid = (max_record_frame_size_ == 0)
+                              ? record_frame_size == 0
+                              : record_frame_size <= max_record_frame_size_;
+  if (!frame_size_valid) {
+    return Status(Abort::PROTOCOL_ERROR,
+                  absl::StrCat("Selected record frame size is invalid: ",
+                               record_frame_size));
+  }
+  SetRecordFrameSize(record_frame_size);
+
   // Verify that the server sent an adequately-sized challenge.
   if (server_precommit.challenge().size() != kEkepChallengeSize) {
     return Status(Abort::PROTOCOL_ERROR,
@@ -384,6 +398,10 @@ Status ClientEkepHandshaker::WriteClientPrecommit(std::string *output) {
         additional_authenticated_data_);
   }
 
+  if (max_record_frame_size_ != 0) {
+    client_precommit.set_max_record_frame_size(max_record_frame_size_);
+  }
+
   std::vector<uint8_t> challenge(kEkepChallengeSize);
   if (RAND_bytes(challenge.data(), kEkepChallengeSize) != 1) {
     return Status(Abort::INTERNAL_ERROR, "Internal error");
@@ -140,6 +140,10 @@ class ClientEkepHandshaker final : public EkepHandshaker {
   // Additional data that is authenticated during the handshake.
   const std::string additional_authenticated_data_;
 
+  // The maximum size of protected record protocol frames supported by the
+  // client, or zero to use the record protocol's default.
+  const size_t max_record_frame_size_;
+
   // Assertions expected from the peer. This field is populated after validation
   // of the ServerPrecommit message.
   std::vector<AssertionDescription> expected_peer_assertions_;
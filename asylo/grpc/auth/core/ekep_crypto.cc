@@ -165,7 +165,10 @@ Status DeriveRecordProtocolKey(const HandshakeCipher &ciphersuite,
   // protocol.
   switch (record_protocol) {
     case ALTSRP_AES128_GCM:
-      record_protocol_key->resize(kAltsRecordProtocolAes128GcmKeySize);
+    case ALTSRP_AES256_GCM:
+      record_protocol_key->resize(record_protocol == ALTSRP_AES128_GCM
+                                      ? kAltsRecordProtocolAes128GcmKeySize
+                                      : kAltsRecordProtocolAes256GcmKeySize);
       // Randomize the key bytes just in case the key is mistakenly used even
       // when the key derivation fails. The byte-sequence in uninitialized
       // memory could be predictable and, as a result, an attacker may be able
@@ -67,6 +67,14 @@ constexpr char kTestAuthenticatorSecret[] =
 //     kTestRecordProtocolKey
 constexpr char kTestRecordProtocolKey[] = "c7e0f5436c0fe4efdb6327469651b9fe";
 
+// Test vector for 256-bit record protocol key derivation.
+//   Inputs:
+//     kTestMasterSecret, kTestTranscriptHash
+//   Outputs:
+//     kTestRecordProtocolAes256Key
+constexpr char kTestRecordProtocolAes256Key[] =
+    "c7e0f5436c0fe4efdb6327469651b9fe0b50787e2c74e2211e57ae267fac1399";
+
 // Test vector for server handshake-authenticator computation.
 //   Inputs:
 //     kTestAuthenticatorSecret
@@ -240,6 +248,33 @@ TEST(EkepCryptoTest, DeriveRecordProtocolKeySealAes128Gcm) {
   EXPECT_EQ(*actual_key, expected_key);
 }
 
+// Verify success of DeriveRecordProtocolKey when using the ciphersuite
+// consisting of Curve25519 and SHA256, and the AES-256-GCM record protocol.
+TEST(EkepCryptoTest, DeriveRecordProtocolKeyAes256Gcm) {
+  UnsafeBytes<SHA256_DIGEST_LENGTH> transcript_hash;
+  ASYLO_ASSERT_OK(
+      SetTrivialObjectFromHexString(kTestTranscriptHash, &transcript_hash));
+
+  SafeBytes<kEkepMasterSecretSize> master_secret;
+  ASYLO_ASSERT_OK(
+      SetTrivialObjectFromHexString(kTestMasterSecret, &master_secret));
+
+  SafeBytes<kAltsRecordProtocolAes256GcmKeySize> expected_key;
+  ASYLO_ASSERT_OK(SetTrivialObjectFromHexString(kTestRecordProtocolAes256Key,
+                                                &expected_key));
+
+  CleansingVector<uint8_t> key;
+  ASSERT_TRUE(DeriveRecordProtocolKey(CURVE25519_SHA256, ALTSRP_AES256_GCM,
+                                      transcript_hash, master_secret, &key)
+                  .ok());
+
+  // Verify that the record protocol key is as expected.
+  ASSERT_EQ(key.size(), kAltsRecordProtocolAes256GcmKeySize);
+  SafeBytes<kAltsRecordProtocolAes256GcmKeySize> *actual_key =
+      SafeBytes<kAltsRecordProtocolAes256GcmKeySize>::Place(&key, /*offset=*/0);
+  EXPECT_EQ(*actual_key, expected_key);
+}
+
 // Verify that ComputeClientHandshakeAuthenticator fails and returns
 // BAD_HANDSHAKER_CIPHER when passed an unsupported ciphersuite.
 TEST(EkepCryptoTest, ComputeClientHandshakeAuthenticatorBadCipherSuite) {
@@ -94,19 +94,25 @@ EkepHandshaker::Result EkepHandshaker::NextHandshakeStep(
 
     result = StartHandshake(outgoing_bytes);
   } else {
-    // Process bytes from the peer.
-    input_stream_.AddBuffer(incoming_bytes, incoming_bytes_size);
+    // Process bytes from the peer. Frames that are entirely contained in
+    // |incoming_bytes| are parsed and added to the transcript in place.
+    input_stream_.AddUnownedBuffer(incoming_bytes, incoming_bytes_size);
 
     do {
       result = DecodeAndHandleFrame(outgoing_bytes);
-      if (result != Result::IN_PROGRESS) {
-        return result;
-      }
       // Continue processing data from the peer while there are still leftover
       // bytes from the peer and the handshaker has not encoded a response
       // frame.
-    } while (input_stream_.RemainingByteCount() != 0 &&
+    } while (result == Result::IN_PROGRESS &&
+             input_stream_.RemainingByteCount() != 0 &&
              outgoing_bytes->empty());
+
+    // |incoming_bytes| is only valid for the duration of this call, so any
+    // bytes that have not been consumed yet must be copied.
+    input_stream_.CopyUnownedBuffers();
+    if (result != Result::IN_PROGRESS) {
+      return result;
+    }
   }
 
   if (!outgoing_bytes->empty() && input_stream_.RemainingByteCount() != 0) {
@@ -241,8 +247,18 @@ StatusOr<CleansingVector<uint8_t>> EkepHandshaker::GetRecordProtocolKey() {
   return record_protocol_key_;
 }
 
+StatusOr<size_t> EkepHandshaker::GetRecordFrameSize() {
+  if (!IsHandshakeCompleted()) {
+    return Status(asylo::error::GoogleError::FAILED_PRECONDITION,
+                  "Cannot retrieve record frame size before handshake is "
+                  "complete");
+  }
+
+  return record_frame_size_;
+}
+
 EkepHandshaker::EkepHandshaker(int max_frame_size)
-    : max_frame_size_(max_frame_size) {
+    : max_frame_size_(max_frame_size), record_frame_size_(0) {
   peer_identities_ = absl::make_unique<EnclaveIdentities>();
 }
 
@@ -318,6 +334,8 @@ Status EkepHandshaker::WriteFrameAndUpdateTranscript(
     HandshakeMessageType message_type, const google::protobuf::Message &handshake_message,
     std::string *output) {
   int offset = output->size();
+  output->reserve(offset + kEkepFrameHeaderSize +
+                  handshake_message.ByteSizeLong());
   google::protobuf::io::StringOutputStream outgoing_frame(output);
   ASYLO_RETURN_IF_ERROR(
       EncodeFrame(message_type, handshake_message, &outgoing_frame));
@@ -337,6 +355,10 @@ void EkepHandshaker::SetRecordProtocol(RecordProtocol record_protocol) {
   record_protocol_ = record_protocol;
 }
 
+void EkepHandshaker::SetRecordFrameSize(size_t record_frame_size) {
+  record_frame_size_ = record_frame_size;
+}
+
 Status EkepHandshaker::DeriveAndSetRecordProtocolKey(
     HandshakeCipher cipher_suite, RecordProtocol record_protocol,
     ByteContainerView master_secret) {
@@ -363,9 +385,7 @@ Status EkepHandshaker::GetTranscriptHash(std::string *transcript_hash) {
 void EkepHandshaker::UpdateTranscriptWithOutgoingBytes(
     const char *outgoing_bytes, int outgoing_bytes_size) {
   if (outgoing_bytes_size > 0) {
-    google::protobuf::io::ArrayInputStream sent_bytes(outgoing_bytes,
-                                            outgoing_bytes_size);
-    transcript_.Add(&sent_bytes);
+    transcript_.Add(ByteContainerView(outgoing_bytes, outgoing_bytes_size));
   }
 }
 
@@ -85,6 +85,13 @@ class EkepHandshaker {
   // attack on an EkepHandshaker.
   static constexpr size_t kFrameSizeLimit = 1 << 30;  // 1 GB
 
+  // The limit for the maximum size of a protected record protocol frame that an
+  // EkepHandshaker negotiates. Larger frames amortize the per-frame overhead of
+  // the record protocol for bulk transfers, at the cost of buffering a whole
+  // frame before it can be unprotected. This is the largest frame size the ALTS
+  // frame protectors accept; they silently clamp anything larger.
+  static constexpr size_t kRecordFrameSizeLimit = 1 << 20;  // 1 MB
+
   virtual ~EkepHandshaker() = default;
 
   // Performs the next handshake step for this handshaker. This step processes a
@@ -154,6 +161,12 @@ class EkepHandshaker {
   // GoogleError::FAILED_PRECONDITION.
   StatusOr<CleansingVector<uint8_t>> GetRecordProtocolKey();
 
+  // Returns the negotiated size of protected record protocol frames, given that
+  // the handshake has successfully completed. A size of zero indicates that the
+  // default frame size of the record protocol should be used. If the handshake
+  // has not yet completed, returns GoogleError::FAILED_PRECONDITION.
+  StatusOr<size_t> GetRecordFrameSize();
+
  protected:
   enum class HandshakeState {
     NOT_STARTED = 0,
@@ -201,6 +214,10 @@ class EkepHandshaker {
   // Sets the record protocol to use after the handshake completes.
   void SetRecordProtocol(RecordProtocol record_protocol);
 
+  // Sets the size of protected frames to use with the record protocol after
+  // the handshake completes.
+  void SetRecordFrameSize(size_t record_frame_size);
+
   // Derives and sets the record protocol key using the given |cipher_suite|,
   // |record_protocol|, |master_secret|, and the current handshake transcript.
   Status DeriveAndSetRecordProtocolKey(HandshakeCipher cipher_suite,
@@ -286,6 +303,9 @@ class EkepHandshaker {
 
   // The key used in the record protocol.
   CleansingVector<uint8_t> record_protocol_key_;
+
+  // The size of protected frames to use with the record protocol.
+  size_t record_frame_size_;
 };
 
 }  // namespace asylo
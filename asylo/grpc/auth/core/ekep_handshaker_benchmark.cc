@@ -0,0 +1,134 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/grpc/auth/core/client_ekep_handshaker.h"
+#include "asylo/grpc/auth/core/ekep_handshaker.h"
+#include "asylo/grpc/auth/core/server_ekep_handshaker.h"
+#include "asylo/identity/descriptions.h"
+#include "asylo/identity/enclave_assertion_authority_config.pb.h"
+#include "asylo/identity/enclave_assertion_authority_configs.h"
+#include "asylo/identity/identity.pb.h"
+#include "asylo/identity/init.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace {
+
+using Result = EkepHandshaker::Result;
+
+// The number of handshakes performed by each measurement.
+constexpr int kBenchmarkHandshakes = 200;
+
+// A chunk size large enough to deliver every handshake flight at once.
+constexpr size_t kWholeFlight = 1 << 20;
+
+class EkepHandshakerBenchmark : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    std::vector<EnclaveAssertionAuthorityConfig> authority_configs = {
+        CreateNullAssertionAuthorityConfig(),
+    };
+    ASYLO_ASSERT_OK(InitializeEnclaveAssertionAuthorities(
+        authority_configs.cbegin(), authority_configs.cend()));
+  }
+
+  void SetUp() override {
+    AssertionDescription null_assertion_description;
+    SetNullAssertionDescription(&null_assertion_description);
+    options_.self_assertions = {null_assertion_description};
+    options_.accepted_peer_assertions = {null_assertion_description};
+  }
+
+  // Delivers |input| to |handshaker| in chunks of at most |chunk_size| bytes,
+  // appending any response bytes to |output|, and returns the result of the
+  // last handshake step.
+  static Result Deliver(EkepHandshaker *handshaker, size_t chunk_size,
+                        std::string *input, std::string *output) {
+    Result result = Result::NOT_ENOUGH_DATA;
+    std::string outgoing_bytes;
+    for (size_t offset = 0; offset < input->size(); offset += chunk_size) {
+      size_t size = std::min(chunk_size, input->size() - offset);
+      result = handshaker->NextHandshakeStep(input->data() + offset, size,
+                                             &outgoing_bytes);
+      output->append(outgoing_bytes);
+      if (result == Result::ABORTED || result == Result::COMPLETED) {
+        break;
+      }
+    }
+    input->clear();
+    return result;
+  }
+
+  // Runs kBenchmarkHandshakes handshakes with the given |chunk_size| and logs
+  // the handshake rate.
+  void RunBenchmark(size_t chunk_size, const std::string &label) {
+    absl::Time start = absl::Now();
+    for (int i = 0; i < kBenchmarkHandshakes; ++i) {
+      std::unique_ptr<EkepHandshaker> client =
+          ClientEkepHandshaker::Create(options_);
+      std::unique_ptr<EkepHandshaker> server =
+          ServerEkepHandshaker::Create(options_);
+      ASSERT_NE(client, nullptr);
+      ASSERT_NE(server, nullptr);
+
+      std::string to_server;
+      std::string to_client;
+      Result client_result = client->NextHandshakeStep(
+          /*incoming_bytes=*/nullptr, /*incoming_bytes_size=*/0, &to_server);
+      Result server_result = Result::NOT_ENOUGH_DATA;
+      while (!to_server.empty() || !to_client.empty()) {
+        if (!to_server.empty()) {
+          server_result =
+              Deliver(server.get(), chunk_size, &to_server, &to_client);
+        }
+        if (!to_client.empty()) {
+          client_result =
+              Deliver(client.get(), chunk_size, &to_client, &to_server);
+        }
+      }
+      ASSERT_EQ(client_result, Result::COMPLETED);
+      ASSERT_EQ(server_result, Result::COMPLETED);
+    }
+    LOG(INFO) << label << ": "
+              << kBenchmarkHandshakes /
+                     absl::ToDoubleSeconds(absl::Now() - start)
+              << " handshakes/s";
+  }
+
+  EkepHandshakerOptions options_;
+};
+
+// Logs the handshake rate when each flight arrives in one buffer and when
+// frames are split across many small buffers.
+TEST_F(EkepHandshakerBenchmark, HandshakeThroughput) {
+  RunBenchmark(kWholeFlight, "Whole flights");
+  RunBenchmark(/*chunk_size=*/64, "64-byte chunks");
+}
+
+}  // namespace
+}  // namespace asylo
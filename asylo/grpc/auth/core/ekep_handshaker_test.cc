@@ -0,0 +1,213 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/grpc/auth/core/ekep_handshaker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "asylo/grpc/auth/core/client_ekep_handshaker.h"
+#include "asylo/grpc/auth/core/ekep_crypto.h"
+#include "asylo/grpc/auth/core/ekep_handshaker_util.h"
+#include "asylo/grpc/auth/core/handshake.pb.h"
+#include "asylo/grpc/auth/core/server_ekep_handshaker.h"
+#include "asylo/identity/descriptions.h"
+#include "asylo/identity/enclave_assertion_authority_config.pb.h"
+#include "asylo/identity/enclave_assertion_authority_configs.h"
+#include "asylo/identity/identity.pb.h"
+#include "asylo/identity/init.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/cleansing_types.h"
+
+namespace asylo {
+namespace {
+
+using Result = EkepHandshaker::Result;
+
+constexpr char kUnusedBytes[] = "application data";
+
+// A chunk size large enough to deliver every handshake flight at once.
+constexpr size_t kWholeFlight = 1 << 20;
+
+class EkepHandshakerTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    std::vector<EnclaveAssertionAuthorityConfig> authority_configs = {
+        CreateNullAssertionAuthorityConfig(),
+    };
+    ASYLO_ASSERT_OK(InitializeEnclaveAssertionAuthorities(
+        authority_configs.cbegin(), authority_configs.cend()));
+  }
+
+  void SetUp() override {
+    AssertionDescription null_assertion_description;
+    SetNullAssertionDescription(&null_assertion_description);
+    options_.self_assertions = {null_assertion_description};
+    options_.accepted_peer_assertions = {null_assertion_description};
+  }
+
+  // Delivers |input| to |handshaker| in chunks of at most |chunk_size| bytes
+  // and appends any response bytes to |output|. The last |tail_size| bytes of
+  // |input| are delivered in the same chunk as the bytes preceding them. Each
+  // chunk is copied to a temporary buffer that is overwritten once the
+  // handshaker returns, as a network buffer would be. Returns the result of
+  // the last handshake step.
+  static Result Deliver(EkepHandshaker *handshaker, size_t chunk_size,
+                        size_t tail_size, std::string *input,
+                        std::string *output) {
+    Result result = Result::NOT_ENOUGH_DATA;
+    std::vector<char> chunk;
+    std::string outgoing_bytes;
+    size_t size;
+    for (size_t offset = 0; offset < input->size(); offset += size) {
+      size = std::min(chunk_size, input->size() - offset);
+      if (input->size() - offset - size < tail_size) {
+        size = input->size() - offset;
+      }
+      chunk.assign(input->data() + offset, input->data() + offset + size);
+      result = handshaker->NextHandshakeStep(chunk.data(), chunk.size(),
+                                             &outgoing_bytes);
+      std::fill(chunk.begin(), chunk.end(), 0);
+      output->append(outgoing_bytes);
+      if (result == Result::ABORTED || result == Result::COMPLETED) {
+        break;
+      }
+    }
+    input->clear();
+    return result;
+  }
+
+  // Runs a complete handshake between |client| and |server|, delivering bytes
+  // in chunks of at most |chunk_size| bytes. |trailing_bytes| are sent to the
+  // server immediately after the client's final frame.
+  static void RunHandshake(EkepHandshaker *client, EkepHandshaker *server,
+                           size_t chunk_size,
+                           const std::string &trailing_bytes) {
+    std::string to_server;
+    std::string to_client;
+    Result client_result = client->NextHandshakeStep(
+        /*incoming_bytes=*/nullptr, /*incoming_bytes_size=*/0, &to_server);
+    ASSERT_EQ(client_result, Result::IN_PROGRESS);
+
+    Result server_result = Result::NOT_ENOUGH_DATA;
+    while (!to_server.empty() || !to_client.empty()) {
+      if (!to_server.empty()) {
+        size_t tail_size = 0;
+        if (client_result == Result::COMPLETED) {
+          to_server.append(trailing_bytes);
+          tail_size = trailing_bytes.size();
+        }
+        server_result =
+            Deliver(server, chunk_size, tail_size, &to_server, &to_client);
+        ASSERT_NE(server_result, Result::ABORTED);
+      }
+      if (!to_client.empty()) {
+        client_result = Deliver(client, chunk_size, /*tail_size=*/0,
+                                &to_client, &to_server);
+        ASSERT_NE(client_result, Result::ABORTED);
+      }
+    }
+    EXPECT_EQ(client_result, Result::COMPLETED);
+    EXPECT_EQ(server_result, Result::COMPLETED);
+  }
+
+  EkepHandshakerOptions options_;
+};
+
+// Verifies that a handshake completes and that both participants derive the
+// same record protocol key, for several ways of fragmenting the frames.
+TEST_F(EkepHandshakerTest, HandshakeWithFragmentedFrames) {
+  for (size_t chunk_size : {kWholeFlight, size_t{64}, size_t{7}, size_t{1}}) {
+    std::unique_ptr<EkepHandshaker> client =
+        ClientEkepHandshaker::Create(options_);
+    std::unique_ptr<EkepHandshaker> server =
+        ServerEkepHandshaker::Create(options_);
+    ASSERT_NE(client, nullptr);
+    ASSERT_NE(server, nullptr);
+
+    RunHandshake(client.get(), server.get(), chunk_size,
+                 /*trailing_bytes=*/"");
+
+    CleansingVector<uint8_t> client_key;
+    CleansingVector<uint8_t> server_key;
+    ASYLO_ASSERT_OK_AND_ASSIGN(client_key, client->GetRecordProtocolKey());
+    ASYLO_ASSERT_OK_AND_ASSIGN(server_key, server->GetRecordProtocolKey());
+    EXPECT_EQ(client_key, server_key) << "chunk size " << chunk_size;
+  }
+}
+
+// Verifies that bytes received after the final frame are returned by
+// GetUnusedBytes() after the buffer they arrived in has been reused.
+TEST_F(EkepHandshakerTest, UnusedBytesOutliveIncomingBuffer) {
+  for (size_t chunk_size : {kWholeFlight, size_t{5}}) {
+    std::unique_ptr<EkepHandshaker> client =
+        ClientEkepHandshaker::Create(options_);
+    std::unique_ptr<EkepHandshaker> server =
+        ServerEkepHandshaker::Create(options_);
+    ASSERT_NE(client, nullptr);
+    ASSERT_NE(server, nullptr);
+
+    RunHandshake(client.get(), server.get(), chunk_size, kUnusedBytes);
+    EXPECT_THAT(server->GetUnusedBytes(), IsOkAndHolds(kUnusedBytes))
+        << "chunk size " << chunk_size;
+  }
+}
+
+// Verifies that the participants select the AES-256-GCM record protocol and
+// agree on the smaller of their maximum record frame sizes.
+TEST_F(EkepHandshakerTest, NegotiatesRecordProtocolAndFrameSize) {
+  struct FrameSizes {
+    size_t client;
+    size_t server;
+    size_t expected;
+  };
+  for (const FrameSizes &sizes : std::vector<FrameSizes>{
+           {0, 0, 0}, {1 << 20, 0, 0}, {0, 1 << 20, 0},
+           {1 << 20, 1 << 16, 1 << 16}, {1 << 16, 1 << 20, 1 << 16}}) {
+    EkepHandshakerOptions client_options = options_;
+    client_options.max_record_frame_size = sizes.client;
+    EkepHandshakerOptions server_options = options_;
+    server_options.max_record_frame_size = sizes.server;
+    std::unique_ptr<EkepHandshaker> client =
+        ClientEkepHandshaker::Create(client_options);
+    std::unique_ptr<EkepHandshaker> server =
+        ServerEkepHandshaker::Create(server_options);
+    ASSERT_NE(client, nullptr);
+    ASSERT_NE(server, nullptr);
+
+    RunHandshake(client.get(), server.get(), kWholeFlight,
+                 /*trailing_bytes=*/"");
+
+    EXPECT_THAT(client->GetRecordProtocol(), IsOkAndHolds(ALTSRP_AES256_GCM));
+    EXPECT_THAT(server->GetRecordProtocol(), IsOkAndHolds(ALTSRP_AES256_GCM));
+    EXPECT_THAT(client->GetRecordFrameSize(), IsOkAndHolds(sizes.expected));
+    EXPECT_THAT(server->GetRecordFrameSize(), IsOkAndHolds(sizes.expected));
+
+    CleansingVector<uint8_t> client_key;
+    ASYLO_ASSERT_OK_AND_ASSIGN(client_key, client->GetRecordProtocolKey());
+    EXPECT_EQ(client_key.size(), kAltsRecordProtocolAes256GcmKeySize);
+  }
+}
+
+}  // namespace
+}  // namespace asylo
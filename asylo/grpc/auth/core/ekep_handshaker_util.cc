@@ -24,6 +24,8 @@
 #include "asylo/identity/enclave_assertion_authority.h"
 #include "asylo/identity/enclave_assertion_generator.h"
 #include "asylo/identity/enclave_assertion_verifier.h"
+#include "asylo/identity/init.h"
+#include "asylo/util/logging.h"
 #include "asylo/util/status.h"
 
 namespace asylo {
@@ -35,7 +37,15 @@ const EnclaveAssertionGenerator *GetEnclaveAssertionGenerator(
           description.identity_type(), description.authority_type())
           .ValueOrDie();
   auto it = AssertionGeneratorMap::GetValue(authority_id);
-  return (it == AssertionGeneratorMap::value_end()) ? nullptr : &*it;
+  if (it == AssertionGeneratorMap::value_end()) {
+    return nullptr;
+  }
+
+  // The generator may have been configured for initialization on first use.
+  Status status = InitializeDeferredAssertionGenerator(authority_id);
+  LOG_IF(ERROR, !status.ok())
+      << "Could not initialize assertion generator: " << status;
+  return &*it;
 }
 
 const EnclaveAssertionVerifier *GetEnclaveAssertionVerifier(
@@ -45,7 +55,15 @@ const EnclaveAssertionVerifier *GetEnclaveAssertionVerifier(
           description.identity_type(), description.authority_type())
           .ValueOrDie();
   auto it = AssertionVerifierMap::GetValue(authority_id);
-  return (it == AssertionVerifierMap::value_end()) ? nullptr : &*it;
+  if (it == AssertionVerifierMap::value_end()) {
+    return nullptr;
+  }
+
+  // The verifier may have been configured for initialization on first use.
+  Status status = InitializeDeferredAssertionVerifier(authority_id);
+  LOG_IF(ERROR, !status.ok())
+      << "Could not initialize assertion verifier: " << status;
+  return &*it;
 }
 
 Status EkepHandshakerOptions::Validate() const {
@@ -55,6 +73,12 @@ Status EkepHandshakerOptions::Validate() const {
                                EkepHandshaker::kFrameSizeLimit));
   }
 
+  if (max_record_frame_size > EkepHandshaker::kRecordFrameSizeLimit) {
+    return Status(asylo::error::GoogleError::INVALID_ARGUMENT,
+                  absl::StrCat("max_record_frame_size cannot exceed ",
+                               EkepHandshaker::kRecordFrameSizeLimit));
+  }
+
   if (additional_authenticated_data.size() > max_frame_size) {
     return Status(asylo::error::GoogleError::INVALID_ARGUMENT,
                   "additional_authenticated_data size cannot be more than "
@@ -36,6 +36,12 @@ struct EkepHandshakerOptions {
   // The maximum frame size supported by the EKEP participant.
   size_t max_frame_size = 1 << 20;
 
+  // The maximum size of a protected frame sent or received with the record
+  // protocol after the handshake completes. The frame size used in a session
+  // is the smaller of the sizes offered by the two participants. Zero selects
+  // the default frame size of the record protocol.
+  size_t max_record_frame_size = 0;
+
   // Assertions offered by the EKEP participant.
   std::vector<AssertionDescription> self_assertions;
 
@@ -49,6 +55,8 @@ struct EkepHandshakerOptions {
   // hold, otherwise returns INVALID_ARGUMENT:
   //   * max_frame_size is non-zero and does not exceed
   //   EkepHandshaker::kFrameSizeLimit
+  //   * max_record_frame_size does not exceed
+  //   EkepHandshaker::kRecordFrameSizeLimit
   //   * self_assertions is non-empty
   //   * For each assertion description in self_assertions, there is an
   //   appropriate assertion-generation library available
@@ -63,14 +71,16 @@ struct EkepHandshakerOptions {
 // Returns a pointer to the EnclaveAssertionGenerator corresponding to identity
 // type |description|.identity_type() and authority type
 // |description|.authority_type() from the AssertionGenerator static map, or
-// nullptr if such a generator does not exist.
+// nullptr if such a generator does not exist. If initialization of the
+// generator was deferred, it is initialized before being returned.
 const EnclaveAssertionGenerator *GetEnclaveAssertionGenerator(
     const AssertionDescription &description);
 
 // Returns a pointer to the EnclaveAssertionVerifier corresponding to identity
 // type |description|.identity_type() and authority type
 // |description|.authority_type() from the AssertionVerifier static map, or
-// nullptr if such a verifier does not exist.
+// nullptr if such a verifier does not exist. If initialization of the verifier
+// was deferred, it is initialized before being returned.
 const EnclaveAssertionVerifier *GetEnclaveAssertionVerifier(
     const AssertionDescription &description);
 
@@ -93,6 +93,23 @@ TEST_F(EkepHandshakerUtilTest, ValidateBadFrameSize) {
   EXPECT_THAT(options.Validate(), Not(IsOk()));
 }
 
+// Verify that Validate fails on a set of options with a maximum record frame
+// size that exceeds the limit.
+TEST_F(EkepHandshakerUtilTest, ValidateBadRecordFrameSize) {
+  EkepHandshakerOptions options = default_options_;
+
+  // The limit matches the 1 MiB maximum frame size of the ALTS frame
+  // protectors.
+  static_assert(EkepHandshaker::kRecordFrameSizeLimit == 1 << 20,
+                "Record frame size limit must be the ALTS maximum");
+
+  options.max_record_frame_size = 1 << 20;
+  EXPECT_THAT(options.Validate(), IsOk());
+
+  options.max_record_frame_size = (1 << 20) + 1;
+  EXPECT_THAT(options.Validate(), Not(IsOk()));
+}
+
 // Verify that Validate fails on a set of options with additional authenticated
 // data that is larger than half the maximum frame size.
 TEST_F(EkepHandshakerUtilTest, ValidateBadAadSize) {
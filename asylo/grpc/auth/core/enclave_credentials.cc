@@ -89,6 +89,7 @@ grpc_enclave_channel_credentials::grpc_enclave_channel_credentials(
       /*dest=*/&accepted_peer_assertions_);
 
   peer_acl_ = options.peer_acl;
+  max_record_frame_size_ = options.max_record_frame_size;
 }
 
 grpc_enclave_server_credentials::grpc_enclave_server_credentials(
@@ -109,4 +110,5 @@ grpc_enclave_server_credentials::grpc_enclave_server_credentials(
       /*dest=*/&accepted_peer_assertions_);
 
   peer_acl_ = options.peer_acl;
+  max_record_frame_size_ = options.max_record_frame_size;
 }
@@ -67,6 +67,7 @@ class grpc_enclave_channel_credentials final : public grpc_channel_credentials {
     return &accepted_peer_assertions_;
   }
   absl::optional<asylo::IdentityAclPredicate> peer_acl() { return peer_acl_; }
+  size_t max_record_frame_size() const { return max_record_frame_size_; }
 
  private:
   // Additional authenticated data provided by the client.
@@ -80,6 +81,9 @@ class grpc_enclave_channel_credentials final : public grpc_channel_credentials {
 
   // Optional ACL enforced on the server's identity.
   absl::optional<asylo::IdentityAclPredicate> peer_acl_;
+
+  // Maximum size of protected record protocol frames offered by the client.
+  size_t max_record_frame_size_;
 };
 
 class grpc_enclave_server_credentials final : public grpc_server_credentials {
@@ -102,6 +106,7 @@ class grpc_enclave_server_credentials final : public grpc_server_credentials {
   }
 
   absl::optional<asylo::IdentityAclPredicate> peer_acl() { return peer_acl_; }
+  size_t max_record_frame_size() const { return max_record_frame_size_; }
 
  private:
   // Additional authenticated data provided by the server.
@@ -115,6 +120,9 @@ class grpc_enclave_server_credentials final : public grpc_server_credentials {
 
   // Optional ACL enforced on the client's identity.
   absl::optional<asylo::IdentityAclPredicate> peer_acl_;
+
+  // Maximum size of protected record protocol frames accepted by the server.
+  size_t max_record_frame_size_;
 };
 
 #endif  // ASYLO_GRPC_AUTH_CORE_ENCLAVE_CREDENTIALS_H_
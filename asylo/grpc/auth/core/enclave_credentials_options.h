@@ -19,6 +19,8 @@
 #ifndef ASYLO_GRPC_AUTH_CORE_ENCLAVE_CREDENTIALS_OPTIONS_H_
 #define ASYLO_GRPC_AUTH_CORE_ENCLAVE_CREDENTIALS_OPTIONS_H_
 
+#include <stddef.h>
+
 #include "absl/types/optional.h"
 #include "asylo/grpc/auth/core/assertion_description.h"
 #include "asylo/grpc/auth/util/safe_string.h"
@@ -35,6 +37,10 @@ typedef struct {
 
   /* The credential holder's accepted peer ACL. */
   absl::optional<asylo::IdentityAclPredicate> peer_acl;
+
+  /* The maximum size of protected record protocol frames, or zero to use the
+   * record protocol's default. */
+  size_t max_record_frame_size;
 } grpc_enclave_credentials_options;
 
 /* Initializes an options object. This should be called before assigning to or
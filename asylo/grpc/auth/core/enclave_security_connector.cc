@@ -173,7 +173,8 @@ class grpc_enclave_channel_security_connector final
         /*is_client=*/true, channel_creds->mutable_self_assertions(),
         channel_creds->mutable_accepted_peer_assertions(),
         channel_creds->mutable_additional_authenticated_data(),
-        channel_creds->peer_acl(), &tsi_handshaker);
+        channel_creds->peer_acl(), channel_creds->max_record_frame_size(),
+        &tsi_handshaker);
     if (result != TSI_OK) {
       gpr_log(GPR_ERROR, "Enclave handshaker creation failed with error %s.",
               tsi_result_to_string(result));
@@ -220,7 +221,8 @@ class grpc_enclave_server_security_connector final
         /*is_client=*/false, server_creds->mutable_self_assertions(),
         server_creds->mutable_accepted_peer_assertions(),
         server_creds->mutable_additional_authenticated_data(),
-        server_creds->peer_acl(), &tsi_handshaker);
+        server_creds->peer_acl(), server_creds->max_record_frame_size(),
+        &tsi_handshaker);
     if (result != TSI_OK) {
       gpr_log(GPR_ERROR, "Enclave handshaker creation failed with error %s.",
               tsi_result_to_string(result));
@@ -41,6 +41,7 @@
 #include "src/core/lib/gpr/string.h"
 #include "src/core/lib/surface/api_trace.h"
 #include "src/core/tsi/alts/frame_protector/alts_frame_protector.h"
+#include "src/core/tsi/alts/zero_copy_frame_protector/alts_zero_copy_grpc_protector.h"
 #include "src/core/tsi/transport_security.h"
 
 namespace asylo {
@@ -79,24 +80,51 @@ class TsiEnclaveHandshakerResult {
   TsiEnclaveHandshakerResult(
       bool is_client, RecordProtocol record_protocol,
       const CleansingVector<uint8_t> &record_protocol_key,
+      size_t record_frame_size,
       std::unique_ptr<EnclaveIdentities> peer_identities,
       std::string unused_bytes)
       : is_client_(is_client),
         record_protocol_(record_protocol),
         record_protocol_key_(record_protocol_key),
+        record_frame_size_(record_frame_size),
         peer_identities_(std::move(peer_identities)),
         unused_bytes_(std::move(unused_bytes)) {}
 
+  // Creates a zero-copy frame protector that uses a max frame size of
+  // |max_output_protected_frame_size|, if non-null, and places the result in
+  // |protector|. The protector seals and opens frames directly in gRPC slice
+  // buffers, avoiding the copies made by the legacy frame protector.
+  tsi_result CreateZeroCopyGrpcProtector(
+      size_t *max_output_protected_frame_size,
+      tsi_zero_copy_grpc_protector **protector) {
+    size_t frame_size;
+    switch (record_protocol_) {
+      case ALTSRP_AES128_GCM:
+      case ALTSRP_AES256_GCM:
+        return alts_zero_copy_grpc_protector_create(
+            record_protocol_key_.data(), record_protocol_key_.size(),
+            /*is_rekey=*/false, is_client_, /*is_integrity_only=*/false,
+            /*enable_extra_copy=*/false,
+            GetFrameSize(max_output_protected_frame_size, &frame_size),
+            protector);
+      default:
+        return TSI_INTERNAL_ERROR;
+    }
+  }
+
   // Creates a frame protector that uses a max frame size of
   // |max_output_protected_frame_size|, if non-null, and places the result in
   // |protector|.
   tsi_result CreateFrameProtector(size_t *max_output_protected_frame_size,
                                   tsi_frame_protector **protector) {
+    size_t frame_size;
     switch (record_protocol_) {
       case ALTSRP_AES128_GCM:
+      case ALTSRP_AES256_GCM:
         return alts_create_frame_protector(
             record_protocol_key_.data(), record_protocol_key_.size(),
-            is_client_, /*is_rekey=*/false, max_output_protected_frame_size,
+            is_client_, /*is_rekey=*/false,
+            GetFrameSize(max_output_protected_frame_size, &frame_size),
             protector);
       default:
         return TSI_INTERNAL_ERROR;
@@ -162,6 +190,25 @@ class TsiEnclaveHandshakerResult {
   }
 
  private:
+  // Returns the max frame size to pass to a frame protector. This is the
+  // smaller of the negotiated frame size and |*max_output_protected_frame_size|
+  // if either is set, and nullptr otherwise. If only the negotiated frame size
+  // is set, it is stored in |frame_size|. If non-null,
+  // |max_output_protected_frame_size| is updated to the returned frame size.
+  size_t *GetFrameSize(size_t *max_output_protected_frame_size,
+                       size_t *frame_size) const {
+    if (record_frame_size_ == 0) {
+      return max_output_protected_frame_size;
+    }
+    if (max_output_protected_frame_size == nullptr) {
+      *frame_size = record_frame_size_;
+      return frame_size;
+    }
+    *max_output_protected_frame_size =
+        std::min(*max_output_protected_frame_size, record_frame_size_);
+    return max_output_protected_frame_size;
+  }
+
   // True if this is a client handshaker result. Required for configuration of
   // the frame protector.
   bool is_client_;
@@ -172,6 +219,10 @@ class TsiEnclaveHandshakerResult {
   // The record protocol key to use for frame protection.
   CleansingVector<uint8_t> record_protocol_key_;
 
+  // The negotiated size of protected frames, or zero if the record protocol's
+  // default frame size should be used.
+  size_t record_frame_size_;
+
   // The peer's enclave identities.
   std::unique_ptr<EnclaveIdentities> peer_identities_;
 
@@ -194,6 +245,16 @@ tsi_result enclave_handshaker_result_extract_peer(
   return result->impl->ExtractPeer(peer);
 }
 
+tsi_result enclave_handshaker_result_create_zero_copy_grpc_protector(
+    const tsi_handshaker_result *self, size_t *max_output_protected_frame_size,
+    tsi_zero_copy_grpc_protector **protector) {
+  const tsi_enclave_handshaker_result *result =
+      reinterpret_cast<const tsi_enclave_handshaker_result *>(self);
+
+  return result->impl->CreateZeroCopyGrpcProtector(
+      max_output_protected_frame_size, protector);
+}
+
 tsi_result enclave_handshaker_result_create_frame_protector(
     const tsi_handshaker_result *self, size_t *max_output_protected_frame_size,
     tsi_frame_protector **protector) {
@@ -221,7 +282,7 @@ void enclave_handshaker_result_destroy(tsi_handshaker_result *self) {
 
 const tsi_handshaker_result_vtable handshaker_result_vtable = {
     enclave_handshaker_result_extract_peer,
-    nullptr /* create_zero_copy_grpc_protector */,
+    enclave_handshaker_result_create_zero_copy_grpc_protector,
     enclave_handshaker_result_create_frame_protector,
     enclave_handshaker_result_get_unused_bytes,
     enclave_handshaker_result_destroy,
@@ -331,6 +392,14 @@ tsi_result enclave_handshaker_next(
         return TSI_INTERNAL_ERROR;
       }
 
+      StatusOr<size_t> frame_size_result = handshaker->GetRecordFrameSize();
+      if (!frame_size_result.ok()) {
+        gpr_log(GPR_ERROR, "Failed to retrieve record frame size: %s",
+                std::string(frame_size_result.status().error_message())
+                    .c_str());
+        return TSI_INTERNAL_ERROR;
+      }
+
       StatusOr<std::unique_ptr<EnclaveIdentities>> identities_result =
           handshaker->GetPeerIdentities();
       if (!identities_result.ok()) {
@@ -353,7 +422,8 @@ tsi_result enclave_handshaker_next(
       tsi_result result = enclave_handshaker_result_create(
           absl::make_unique<TsiEnclaveHandshakerResult>(
               tsi_handshaker->is_client, record_protocol_result.ValueOrDie(),
-              key_result.ValueOrDie(), std::move(identities),
+              key_result.ValueOrDie(), frame_size_result.ValueOrDie(),
+              std::move(identities),
               unused_bytes_result.ValueOrDie()),
           handshaker_result);
       if (result == TSI_OK) {
@@ -416,14 +486,15 @@ tsi_result tsi_enclave_handshaker_create(
     const assertion_description_array *accepted_peer_assertions,
     const safe_string *additional_authenticated_data,
     const absl::optional<asylo::IdentityAclPredicate> &peer_acl,
-    tsi_handshaker **handshaker) {
+    size_t max_record_frame_size, tsi_handshaker **handshaker) {
   GRPC_API_TRACE(
       "tsi_enclave_handshaker_create(is_client=%d, self_assertions=%p, "
       "accepted_peer_assertions=%p, additional_authenticated_data=%p, "
-      "peer_acl=%d, handshaker=%p)",
-      6,
+      "peer_acl=%d, max_record_frame_size=%zu, handshaker=%p)",
+      7,
       (is_client, self_assertions, accepted_peer_assertions,
-       additional_authenticated_data, peer_acl.has_value(), handshaker));
+       additional_authenticated_data, peer_acl.has_value(),
+       max_record_frame_size, handshaker));
 
   // Convert arguments to handshaker options.
   asylo::EkepHandshakerOptions options;
@@ -433,6 +504,7 @@ tsi_result tsi_enclave_handshaker_create(
       asylo::CreateAssertionDescriptionVector(*self_assertions);
   options.accepted_peer_assertions =
       asylo::CreateAssertionDescriptionVector(*accepted_peer_assertions);
+  options.max_record_frame_size = max_record_frame_size;
 
   if (!options.additional_authenticated_data.empty()) {
     gpr_log(GPR_DEBUG, "additional authenticated data: %s",
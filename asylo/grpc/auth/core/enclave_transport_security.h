@@ -19,6 +19,8 @@
 #ifndef ASYLO_GRPC_AUTH_CORE_ENCLAVE_TRANSPORT_SECURITY_H_
 #define ASYLO_GRPC_AUTH_CORE_ENCLAVE_TRANSPORT_SECURITY_H_
 
+#include <stddef.h>
+
 #include "absl/types/optional.h"
 #include "asylo/grpc/auth/core/assertion_description.h"
 #include "asylo/grpc/auth/util/safe_string.h"
@@ -46,11 +48,14 @@
 //   the handshake
 //   * |peer_acl| is the ACL evaluated using the authenticated peer's
 //   identities.
+//   * |max_record_frame_size| is the maximum size of protected frames that the
+//   handshaker negotiates for the record protocol, or zero to use the record
+//   protocol's default
 tsi_result tsi_enclave_handshaker_create(
     int is_client, const assertion_description_array *self_assertions,
     const assertion_description_array *accepted_peer_assertions,
     const safe_string *additional_authenticated_data,
     const absl::optional<asylo::IdentityAclPredicate> &peer_acl,
-    tsi_handshaker **handshaker);
+    size_t max_record_frame_size, tsi_handshaker **handshaker);
 
 #endif  // ASYLO_GRPC_AUTH_CORE_ENCLAVE_TRANSPORT_SECURITY_H_
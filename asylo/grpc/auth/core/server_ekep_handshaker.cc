@@ -21,6 +21,8 @@
 #include <openssl/curve25519.h>
 #include <openssl/rand.h>
 
+#include <algorithm>
+
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include "absl/memory/memory.h"
 #include "asylo/crypto/sha256_hash.h"
@@ -59,11 +61,13 @@ ServerEkepHandshaker::ServerEkepHandshaker(const EkepHandshakerOptions &options)
       self_assertions_(options.self_assertions),
       accepted_peer_assertions_(options.accepted_peer_assertions),
       available_cipher_suites_({CURVE25519_SHA256}),
-      available_record_protocols_({ALTSRP_AES128_GCM}),
+      available_record_protocols_({ALTSRP_AES256_GCM, ALTSRP_AES128_GCM}),
       available_ekep_versions_({"EKEP v1"}),
       additional_authenticated_data_(options.additional_authenticated_data),
+      max_record_frame_size_(options.max_record_frame_size),
       selected_cipher_suite_(UNKNOWN_HANDSHAKE_CIPHER),
       selected_record_protocol_(UNKNOWN_RECORD_PROTOCOL),
+      selected_record_frame_size_(0),
       expected_message_type_(CLIENT_PRECOMMIT),
       // The handshake is in progress for the server because it relies on the
       // client to act first.
@@ -222,6 +226,7 @@ Status ServerEkepHandshaker::HandleClientPrecommit(
           client_precommit.available_record_protocols())) {
     return Status(Abort::BAD_RECORD_PROTOCOL, "No compatible record_protocol");
   }
+  SetSelectedRecordFrameSize(client_precommit.max_record_frame_size());
 
   // Verify that the client sent an adequately-sized challenge.
   if (client_precommit.challenge().size() != kEkepChallengeSize) {
@@ -361,6 +366,10 @@ Status ServerEkepHandshaker::WriteServerPrecommit(std::string *output) {
       selected_ekep_version_);
   server_precommit.set_selected_cipher_suite(selected_cipher_suite_);
   server_precommit.set_selected_record_protocol(selected_record_protocol_);
+  if (selected_record_frame_size_ != 0) {
+    server_precommit.set_selected_record_frame_size(
+        selected_record_frame_size_);
+  }
 
   if (!additional_authenticated_data_.empty()) {
     server_precommit.mutable_options()->set_data(
@@ -524,4 +533,17 @@ bool ServerEkepHandshaker::SetSelectedRecordProtocol(
   return true;
 }
 
+void ServerEkepHandshaker::SetSelectedRecordFrameSize(
+    size_t max_record_frame_size) {
+  // Use the smaller of the two maximums. If either participant did not specify
+  // a maximum, fall back to the record protocol's default frame size.
+  if (max_record_frame_size == 0 || max_record_frame_size_ == 0) {
+    selected_record_frame_size_ = 0;
+  } else {
+    selected_record_frame_size_ =
+        std::min(max_record_frame_size, max_record_frame_size_);
+  }
+  SetRecordFrameSize(selected_record_frame_size_);
+}
+
 }  // namespace asylo
@@ -117,6 +117,10 @@ class ServerEkepHandshaker final : public EkepHandshaker {
   bool SetSelectedRecordProtocol(
       const google::protobuf::RepeatedField<int> &record_protocols);
 
+  // Sets the handshaker's selected record frame size based on the client's
+  // |max_record_frame_size| and the server's own maximum.
+  void SetSelectedRecordFrameSize(size_t max_record_frame_size);
+
   // A list of assertions offered by the server.
   const std::vector<AssertionDescription> self_assertions_;
 
@@ -136,6 +140,10 @@ class ServerEkepHandshaker final : public EkepHandshaker {
   // Additional data that is authenticated during the handshake.
   const std::string additional_authenticated_data_;
 
+  // The maximum size of protected record protocol frames supported by the
+  // server, or zero to use the record protocol's default.
+  const size_t max_record_frame_size_;
+
   // Assertions requested by the client that the server is willing to offer.
   // This field is populated after validation of the ClientPrecommit message.
   std::vector<AssertionRequest> promised_assertions_;
@@ -153,6 +161,10 @@ class ServerEkepHandshaker final : public EkepHandshaker {
   // message.
   RecordProtocol selected_record_protocol_;
 
+  // The selected size of protected record protocol frames. This field is
+  // populated after validation of the ClientPrecommit message.
+  size_t selected_record_frame_size_;
+
   // The selected EKEP version for the handshake. This field is populated after
   // validation of the ClientPrecommit message.
   std::string selected_ekep_version_;
@@ -25,6 +25,7 @@
 #include <google/protobuf/io/zero_copy_stream.h>
 #include "asylo/crypto/hash_interface.h"
 #include "asylo/crypto/util/byte_container_util.h"
+#include "asylo/crypto/util/byte_container_view.h"
 #include "asylo/util/status.h"
 
 namespace asylo {
@@ -37,6 +38,10 @@ void Transcript::Add(google::protobuf::io::ZeroCopyInputStream *input) {
   }
 }
 
+void Transcript::Add(ByteContainerView bytes) {
+  Add(bytes.data(), bytes.size());
+}
+
 bool Transcript::SetHasher(HashInterface *hasher) {
   if (hasher_) {
     return false;
@@ -44,7 +49,9 @@ bool Transcript::SetHasher(HashInterface *hasher) {
   hasher_.reset(hasher);
   hasher_->Init();
   hasher_->Update(bytes_to_hash_);
-  bytes_to_hash_.clear();
+
+  // All further bytes are hashed directly, so release the buffer.
+  std::string().swap(bytes_to_hash_);
   return true;
 }
 
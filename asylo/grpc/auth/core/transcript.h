@@ -25,6 +25,7 @@
 
 #include <google/protobuf/io/zero_copy_stream.h>
 #include "asylo/crypto/hash_interface.h"
+#include "asylo/crypto/util/byte_container_view.h"
 
 namespace asylo {
 
@@ -50,9 +51,13 @@ class Transcript {
   Transcript(const Transcript &) = delete;
   Transcript &operator=(const Transcript &) = delete;
 
-  // Adds the entire contents of |input| to the transcript hash.
+  // Adds the entire contents of |input| to the transcript hash. Each chunk of
+  // |input| is hashed in place once a hash function has been set.
   void Add(google::protobuf::io::ZeroCopyInputStream *input);
 
+  // Adds |bytes| to the transcript hash.
+  void Add(ByteContainerView bytes);
+
   // Sets |hasher| as the hash function to use for hashing the transcript.
   // Returns false if a hash function has already been set. Takes ownership of
   // |hasher|.
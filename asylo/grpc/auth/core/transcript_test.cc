@@ -158,6 +158,27 @@ TYPED_TEST(TranscriptTest, AddBytesAndHash) {
   EXPECT_EQ(running_hash2, running_hash3);
 }
 
+// Verify that adding bytes directly produces the same hash as adding them
+// through an input stream.
+TYPED_TEST(TranscriptTest, AddByteContainerViewSameAsAddStream) {
+  Transcript transcript1;
+  Transcript transcript2;
+
+  AddFromString(kData1, &transcript1);
+  EXPECT_TRUE(transcript1.SetHasher(new TypeParam()));
+  AddFromString(kData2, &transcript1);
+
+  transcript2.Add(ByteContainerView(kData1));
+  EXPECT_TRUE(transcript2.SetHasher(new TypeParam()));
+  transcript2.Add(ByteContainerView(kData2));
+
+  std::string running_hash1;
+  std::string running_hash2;
+  ASSERT_TRUE(transcript1.Hash(&running_hash1));
+  ASSERT_TRUE(transcript2.Hash(&running_hash2));
+  EXPECT_EQ(running_hash1, running_hash2);
+}
+
 }  // namespace
 }  // namespace auth
 }  // namespace grpc
@@ -18,14 +18,119 @@
 
 #include "asylo/grpc/auth/enclave_auth_context.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "asylo/grpc/auth/core/enclave_grpc_security_constants.h"
 #include "asylo/identity/identity_acl_evaluator.h"
 #include "asylo/util/status.h"
+#include "asylo/util/status_macros.h"
 #include "src/core/lib/security/context/security_context.h"
 
 namespace asylo {
+namespace {
+
+using google::protobuf::internal::WireFormatLite;
+
+// The maximum number of peers whose parsed identities are kept. When it is
+// reached, an arbitrary peer is forgotten.
+constexpr size_t kMaxPeers = 256;
+
+// The maximum number of ACL verdicts memoized per peer, and the largest
+// serialized ACL that is memoized. Larger ACLs are evaluated on every call.
+constexpr size_t kMaxAclVerdicts = 64;
+constexpr size_t kMaxMemoizedAclSize = 1024;
+
+// Writes the serialization of |acl|, or of an IdentityAclPredicate holding
+// just |expectation| if |acl| is null, to |buffer|, which has room for
+// kMaxMemoizedAclSize bytes. Returns false if the serialization does not fit.
+bool SerializeAclKey(const IdentityAclPredicate *acl,
+                     const EnclaveIdentityExpectation *expectation,
+                     uint8_t *buffer, size_t *size) {
+  if (acl) {
+    *size = acl->ByteSizeLong();
+    if (*size > kMaxMemoizedAclSize) {
+      return false;
+    }
+    acl->SerializeWithCachedSizesToArray(buffer);
+    return true;
+  }
+
+  // Both EvaluateAcl() overloads share verdicts by producing the same bytes
+  // for an expectation and the predicate wrapping it.
+  size_t expectation_size = expectation->ByteSizeLong();
+  *size = WireFormatLite::TagSize(IdentityAclPredicate::kExpectationFieldNumber,
+                                  WireFormatLite::TYPE_MESSAGE) +
+          WireFormatLite::LengthDelimitedSize(expectation_size);
+  if (*size > kMaxMemoizedAclSize) {
+    return false;
+  }
+  uint8_t *target = WireFormatLite::WriteTagToArray(
+      IdentityAclPredicate::kExpectationFieldNumber,
+      WireFormatLite::WIRETYPE_LENGTH_DELIMITED, buffer);
+  target = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+      static_cast<uint32_t>(expectation_size), target);
+  expectation->SerializeWithCachedSizesToArray(target);
+  return true;
+}
+
+}  // namespace
+
+class EnclaveAuthContext::Peer {
+ public:
+  explicit Peer(const EnclaveIdentities &identities)
+      : identities_(identities.identities().begin(),
+                    identities.identities().end()) {}
+
+  const std::vector<EnclaveIdentity> &identities() const { return identities_; }
+
+  // Copies the memoized verdict for |key| to |result| and |explanation|, if
+  // there is one.
+  bool Lookup(absl::string_view key, StatusOr<bool> *result,
+              std::string *explanation) const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::ReaderMutexLock lock(&mu_);
+    auto it = verdicts_.find(key);
+    if (it == verdicts_.end()) {
+      return false;
+    }
+    *result = it->second.result;
+    if (explanation && !it->second.explanation.empty()) {
+      *explanation = it->second.explanation;
+    }
+    return true;
+  }
+
+  void Insert(absl::string_view key, const StatusOr<bool> &result,
+              const std::string &explanation) ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    if (verdicts_.size() >= kMaxAclVerdicts) {
+      verdicts_.erase(verdicts_.begin());
+    }
+    verdicts_.emplace(key, Verdict{result, explanation});
+  }
+
+ private:
+  struct Verdict {
+    StatusOr<bool> result;
+    std::string explanation;
+  };
+
+  // Enclave identities held by the peer.
+  const std::vector<EnclaveIdentity> identities_;
+
+  // Verdicts keyed by serialized IdentityAclPredicate.
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, Verdict> verdicts_ ABSL_GUARDED_BY(mu_);
+};
 
 StatusOr<EnclaveAuthContext> EnclaveAuthContext::CreateFromServerContext(
     const ::grpc::ServerContext &server_context) {
@@ -39,7 +144,7 @@ StatusOr<EnclaveAuthContext> EnclaveAuthContext::CreateFromAuthContext(
                   "Peer is not authenticated");
   }
 
-  EnclaveIdentities identities;
+  absl::string_view serialized_identities;
   uint32_t record_protocol = 0;
   for (auto it = auth_context.begin(); it != auth_context.end(); ++it) {
     ::grpc::AuthProperty auth_property = *it;
@@ -50,11 +155,8 @@ StatusOr<EnclaveAuthContext> EnclaveAuthContext::CreateFromAuthContext(
           &record_protocol);
     } else if (auth_property.first ==
                auth_context.GetPeerIdentityPropertyName()) {
-      if (!identities.ParseFromArray(auth_property.second.data(),
-                                     auth_property.second.length())) {
-        return Status(error::GoogleError::INVALID_ARGUMENT,
-                      "Ill-formed peer identity in auth context");
-      }
+      serialized_identities = absl::string_view(
+          auth_property.second.data(), auth_property.second.length());
     } else if (auth_property.first ==
                GRPC_TRANSPORT_SECURITY_TYPE_PROPERTY_NAME) {
       if (auth_property.second != GRPC_ENCLAVE_TRANSPORT_SECURITY_TYPE) {
@@ -74,15 +176,52 @@ StatusOr<EnclaveAuthContext> EnclaveAuthContext::CreateFromAuthContext(
     }
   }
 
-  return EnclaveAuthContext(std::move(identities),
+  std::shared_ptr<Peer> peer;
+  ASYLO_ASSIGN_OR_RETURN(peer, FindOrParsePeer(serialized_identities));
+  return EnclaveAuthContext(std::move(peer),
                             static_cast<RecordProtocol>(record_protocol));
 }
 
-EnclaveAuthContext::EnclaveAuthContext(EnclaveIdentities identities,
+StatusOr<std::shared_ptr<EnclaveAuthContext::Peer>>
+EnclaveAuthContext::FindOrParsePeer(absl::string_view serialized_identities) {
+  // The serialized identities of a connection never change, so they identify
+  // the connection's peer for as long as the connection lasts.
+  static absl::Mutex *peers_mutex = new absl::Mutex;
+  static auto *peers =
+      new absl::flat_hash_map<std::string, std::shared_ptr<Peer>>;
+  {
+    absl::ReaderMutexLock lock(peers_mutex);
+    auto it = peers->find(serialized_identities);
+    if (it != peers->end()) {
+      return it->second;
+    }
+  }
+
+  EnclaveIdentities identities;
+  if (!identities.ParseFromArray(serialized_identities.data(),
+                                 serialized_identities.size())) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Ill-formed peer identity in auth context");
+  }
+  auto peer = std::make_shared<Peer>(identities);
+
+  absl::MutexLock lock(peers_mutex);
+  if (peers->size() >= kMaxPeers) {
+    peers->erase(peers->begin());
+  }
+  return peers->emplace(serialized_identities, std::move(peer))
+      .first->second;
+}
+
+EnclaveAuthContext::EnclaveAuthContext(std::shared_ptr<Peer> peer,
                                        RecordProtocol record_protocol)
-    : identities_(
-          {identities.identities().begin(), identities.identities().end()}),
-      record_protocol_(record_protocol) {}
+    : peer_(std::move(peer)), record_protocol_(record_protocol) {}
+
+const std::vector<EnclaveIdentity> &EnclaveAuthContext::identities() const {
+  static const std::vector<EnclaveIdentity> *const kNoIdentities =
+      new std::vector<EnclaveIdentity>;
+  return peer_ ? peer_->identities() : *kNoIdentities;
+}
 
 RecordProtocol EnclaveAuthContext::GetRecordProtocol() const {
   return record_protocol_;
@@ -95,15 +234,16 @@ bool EnclaveAuthContext::HasEnclaveIdentity(
 
 StatusOr<const EnclaveIdentity *> EnclaveAuthContext::FindEnclaveIdentity(
     const EnclaveIdentityDescription &description) const {
+  const std::vector<EnclaveIdentity> &peer_identities = identities();
   auto it = std::find_if(
-      identities_.cbegin(), identities_.cend(),
+      peer_identities.cbegin(), peer_identities.cend(),
       [&description](const EnclaveIdentity &identity) -> bool {
         return identity.description().identity_type() ==
                    description.identity_type() &&
                identity.description().authority_type() ==
                    description.authority_type();
       });
-  if (it == identities_.cend()) {
+  if (it == peer_identities.cend()) {
     return Status(error::GoogleError::NOT_FOUND, "No matching identity");
   }
   return &*it;
@@ -116,8 +256,7 @@ StatusOr<bool> EnclaveAuthContext::EvaluateAcl(
 
 StatusOr<bool> EnclaveAuthContext::EvaluateAcl(const IdentityAclPredicate &acl,
                                                std::string *explanation) const {
-  return EvaluateIdentityAcl(identities_, acl, matcher_,
-                             /*explanation=*/explanation);
+  return EvaluateMemoized(&acl, /*expectation=*/nullptr, explanation);
 }
 
 StatusOr<bool> EnclaveAuthContext::EvaluateAcl(
@@ -128,9 +267,43 @@ StatusOr<bool> EnclaveAuthContext::EvaluateAcl(
 StatusOr<bool> EnclaveAuthContext::EvaluateAcl(
     const EnclaveIdentityExpectation &expectation,
     std::string *explanation) const {
-  IdentityAclPredicate acl;
-  *acl.mutable_expectation() = expectation;
-  return EvaluateAcl(acl, explanation);
+  return EvaluateMemoized(/*acl=*/nullptr, &expectation, explanation);
+}
+
+StatusOr<bool> EnclaveAuthContext::EvaluateMemoized(
+    const IdentityAclPredicate *acl,
+    const EnclaveIdentityExpectation *expectation,
+    std::string *explanation) const {
+  uint8_t key_buffer[kMaxMemoizedAclSize];
+  size_t key_size;
+  bool memoize =
+      peer_ && SerializeAclKey(acl, expectation, key_buffer, &key_size);
+  absl::string_view key(reinterpret_cast<const char *>(key_buffer),
+                        memoize ? key_size : 0);
+
+  StatusOr<bool> result;
+  if (memoize && peer_->Lookup(key, &result, explanation)) {
+    return result;
+  }
+
+  IdentityAclPredicate expectation_acl;
+  if (!acl) {
+    *expectation_acl.mutable_expectation() = *expectation;
+    acl = &expectation_acl;
+  }
+  if (!memoize) {
+    return EvaluateIdentityAcl(identities(), *acl, matcher_, explanation);
+  }
+  // Always produce the explanation, so that later calls that ask for it can be
+  // answered from the memoized verdict.
+  std::string verdict_explanation;
+  result =
+      EvaluateIdentityAcl(identities(), *acl, matcher_, &verdict_explanation);
+  peer_->Insert(key, result, verdict_explanation);
+  if (explanation && !verdict_explanation.empty()) {
+    *explanation = std::move(verdict_explanation);
+  }
+  return result;
 }
 
 }  // namespace asylo
@@ -19,9 +19,11 @@
 #ifndef ASYLO_GRPC_AUTH_ENCLAVE_AUTH_CONTEXT_H_
 #define ASYLO_GRPC_AUTH_ENCLAVE_AUTH_CONTEXT_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "asylo/grpc/auth/core/handshake.pb.h"
 #include "asylo/identity/delegating_identity_expectation_matcher.h"
 #include "asylo/identity/identity.pb.h"
@@ -36,6 +38,11 @@ namespace asylo {
 /// The authentication properties in an EnclaveAuthContext object include the
 /// secure transport protocol and the peer's enclave identities.
 ///
+/// The parsed identities of a peer are shared by every EnclaveAuthContext
+/// created for its connections, and the results of evaluating ACLs against
+/// them are memoized, so that authorizing each call on a long-lived connection
+/// does not repeat the work.
+///
 /// Virtual functions are only for mocking.
 class EnclaveAuthContext {
  public:
@@ -50,7 +57,8 @@ class EnclaveAuthContext {
       const ::grpc::ServerContext &server_context);
 
   /// Creates an EnclaveAuthContext from the authentication properties in
-  /// `auth_context`.
+  /// `auth_context`. The peer's identities are only parsed the first time they
+  /// are seen.
   ///
   /// \param auth_context An authentication context.
   static StatusOr<EnclaveAuthContext> CreateFromAuthContext(
@@ -122,16 +130,36 @@ class EnclaveAuthContext {
       std::string *explanation) const;
 
  private:
-  // Creates an EnclaveAuthContext for the given peer's |identities| and the
-  // session |record_protocol|.
-  EnclaveAuthContext(EnclaveIdentities identities,
+  // The parsed identities of a peer and its memoized ACL verdicts. Defined in
+  // the source file.
+  class Peer;
+
+  // Returns the Peer for |serialized_identities|, parsing them only if they
+  // have not been seen recently.
+  static StatusOr<std::shared_ptr<Peer>> FindOrParsePeer(
+      absl::string_view serialized_identities);
+
+  // Creates an EnclaveAuthContext for the given |peer| and the session
+  // |record_protocol|.
+  EnclaveAuthContext(std::shared_ptr<Peer> peer,
                      RecordProtocol record_protocol);
 
-  // Enclave identities held by the authenticated peer.
-  std::vector<EnclaveIdentity> identities_;
+  // Returns the peer's identities.
+  const std::vector<EnclaveIdentity> &identities() const;
+
+  // Evaluates either |acl| or, if it is null, the ACL consisting of just
+  // |expectation| against the peer's identities, reusing a memoized verdict if
+  // there is one.
+  StatusOr<bool> EvaluateMemoized(const IdentityAclPredicate *acl,
+                                  const EnclaveIdentityExpectation *expectation,
+                                  std::string *explanation) const;
+
+  // Enclave identities held by the authenticated peer. Null if this object was
+  // default-constructed.
+  std::shared_ptr<Peer> peer_;
 
   // Secure transport record protocol.
-  RecordProtocol record_protocol_;
+  RecordProtocol record_protocol_ = RecordProtocol::UNKNOWN_RECORD_PROTOCOL;
 
   // Matcher used to evaluate ACLs against the authenticated peer's identities.
   DelegatingIdentityExpectationMatcher matcher_;
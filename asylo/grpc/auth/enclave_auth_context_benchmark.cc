@@ -0,0 +1,130 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/grpc/auth/core/enclave_grpc_security_constants.h"
+#include "asylo/grpc/auth/core/handshake.pb.h"
+#include "asylo/grpc/auth/enclave_auth_context.h"
+#include "asylo/identity/identity.pb.h"
+#include "asylo/identity/named_identity_expectation_matcher.h"
+#include "asylo/platform/common/static_map.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/statusor.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/security/context/security_context.h"
+#include "src/cpp/common/secure_auth_context.h"
+
+namespace asylo {
+namespace {
+
+constexpr char kIdentity[] = "Identity";
+constexpr char kAuthorityType[] = "Benchmark Authority";
+
+// Matches identities whose identity field equals the expectation's match spec.
+class BenchmarkIdentityExpectationMatcher
+    : public NamedIdentityExpectationMatcher {
+ public:
+  StatusOr<bool> MatchAndExplain(const EnclaveIdentity &identity,
+                                 const EnclaveIdentityExpectation &expectation,
+                                 std::string *explanation) const override {
+    return identity.identity() == expectation.match_spec();
+  }
+
+  StatusOr<bool> Match(
+      const EnclaveIdentity &identity,
+      const EnclaveIdentityExpectation &expectation) const override {
+    return MatchAndExplain(identity, expectation, /*explanation=*/nullptr);
+  }
+
+  EnclaveIdentityDescription Description() const override {
+    EnclaveIdentityDescription description;
+    description.set_identity_type(EnclaveIdentityType::CODE_IDENTITY);
+    description.set_authority_type(kAuthorityType);
+    return description;
+  }
+};
+
+SET_STATIC_MAP_VALUE_OF_DERIVED_TYPE(IdentityExpectationMatcherMap,
+                                     BenchmarkIdentityExpectationMatcher);
+
+// Measures the per-call cost of building an EnclaveAuthContext from a
+// connection's auth context and evaluating an ACL against it, as an enclave
+// server does for every authorized RPC, and logs the result.
+TEST(EnclaveAuthContextBenchmark, PerCallAuthorizationOverhead) {
+  constexpr absl::Duration kBenchmarkDuration = absl::Seconds(1);
+
+  EnclaveIdentityDescription description;
+  description.set_identity_type(EnclaveIdentityType::CODE_IDENTITY);
+  description.set_authority_type(kAuthorityType);
+
+  EnclaveIdentities identities;
+  EnclaveIdentity *identity = identities.add_identities();
+  identity->set_identity(kIdentity);
+  *identity->mutable_description() = description;
+  std::string serialized_identities;
+  ASSERT_TRUE(identities.SerializeToString(&serialized_identities));
+
+  std::vector<uint8_t> record_protocol(sizeof(uint32_t));
+  google::protobuf::io::CodedOutputStream::WriteLittleEndian32ToArray(
+      RecordProtocol::ALTSRP_AES128_GCM, record_protocol.data());
+
+  auto secure_auth_context = absl::make_unique<::grpc::SecureAuthContext>(
+      grpc_core::MakeRefCounted<grpc_auth_context>(/*chained=*/nullptr).get());
+  secure_auth_context->AddProperty(GRPC_ENCLAVE_IDENTITIES_PROTO_PROPERTY_NAME,
+                                   serialized_identities);
+  secure_auth_context->SetPeerIdentityPropertyName(
+      GRPC_ENCLAVE_IDENTITIES_PROTO_PROPERTY_NAME);
+  secure_auth_context->AddProperty(
+      GRPC_ENCLAVE_RECORD_PROTOCOL_PROPERTY_NAME,
+      std::string(reinterpret_cast<const char *>(record_protocol.data()),
+                  record_protocol.size()));
+  secure_auth_context->AddProperty(GRPC_TRANSPORT_SECURITY_TYPE_PROPERTY_NAME,
+                                   GRPC_ENCLAVE_TRANSPORT_SECURITY_TYPE);
+
+  IdentityAclPredicate acl;
+  EnclaveIdentityExpectation *expectation = acl.mutable_expectation();
+  *expectation->mutable_reference_identity()->mutable_description() =
+      description;
+  expectation->set_match_spec(kIdentity);
+
+  uint64_t calls = 0;
+  absl::Time start = absl::Now();
+  while (absl::Now() - start < kBenchmarkDuration) {
+    EnclaveAuthContext auth_context;
+    ASYLO_ASSERT_OK_AND_ASSIGN(
+        auth_context,
+        EnclaveAuthContext::CreateFromAuthContext(*secure_auth_context));
+    ASSERT_THAT(auth_context.EvaluateAcl(acl), IsOkAndHolds(true));
+    ++calls;
+  }
+  absl::Duration elapsed = absl::Now() - start;
+  LOG(INFO) << "Authorization overhead: " << elapsed / calls << " per call";
+}
+
+}  // namespace
+}  // namespace asylo
@@ -366,5 +366,70 @@ TEST_F(EnclaveAuthContextTest, EvaluateAclSuccess) {
   }
 }
 
+// Verify that EnclaveAuthContexts created for the same peer share its parsed
+// identities.
+TEST_F(EnclaveAuthContextTest, PeerIdentitiesAreShared) {
+  EnclaveAuthContext first;
+  ASYLO_ASSERT_OK_AND_ASSIGN(
+      first, EnclaveAuthContext::CreateFromAuthContext(*secure_auth_context_));
+  EnclaveAuthContext second;
+  ASYLO_ASSERT_OK_AND_ASSIGN(
+      second, EnclaveAuthContext::CreateFromAuthContext(*secure_auth_context_));
+
+  const EnclaveIdentity *first_identity;
+  ASYLO_ASSERT_OK_AND_ASSIGN(
+      first_identity, first.FindEnclaveIdentity(good_identity_description_));
+  const EnclaveIdentity *second_identity;
+  ASYLO_ASSERT_OK_AND_ASSIGN(
+      second_identity, second.FindEnclaveIdentity(good_identity_description_));
+  EXPECT_EQ(first_identity, second_identity);
+}
+
+// Verify that memoized ACL verdicts are reported with their explanations, and
+// are shared between the two EvaluateAcl() overloads.
+TEST_F(EnclaveAuthContextTest, MemoizedVerdictsKeepExplanations) {
+  EnclaveAuthContext auth_context;
+  ASYLO_ASSERT_OK_AND_ASSIGN(
+      auth_context,
+      EnclaveAuthContext::CreateFromAuthContext(*secure_auth_context_));
+
+  IdentityAclPredicate acl;
+  EnclaveIdentityExpectation *expectation = acl.mutable_expectation();
+  *expectation->mutable_reference_identity()->mutable_description() =
+      good_identity_description_;
+  expectation->set_match_spec(kMatchSpec2);
+
+  EXPECT_THAT(auth_context.EvaluateAcl(acl), IsOkAndHolds(false));
+  for (int i = 0; i < 2; ++i) {
+    std::string explanation;
+    ASSERT_THAT(auth_context.EvaluateAcl(acl, &explanation),
+                IsOkAndHolds(false));
+    EXPECT_THAT(explanation, HasSubstr(kIdentityMismatchError));
+
+    explanation.clear();
+    ASSERT_THAT(auth_context.EvaluateAcl(acl.expectation(), &explanation),
+                IsOkAndHolds(false));
+    EXPECT_THAT(explanation, HasSubstr(kIdentityMismatchError));
+  }
+
+  // A different ACL gets its own verdict.
+  expectation->set_match_spec(kMatchSpec1);
+  EXPECT_THAT(auth_context.EvaluateAcl(acl), IsOkAndHolds(true));
+  EXPECT_THAT(auth_context.EvaluateAcl(acl.expectation()), IsOkAndHolds(true));
+}
+
+// Verify that a default-constructed EnclaveAuthContext has no identities.
+TEST_F(EnclaveAuthContextTest, DefaultConstructedHasNoIdentities) {
+  EnclaveAuthContext auth_context;
+  EXPECT_FALSE(auth_context.HasEnclaveIdentity(good_identity_description_));
+
+  IdentityAclPredicate acl;
+  EnclaveIdentityExpectation *expectation = acl.mutable_expectation();
+  *expectation->mutable_reference_identity()->mutable_description() =
+      good_identity_description_;
+  expectation->set_match_spec(kMatchSpec1);
+  EXPECT_THAT(auth_context.EvaluateAcl(acl), IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace asylo
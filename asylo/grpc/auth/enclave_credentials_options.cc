@@ -17,6 +17,8 @@
  */
 #include "asylo/grpc/auth/enclave_credentials_options.h"
 
+#include <algorithm>
+
 #include "asylo/identity/identity_acl.pb.h"
 
 namespace asylo {
@@ -48,6 +50,8 @@ EnclaveCredentialsOptions &EnclaveCredentialsOptions::Add(
       peer_acl = additional.peer_acl;
     }
   }
+  max_record_frame_size =
+      std::max(max_record_frame_size, additional.max_record_frame_size);
 
   return *this;
 }
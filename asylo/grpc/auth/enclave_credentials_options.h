@@ -19,6 +19,7 @@
 #ifndef ASYLO_GRPC_AUTH_ENCLAVE_CREDENTIALS_OPTIONS_H_
 #define ASYLO_GRPC_AUTH_ENCLAVE_CREDENTIALS_OPTIONS_H_
 
+#include <cstddef>
 #include <string>
 
 #include "absl/types/optional.h"
@@ -53,6 +54,14 @@ struct EnclaveCredentialsOptions {
   /// authenticated peer's identities will cause gRPC channel establishment to
   /// fail.
   absl::optional<IdentityAclPredicate> peer_acl;
+
+  /// The maximum size, in bytes, of the protected frames used to carry gRPC
+  /// traffic after the channel is established. The frame size used by a
+  /// channel is the smaller of the sizes configured by its two endpoints.
+  /// Larger frames reduce the per-frame overhead of bulk transfers. The size
+  /// must not exceed 1 MiB, the largest frame the record protocol supports. If
+  /// zero, the default frame size of the record protocol is used.
+  size_t max_record_frame_size = 0;
 };
 
 }  // namespace asylo
@@ -151,5 +151,16 @@ TEST_F(EnclaveCredentialsOptionsTest, CombineIdentityAclPredicates) {
   EXPECT_THAT(lhs.Add(rhs).peer_acl, Optional(EqualsProto(combined)));
 }
 
+TEST_F(EnclaveCredentialsOptionsTest, AddKeepsLargerMaxRecordFrameSize) {
+  EnclaveCredentialsOptions lhs = BidirectionalNullCredentialsOptions();
+  lhs.max_record_frame_size = 1 << 16;
+  EnclaveCredentialsOptions rhs = BidirectionalNullCredentialsOptions();
+  rhs.max_record_frame_size = 1 << 20;
+  EXPECT_EQ(lhs.Add(rhs).max_record_frame_size, 1 << 20);
+  EXPECT_EQ(lhs.Add(BidirectionalNullCredentialsOptions())
+                .max_record_frame_size,
+            1 << 20);
+}
+
 }  // namespace
 }  // namespace asylo
@@ -65,6 +65,7 @@ void CopyEnclaveCredentialsOptions(const EnclaveCredentialsOptions &src,
   }
 
   dest->peer_acl = src.peer_acl;
+  dest->max_record_frame_size = src.max_record_frame_size;
 }
 
 }  // namespace asylo
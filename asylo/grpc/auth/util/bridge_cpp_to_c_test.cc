@@ -94,6 +94,9 @@ bool CredentialsOptionsAreEqual(
                                      actual.accepted_peer_assertions)) {
     return false;
   }
+  if (expected.max_record_frame_size != actual.max_record_frame_size) {
+    return false;
+  }
   return AdditionalAuthenticatedDataIsEqual(
       expected.additional_authenticated_data,
       actual.additional_authenticated_data);
@@ -21,6 +21,12 @@
 #include "asylo/util/logging.h"
 
 namespace asylo {
+namespace {
+
+// The maximum number of released buffers kept for reuse.
+constexpr size_t kMaxFreeBuffers = 4;
+
+}  // namespace
 
 MultiBufferInputStream::MultiBufferInputStream()
     : buffers_(BufferList()),
@@ -36,24 +42,24 @@ bool MultiBufferInputStream::Next(const void **data, int *size) {
     return false;
   }
 
-  std::vector<char> *buffer = current_->get();
-  if (buffer->size() == offset_) {
+  const Buffer *buffer = &*current_;
+  if (buffer->size == offset_) {
     // Advance to the next buffer, if one exists.
     if (++current_ == buffers_.cend()) {
       // Don't let the caller back up.
       last_returned_size_ = 0;
       return false;
     }
-    buffer = current_->get();
+    buffer = &*current_;
     offset_ = 0;
   }
 
-  *data = buffer->data() + offset_;
-  *size = buffer->size() - offset_;
+  *data = buffer->data + offset_;
+  *size = buffer->size - offset_;
 
-  last_returned_size_ = buffer->size() - offset_;
+  last_returned_size_ = buffer->size - offset_;
   bytes_read_ += last_returned_size_;
-  offset_ = buffer->size();
+  offset_ = buffer->size;
 
   return true;
 }
@@ -92,7 +98,7 @@ bool MultiBufferInputStream::Skip(int count) {
   last_returned_size_ = 0;
 
   while (count > 0) {
-    if (current_->get()->size() == offset_) {
+    if (current_->size == offset_) {
       // Advance to the next buffer, if one exists.
       if (++current_ == buffers_.cend()) {
         return false;
@@ -100,7 +106,7 @@ bool MultiBufferInputStream::Skip(int count) {
       offset_ = 0;
     }
 
-    int bytes_remaining = current_->get()->size() - offset_;
+    int bytes_remaining = current_->size - offset_;
     int bytes_to_skip = (count <= bytes_remaining) ? count : bytes_remaining;
 
     offset_ += bytes_to_skip;
@@ -113,32 +119,55 @@ bool MultiBufferInputStream::Skip(int count) {
 int64_t MultiBufferInputStream::ByteCount() const { return bytes_read_; }
 
 void MultiBufferInputStream::AddBuffer(const char *data, size_t size) {
-  std::vector<char> *buffer = new std::vector<char>(data, data + size);
-  buffers_.emplace_back(std::unique_ptr<std::vector<char>>(buffer));
+  Buffer *buffer = AppendBuffer(size);
+  buffer->storage.assign(data, data + size);
+  buffer->data = buffer->storage.data();
+}
 
-  // Adjust the current_ pointer in case it was pointing at the end of the list.
-  if (current_ == buffers_.cend()) {
-    current_--;
+void MultiBufferInputStream::AddUnownedBuffer(const char *data, size_t size) {
+  if (size == 0) {
+    return;
   }
+  Buffer *buffer = AppendBuffer(size);
+  buffer->storage.clear();
+  buffer->data = data;
+}
 
-  // Update the stream size.
-  size_ += size;
+void MultiBufferInputStream::CopyUnownedBuffers() {
+  for (auto it = buffers_.begin(); it != buffers_.end(); ++it) {
+    if (!it->storage.empty() || it->size == 0) {
+      continue;
+    }
+
+    // Bytes of the first buffer before trim_offset_ are no longer part of the
+    // stream, so they are not copied.
+    int start = (it == buffers_.begin()) ? trim_offset_ : 0;
+    it->storage.assign(it->data + start, it->data + it->size);
+    it->data = it->storage.data();
+    it->size -= start;
+    if (start != 0) {
+      if (current_ == it) {
+        offset_ -= start;
+      }
+      trim_offset_ = 0;
+    }
+  }
 }
 
 void MultiBufferInputStream::TrimFront() {
   // Remove all buffers up to the current buffer.
   while (buffers_.cbegin() != current_) {
-    buffers_.pop_front();
+    PopFront();
   }
 
   if (current_ == buffers_.cend()) {
     // The entire stream has been consumed.
     offset_ = 0;
     trim_offset_ = 0;
-  } else if (current_->get()->size() == offset_) {
+  } else if (current_->size == offset_) {
     // The current buffer has been entirely consumed. Remove it.
     current_++;
-    buffers_.pop_front();
+    PopFront();
 
     // Update the offsets.
     offset_ = 0;
@@ -174,13 +203,13 @@ std::string MultiBufferInputStream::RemainingBytes() const {
     return contents;
   }
 
+  contents.reserve(RemainingByteCount());
+
   // The first buffer may be partially consumed.
-  std::vector<char> *buffer = it->get();
-  contents.append(buffer->data() + offset_, buffer->size() - offset_);
+  contents.append(it->data + offset_, it->size - offset_);
 
   while (++it != buffers_.cend()) {
-    buffer = it->get();
-    contents.append(buffer->data(), buffer->size());
+    contents.append(it->data, it->size);
   }
   return contents;
 }
@@ -189,4 +218,31 @@ int MultiBufferInputStream::RemainingByteCount() const {
   return size_ - bytes_read_;
 }
 
+MultiBufferInputStream::Buffer *MultiBufferInputStream::AppendBuffer(
+    size_t size) {
+  if (free_buffers_.empty()) {
+    buffers_.emplace_back();
+  } else {
+    buffers_.splice(buffers_.end(), free_buffers_, free_buffers_.begin());
+  }
+  Buffer *buffer = &buffers_.back();
+  buffer->size = size;
+
+  // Adjust the current_ pointer in case it was pointing at the end of the list.
+  if (current_ == buffers_.cend()) {
+    current_--;
+  }
+
+  // Update the stream size.
+  size_ += size;
+  return buffer;
+}
+
+void MultiBufferInputStream::PopFront() {
+  free_buffers_.splice(free_buffers_.begin(), buffers_, buffers_.begin());
+  if (free_buffers_.size() > kMaxFreeBuffers) {
+    free_buffers_.pop_back();
+  }
+}
+
 }  // namespace asylo
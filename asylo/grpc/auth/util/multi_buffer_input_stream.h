@@ -19,8 +19,9 @@
 #ifndef ASYLO_GRPC_AUTH_UTIL_MULTI_BUFFER_INPUT_STREAM_H_
 #define ASYLO_GRPC_AUTH_UTIL_MULTI_BUFFER_INPUT_STREAM_H_
 
+#include <cstddef>
 #include <list>
-#include <memory>
+#include <string>
 #include <vector>
 
 #include <google/protobuf/io/zero_copy_stream.h>
@@ -48,8 +49,11 @@ using google::protobuf::io::ZeroCopyInputStream;
 //
 // Unlike most ZeroCopyInputStream implementations, MultiBufferInputStream's
 // constructor does not accept parameters that initialize the stream contents.
-// Instead, buffers are added to the stream via the AddBuffer() method. This is
-// the only time that data is copied.
+// Instead, buffers are added to the stream via the AddBuffer() method, which
+// copies the data, or the AddUnownedBuffer() method, which does not. Unowned
+// buffers are only copied if their data is still part of the stream when
+// CopyUnownedBuffers() is called. Buffers released by TrimFront() are reused
+// by subsequently added buffers.
 //
 // This class is thread-compatible.
 class MultiBufferInputStream : public ZeroCopyInputStream {
@@ -66,6 +70,17 @@ class MultiBufferInputStream : public ZeroCopyInputStream {
   // Adds a new buffer containing |size| bytes from |data| to the stream.
   void AddBuffer(const char *data, size_t size);
 
+  // Adds a buffer that refers to |size| bytes at |data| to the stream without
+  // copying them. The caller must keep |data| valid and unmodified until the
+  // buffer has been trimmed from the stream or CopyUnownedBuffers() has been
+  // called.
+  void AddUnownedBuffer(const char *data, size_t size);
+
+  // Copies the bytes of all unowned buffers that are still part of the stream
+  // into storage owned by the stream. Bytes that have been trimmed from the
+  // stream are not copied. Does not change the position of the stream.
+  void CopyUnownedBuffers();
+
   // Trims the first ByteCount() bytes from the front of the stream. All
   // unconsumed data in the stream is unaffected. After calling TrimFront(),
   // ByteCount() will return 0 until more data is consumed through a call to
@@ -91,10 +106,29 @@ class MultiBufferInputStream : public ZeroCopyInputStream {
   int RemainingByteCount() const;
 
  private:
-  using BufferList = std::list<std::unique_ptr<std::vector<char>>>;
+  // A buffer of stream data. The bytes are either held in |storage| or owned
+  // by the caller of AddUnownedBuffer(), in which case |storage| is empty.
+  struct Buffer {
+    const char *data;
+    int size;
+    std::vector<char> storage;
+  };
+
+  using BufferList = std::list<Buffer>;
+
+  // Appends a buffer of |size| bytes to the stream and returns it. The caller
+  // must set the data of the returned buffer.
+  Buffer *AppendBuffer(size_t size);
+
+  // Removes the first buffer of the stream, keeping it for reuse.
+  void PopFront();
 
   BufferList buffers_;
 
+  // Buffers removed from the stream, whose list nodes and storage are reused
+  // by subsequently added buffers.
+  BufferList free_buffers_;
+
   // Iterator pointing to the current buffer.
   BufferList::const_iterator current_;
 
@@ -0,0 +1,96 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/grpc/auth/util/multi_buffer_input_stream.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace asylo {
+namespace {
+
+constexpr char kOwnedData[] = "Enclave ";
+constexpr char kUnownedData[] = "Key Exchange";
+
+// Verify that bytes of an unowned buffer are returned in place.
+TEST(MultiBufferInputStreamTest, UnownedBufferIsReadInPlace) {
+  std::string unowned(kUnownedData);
+  MultiBufferInputStream stream;
+  stream.AddUnownedBuffer(unowned.data(), unowned.size());
+
+  const void *data;
+  int size;
+  ASSERT_TRUE(stream.Next(&data, &size));
+  EXPECT_EQ(data, unowned.data());
+  EXPECT_EQ(size, unowned.size());
+  EXPECT_FALSE(stream.Next(&data, &size));
+}
+
+// Verify that owned and unowned buffers form a single stream.
+TEST(MultiBufferInputStreamTest, MixedBuffers) {
+  std::string unowned(kUnownedData);
+  MultiBufferInputStream stream;
+  stream.AddBuffer(kOwnedData, sizeof(kOwnedData) - 1);
+  stream.AddUnownedBuffer(unowned.data(), unowned.size());
+  stream.AddBuffer(kOwnedData, sizeof(kOwnedData) - 1);
+
+  EXPECT_EQ(stream.RemainingBytes(),
+            std::string(kOwnedData) + kUnownedData + kOwnedData);
+  EXPECT_EQ(stream.RemainingByteCount(),
+            2 * (sizeof(kOwnedData) - 1) + unowned.size());
+}
+
+// Verify that CopyUnownedBuffers() only keeps the untrimmed bytes of unowned
+// buffers, and that the stream no longer refers to the caller's memory.
+TEST(MultiBufferInputStreamTest, CopyUnownedBuffersKeepsUntrimmedBytes) {
+  std::string unowned(kUnownedData);
+  MultiBufferInputStream stream;
+  stream.AddBuffer(kOwnedData, sizeof(kOwnedData) - 1);
+  stream.AddUnownedBuffer(unowned.data(), unowned.size());
+
+  // Trim "Enclave Key" and consume " Ex" without trimming it.
+  ASSERT_TRUE(stream.Skip(sizeof(kOwnedData) - 1 + 3));
+  stream.TrimFront();
+  ASSERT_TRUE(stream.Skip(3));
+
+  stream.CopyUnownedBuffers();
+  unowned.assign(unowned.size(), 'X');
+
+  EXPECT_EQ(stream.RemainingBytes(), "change");
+  stream.Rewind();
+  EXPECT_EQ(stream.RemainingBytes(), " Exchange");
+  EXPECT_EQ(stream.RemainingByteCount(), 9);
+}
+
+// Verify that a stream can be read after its buffers are trimmed and new
+// buffers reuse the released storage.
+TEST(MultiBufferInputStreamTest, AddBufferAfterTrim) {
+  MultiBufferInputStream stream;
+  for (int i = 0; i < 3; ++i) {
+    stream.AddBuffer(kUnownedData, sizeof(kUnownedData) - 1);
+    EXPECT_EQ(stream.RemainingBytes(), kUnownedData);
+    ASSERT_TRUE(stream.Skip(sizeof(kUnownedData) - 1));
+    stream.TrimFront();
+    EXPECT_EQ(stream.RemainingByteCount(), 0);
+  }
+}
+
+}  // namespace
+}  // namespace asylo
@@ -0,0 +1,95 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/grpc/util/async_grpc_service.h"
+
+#include "absl/memory/memory.h"
+
+namespace asylo {
+
+bool ConcurrencyLimit::TryAcquire() {
+  if (max_calls_ <= 0) {
+    return true;
+  }
+  if (calls_.fetch_add(1) >= max_calls_) {
+    calls_.fetch_sub(1);
+    return false;
+  }
+  return true;
+}
+
+void ConcurrencyLimit::Release() {
+  if (max_calls_ > 0) {
+    calls_.fetch_sub(1);
+  }
+}
+
+void MethodLimits::Set(const std::string &method, int max_calls) {
+  limits_[method] = absl::make_unique<ConcurrencyLimit>(max_calls);
+}
+
+ConcurrencyLimit *MethodLimits::Get(absl::string_view method) const {
+  auto it = limits_.find(method);
+  return it == limits_.end() ? nullptr : it->second.get();
+}
+
+CompletionQueuePoller::CompletionQueuePoller(int num_threads,
+                                             ::grpc::ServerBuilder *builder) {
+  for (int i = 0; i < num_threads; ++i) {
+    queues_.push_back(builder->AddCompletionQueue());
+  }
+}
+
+CompletionQueuePoller::~CompletionQueuePoller() { Shutdown(); }
+
+void CompletionQueuePoller::Start(AsyncGrpcService *service,
+                                  const MethodLimits &limits) {
+  for (const auto &queue : queues_) {
+    service->RequestCalls(queue.get(), limits);
+    threads_.emplace_back(&CompletionQueuePoller::Poll, queue.get());
+  }
+}
+
+void CompletionQueuePoller::Shutdown() {
+  for (const auto &queue : queues_) {
+    queue->Shutdown();
+  }
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+  // Queues that were never polled must still be drained before destruction.
+  for (const auto &queue : queues_) {
+    void *tag;
+    bool ok;
+    while (queue->Next(&tag, &ok)) {
+      static_cast<AsyncCall *>(tag)->Proceed(ok);
+    }
+  }
+  queues_.clear();
+}
+
+void CompletionQueuePoller::Poll(::grpc::ServerCompletionQueue *cq) {
+  void *tag;
+  bool ok;
+  while (cq->Next(&tag, &ok)) {
+    static_cast<AsyncCall *>(tag)->Proceed(ok);
+  }
+}
+
+}  // namespace asylo
@@ -0,0 +1,204 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_GRPC_UTIL_ASYNC_GRPC_SERVICE_H_
+#define ASYLO_GRPC_UTIL_ASYNC_GRPC_SERVICE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "include/grpcpp/impl/codegen/async_unary_call.h"
+#include "include/grpcpp/impl/codegen/service_type.h"
+#include "include/grpcpp/server_builder.h"
+#include "include/grpcpp/server_context.h"
+
+namespace asylo {
+
+// Bounds the number of calls of one method that are handled at once. Calls
+// beyond the limit fail with RESOURCE_EXHAUSTED instead of occupying a
+// completion-queue polling thread.
+class ConcurrencyLimit {
+ public:
+  // A |max_calls| of zero means no limit.
+  explicit ConcurrencyLimit(int max_calls) : max_calls_(max_calls) {}
+
+  // Returns whether a call may proceed. A successful call must be paired with
+  // Release().
+  bool TryAcquire();
+  void Release();
+
+ private:
+  const int max_calls_;
+  std::atomic<int> calls_{0};
+};
+
+// The concurrency limits of an asynchronous service, keyed by full method name
+// ("/package.Service/Method").
+class MethodLimits {
+ public:
+  void Set(const std::string &method, int max_calls);
+
+  // Returns the limit for |method|, or nullptr if it is unlimited.
+  ConcurrencyLimit *Get(absl::string_view method) const;
+
+ private:
+  absl::flat_hash_map<std::string, std::unique_ptr<ConcurrencyLimit>> limits_;
+};
+
+// The tag type of every event on the completion queues of a
+// CompletionQueuePoller.
+class AsyncCall {
+ public:
+  virtual ~AsyncCall() = default;
+
+  // Advances the call after the operation it was waiting for completed. |ok|
+  // is the result reported by the completion queue.
+  virtual void Proceed(bool ok) = 0;
+};
+
+// A service implemented with the asynchronous gRPC API. An implementation
+// wraps a generated AsyncService and requests calls of each of its methods,
+// typically with AsyncUnaryCall.
+class AsyncGrpcService {
+ public:
+  virtual ~AsyncGrpcService() = default;
+
+  // Returns the generated service to register with the server.
+  virtual ::grpc::Service *GetService() = 0;
+
+  // Requests the first call of every method on |cq|. The events of each call
+  // must be tagged with an AsyncCall.
+  virtual void RequestCalls(::grpc::ServerCompletionQueue *cq,
+                            const MethodLimits &limits) = 0;
+};
+
+// Serves a unary method of an asynchronous service with a synchronous handler.
+// Each call object handles one call, and requests the next one once its call
+// has arrived, so there is always one outstanding request per method and
+// completion queue.
+template <typename ServiceT, typename RequestT, typename ResponseT>
+class AsyncUnaryCall : public AsyncCall {
+ public:
+  // The generated Request<Method> member of ServiceT.
+  using RequestMethod = void (ServiceT::*)(
+      ::grpc::ServerContext *, RequestT *,
+      ::grpc::ServerAsyncResponseWriter<ResponseT> *, ::grpc::CompletionQueue *,
+      ::grpc::ServerCompletionQueue *, void *);
+  using Handler = std::function<::grpc::Status(
+      ::grpc::ServerContext *, const RequestT &, ResponseT *)>;
+
+  // Requests a call of |request_method| on |cq|, to be answered by |handler|
+  // subject to |limit|, which may be nullptr.
+  static void Request(ServiceT *service, RequestMethod request_method,
+                      Handler handler, ::grpc::ServerCompletionQueue *cq,
+                      ConcurrencyLimit *limit) {
+    new AsyncUnaryCall(service, request_method, std::move(handler), cq, limit);
+  }
+
+  void Proceed(bool ok) override {
+    if (!ok || finishing_) {
+      // The server is shutting down, or the response has been sent.
+      delete this;
+      return;
+    }
+    Request(service_, request_method_, handler_, cq_, limit_);
+
+    ::grpc::Status status;
+    if (limit_ && !limit_->TryAcquire()) {
+      status = ::grpc::Status(::grpc::StatusCode::RESOURCE_EXHAUSTED,
+                              "Too many concurrent calls");
+    } else {
+      status = handler_(&context_, request_, &response_);
+      if (limit_) limit_->Release();
+    }
+    finishing_ = true;
+    if (status.ok()) {
+      responder_.Finish(response_, status, this);
+    } else {
+      responder_.FinishWithError(status, this);
+    }
+  }
+
+ private:
+  AsyncUnaryCall(ServiceT *service, RequestMethod request_method,
+                 Handler handler, ::grpc::ServerCompletionQueue *cq,
+                 ConcurrencyLimit *limit)
+      : service_(service),
+        request_method_(request_method),
+        handler_(std::move(handler)),
+        cq_(cq),
+        limit_(limit),
+        responder_(&context_) {
+    (service_->*request_method_)(&context_, &request_, &responder_, cq_, cq_,
+                                 this);
+  }
+
+  ServiceT *const service_;
+  const RequestMethod request_method_;
+  const Handler handler_;
+  ::grpc::ServerCompletionQueue *const cq_;
+  ConcurrencyLimit *const limit_;
+
+  ::grpc::ServerContext context_;
+  RequestT request_;
+  ResponseT response_;
+  ::grpc::ServerAsyncResponseWriter<ResponseT> responder_;
+
+  // Whether the response is being sent.
+  bool finishing_ = false;
+};
+
+// Owns the completion queues of an asynchronous server and one polling thread
+// per queue, so the number of threads serving calls is fixed regardless of
+// load.
+class CompletionQueuePoller {
+ public:
+  // Adds |num_threads| completion queues to |builder|.
+  CompletionQueuePoller(int num_threads, ::grpc::ServerBuilder *builder);
+  CompletionQueuePoller(const CompletionQueuePoller &other) = delete;
+  CompletionQueuePoller &operator=(const CompletionQueuePoller &other) =
+      delete;
+
+  // Calls Shutdown().
+  ~CompletionQueuePoller();
+
+  // Requests calls of |service| on every queue and starts the polling threads.
+  // Must be called after the server has been built.
+  void Start(AsyncGrpcService *service, const MethodLimits &limits);
+
+  // Shuts down the queues and joins the polling threads. The server must have
+  // been shut down first.
+  void Shutdown();
+
+ private:
+  // Handles the events of |cq| until it is shut down and drained.
+  static void Poll(::grpc::ServerCompletionQueue *cq);
+
+  std::vector<std::unique_ptr<::grpc::ServerCompletionQueue>> queues_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace asylo
+
+#endif  // ASYLO_GRPC_UTIL_ASYNC_GRPC_SERVICE_H_
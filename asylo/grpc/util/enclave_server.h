@@ -22,15 +22,19 @@
 #include <memory>
 #include <string>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "asylo/util/logging.h"
+#include "asylo/grpc/util/async_grpc_service.h"
 #include "asylo/grpc/util/enclave_server.pb.h"
 #include "asylo/trusted_application.h"
 #include "asylo/util/mutex_guarded.h"
 #include "asylo/util/status.h"
 #include "asylo/util/status_macros.h"
 #include "asylo/util/statusor.h"
+#include "include/grpc/impl/codegen/grpc_types.h"
 #include "include/grpcpp/impl/codegen/service_type.h"
+#include "include/grpcpp/resource_quota.h"
 #include "include/grpcpp/security/server_credentials.h"
 #include "include/grpcpp/server.h"
 #include "include/grpcpp/server_builder.h"
@@ -39,7 +43,10 @@ namespace asylo {
 
 // Enclave for hosting a gRPC service.
 //
-// The gRPC service and credentials are configurable in the constructor.
+// The gRPC service and credentials are configurable in the constructor. The
+// service may be synchronous, or asynchronous, in which case it is served by a
+// fixed number of completion-queue polling threads rather than a thread per
+// call. Threading and resource limits are taken from the ServerConfig.
 //
 // The server is initialized and started during Initialize(). Users of this
 // class are expected to set the server's host and port in the EnclaveConfig
@@ -72,6 +79,13 @@ class EnclaveServer final : public TrustedApplication {
         service_factory_{service_factory},
         credentials_{credentials} {}
 
+  EnclaveServer(std::unique_ptr<AsyncGrpcService> async_service,
+                std::shared_ptr<::grpc::ServerCredentials> credentials)
+      : server_{nullptr},
+        service_factory_{NoFactory},
+        async_service_{std::move(async_service)},
+        credentials_{credentials} {}
+
   ~EnclaveServer() = default;
 
   // From TrustedApplication.
@@ -91,6 +105,7 @@ class EnclaveServer final : public TrustedApplication {
     }
     host_ = config_server_proto.host();
     port_ = config_server_proto.port();
+    server_config_ = config_server_proto;
 
     LOG(INFO) << "gRPC server configured with address: " << host_ << ":"
               << port_;
@@ -129,6 +144,21 @@ class EnclaveServer final : public TrustedApplication {
     ::grpc::ServerBuilder builder;
     builder.AddListeningPort(absl::StrCat(host_, ":", port_), credentials_,
                              &port);
+    ASYLO_RETURN_IF_ERROR(ConfigureBuilder(&builder));
+    if (async_service_) {
+      builder.RegisterService(async_service_->GetService());
+      std::unique_ptr<::grpc::Server> server = builder.BuildAndStart();
+      if (!server) {
+        return Status(error::GoogleError::INTERNAL,
+                      "Failed to start gRPC server");
+      }
+      poller_->Start(async_service_.get(), method_limits_);
+
+      port_ = port;
+      LOG(INFO) << "gRPC server is listening on " << host_ << ":" << port_;
+      return std::move(server);
+    }
+
     if (service_ == nullptr) {
       StatusOr<std::unique_ptr<::grpc::Service>> service_result =
           service_factory_();
@@ -153,6 +183,60 @@ class EnclaveServer final : public TrustedApplication {
     return std::move(server);
   }
 
+  // Applies the threading and resource limits of |server_config_| to
+  // |builder|, and creates the completion queues of an asynchronous service.
+  Status ConfigureBuilder(::grpc::ServerBuilder *builder) {
+    if (server_config_.has_max_threads() ||
+        server_config_.has_max_memory_bytes()) {
+      ::grpc::ResourceQuota quota("asylo_enclave_server");
+      if (server_config_.has_max_threads()) {
+        quota.SetMaxThreads(server_config_.max_threads());
+      }
+      if (server_config_.has_max_memory_bytes()) {
+        quota.Resize(server_config_.max_memory_bytes());
+      }
+      builder->SetResourceQuota(quota);
+    }
+    if (server_config_.has_max_concurrent_streams()) {
+      builder->AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS,
+                                  server_config_.max_concurrent_streams());
+    }
+
+    if (!async_service_) {
+      if (server_config_.method_limits_size() > 0) {
+        return Status(error::GoogleError::INVALID_ARGUMENT,
+                      "Method limits require an asynchronous service");
+      }
+      if (server_config_.has_num_completion_queues()) {
+        builder->SetSyncServerOption(::grpc::ServerBuilder::NUM_CQS,
+                                     server_config_.num_completion_queues());
+      }
+      if (server_config_.has_min_pollers()) {
+        builder->SetSyncServerOption(::grpc::ServerBuilder::MIN_POLLERS,
+                                     server_config_.min_pollers());
+      }
+      if (server_config_.has_max_pollers()) {
+        builder->SetSyncServerOption(::grpc::ServerBuilder::MAX_POLLERS,
+                                     server_config_.max_pollers());
+      }
+      return Status::OkStatus();
+    }
+
+    int num_completion_queues = server_config_.has_num_completion_queues()
+                                    ? server_config_.num_completion_queues()
+                                    : 1;
+    if (num_completion_queues < 1) {
+      return Status(error::GoogleError::INVALID_ARGUMENT,
+                    "An asynchronous service needs a completion queue");
+    }
+    for (const auto &limit : server_config_.method_limits()) {
+      method_limits_.Set(limit.method(), limit.max_concurrent_calls());
+    }
+    poller_ = absl::make_unique<CompletionQueuePoller>(num_completion_queues,
+                                                       builder);
+    return Status::OkStatus();
+  }
+
   // Gets the address of the hosted gRPC server and writes it to
   // server_output_config extension of |output|.
   void GetServerAddress(EnclaveOutput *output) {
@@ -169,6 +253,8 @@ class EnclaveServer final : public TrustedApplication {
       (*server_view)->Shutdown();
       *server_view = nullptr;
     }
+    // The completion queues can only be shut down after the server.
+    poller_ = nullptr;
   }
 
   static StatusOr<std::unique_ptr<::grpc::Service>> NoFactory() {
@@ -184,7 +270,16 @@ class EnclaveServer final : public TrustedApplication {
 
   std::unique_ptr<::grpc::Service> service_;
   GrpcServiceFactory service_factory_;
+  std::unique_ptr<AsyncGrpcService> async_service_;
   std::shared_ptr<::grpc::ServerCredentials> credentials_;
+
+  // The configuration provided at initialization.
+  ServerConfig server_config_;
+
+  // The completion queues and polling threads of |async_service_|, and the
+  // method concurrency limits they enforce.
+  std::unique_ptr<CompletionQueuePoller> poller_;
+  MethodLimits method_limits_;
 };
 
 }  // namespace asylo
@@ -0,0 +1,218 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/grpc/util/enclave_server.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "asylo/enclave.pb.h"
+#include "asylo/grpc/util/async_grpc_service.h"
+#include "asylo/grpc/util/enclave_server.pb.h"
+#include "asylo/test/grpc/messenger_server_impl.h"
+#include "asylo/test/grpc/service.grpc.pb.h"
+#include "asylo/test/util/status_matchers.h"
+#include "include/grpcpp/grpcpp.h"
+#include "include/grpcpp/security/credentials.h"
+#include "include/grpcpp/security/server_credentials.h"
+
+namespace asylo {
+namespace {
+
+constexpr char kLocalhostAddress[] = "[::1]";
+constexpr char kHelloMethod[] = "/asylo.test.Messenger1/Hello";
+
+// Calls with this name are held by the server until released.
+constexpr char kBlockingName[] = "blocking";
+
+// Deadline for connecting to the server.
+constexpr absl::Duration kConnectDeadline = absl::Seconds(10);
+
+// Deadline for calls that may be queued behind the blocked call.
+constexpr absl::Duration kProbeDeadline = absl::Seconds(1);
+
+using AsyncHelloCall = AsyncUnaryCall<test::Messenger1::AsyncService,
+                                      test::HelloRequest, test::HelloResponse>;
+
+// The Messenger1 service implemented with the asynchronous gRPC API. Calls
+// named kBlockingName do not return until Release() is called.
+class AsyncMessengerService : public AsyncGrpcService {
+ public:
+  ::grpc::Service *GetService() override { return &service_; }
+
+  void RequestCalls(::grpc::ServerCompletionQueue *cq,
+                    const MethodLimits &limits) override {
+    AsyncHelloCall::Request(
+        &service_, &test::Messenger1::AsyncService::RequestHello,
+        [this](::grpc::ServerContext *context,
+               const test::HelloRequest &request,
+               test::HelloResponse *response) {
+          return Hello(request, response);
+        },
+        cq, limits.Get(kHelloMethod));
+  }
+
+  // Blocks until a call named kBlockingName is being handled.
+  void WaitForBlockedCall() { blocked_.WaitForNotification(); }
+
+  // Lets the blocked call return.
+  void Release() { released_.Notify(); }
+
+ private:
+  ::grpc::Status Hello(const test::HelloRequest &request,
+                       test::HelloResponse *response) {
+    if (request.name() == kBlockingName) {
+      blocked_.Notify();
+      released_.WaitForNotification();
+    }
+    response->set_message(
+        test::MessengerServer1::ResponseString(request.name()));
+    return ::grpc::Status::OK;
+  }
+
+  test::Messenger1::AsyncService service_;
+  absl::Notification blocked_;
+  absl::Notification released_;
+};
+
+class EnclaveServerTest : public ::testing::Test {
+ protected:
+  EnclaveServerTest() {
+    ServerConfig *server_config =
+        enclave_config_.MutableExtension(server_input_config);
+    server_config->set_host(kLocalhostAddress);
+    server_config->set_port(0);
+  }
+
+  ServerConfig *server_config() {
+    return enclave_config_.MutableExtension(server_input_config);
+  }
+
+  // Initializes |server|, and connects |stub_| to it.
+  void StartServer(EnclaveServer *server) {
+    ASYLO_ASSERT_OK(server->Initialize(enclave_config_));
+    EnclaveOutput output;
+    ASYLO_ASSERT_OK(server->Run(EnclaveInput(), &output));
+    const ServerConfig &address = output.GetExtension(server_output_config);
+    ASSERT_NE(address.port(), 0);
+
+    std::shared_ptr<::grpc::Channel> channel = ::grpc::CreateChannel(
+        absl::StrCat(address.host(), ":", address.port()),
+        ::grpc::InsecureChannelCredentials());
+    ASSERT_TRUE(channel->WaitForConnected(
+        absl::ToChronoTime(absl::Now() + kConnectDeadline)));
+    stub_ = test::Messenger1::NewStub(channel);
+  }
+
+  // Calls Hello with |name|, optionally with a |deadline|, and checks the
+  // response if the call succeeds.
+  ::grpc::Status Hello(const std::string &name,
+                       absl::Duration deadline = absl::InfiniteDuration()) {
+    ::grpc::ClientContext context;
+    if (deadline != absl::InfiniteDuration()) {
+      context.set_deadline(absl::ToChronoTime(absl::Now() + deadline));
+    }
+    test::HelloRequest request;
+    request.set_name(name);
+    test::HelloResponse response;
+    ::grpc::Status status = stub_->Hello(&context, request, &response);
+    if (status.ok()) {
+      EXPECT_EQ(response.message(),
+                test::MessengerServer1::ResponseString(name));
+    }
+    return status;
+  }
+
+  EnclaveConfig enclave_config_;
+  std::unique_ptr<test::Messenger1::Stub> stub_;
+};
+
+TEST_F(EnclaveServerTest, ServesAsynchronousService) {
+  server_config()->set_num_completion_queues(2);
+  EnclaveServer server(absl::make_unique<AsyncMessengerService>(),
+                       ::grpc::InsecureServerCredentials());
+  StartServer(&server);
+
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(Hello(absl::StrCat("client ", i)).ok());
+  }
+  ASYLO_EXPECT_OK(server.Finalize(EnclaveFinal()));
+}
+
+TEST_F(EnclaveServerTest, RejectsCallsOverMethodLimit) {
+  server_config()->set_num_completion_queues(2);
+  ServerConfig::MethodLimit *limit = server_config()->add_method_limits();
+  limit->set_method(kHelloMethod);
+  limit->set_max_concurrent_calls(1);
+
+  auto service = absl::make_unique<AsyncMessengerService>();
+  AsyncMessengerService *service_ptr = service.get();
+  EnclaveServer server(std::move(service),
+                       ::grpc::InsecureServerCredentials());
+  StartServer(&server);
+
+  ::grpc::Status blocked_status;
+  std::thread blocked_client(
+      [this, &blocked_status] { blocked_status = Hello(kBlockingName); });
+  service_ptr->WaitForBlockedCall();
+
+  // The blocked call occupies one polling thread, and the limit rejects calls
+  // handled by the other. A call matched with the request already pending on
+  // the blocked thread's queue waits behind it instead, and at most one call
+  // can be, so the second probe is always handled by the free thread.
+  bool rejected = false;
+  for (int i = 0; i < 2 && !rejected; i++) {
+    ::grpc::Status status = Hello("over limit", kProbeDeadline);
+    if (status.error_code() == ::grpc::StatusCode::RESOURCE_EXHAUSTED) {
+      rejected = true;
+    } else {
+      EXPECT_EQ(status.error_code(), ::grpc::StatusCode::DEADLINE_EXCEEDED)
+          << status.error_message();
+    }
+  }
+  EXPECT_TRUE(rejected);
+
+  service_ptr->Release();
+  blocked_client.join();
+  EXPECT_TRUE(blocked_status.ok()) << blocked_status.error_message();
+
+  // The limit is released once the call is done.
+  EXPECT_TRUE(Hello("under limit").ok());
+  ASYLO_EXPECT_OK(server.Finalize(EnclaveFinal()));
+}
+
+TEST_F(EnclaveServerTest, MethodLimitsRequireAsynchronousService) {
+  ServerConfig::MethodLimit *limit = server_config()->add_method_limits();
+  limit->set_method(kHelloMethod);
+  limit->set_max_concurrent_calls(1);
+
+  EnclaveServer server(absl::make_unique<test::MessengerServer1>(),
+                       ::grpc::InsecureServerCredentials());
+  EXPECT_THAT(server.Initialize(enclave_config_),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+}  // namespace
+}  // namespace asylo
@@ -0,0 +1,82 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/identity/init.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace asylo {
+namespace {
+
+// Configs recorded by DeferEnclaveAssertionAuthorityInitialization(), keyed by
+// authority identifier. The mutex also serializes deferred initialization, so
+// that concurrent first uses of an authority initialize it exactly once.
+struct DeferredConfigs {
+  absl::Mutex mu;
+  absl::flat_hash_map<std::string, std::string> configs ABSL_GUARDED_BY(mu);
+};
+
+DeferredConfigs *GetDeferredConfigs() {
+  static DeferredConfigs *const deferred_configs = new DeferredConfigs();
+  return deferred_configs;
+}
+
+// Initializes the authority identified by |authority_id| in |MapT| with its
+// deferred config, if any.
+template <class MapT>
+Status InitializeDeferred(const std::string &authority_id) {
+  auto authority_it = MapT::GetValue(authority_id);
+  if (authority_it == MapT::value_end() || authority_it->IsInitialized()) {
+    return Status::OkStatus();
+  }
+
+  DeferredConfigs *deferred_configs = GetDeferredConfigs();
+  absl::MutexLock lock(&deferred_configs->mu);
+  auto config_it = deferred_configs->configs.find(authority_id);
+  if (config_it == deferred_configs->configs.end()) {
+    return Status::OkStatus();
+  }
+  return internal::TryInitialize(config_it->second, authority_it);
+}
+
+}  // namespace
+
+namespace internal {
+
+void DeferInitialization(const std::string &authority_id, std::string config) {
+  DeferredConfigs *deferred_configs = GetDeferredConfigs();
+  absl::MutexLock lock(&deferred_configs->mu);
+  deferred_configs->configs[authority_id] = std::move(config);
+}
+
+}  // namespace internal
+
+Status InitializeDeferredAssertionGenerator(const std::string &authority_id) {
+  return InitializeDeferred<AssertionGeneratorMap>(authority_id);
+}
+
+Status InitializeDeferredAssertionVerifier(const std::string &authority_id) {
+  return InitializeDeferred<AssertionVerifierMap>(authority_id);
+}
+
+}  // namespace asylo
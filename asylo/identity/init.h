@@ -105,6 +105,75 @@ Status InitializeEnclaveAssertionAuthorities(ConfigIteratorT configs_begin,
                   "assertion generators and assertion verifiers");
 }
 
+// Records the configs provided in the range [|configs_begin|,
+// |configs_end|) so that each statically-registered EnclaveAssertionGenerator
+// and EnclaveAssertionVerifier is initialized with its config on first use,
+// rather than up front. Authorities with a deferred config are initialized by
+// InitializeDeferredAssertionGenerator() and
+// InitializeDeferredAssertionVerifier().
+//
+// ConfigIteratorT must satisfy the same constraints as for
+// InitializeEnclaveAssertionAuthorities(). This function returns a non-ok
+// status if a config was provided for which there is no matching
+// EnclaveAssertionGenerator and/or EnclaveAssertionVerifier, or if an
+// authority identifier could not be generated from a provided config. Errors
+// in the configs themselves are only reported when the authorities are
+// initialized.
+template <class ConfigIteratorT>
+Status DeferEnclaveAssertionAuthorityInitialization(
+    ConfigIteratorT configs_begin, ConfigIteratorT configs_end) {
+  bool ok = true;
+
+  for (auto it = configs_begin; it != configs_end; ++it) {
+    const EnclaveAssertionAuthorityConfig &config = *it;
+
+    const AssertionDescription &description = config.description();
+    StatusOr<std::string> authority_id_result =
+        EnclaveAssertionAuthority::GenerateAuthorityId(
+            description.identity_type(), description.authority_type());
+    if (!authority_id_result.ok()) {
+      ok = false;
+      LOG(ERROR) << authority_id_result.status();
+      continue;
+    }
+
+    std::string authority_id = authority_id_result.ValueOrDie();
+
+    if (AssertionGeneratorMap::GetValue(authority_id) ==
+        AssertionGeneratorMap::value_end()) {
+      ok = false;
+      LOG(WARNING) << "Config for " << description.ShortDebugString()
+                   << " does not match any known assertion generator";
+    }
+
+    if (AssertionVerifierMap::GetValue(authority_id) ==
+        AssertionVerifierMap::value_end()) {
+      ok = false;
+      LOG(WARNING) << "Config for " << description.ShortDebugString()
+                   << " does not match any known assertion verifier";
+    }
+
+    internal::DeferInitialization(authority_id, config.config());
+  }
+
+  return ok ? Status::OkStatus()
+            : Status(error::GoogleError::INTERNAL,
+                     "One or more errors occurred while attempting to defer "
+                     "initialization of assertion generators and assertion "
+                     "verifiers");
+}
+
+// Initializes the EnclaveAssertionGenerator identified by |authority_id| with
+// the config recorded for it by DeferEnclaveAssertionAuthorityInitialization(),
+// if the generator is not already initialized. Returns an ok status if no
+// config was deferred for |authority_id|, or if the generator is initialized at
+// the end of the call. This function is thread-safe.
+Status InitializeDeferredAssertionGenerator(const std::string &authority_id);
+
+// Initializes the EnclaveAssertionVerifier identified by |authority_id| in the
+// same manner as InitializeDeferredAssertionGenerator().
+Status InitializeDeferredAssertionVerifier(const std::string &authority_id);
+
 }  // namespace asylo
 
 #endif  // ASYLO_IDENTITY_INIT_H_
@@ -45,6 +45,11 @@ Status TryInitialize(const std::string &config, IteratorT authority_it) {
   return status;
 }
 
+// Records |config| as the config with which to initialize the assertion
+// authorities identified by |authority_id| on first use, replacing any config
+// recorded previously.
+void DeferInitialization(const std::string &authority_id, std::string config);
+
 }  // namespace internal
 }  // namespace asylo
 
@@ -18,6 +18,7 @@
 
 #include "asylo/identity/init.h"
 
+#include <string>
 #include <vector>
 
 #include <google/protobuf/text_format.h>
@@ -93,5 +94,59 @@ TEST(InitTest, InitializeFailsWithNonMatchingConfigs) {
       Not(IsOk()));
 }
 
+// Verify that DeferEnclaveAssertionAuthorityInitialization fails when provided
+// with configs that don't match any available assertion authorities.
+TEST(InitTest, DeferFailsWithNonMatchingConfigs) {
+  std::vector<EnclaveAssertionAuthorityConfig> configs(1);
+
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::ParseFromString("description: {                 "
+                                          "  identity_type: CODE_IDENTITY "
+                                          "  authority_type: 'foobar'     "
+                                          "}                              "
+                                          "config: 'baz'                  ",
+                                          &configs.front()));
+
+  EXPECT_THAT(DeferEnclaveAssertionAuthorityInitialization(configs.begin(),
+                                                           configs.end()),
+              Not(IsOk()));
+}
+
+// Verify that authorities whose initialization was deferred are initialized by
+// InitializeDeferredAssertionGenerator and InitializeDeferredAssertionVerifier.
+TEST(InitTest, DeferredAuthoritiesAreInitializedOnDemand) {
+  std::vector<EnclaveAssertionAuthorityConfig> configs(1);
+
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::ParseFromString("description: {                 "
+                                          "  identity_type: NULL_IDENTITY "
+                                          "  authority_type: 'Any'        "
+                                          "}                              "
+                                          "config: 'foobar'               ",
+                                          &configs.front()));
+
+  ASSERT_THAT(DeferEnclaveAssertionAuthorityInitialization(configs.begin(),
+                                                           configs.end()),
+              IsOk());
+
+  std::string authority_id =
+      EnclaveAssertionAuthority::GenerateAuthorityId(NULL_IDENTITY, "Any")
+          .ValueOrDie();
+  EXPECT_THAT(InitializeDeferredAssertionGenerator(authority_id), IsOk());
+  EXPECT_TRUE(AssertionGeneratorMap::GetValue(authority_id)->IsInitialized());
+  EXPECT_THAT(InitializeDeferredAssertionVerifier(authority_id), IsOk());
+  EXPECT_TRUE(AssertionVerifierMap::GetValue(authority_id)->IsInitialized());
+
+  // Repeated calls have no effect.
+  EXPECT_THAT(InitializeDeferredAssertionGenerator(authority_id), IsOk());
+  EXPECT_THAT(InitializeDeferredAssertionVerifier(authority_id), IsOk());
+}
+
+// Verify that initializing an authority without a deferred config succeeds.
+TEST(InitTest, InitializeDeferredSucceedsWithoutConfig) {
+  EXPECT_THAT(InitializeDeferredAssertionGenerator("unknown authority"), IsOk());
+  EXPECT_THAT(InitializeDeferredAssertionVerifier("unknown authority"), IsOk());
+}
+
 }  // namespace
 }  // namespace asylo
@@ -18,6 +18,10 @@
 
 #include "asylo/identity/sgx/local_secret_sealer_helpers.h"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -40,6 +44,7 @@
 #include "asylo/identity/sgx/sgx_identity_util_internal.h"
 #include "asylo/platform/common/singleton.h"
 #include "asylo/util/cleansing_types.h"
+#include "asylo/util/posix_error_space.h"
 #include "asylo/util/status_macros.h"
 
 namespace asylo {
@@ -63,6 +68,40 @@ bool IsLegacySealedSecret(const SealedSecretHeader &header) {
   return !header.client_acl().expectation().reference_identity().has_version();
 }
 
+// The size of the big-endian length that precedes the preamble of a sealed
+// stream.
+constexpr size_t kPreambleLengthSize = sizeof(uint32_t);
+
+// The size of the additional data bound to each chunk of a sealed stream: a
+// SHA-256 digest of the preamble, the big-endian chunk index, and a flag that
+// is set on the last chunk.
+constexpr size_t kChunkAdditionalDataSize =
+    SHA256_DIGEST_LENGTH + sizeof(uint64_t) + 1;
+
+// Returns the SHA-256 digest of |serialized_preamble|.
+StatusOr<std::vector<uint8_t>> DigestPreamble(
+    ByteContainerView serialized_preamble) {
+  Sha256Hash hasher;
+  hasher.Update(serialized_preamble);
+  std::vector<uint8_t> digest;
+  ASYLO_RETURN_IF_ERROR(hasher.CumulativeHash(&digest));
+  return digest;
+}
+
+// Writes the additional data for chunk |index| of the stream whose preamble
+// has |preamble_digest| to |additional_data|.
+void BuildChunkAdditionalData(const std::vector<uint8_t> &preamble_digest,
+                              uint64_t index, bool last,
+                              uint8_t additional_data[]) {
+  std::copy(preamble_digest.cbegin(), preamble_digest.cend(),
+            additional_data);
+  uint8_t *position = additional_data + SHA256_DIGEST_LENGTH;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    *position++ = static_cast<uint8_t>(index >> shift);
+  }
+  *position = last ? 1 : 0;
+}
+
 }  // namespace
 
 namespace internal {
@@ -153,21 +192,8 @@ uint16_t ConvertMatchSpecToKeypolicy(const SgxIdentityMatchSpec &spec) {
   return policy;
 }
 
-Status GenerateCryptorKey(AeadScheme aead_scheme, const std::string &key_id,
-                          const SgxIdentityExpectation &sgx_expectation,
-                          size_t key_size, CleansingVector<uint8_t> *key) {
-  // The function generates the |key_size| number of bytes by concatenating
-  // bytes from one or more hardware-generated "subkeys." Each of the subkeys
-  // is obtained by calling the GetHardwareKey() function. Except for the last
-  // subkey, all bytes from all other subkeys are utilized. If more than one
-  // subkey is used, each subkey is generated using a different value of
-  // the KEYID field of the KEYREQUEST input to the GetHardwareKey() function.
-  // All the other fields of the KEYREQUEST structure stay unchanged across
-  // the GetHardwareKey() calls.
-
-  // Create and populate an aligned KEYREQUEST structure.
-  AlignedKeyrequestPtr req;
-
+void PopulateSealKeyrequest(const SgxIdentityExpectation &sgx_expectation,
+                            Keyrequest *req) {
   // Zero-out the KEYREQUEST.
   *req = TrivialZeroObject<Keyrequest>();
 
@@ -186,11 +212,28 @@ Status GenerateCryptorKey(AeadScheme aead_scheme, const std::string &key_id,
                                          .code_identity_match_spec()
                                          .attributes_match_mask(),
                                      &req->attributemask);
-  // req->keyid is populated uniquely on each call to GetHardwareKey().
   req->miscmask = sgx_expectation.match_spec()
                       .code_identity_match_spec()
                       .miscselect_match_mask();
+}
+
+Status GenerateCryptorKey(AeadScheme aead_scheme, const std::string &key_id,
+                          const SgxIdentityExpectation &sgx_expectation,
+                          size_t key_size, CleansingVector<uint8_t> *key) {
+  // The function generates the |key_size| number of bytes by concatenating
+  // bytes from one or more hardware-generated "subkeys." Each of the subkeys
+  // is obtained by calling the GetHardwareKey() function. Except for the last
+  // subkey, all bytes from all other subkeys are utilized. If more than one
+  // subkey is used, each subkey is generated using a different value of
+  // the KEYID field of the KEYREQUEST input to the GetHardwareKey() function.
+  // All the other fields of the KEYREQUEST structure stay unchanged across
+  // the GetHardwareKey() calls.
 
+  // Create and populate an aligned KEYREQUEST structure.
+  AlignedKeyrequestPtr req;
+  PopulateSealKeyrequest(sgx_expectation, req.get());
+
+  // req->keyid is populated uniquely on each call to GetHardwareKey().
   key->resize(0);
   key->reserve(key_size);
 
@@ -266,6 +309,188 @@ Status Open(AeadCryptor *cryptor, const SealedSecret &sealed_secret,
   return Status::OkStatus();
 }
 
+StatusOr<size_t> FdStreamReader::Read(void *buffer, size_t size) {
+  size_t count = 0;
+  while (count < size) {
+    ssize_t result =
+        read(fd_, reinterpret_cast<uint8_t *>(buffer) + count, size - count);
+    if (result == 0) {
+      break;
+    }
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Status(static_cast<error::PosixError>(errno),
+                    "read() failed in FdStreamReader::Read()");
+    }
+    count += result;
+  }
+  return count;
+}
+
+Status FdStreamWriter::Write(const void *buffer, size_t size) {
+  size_t count = 0;
+  while (count < size) {
+    ssize_t result = write(
+        fd_, reinterpret_cast<const uint8_t *>(buffer) + count, size - count);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Status(static_cast<error::PosixError>(errno),
+                    "write() failed in FdStreamWriter::Write()");
+    }
+    count += result;
+  }
+  return Status::OkStatus();
+}
+
+Status FdStreamWriter::Finish() { return Status::OkStatus(); }
+
+StatusOr<size_t> StorageStreamReader::Read(void *buffer, size_t size) {
+  size_t storage_size;
+  ASYLO_ASSIGN_OR_RETURN(storage_size, storage_->Size());
+  if (offset_ >= storage_size) {
+    return 0;
+  }
+  size = std::min(size, storage_size - offset_);
+  ASYLO_RETURN_IF_ERROR(storage_->Read(buffer, offset_, size));
+  offset_ += size;
+  return size;
+}
+
+Status StorageStreamWriter::Write(const void *buffer, size_t size) {
+  ASYLO_RETURN_IF_ERROR(storage_->Write(buffer, offset_, size));
+  offset_ += size;
+  return Status::OkStatus();
+}
+
+Status StorageStreamWriter::Finish() {
+  ASYLO_RETURN_IF_ERROR(storage_->Truncate(offset_));
+  return storage_->Sync();
+}
+
+Status WriteSealedStream(AeadCryptor *cryptor,
+                         ByteContainerView serialized_preamble,
+                         StreamReader *input, StreamWriter *output) {
+  if (serialized_preamble.size() > kMaxSealedStreamPreambleSize) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Sealed stream preamble is too large");
+  }
+  uint8_t length[kPreambleLengthSize];
+  for (size_t i = 0; i < kPreambleLengthSize; ++i) {
+    length[i] = static_cast<uint8_t>(serialized_preamble.size() >>
+                                     (8 * (kPreambleLengthSize - i - 1)));
+  }
+  ASYLO_RETURN_IF_ERROR(output->Write(length, sizeof(length)));
+  ASYLO_RETURN_IF_ERROR(
+      output->Write(serialized_preamble.data(), serialized_preamble.size()));
+
+  std::vector<uint8_t> preamble_digest;
+  ASYLO_ASSIGN_OR_RETURN(preamble_digest,
+                         DigestPreamble(serialized_preamble));
+
+  // Each chunk is written as its nonce followed by its ciphertext. Only the
+  // last chunk is shorter than kSealedStreamChunkSize, so that a stream which
+  // is cut at a chunk boundary is detected as truncated.
+  const size_t nonce_size = cryptor->NonceSize();
+  const size_t overhead = cryptor->MaxSealOverhead();
+  CleansingVector<uint8_t> plaintext(kSealedStreamChunkSize);
+  std::vector<uint8_t> record(nonce_size + kSealedStreamChunkSize + overhead);
+  uint8_t additional_data[kChunkAdditionalDataSize];
+  for (uint64_t index = 0;; ++index) {
+    size_t plaintext_size;
+    ASYLO_ASSIGN_OR_RETURN(plaintext_size,
+                           input->Read(plaintext.data(), plaintext.size()));
+    bool last = plaintext_size < kSealedStreamChunkSize;
+    BuildChunkAdditionalData(preamble_digest, index, last, additional_data);
+
+    size_t ciphertext_size = 0;
+    ASYLO_RETURN_IF_ERROR(cryptor->Seal(
+        ByteContainerView(plaintext.data(), plaintext_size),
+        ByteContainerView(additional_data, sizeof(additional_data)),
+        absl::MakeSpan(record.data(), nonce_size),
+        absl::MakeSpan(record.data() + nonce_size, plaintext_size + overhead),
+        &ciphertext_size));
+    if (ciphertext_size != plaintext_size + overhead) {
+      return Status(error::GoogleError::INTERNAL,
+                    "Unexpected ciphertext size for sealed stream chunk");
+    }
+    ASYLO_RETURN_IF_ERROR(
+        output->Write(record.data(), nonce_size + ciphertext_size));
+    if (last) {
+      break;
+    }
+  }
+  return output->Finish();
+}
+
+Status ReadSealedStreamPreamble(StreamReader *input,
+                                std::string *serialized_preamble) {
+  uint8_t length[kPreambleLengthSize];
+  size_t read_size;
+  ASYLO_ASSIGN_OR_RETURN(read_size, input->Read(length, sizeof(length)));
+  if (read_size != sizeof(length)) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Sealed stream is truncated");
+  }
+  size_t preamble_size = 0;
+  for (uint8_t byte : length) {
+    preamble_size = (preamble_size << 8) | byte;
+  }
+  if (preamble_size > kMaxSealedStreamPreambleSize) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Sealed stream preamble is too large");
+  }
+
+  serialized_preamble->resize(preamble_size);
+  ASYLO_ASSIGN_OR_RETURN(
+      read_size, input->Read(&(*serialized_preamble)[0], preamble_size));
+  if (read_size != preamble_size) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Sealed stream is truncated");
+  }
+  return Status::OkStatus();
+}
+
+Status OpenSealedStream(AeadCryptor *cryptor,
+                        ByteContainerView serialized_preamble,
+                        StreamReader *input, StreamWriter *output) {
+  std::vector<uint8_t> preamble_digest;
+  ASYLO_ASSIGN_OR_RETURN(preamble_digest,
+                         DigestPreamble(serialized_preamble));
+
+  const size_t nonce_size = cryptor->NonceSize();
+  const size_t overhead = cryptor->MaxSealOverhead();
+  CleansingVector<uint8_t> plaintext(kSealedStreamChunkSize + overhead);
+  std::vector<uint8_t> record(nonce_size + kSealedStreamChunkSize + overhead);
+  uint8_t additional_data[kChunkAdditionalDataSize];
+  for (uint64_t index = 0;; ++index) {
+    size_t record_size;
+    ASYLO_ASSIGN_OR_RETURN(record_size,
+                           input->Read(record.data(), record.size()));
+    if (record_size < nonce_size + overhead) {
+      return Status(error::GoogleError::INVALID_ARGUMENT,
+                    "Sealed stream is truncated");
+    }
+    bool last = record_size < record.size();
+    BuildChunkAdditionalData(preamble_digest, index, last, additional_data);
+
+    size_t plaintext_size = 0;
+    ASYLO_RETURN_IF_ERROR(cryptor->Open(
+        ByteContainerView(record.data() + nonce_size, record_size - nonce_size),
+        ByteContainerView(additional_data, sizeof(additional_data)),
+        ByteContainerView(record.data(), nonce_size), absl::MakeSpan(plaintext),
+        &plaintext_size));
+    ASYLO_RETURN_IF_ERROR(output->Write(plaintext.data(), plaintext_size));
+    if (last) {
+      break;
+    }
+  }
+  return output->Finish();
+}
+
 StatusOr<AeadScheme> ParseAeadSchemeFromSealedSecretHeader(
     const SealedSecretHeader &header) {
   AeadScheme aead_scheme;
@@ -19,6 +19,9 @@
 #ifndef ASYLO_IDENTITY_SGX_LOCAL_SECRET_SEALER_HELPERS_H_
 #define ASYLO_IDENTITY_SGX_LOCAL_SECRET_SEALER_HELPERS_H_
 
+#include <cstddef>
+#include <string>
+
 #include "asylo/crypto/aead_cryptor.h"
 #include "asylo/crypto/algorithms.pb.h"
 #include "asylo/crypto/util/byte_container_view.h"
@@ -28,8 +31,10 @@
 #include "asylo/identity/sgx/identity_key_management_structs.h"
 #include "asylo/identity/sgx/local_sealed_secret.pb.h"
 #include "asylo/identity/sgx/sgx_identity.pb.h"
+#include "asylo/platform/storage/utils/random_access_storage.h"
 #include "asylo/util/cleansing_types.h"
 #include "asylo/util/status.h"
+#include "asylo/util/statusor.h"
 
 namespace asylo {
 namespace sgx {
@@ -46,6 +51,12 @@ Status ParseKeyGenerationParamsFromSealedSecretHeader(
 // Converts |spec| to the KEYPOLICY bit vector defined in the Intel SDM.
 uint16_t ConvertMatchSpecToKeypolicy(const SgxIdentityMatchSpec &spec);
 
+// Populates |req| with a SEAL_KEY KEYREQUEST for the key policy, ISVSVN,
+// CPUSVN, and attribute and MISCSELECT masks in |sgx_expectation|. The KEYID
+// field is left zeroed.
+void PopulateSealKeyrequest(const SgxIdentityExpectation &sgx_expectation,
+                            Keyrequest *req);
+
 // Generates the key used by the AEAD Cryptor to perform the Seal or the Open
 // operation.
 Status GenerateCryptorKey(AeadScheme aead_scheme, const std::string &key_id,
@@ -72,6 +83,102 @@ Status Open(experimental::AeadCryptor *cryptor,
 StatusOr<AeadScheme> ParseAeadSchemeFromSealedSecretHeader(
     const SealedSecretHeader &header);
 
+// The number of plaintext bytes in each chunk of a sealed stream. Every chunk
+// except the last holds exactly this many bytes, and the last chunk always
+// holds fewer.
+constexpr size_t kSealedStreamChunkSize = 64 * 1024;
+
+// The maximum size of the serialized SealedSecret at the start of a sealed
+// stream.
+constexpr size_t kMaxSealedStreamPreambleSize = 1024 * 1024;
+
+// A sequential source of bytes for sealed streams.
+class StreamReader {
+ public:
+  virtual ~StreamReader() = default;
+
+  // Reads up to |size| bytes into |buffer| and returns the number of bytes
+  // read. Returns fewer than |size| bytes only at the end of the stream.
+  virtual StatusOr<size_t> Read(void *buffer, size_t size) = 0;
+};
+
+// A sequential sink of bytes for sealed streams.
+class StreamWriter {
+ public:
+  virtual ~StreamWriter() = default;
+
+  // Appends |size| bytes from |buffer| to the stream.
+  virtual Status Write(const void *buffer, size_t size) = 0;
+
+  // Marks the end of the stream. No further writes are made.
+  virtual Status Finish() = 0;
+};
+
+// A StreamReader that reads from a file descriptor until end-of-file.
+class FdStreamReader : public StreamReader {
+ public:
+  explicit FdStreamReader(int fd) : fd_(fd) {}
+  StatusOr<size_t> Read(void *buffer, size_t size) override;
+
+ private:
+  int fd_;
+};
+
+// A StreamWriter that writes to a file descriptor.
+class FdStreamWriter : public StreamWriter {
+ public:
+  explicit FdStreamWriter(int fd) : fd_(fd) {}
+  Status Write(const void *buffer, size_t size) override;
+  Status Finish() override;
+
+ private:
+  int fd_;
+};
+
+// A StreamReader that reads a RandomAccessStorage from offset zero to its end.
+class StorageStreamReader : public StreamReader {
+ public:
+  explicit StorageStreamReader(RandomAccessStorage *storage)
+      : storage_(storage), offset_(0) {}
+  StatusOr<size_t> Read(void *buffer, size_t size) override;
+
+ private:
+  RandomAccessStorage *storage_;
+  size_t offset_;
+};
+
+// A StreamWriter that writes a RandomAccessStorage from offset zero, and
+// truncates it to the end of the stream in Finish().
+class StorageStreamWriter : public StreamWriter {
+ public:
+  explicit StorageStreamWriter(RandomAccessStorage *storage)
+      : storage_(storage), offset_(0) {}
+  Status Write(const void *buffer, size_t size) override;
+  Status Finish() override;
+
+ private:
+  RandomAccessStorage *storage_;
+  size_t offset_;
+};
+
+// Writes |serialized_preamble| to |output|, followed by the contents of
+// |input| sealed in chunks with |cryptor|. Each chunk is bound to the
+// preamble, its index, and whether it is the last chunk of the stream.
+Status WriteSealedStream(experimental::AeadCryptor *cryptor,
+                         ByteContainerView serialized_preamble,
+                         StreamReader *input, StreamWriter *output);
+
+// Reads the preamble of a sealed stream from |input| into
+// |serialized_preamble|.
+Status ReadSealedStreamPreamble(StreamReader *input,
+                                std::string *serialized_preamble);
+
+// Opens the chunks that follow |serialized_preamble| in |input| with |cryptor|
+// and writes their plaintext to |output|.
+Status OpenSealedStream(experimental::AeadCryptor *cryptor,
+                        ByteContainerView serialized_preamble,
+                        StreamReader *input, StreamWriter *output);
+
 }  // namespace internal
 }  // namespace sgx
 }  // namespace asylo
@@ -53,6 +53,13 @@ Status MakeRemoteAssertion(const std::string &user_data,
     *assertion->add_certificate_chains() = chain;
   }
 
+  return SignRemoteAssertion(user_data, identity, signing_key, assertion);
+}
+
+Status SignRemoteAssertion(const std::string &user_data,
+                           const SgxIdentity &identity,
+                           const SigningKey &signing_key,
+                           RemoteAssertion *assertion) {
   RemoteAssertionPayload payload;
   payload.set_version(kRemoteAssertionVersion);
   payload.set_signature_scheme(signing_key.GetSignatureScheme());
@@ -41,6 +41,15 @@ Status MakeRemoteAssertion(const std::string &user_data,
                            const std::vector<CertificateChain> &cert_chains,
                            RemoteAssertion *assertion);
 
+// Binds |user_data| to a statement about |identity| and signs the statement
+// with |signing_key|, placing the statement and signature in |assertion|. The
+// verifying key and certificate chains in |assertion| are left unchanged, so
+// that they can be prepared once for every assertion signed by |signing_key|.
+Status SignRemoteAssertion(const std::string &user_data,
+                           const SgxIdentity &identity,
+                           const SigningKey &signing_key,
+                           RemoteAssertion *assertion);
+
 // Verifies |assertion| by verifying the following:
 //   * |assertion| is cryptographically-bound to |user_data|
 //   * The payload in |assertion| is signed by |verifying_key|
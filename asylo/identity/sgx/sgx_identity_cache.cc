@@ -0,0 +1,236 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/identity/sgx/sgx_identity_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <google/protobuf/message_lite.h>
+
+#include "asylo/crypto/sha256_hash.h"
+#include "asylo/crypto/util/byte_container_view.h"
+#include "asylo/identity/sgx/sgx_identity_util_internal.h"
+#include "asylo/util/status_macros.h"
+
+namespace asylo {
+namespace sgx {
+namespace {
+
+// Adds |data| to |hash| prefixed by its length, so that the digest of a
+// sequence of inputs uniquely determines each of them.
+void UpdateWithLength(ByteContainerView data, Sha256Hash *hash) {
+  uint64_t size = data.size();
+  hash->Update(ByteContainerView(&size, sizeof(size)));
+  hash->Update(data);
+}
+
+std::string Finalize(const Sha256Hash &hash) {
+  std::vector<uint8_t> digest;
+  hash.CumulativeHash(&digest);
+  return std::string(digest.cbegin(), digest.cend());
+}
+
+// Returns the digest of |message| in its serialized form.
+std::string DigestOf(const google::protobuf::MessageLite &message) {
+  Sha256Hash hash;
+  UpdateWithLength(message.SerializeAsString(), &hash);
+  return Finalize(hash);
+}
+
+// Returns the digest of the fields of |report| from which
+// ParseIdentityFromHardwareReport() constructs an SGX identity.
+std::string IdentityDigestOf(const Report &report) {
+  Sha256Hash hash;
+  hash.Update(report.body.cpusvn);
+  hash.Update(ByteContainerView(&report.body.miscselect,
+                                sizeof(report.body.miscselect)));
+  hash.Update(ByteContainerView(&report.body.attributes,
+                                sizeof(report.body.attributes)));
+  hash.Update(report.body.mrenclave);
+  hash.Update(report.body.mrsigner);
+  hash.Update(ByteContainerView(&report.body.isvprodid,
+                                sizeof(report.body.isvprodid)));
+  hash.Update(
+      ByteContainerView(&report.body.isvsvn, sizeof(report.body.isvsvn)));
+  return Finalize(hash);
+}
+
+}  // namespace
+
+template <typename T>
+SgxIdentityCache::Table<T>::Table(size_t capacity)
+    : shard_capacity_(std::max<size_t>((capacity + kShards - 1) / kShards, 1)) {
+}
+
+template <typename T>
+bool SgxIdentityCache::Table<T>::Lookup(const std::string &digest, T *value) {
+  Shard &shard = ShardFor(digest);
+  absl::MutexLock lock(&shard.mu);
+  auto it = shard.index.find(digest);
+  if (it == shard.index.end()) {
+    return false;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+  *value = it->second->second;
+  return true;
+}
+
+template <typename T>
+void SgxIdentityCache::Table<T>::Insert(const std::string &digest, T value) {
+  Shard &shard = ShardFor(digest);
+  absl::MutexLock lock(&shard.mu);
+
+  // Another thread may have computed the same value concurrently.
+  auto it = shard.index.find(digest);
+  if (it != shard.index.end()) {
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return;
+  }
+
+  if (shard.entries.size() >= shard_capacity_) {
+    shard.index.erase(shard.entries.back().first);
+    shard.entries.pop_back();
+  }
+  shard.entries.emplace_front(digest, std::move(value));
+  shard.index.emplace(digest, shard.entries.begin());
+}
+
+template <typename T>
+size_t SgxIdentityCache::Table<T>::size() const {
+  size_t size = 0;
+  for (const Shard &shard : shards_) {
+    absl::MutexLock lock(&shard.mu);
+    size += shard.entries.size();
+  }
+  return size;
+}
+
+template <typename T>
+void SgxIdentityCache::Table<T>::Clear() {
+  for (Shard &shard : shards_) {
+    absl::MutexLock lock(&shard.mu);
+    shard.index.clear();
+    shard.entries.clear();
+  }
+}
+
+template <typename T>
+typename SgxIdentityCache::Table<T>::Shard &
+SgxIdentityCache::Table<T>::ShardFor(const std::string &digest) {
+  // The digest is uniformly distributed, so its first byte is as good a shard
+  // selector as any.
+  return shards_[static_cast<uint8_t>(digest[0]) % kShards];
+}
+
+SgxIdentityCache::SgxIdentityCache(size_t capacity)
+    : identities_(capacity),
+      matches_(capacity),
+      report_identities_(capacity) {}
+
+SgxIdentityCache *SgxIdentityCache::GetInstance() {
+  static SgxIdentityCache *const instance = new SgxIdentityCache();
+  return instance;
+}
+
+Status SgxIdentityCache::ParseSgxIdentity(
+    const EnclaveIdentity &generic_identity, SgxIdentity *sgx_identity) {
+  std::string digest = DigestOf(generic_identity);
+  StatusOr<SgxIdentity> cached;
+  if (!identities_.Lookup(digest, &cached)) {
+    SgxIdentity parsed;
+    Status status = sgx::ParseSgxIdentity(generic_identity, &parsed);
+    if (status.ok()) {
+      cached = std::move(parsed);
+    } else {
+      cached = status;
+    }
+    identities_.Insert(digest, cached);
+  }
+  ASYLO_RETURN_IF_ERROR(cached.status());
+  *sgx_identity = cached.ValueOrDie();
+  return Status::OkStatus();
+}
+
+StatusOr<bool> SgxIdentityCache::MatchIdentityToExpectation(
+    const EnclaveIdentity &identity,
+    const EnclaveIdentityExpectation &expectation, std::string *explanation) {
+  Sha256Hash hash;
+  UpdateWithLength(identity.SerializeAsString(), &hash);
+  UpdateWithLength(expectation.SerializeAsString(), &hash);
+  std::string digest = Finalize(hash);
+
+  MatchResult cached;
+  if (!matches_.Lookup(digest, &cached)) {
+    cached.result = [&]() -> StatusOr<bool> {
+      // If this call fails, then |identity| either does not have the correct
+      // description, or is malformed.
+      SgxIdentity sgx_identity;
+      ASYLO_RETURN_IF_ERROR(ParseSgxIdentity(identity, &sgx_identity));
+
+      // If this call fails, then |expectation|.reference_identity() either
+      // does not have the correct description, or is malformed.
+      SgxIdentityExpectation sgx_expectation;
+      bool is_legacy = !expectation.reference_identity().has_version();
+      ASYLO_RETURN_IF_ERROR(
+          ParseSgxExpectation(expectation, &sgx_expectation, is_legacy));
+
+      return sgx::MatchIdentityToExpectation(sgx_identity, sgx_expectation,
+                                             &cached.explanation, is_legacy);
+    }();
+    matches_.Insert(digest, cached);
+  }
+  if (cached.result.ok() && explanation != nullptr) {
+    *explanation = cached.explanation;
+  }
+  return cached.result;
+}
+
+Status SgxIdentityCache::SerializeIdentityFromHardwareReport(
+    const Report &report, EnclaveIdentity *identity) {
+  std::string digest = IdentityDigestOf(report);
+  StatusOr<EnclaveIdentity> cached;
+  if (!report_identities_.Lookup(digest, &cached)) {
+    cached = [&]() -> StatusOr<EnclaveIdentity> {
+      SgxIdentity sgx_identity;
+      ASYLO_RETURN_IF_ERROR(
+          ParseIdentityFromHardwareReport(report, &sgx_identity));
+      EnclaveIdentity serialized;
+      ASYLO_RETURN_IF_ERROR(SerializeSgxIdentity(sgx_identity, &serialized));
+      return serialized;
+    }();
+    report_identities_.Insert(digest, cached);
+  }
+  ASYLO_RETURN_IF_ERROR(cached.status());
+  *identity = cached.ValueOrDie();
+  return Status::OkStatus();
+}
+
+size_t SgxIdentityCache::size() const {
+  return identities_.size() + matches_.size() + report_identities_.size();
+}
+
+void SgxIdentityCache::Clear() {
+  identities_.Clear();
+  matches_.Clear();
+  report_identities_.Clear();
+}
+
+}  // namespace sgx
+}  // namespace asylo
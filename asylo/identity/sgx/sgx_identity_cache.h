@@ -0,0 +1,144 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_IDENTITY_SGX_SGX_IDENTITY_CACHE_H_
+#define ASYLO_IDENTITY_SGX_SGX_IDENTITY_CACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "asylo/identity/identity.pb.h"
+#include "asylo/identity/sgx/identity_key_management_structs.h"
+#include "asylo/identity/sgx/sgx_identity.pb.h"
+#include "asylo/util/status.h"
+#include "asylo/util/statusor.h"
+
+namespace asylo {
+namespace sgx {
+
+// A bounded, thread-safe cache of parsed SGX identities and of the outcomes of
+// matching SGX identities against SGX identity expectations.
+//
+// Each entry is keyed by a SHA-256 digest of the inputs from which it was
+// computed, so a cached result is returned for any input that is byte-for-byte
+// identical to one seen before. Failures are cached along with successes, since
+// parsing and matching are deterministic functions of their inputs.
+//
+// Each kind of entry is held in a separate table of at most |capacity| entries.
+// Tables are split into shards that are locked independently, and each shard
+// evicts its least-recently-used entry when full.
+class SgxIdentityCache {
+ public:
+  // Default maximum number of entries of each kind held by the cache.
+  static constexpr size_t kDefaultCapacity = 4096;
+
+  explicit SgxIdentityCache(size_t capacity = kDefaultCapacity);
+
+  SgxIdentityCache(const SgxIdentityCache &) = delete;
+  SgxIdentityCache &operator=(const SgxIdentityCache &) = delete;
+
+  // Returns the process-wide cache shared by SgxIdentityExpectationMatcher and
+  // SgxLocalAssertionVerifier.
+  static SgxIdentityCache *GetInstance();
+
+  // Equivalent to ParseSgxIdentity(|generic_identity|, |sgx_identity|).
+  Status ParseSgxIdentity(const EnclaveIdentity &generic_identity,
+                          SgxIdentity *sgx_identity);
+
+  // Parses |identity| and |expectation| and matches them against each other.
+  // Returns true if the match is successful, and otherwise returns false and
+  // populates |explanation|, if non-null, with the reason the match failed.
+  // Returns a non-OK status if either input cannot be parsed or the two are not
+  // comparable.
+  StatusOr<bool> MatchIdentityToExpectation(
+      const EnclaveIdentity &identity,
+      const EnclaveIdentityExpectation &expectation, std::string *explanation);
+
+  // Parses the SGX identity of the enclave that produced |report| and
+  // serializes it into |identity|. Does not verify |report|.
+  //
+  // Only the REPORT fields that make up the SGX identity contribute to the
+  // cache key, so REPORTs from the same enclave that carry different REPORTDATA
+  // share an entry.
+  Status SerializeIdentityFromHardwareReport(const Report &report,
+                                             EnclaveIdentity *identity);
+
+  // Returns the total number of entries held by the cache.
+  size_t size() const;
+
+  // Removes all entries from the cache.
+  void Clear();
+
+ private:
+  // A table mapping digests to values of type |T|.
+  template <typename T>
+  class Table {
+   public:
+    explicit Table(size_t capacity);
+
+    // Copies the value stored for |digest| into |value| and marks it as most
+    // recently used. Returns false if there is no such value.
+    bool Lookup(const std::string &digest, T *value);
+
+    // Stores |value| for |digest|, evicting the least-recently-used entry of
+    // the shard if it is full.
+    void Insert(const std::string &digest, T value);
+
+    size_t size() const;
+
+    void Clear();
+
+   private:
+    static constexpr size_t kShards = 16;
+
+    struct Shard {
+      using Entry = std::pair<std::string, T>;
+
+      mutable absl::Mutex mu;
+      std::list<Entry> entries ABSL_GUARDED_BY(mu);
+      absl::flat_hash_map<std::string, typename std::list<Entry>::iterator>
+          index ABSL_GUARDED_BY(mu);
+    };
+
+    Shard &ShardFor(const std::string &digest);
+
+    const size_t shard_capacity_;
+    std::array<Shard, kShards> shards_;
+  };
+
+  // The result of a call to MatchIdentityToExpectation().
+  struct MatchResult {
+    StatusOr<bool> result;
+    std::string explanation;
+  };
+
+  Table<StatusOr<SgxIdentity>> identities_;
+  Table<MatchResult> matches_;
+  Table<StatusOr<EnclaveIdentity>> report_identities_;
+};
+
+}  // namespace sgx
+}  // namespace asylo
+
+#endif  // ASYLO_IDENTITY_SGX_SGX_IDENTITY_CACHE_H_
@@ -0,0 +1,145 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/identity/sgx/sgx_identity_cache.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "asylo/crypto/util/trivial_object_util.h"
+#include "asylo/identity/identity.pb.h"
+#include "asylo/identity/sgx/identity_key_management_structs.h"
+#include "asylo/identity/sgx/sgx_identity.pb.h"
+#include "asylo/identity/sgx/sgx_identity_test_util.h"
+#include "asylo/identity/sgx/sgx_identity_util_internal.h"
+#include "asylo/test/util/proto_matchers.h"
+#include "asylo/test/util/status_matchers.h"
+
+namespace asylo {
+namespace sgx {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Not;
+
+TEST(SgxIdentityCacheTest, ParseSgxIdentityMatchesUncachedResult) {
+  EnclaveIdentity generic_identity;
+  SgxIdentity sgx_identity;
+  ASYLO_ASSERT_OK(SetRandomValidGenericIdentity(&generic_identity,
+                                                &sgx_identity));
+
+  SgxIdentityCache cache;
+  for (int i = 0; i < 2; ++i) {
+    SgxIdentity parsed;
+    ASYLO_ASSERT_OK(cache.ParseSgxIdentity(generic_identity, &parsed));
+    EXPECT_THAT(parsed, EqualsProto(sgx_identity));
+  }
+  EXPECT_THAT(cache.size(), Eq(1));
+}
+
+TEST(SgxIdentityCacheTest, ParseSgxIdentityCachesFailures) {
+  EnclaveIdentity generic_identity;
+  ASYLO_ASSERT_OK(SetRandomInvalidGenericIdentity(&generic_identity));
+
+  SgxIdentityCache cache;
+  SgxIdentity parsed;
+  EXPECT_THAT(cache.ParseSgxIdentity(generic_identity, &parsed), Not(IsOk()));
+  EXPECT_THAT(cache.ParseSgxIdentity(generic_identity, &parsed), Not(IsOk()));
+  EXPECT_THAT(cache.size(), Eq(1));
+}
+
+TEST(SgxIdentityCacheTest, MatchIdentityToExpectationMatchesUncachedResult) {
+  EnclaveIdentityExpectation expectation;
+  SgxIdentityExpectation sgx_expectation;
+  ASYLO_ASSERT_OK(
+      SetRandomValidGenericExpectation(&expectation, &sgx_expectation));
+
+  EnclaveIdentity identity;
+  SgxIdentity sgx_identity;
+  ASYLO_ASSERT_OK(SetRandomValidGenericIdentity(&identity, &sgx_identity));
+
+  std::string expected_explanation;
+  StatusOr<bool> expected_result = MatchIdentityToExpectation(
+      sgx_identity, sgx_expectation, &expected_explanation,
+      /*is_legacy_expectation=*/false);
+
+  SgxIdentityCache cache;
+  for (int i = 0; i < 2; ++i) {
+    std::string explanation;
+    StatusOr<bool> result =
+        cache.MatchIdentityToExpectation(identity, expectation, &explanation);
+    ASSERT_THAT(result.status(), Eq(expected_result.status()));
+    if (expected_result.ok()) {
+      EXPECT_THAT(result.ValueOrDie(), Eq(expected_result.ValueOrDie()));
+      EXPECT_THAT(explanation, Eq(expected_explanation));
+    }
+  }
+
+  EXPECT_THAT(cache.MatchIdentityToExpectation(expectation.reference_identity(),
+                                               expectation,
+                                               /*explanation=*/nullptr),
+              IsOkAndHolds(true));
+}
+
+TEST(SgxIdentityCacheTest, SerializeIdentityFromHardwareReportIgnoresReportdata) {
+  Report report = TrivialRandomObject<Report>();
+  SgxIdentity sgx_identity;
+  ASYLO_ASSERT_OK(ParseIdentityFromHardwareReport(report, &sgx_identity));
+  EnclaveIdentity expected_identity;
+  ASYLO_ASSERT_OK(SerializeSgxIdentity(sgx_identity, &expected_identity));
+
+  SgxIdentityCache cache;
+  EnclaveIdentity identity;
+  ASYLO_ASSERT_OK(cache.SerializeIdentityFromHardwareReport(report, &identity));
+  EXPECT_THAT(identity, EqualsProto(expected_identity));
+
+  // A REPORT from the same enclave with different REPORTDATA reuses the entry.
+  report.body.reportdata = TrivialRandomObject<Reportdata>();
+  ASYLO_ASSERT_OK(cache.SerializeIdentityFromHardwareReport(report, &identity));
+  EXPECT_THAT(identity, EqualsProto(expected_identity));
+  EXPECT_THAT(cache.size(), Eq(1));
+
+  // A REPORT from a different enclave does not.
+  report.body.mrenclave = TrivialRandomObject<UnsafeBytes<32>>();
+  ASYLO_ASSERT_OK(cache.SerializeIdentityFromHardwareReport(report, &identity));
+  EXPECT_THAT(identity, Not(EqualsProto(expected_identity)));
+  EXPECT_THAT(cache.size(), Eq(2));
+}
+
+TEST(SgxIdentityCacheTest, EvictsLeastRecentlyUsedEntries) {
+  constexpr int kCapacity = 32;
+  SgxIdentityCache cache(kCapacity);
+  for (int i = 0; i < 4 * kCapacity; ++i) {
+    EnclaveIdentity generic_identity;
+    SgxIdentity sgx_identity;
+    ASYLO_ASSERT_OK(
+        SetRandomValidGenericIdentity(&generic_identity, &sgx_identity));
+    SgxIdentity parsed;
+    ASYLO_ASSERT_OK(cache.ParseSgxIdentity(generic_identity, &parsed));
+    EXPECT_THAT(parsed, EqualsProto(sgx_identity));
+  }
+  EXPECT_LE(cache.size(), kCapacity);
+
+  cache.Clear();
+  EXPECT_THAT(cache.size(), Eq(0));
+}
+
+}  // namespace
+}  // namespace sgx
+}  // namespace asylo
@@ -19,9 +19,7 @@
 #include "asylo/identity/sgx/sgx_identity_expectation_matcher.h"
 
 #include "asylo/identity/descriptions.h"
-#include "asylo/identity/sgx/sgx_identity.pb.h"
-#include "asylo/identity/sgx/sgx_identity_util_internal.h"
-#include "asylo/util/status_macros.h"
+#include "asylo/identity/sgx/sgx_identity_cache.h"
 
 namespace asylo {
 
@@ -35,20 +33,10 @@ StatusOr<bool> SgxIdentityExpectationMatcher::MatchAndExplain(
     const EnclaveIdentity &identity,
     const EnclaveIdentityExpectation &expectation,
     std::string *explanation) const {
-  // If this call fails, then |identity| either does not have the correct
-  // description, or is malformed.
-  SgxIdentity sgx_identity;
-  ASYLO_RETURN_IF_ERROR(sgx::ParseSgxIdentity(identity, &sgx_identity));
-
-  // If this call fails, then |expectation|.reference_identity() either does not
-  // have the correct description, or is malformed.
-  SgxIdentityExpectation sgx_identity_expectation;
-  bool is_legacy = !expectation.reference_identity().has_version();
-  ASYLO_RETURN_IF_ERROR(sgx::ParseSgxExpectation(
-      expectation, &sgx_identity_expectation, is_legacy));
-
-  return sgx::MatchIdentityToExpectation(
-      sgx_identity, sgx_identity_expectation, explanation, is_legacy);
+  // Peers present the same few identities over and over again, so parsing and
+  // matching results are served from the process-wide cache.
+  return sgx::SgxIdentityCache::GetInstance()->MatchIdentityToExpectation(
+      identity, expectation, explanation);
 }
 
 EnclaveIdentityDescription SgxIdentityExpectationMatcher::Description() const {
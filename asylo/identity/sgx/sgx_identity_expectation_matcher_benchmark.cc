@@ -0,0 +1,88 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/identity/sgx/sgx_identity_expectation_matcher.h"
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/identity/identity.pb.h"
+#include "asylo/identity/sgx/sgx_identity.pb.h"
+#include "asylo/identity/sgx/sgx_identity_test_util.h"
+#include "asylo/identity/sgx/sgx_identity_util_internal.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace {
+
+// Number of distinct peer identities matched by the benchmark.
+constexpr int kBenchmarkPeers = 1000;
+
+// Number of matches performed by each measurement.
+constexpr int kBenchmarkMatches = 100000;
+
+// Compares the throughput of SgxIdentityExpectationMatcher, which caches
+// parsing and matching results, with that of parsing and matching each
+// identity from scratch, when a fixed set of peer identities is matched
+// repeatedly.
+TEST(SgxIdentityExpectationMatcherBenchmark, MatcherThroughput) {
+  std::vector<std::pair<EnclaveIdentity, EnclaveIdentityExpectation>> peers(
+      kBenchmarkPeers);
+  for (auto &peer : peers) {
+    SgxIdentityExpectation sgx_identity_expectation;
+    ASYLO_ASSERT_OK(sgx::SetRandomValidGenericExpectation(
+        &peer.second, &sgx_identity_expectation));
+    peer.first = peer.second.reference_identity();
+  }
+
+  absl::Time start = absl::Now();
+  for (int i = 0; i < kBenchmarkMatches; ++i) {
+    const auto &peer = peers[i % peers.size()];
+    SgxIdentity sgx_identity;
+    ASYLO_ASSERT_OK(sgx::ParseSgxIdentity(peer.first, &sgx_identity));
+    SgxIdentityExpectation sgx_identity_expectation;
+    ASYLO_ASSERT_OK(sgx::ParseSgxExpectation(
+        peer.second, &sgx_identity_expectation, /*is_legacy=*/false));
+    ASSERT_THAT(sgx::MatchIdentityToExpectation(
+                    sgx_identity, sgx_identity_expectation,
+                    /*explanation=*/nullptr, /*is_legacy_expectation=*/false),
+                IsOkAndHolds(true));
+  }
+  absl::Duration uncached = absl::Now() - start;
+
+  SgxIdentityExpectationMatcher matcher;
+  start = absl::Now();
+  for (int i = 0; i < kBenchmarkMatches; ++i) {
+    const auto &peer = peers[i % peers.size()];
+    ASSERT_THAT(matcher.Match(peer.first, peer.second), IsOkAndHolds(true));
+  }
+  absl::Duration cached = absl::Now() - start;
+
+  LOG(INFO) << "uncached: "
+            << kBenchmarkMatches / absl::ToDoubleSeconds(uncached)
+            << " matches/s, cached: "
+            << kBenchmarkMatches / absl::ToDoubleSeconds(cached)
+            << " matches/s";
+}
+
+}  // namespace
+}  // namespace asylo
@@ -18,6 +18,8 @@
 
 #include "asylo/identity/sgx/sgx_identity_expectation_matcher.h"
 
+#include <string>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "asylo/identity/descriptions.h"
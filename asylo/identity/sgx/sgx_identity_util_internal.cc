@@ -101,6 +101,32 @@ Status GetReportKey(const UnsafeBytes<kKeyrequestKeyidSize> &keyid,
   return GetHardwareKey(*request, key);
 }
 
+// Verifies the MAC of |report| using |report_key|.
+Status VerifyReportMac(const Report &report, const HardwareKey &report_key) {
+  // Compute the report MAC. SGX uses CMAC to MAC the contents of the report.
+  // The last two fields (KEYID and MAC) from the REPORT struct are not
+  // included in the MAC computation.
+  constexpr size_t kReportMacSize = sizeof(report.mac);
+  static_assert(kReportMacSize == AES_BLOCK_SIZE,
+                "Size of the mac field in the REPORT structure is incorrect.");
+  SafeBytes<kReportMacSize> actual_mac;
+  if (AES_CMAC(/*out=*/actual_mac.data(), /*key=*/report_key.data(),
+               /*key_len=*/report_key.size(),
+               /*in=*/reinterpret_cast<const uint8_t *>(&report.body),
+               /*in_len=*/sizeof(report.body)) != 1) {
+    return Status(
+        error::GoogleError::INTERNAL,
+        absl::StrCat("CMAC computation failed: ", BsslLastErrorString()));
+  }
+
+  // Inequality operator on a SafeBytes object performs a constant-time
+  // comparison, which is required for MAC verification.
+  if (actual_mac != report.mac) {
+    return Status(error::GoogleError::INTERNAL, "MAC verification failed");
+  }
+  return Status::OkStatus();
+}
+
 StatusOr<bool> MatchIdentityToExpectation(const CodeIdentity &identity,
                                           const CodeIdentity &expected,
                                           const CodeIdentityMatchSpec &spec,
@@ -709,29 +735,26 @@ Status VerifyHardwareReport(const Report &report) {
   AlignedHardwareKeyPtr report_key;
 
   ASYLO_RETURN_IF_ERROR(GetReportKey(report.keyid, report_key.get()));
+  return VerifyReportMac(report, *report_key);
+}
 
-  // Compute the report MAC. SGX uses CMAC to MAC the contents of the report.
-  // The last two fields (KEYID and MAC) from the REPORT struct are not
-  // included in the MAC computation.
-  constexpr size_t kReportMacSize = sizeof(report.mac);
-  static_assert(kReportMacSize == AES_BLOCK_SIZE,
-                "Size of the mac field in the REPORT structure is incorrect.");
-  SafeBytes<kReportMacSize> actual_mac;
-  if (AES_CMAC(/*out=*/actual_mac.data(), /*key=*/report_key->data(),
-               /*key_len=*/report_key->size(),
-               /*in=*/reinterpret_cast<const uint8_t *>(&report.body),
-               /*in_len=*/sizeof(report.body)) != 1) {
-    return Status(
-        error::GoogleError::INTERNAL,
-        absl::StrCat("CMAC computation failed: ", BsslLastErrorString()));
-  }
+std::vector<Status> VerifyHardwareReports(
+    absl::Span<const Report *const> reports) {
+  std::vector<Status> results;
+  results.reserve(reports.size());
 
-  // Inequality operator on a SafeBytes object performs a constant-time
-  // comparison, which is required for MAC verification.
-  if (actual_mac != report.mac) {
-    return Status(error::GoogleError::INTERNAL, "MAC verification failed");
+  AlignedHardwareKeyPtr report_key;
+  const Report *keyed_report = nullptr;
+  Status key_status;
+  for (const Report *report : reports) {
+    if (keyed_report == nullptr || report->keyid != keyed_report->keyid) {
+      key_status = GetReportKey(report->keyid, report_key.get());
+      keyed_report = report;
+    }
+    results.push_back(key_status.ok() ? VerifyReportMac(*report, *report_key)
+                                      : key_status);
   }
-  return Status::OkStatus();
+  return results;
 }
 
 }  // namespace sgx
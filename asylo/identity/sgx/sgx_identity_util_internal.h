@@ -20,7 +20,9 @@
 #define ASYLO_IDENTITY_SGX_SGX_IDENTITY_UTIL_INTERNAL_H_
 
 #include <string>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "asylo/identity/identity.pb.h"
 #include "asylo/identity/sgx/code_identity.pb.h"
 #include "asylo/identity/sgx/code_identity_constants.h"
@@ -161,6 +163,14 @@ void SetTargetinfoFromSelfIdentity(Targetinfo *tinfo);
 // Verifies the hardware report |report|.
 Status VerifyHardwareReport(const Report &report);
 
+// Verifies each of the hardware reports in |reports| and returns the results in
+// the same order. The report key is only re-derived when the KEYID changes from
+// one report to the next, which makes verifying a batch of reports generated
+// on the same platform considerably cheaper than calling VerifyHardwareReport()
+// on each of them.
+std::vector<Status> VerifyHardwareReports(
+    absl::Span<const Report *const> reports);
+
 }  // namespace sgx
 }  // namespace asylo
 
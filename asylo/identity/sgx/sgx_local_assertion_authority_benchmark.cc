@@ -0,0 +1,110 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/identity/identity.pb.h"
+#include "asylo/identity/sgx/fake_enclave.h"
+#include "asylo/identity/sgx/sgx_local_assertion_generator.h"
+#include "asylo/identity/sgx/sgx_local_assertion_verifier.h"
+#include "asylo/test/util/enclave_assertion_authority_configs.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace {
+
+constexpr char kUserData[] = "User data";
+
+// Number of assertions generated and verified in each measurement.
+constexpr int kBatchSize = 64;
+
+// Logs the time taken to generate and verify kBatchSize assertions one at a
+// time and in batches, with the generator and verifier in different enclaves.
+TEST(SgxLocalAssertionAuthorityBenchmark, BatchThroughput) {
+  std::string config = GetSgxLocalAssertionAuthorityTestConfig().config();
+  sgx::FakeEnclave generator_enclave;
+  generator_enclave.SetRandomIdentity();
+  sgx::FakeEnclave verifier_enclave;
+  verifier_enclave.SetRandomIdentity();
+
+  sgx::FakeEnclave::EnterEnclave(verifier_enclave);
+  SgxLocalAssertionVerifier verifier;
+  ASSERT_THAT(verifier.Initialize(config), IsOk());
+  AssertionRequest request;
+  ASSERT_THAT(verifier.CreateAssertionRequest(&request), IsOk());
+  sgx::FakeEnclave::ExitEnclave();
+
+  sgx::FakeEnclave::EnterEnclave(generator_enclave);
+  SgxLocalAssertionGenerator generator;
+  ASSERT_THAT(generator.Initialize(config), IsOk());
+
+  std::vector<std::pair<std::string, AssertionRequest>> generate_inputs;
+  for (int i = 0; i < kBatchSize; ++i) {
+    generate_inputs.emplace_back(absl::StrCat(kUserData, i), request);
+  }
+
+  absl::Time start = absl::Now();
+  std::vector<std::pair<std::string, Assertion>> verify_inputs;
+  for (const auto &input : generate_inputs) {
+    Assertion assertion;
+    ASSERT_THAT(generator.Generate(input.first, input.second, &assertion),
+                IsOk());
+    verify_inputs.emplace_back(input.first, assertion);
+  }
+  absl::Duration generate_time = absl::Now() - start;
+
+  start = absl::Now();
+  for (const StatusOr<Assertion> &assertion :
+       generator.GenerateBatch(generate_inputs)) {
+    ASSERT_THAT(assertion, IsOk());
+  }
+  absl::Duration generate_batch_time = absl::Now() - start;
+  sgx::FakeEnclave::ExitEnclave();
+
+  sgx::FakeEnclave::EnterEnclave(verifier_enclave);
+  start = absl::Now();
+  for (const auto &input : verify_inputs) {
+    EnclaveIdentity identity;
+    ASSERT_THAT(verifier.Verify(input.first, input.second, &identity), IsOk());
+  }
+  absl::Duration verify_time = absl::Now() - start;
+
+  start = absl::Now();
+  for (const StatusOr<EnclaveIdentity> &identity :
+       verifier.VerifyBatch(verify_inputs)) {
+    ASSERT_THAT(identity, IsOk());
+  }
+  absl::Duration verify_batch_time = absl::Now() - start;
+  sgx::FakeEnclave::ExitEnclave();
+
+  LOG(INFO) << kBatchSize << " local assertions: generate=" << generate_time
+            << " generate_batch=" << generate_batch_time
+            << " verify=" << verify_time
+            << " verify_batch=" << verify_batch_time;
+}
+
+}  // namespace
+}  // namespace asylo
@@ -16,8 +16,13 @@
  *
  */
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
 #include "asylo/identity/identity.pb.h"
 #include "asylo/identity/sgx/fake_enclave.h"
 #include "asylo/identity/sgx/proto_format.h"
@@ -35,6 +40,9 @@ namespace {
 
 constexpr char kUserData[] = "User data";
 
+// Number of assertions generated and verified by the batch tests.
+constexpr int kBatchSize = 64;
+
 // A test fixture is required for value-parameterized tests. The test fixture is
 // also used to contain common test setup and tear down logic.
 class SgxLocalAssertionAuthorityTest
@@ -158,5 +166,74 @@ TEST_P(SgxLocalAssertionAuthorityTest, VerifyAssertionSameEnclave) {
       << sgx::FormatProto(sgx::GetSelfIdentity()->sgx_identity);
 }
 
+// Verify that assertions generated in a batch by a SgxLocalAssertionGenerator
+// are verified in a batch by a SgxLocalAssertionVerifier, and that a failure
+// in one element of a batch does not affect the others.
+TEST_P(SgxLocalAssertionAuthorityTest, VerifyAssertionBatch) {
+  sgx::FakeEnclave::EnterEnclave(verifier_enclave_);
+
+  SgxLocalAssertionVerifier verifier;
+  ASSERT_THAT(verifier.Initialize(config_), IsOk());
+
+  AssertionRequest request;
+  ASSERT_THAT(verifier.CreateAssertionRequest(&request), IsOk());
+  AssertionRequest bad_request = request;
+  bad_request.mutable_description()->set_authority_type("Bad authority");
+
+  std::vector<std::pair<std::string, AssertionRequest>> generate_inputs;
+  for (int i = 0; i < kBatchSize; ++i) {
+    generate_inputs.emplace_back(absl::StrCat(kUserData, i), request);
+  }
+  generate_inputs[1].second = bad_request;
+
+  sgx::FakeEnclave::ExitEnclave();
+  sgx::FakeEnclave::EnterEnclave(generator_enclave_);
+
+  SgxLocalAssertionGenerator generator;
+  ASSERT_THAT(generator.Initialize(config_), IsOk());
+
+  std::vector<StatusOr<Assertion>> assertions =
+      generator.GenerateBatch(generate_inputs);
+  ASSERT_EQ(assertions.size(), kBatchSize);
+  EXPECT_THAT(assertions[1].status(),
+              StatusIs(error::GoogleError::INVALID_ARGUMENT));
+
+  std::vector<std::pair<std::string, Assertion>> verify_inputs;
+  for (int i = 0; i < kBatchSize; ++i) {
+    if (i == 1) {
+      continue;
+    }
+    ASSERT_THAT(assertions[i], IsOk());
+    verify_inputs.emplace_back(generate_inputs[i].first,
+                               assertions[i].ValueOrDie());
+  }
+  // Bind one assertion to different user-data.
+  verify_inputs[2].first = kUserData;
+
+  sgx::FakeEnclave::ExitEnclave();
+  sgx::FakeEnclave::EnterEnclave(verifier_enclave_);
+
+  std::vector<StatusOr<EnclaveIdentity>> identities =
+      verifier.VerifyBatch(verify_inputs);
+  ASSERT_EQ(identities.size(), verify_inputs.size());
+
+  sgx::FakeEnclave::ExitEnclave();
+  sgx::FakeEnclave::EnterEnclave(generator_enclave_);
+
+  for (size_t i = 0; i < identities.size(); ++i) {
+    if (i == 2) {
+      EXPECT_THAT(identities[i].status(),
+                  StatusIs(error::GoogleError::INTERNAL));
+      continue;
+    }
+    ASSERT_THAT(identities[i], IsOk());
+    SgxIdentity sgx_identity;
+    ASYLO_ASSERT_OK_AND_ASSIGN(sgx_identity,
+                               ParseSgxIdentity(identities[i].ValueOrDie()));
+    EXPECT_THAT(sgx_identity,
+                EqualsProto(sgx::GetSelfIdentity()->sgx_identity));
+  }
+}
+
 }  // namespace
 }  // namespace asylo
@@ -19,7 +19,11 @@
 #include "asylo/identity/sgx/sgx_local_assertion_generator.h"
 
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "asylo/crypto/sha256_hash.h"
 #include "asylo/crypto/util/bytes.h"
 #include "asylo/crypto/util/trivial_object_util.h"
@@ -122,17 +126,77 @@ Status SgxLocalAssertionGenerator::Generate(const std::string &user_data,
     return Status(error::GoogleError::FAILED_PRECONDITION, "Not initialized");
   }
 
+  sgx::AlignedTargetinfoPtr tinfo;
+  ASYLO_RETURN_IF_ERROR(ParseTargetinfo(
+      request, members_.ReaderLock()->attestation_domain, tinfo.get()));
+  return GenerateForTarget(user_data, *tinfo, assertion);
+}
+
+std::vector<StatusOr<Assertion>> SgxLocalAssertionGenerator::GenerateBatch(
+    absl::Span<const std::pair<std::string, AssertionRequest>> inputs) const {
+  std::vector<StatusOr<Assertion>> results;
+  if (!IsInitialized()) {
+    results.assign(inputs.size(),
+                   Status(error::GoogleError::FAILED_PRECONDITION,
+                          "Not initialized"));
+    return results;
+  }
+  const std::string attestation_domain =
+      members_.ReaderLock()->attestation_domain;
+
+  // Requests created by the same verifier carry identical additional
+  // information, so each distinct TARGETINFO is only parsed once. The keys
+  // refer to strings owned by |inputs|. Since the key ignores the description,
+  // each request's description is checked before the cache is consulted.
+  struct ParsedTarget {
+    Status status;
+    sgx::AlignedTargetinfoPtr tinfo;
+  };
+  absl::flat_hash_map<absl::string_view, ParsedTarget> targets;
+
+  results.reserve(inputs.size());
+  for (const auto &input : inputs) {
+    const AssertionRequest &request = input.second;
+    if (!IsCompatibleAssertionDescription(request.description())) {
+      results.push_back(Status(error::GoogleError::INVALID_ARGUMENT,
+                               "Incompatible assertion description"));
+      continue;
+    }
+
+    auto emplace_result = targets.try_emplace(request.additional_information());
+    ParsedTarget &target = emplace_result.first->second;
+    if (emplace_result.second) {
+      target.status =
+          ParseTargetinfo(request, attestation_domain, target.tinfo.get());
+    }
+    if (!target.status.ok()) {
+      results.push_back(target.status);
+      continue;
+    }
+
+    Assertion assertion;
+    Status status = GenerateForTarget(input.first, *target.tinfo, &assertion);
+    if (status.ok()) {
+      results.push_back(std::move(assertion));
+    } else {
+      results.push_back(status);
+    }
+  }
+  return results;
+}
+
+Status SgxLocalAssertionGenerator::ParseTargetinfo(
+    const AssertionRequest &request, const std::string &attestation_domain,
+    sgx::Targetinfo *tinfo) const {
   StatusOr<sgx::LocalAssertionRequestAdditionalInfo> additional_info_result =
       ParseAdditionalInfo(request);
   if (!additional_info_result.ok()) {
     return additional_info_result.status();
   }
 
-  sgx::LocalAssertionRequestAdditionalInfo additional_info =
+  const sgx::LocalAssertionRequestAdditionalInfo &additional_info =
       additional_info_result.ValueOrDie();
-
-  if (additional_info.local_attestation_domain() !=
-      members_.ReaderLock()->attestation_domain) {
+  if (additional_info.local_attestation_domain() != attestation_domain) {
     return Status(error::GoogleError::INVALID_ARGUMENT,
                   "AssertionRequest specifies non-local attestation domain");
   }
@@ -145,10 +209,13 @@ Status SgxLocalAssertionGenerator::Generate(const std::string &user_data,
   // architecture, and was copied into the request byte-for-byte. Since the
   // LocalAssertionGenerator runs inside an SGX enclave, it is safe to restore
   // the TARGETINFO structure directly from the request.
-  sgx::AlignedTargetinfoPtr tinfo;
-  ASYLO_RETURN_IF_ERROR(SetTrivialObjectFromBinaryString<sgx::Targetinfo>(
-      additional_info.targetinfo(), tinfo.get()));
+  return SetTrivialObjectFromBinaryString<sgx::Targetinfo>(
+      additional_info.targetinfo(), tinfo);
+}
 
+Status SgxLocalAssertionGenerator::GenerateForTarget(
+    const std::string &user_data, const sgx::Targetinfo &tinfo,
+    Assertion *assertion) const {
   // The REPORTDATA is a user-provided input to the hardware report that is
   // included in the report's MAC. Use a SHA256 hash of |user_data| as the
   // REPORTDATA value so that the resulting assertion is cryptographically-bound
@@ -167,7 +234,7 @@ Status SgxLocalAssertionGenerator::Generate(const std::string &user_data,
   // at the enclave described in the request.
   sgx::AlignedReportPtr report;
   ASYLO_RETURN_IF_ERROR(
-      sgx::GetHardwareReport(*tinfo, *reportdata, report.get()));
+      sgx::GetHardwareReport(tinfo, *reportdata, report.get()));
 
   // As explained above, the REPORT structure can be copied byte-for-byte into
   // the report field of the assertion because the layout and endianness of the
@@ -182,6 +249,7 @@ Status SgxLocalAssertionGenerator::Generate(const std::string &user_data,
     return Status(error::GoogleError::INTERNAL,
                   "Failed to serialize local assertion");
   }
+
   assertion->mutable_description()->set_identity_type(IdentityType());
   assertion->mutable_description()->set_authority_type(AuthorityType());
 
@@ -19,9 +19,16 @@
 #ifndef ASYLO_IDENTITY_SGX_SGX_LOCAL_ASSERTION_GENERATOR_H_
 #define ASYLO_IDENTITY_SGX_SGX_LOCAL_ASSERTION_GENERATOR_H_
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
 #include "asylo/identity/enclave_assertion_generator.h"
+#include "asylo/identity/sgx/identity_key_management_structs.h"
 #include "asylo/identity/sgx/local_assertion.pb.h"
 #include "asylo/util/mutex_guarded.h"
+#include "asylo/util/statusor.h"
 
 namespace asylo {
 
@@ -61,7 +68,36 @@ class SgxLocalAssertionGenerator final : public EnclaveAssertionGenerator {
   Status Generate(const std::string &user_data, const AssertionRequest &request,
                   Assertion *assertion) const override;
 
+  /// Generates a batch of assertions.
+  ///
+  /// Each element of \p inputs is a pair of the user-data and the request, as
+  /// would be passed to Generate(). The result for `inputs[i]` is at index `i`
+  /// of the returned vector. A failure to generate one assertion does not
+  /// affect the others.
+  ///
+  /// This is equivalent to calling Generate() on each element of \p inputs,
+  /// but reads the authority configuration once for the whole batch and parses
+  /// the TARGETINFO of each distinct verifier only once.
+  ///
+  /// \param inputs The (user-data, request) pairs to generate assertions for.
+  /// \return One assertion or error per element of \p inputs.
+  std::vector<StatusOr<Assertion>> GenerateBatch(
+      absl::Span<const std::pair<std::string, AssertionRequest>> inputs) const;
+
  private:
+  // Parses the TARGETINFO from the additional information of |request| into
+  // |tinfo|. Returns the error from ParseAdditionalInfo() if the request cannot
+  // be parsed, or an error if it is not for |attestation_domain|.
+  Status ParseTargetinfo(const AssertionRequest &request,
+                         const std::string &attestation_domain,
+                         sgx::Targetinfo *tinfo) const;
+
+  // Generates an assertion bound to |user_data| and targeted at the enclave
+  // described by |tinfo|, which must be suitably aligned for EREPORT.
+  Status GenerateForTarget(const std::string &user_data,
+                           const sgx::Targetinfo &tinfo,
+                           Assertion *assertion) const;
+
   // Parses additional information from the given |request|. Returns the
   // LocalAssertionRequestAdditionalInfo on success. Returns a non-OK status on
   // parsing failure.
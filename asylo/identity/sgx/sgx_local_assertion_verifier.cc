@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
@@ -30,6 +31,7 @@
 #include "asylo/identity/sgx/code_identity_constants.h"
 #include "asylo/identity/sgx/identity_key_management_structs.h"
 #include "asylo/identity/sgx/local_assertion.pb.h"
+#include "asylo/identity/sgx/sgx_identity_cache.h"
 #include "asylo/identity/sgx/sgx_identity_util_internal.h"
 #include "asylo/identity/sgx/sgx_local_assertion_authority_config.pb.h"
 #include "asylo/util/status_macros.h"
@@ -139,6 +141,64 @@ Status SgxLocalAssertionVerifier::Verify(const std::string &user_data,
     return Status(error::GoogleError::FAILED_PRECONDITION, "Not initialized");
   }
 
+  // First, verify the hardware REPORT embedded in the assertion. This will only
+  // succeed if the REPORT is targeted at this enclave.
+  sgx::Report report;
+  ASYLO_RETURN_IF_ERROR(ParseReport(assertion, &report));
+  ASYLO_RETURN_IF_ERROR(sgx::VerifyHardwareReport(report));
+
+  return ExtractPeerIdentity(user_data, report, peer_identity);
+}
+
+std::vector<StatusOr<EnclaveIdentity>> SgxLocalAssertionVerifier::VerifyBatch(
+    absl::Span<const std::pair<std::string, Assertion>> inputs) const {
+  std::vector<StatusOr<EnclaveIdentity>> results;
+  if (!IsInitialized()) {
+    results.assign(inputs.size(),
+                   Status(error::GoogleError::FAILED_PRECONDITION,
+                          "Not initialized"));
+    return results;
+  }
+
+  // Parse every assertion up front so that all well-formed REPORTs can be
+  // verified together.
+  std::vector<sgx::Report> reports(inputs.size());
+  std::vector<Status> parse_results;
+  std::vector<const sgx::Report *> parsed_reports;
+  parse_results.reserve(inputs.size());
+  parsed_reports.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    parse_results.push_back(ParseReport(inputs[i].second, &reports[i]));
+    if (parse_results.back().ok()) {
+      parsed_reports.push_back(&reports[i]);
+    }
+  }
+  std::vector<Status> verify_results =
+      sgx::VerifyHardwareReports(parsed_reports);
+
+  results.reserve(inputs.size());
+  auto verify_result = verify_results.cbegin();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!parse_results[i].ok()) {
+      results.push_back(parse_results[i]);
+      continue;
+    }
+    Status status = *verify_result++;
+    EnclaveIdentity peer_identity;
+    if (status.ok()) {
+      status = ExtractPeerIdentity(inputs[i].first, reports[i], &peer_identity);
+    }
+    if (status.ok()) {
+      results.push_back(std::move(peer_identity));
+    } else {
+      results.push_back(status);
+    }
+  }
+  return results;
+}
+
+Status SgxLocalAssertionVerifier::ParseReport(const Assertion &assertion,
+                                              sgx::Report *report) const {
   if (!IsCompatibleAssertionDescription(assertion.description())) {
     return Status(error::GoogleError::INVALID_ARGUMENT,
                   "Assertion has incompatible assertion description");
@@ -150,20 +210,20 @@ Status SgxLocalAssertionVerifier::Verify(const std::string &user_data,
                   "Failed to parse LocalAssertion");
   }
 
-  // First, verify the hardware REPORT embedded in the assertion. This will only
-  // succeed if the REPORT is targeted at this enclave. Note that since the
-  // layout and endianness of the REPORT structure is defined by the Intel SGX
-  // architecture, two SGX enclaves can exchange a REPORT by simply dumping the
-  // raw bytes of a REPORT structure into a proto. This code assumes that the
-  // assertion originates from a machine that supports the Intel SGX
+  // Since the layout and endianness of the REPORT structure is defined by the
+  // Intel SGX architecture, two SGX enclaves can exchange a REPORT by simply
+  // dumping the raw bytes of a REPORT structure into a proto. This code assumes
+  // that the assertion originates from a machine that supports the Intel SGX
   // architecture and was copied into the assertion byte-for-byte, so is safe to
   // restore the REPORT structure directly from the deserialized LocalAssertion.
-  sgx::Report report;
-  ASYLO_RETURN_IF_ERROR(SetTrivialObjectFromBinaryString<sgx::Report>(
-      local_assertion.report(), &report));
-  ASYLO_RETURN_IF_ERROR(sgx::VerifyHardwareReport(report));
+  return SetTrivialObjectFromBinaryString<sgx::Report>(local_assertion.report(),
+                                                       report);
+}
 
-  // Next, verify that the REPORT is cryptographically-bound to the provided
+Status SgxLocalAssertionVerifier::ExtractPeerIdentity(
+    const std::string &user_data, const sgx::Report &report,
+    EnclaveIdentity *peer_identity) const {
+  // Verify that the REPORT is cryptographically-bound to the provided
   // |user_data|. This is done by re-constructing the expected REPORTDATA (a
   // SHA256 hash of |user_data| padded with zeros), and comparing it to the
   // actual REPORTDATA inside the REPORT.
@@ -175,20 +235,16 @@ Status SgxLocalAssertionVerifier::Verify(const std::string &user_data,
   std::vector<uint8_t> digest;
   ASYLO_RETURN_IF_ERROR(hash.CumulativeHash(&digest));
   expected_reportdata.data.replace(/*pos=*/0, digest);
-
   if (expected_reportdata.data != report.body.reportdata.data) {
     return Status(error::GoogleError::INTERNAL,
                   "Assertion is not bound to the provided user-data");
   }
 
   // Serialize the protobuf representation of the peer's SGX identity and save
-  // it in |peer_identity|.
-  SgxIdentity sgx_identity;
-  ASYLO_RETURN_IF_ERROR(
-      sgx::ParseIdentityFromHardwareReport(report, &sgx_identity));
-  ASYLO_RETURN_IF_ERROR(sgx::SerializeSgxIdentity(sgx_identity, peer_identity));
-
-  return Status::OkStatus();
+  // it in |peer_identity|. The identity does not depend on the REPORTDATA, so
+  // it is cached across all REPORTs from the same peer enclave.
+  return sgx::SgxIdentityCache::GetInstance()
+      ->SerializeIdentityFromHardwareReport(report, peer_identity);
 }
 
 // Static registration of the LocalAssertionVerifier library.
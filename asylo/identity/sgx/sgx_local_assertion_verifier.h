@@ -19,9 +19,16 @@
 #ifndef ASYLO_IDENTITY_SGX_SGX_LOCAL_ASSERTION_VERIFIER_H_
 #define ASYLO_IDENTITY_SGX_SGX_LOCAL_ASSERTION_VERIFIER_H_
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "asylo/identity/enclave_assertion_verifier.h"
 
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "asylo/identity/sgx/identity_key_management_structs.h"
+#include "asylo/util/statusor.h"
 
 namespace asylo {
 
@@ -61,7 +68,34 @@ class SgxLocalAssertionVerifier final : public EnclaveAssertionVerifier {
   Status Verify(const std::string &user_data, const Assertion &assertion,
                 EnclaveIdentity *peer_identity) const override;
 
+  /// Verifies a batch of assertions.
+  ///
+  /// Each element of \p inputs is a pair of the user-data and the assertion
+  /// that is bound to it, as would be passed to Verify(). The result for
+  /// `inputs[i]` is at index `i` of the returned vector, and holds the peer's
+  /// identity if verification succeeded. A failure to verify one assertion does
+  /// not affect the others.
+  ///
+  /// This is equivalent to calling Verify() on each element of \p inputs, but
+  /// derives the report key once for all assertions generated on the same
+  /// platform instead of once per assertion.
+  ///
+  /// \param inputs The (user-data, assertion) pairs to verify.
+  /// \return One identity or error per element of \p inputs.
+  std::vector<StatusOr<EnclaveIdentity>> VerifyBatch(
+      absl::Span<const std::pair<std::string, Assertion>> inputs) const;
+
  private:
+  // Checks the description of |assertion| and extracts the hardware REPORT
+  // from it into |report|.
+  Status ParseReport(const Assertion &assertion, sgx::Report *report) const;
+
+  // Checks that |report|, which has already been verified, is bound to
+  // |user_data| and writes the identity it describes to |peer_identity|.
+  Status ExtractPeerIdentity(const std::string &user_data,
+                             const sgx::Report &report,
+                             EnclaveIdentity *peer_identity) const;
+
   // The identity type handled by this verifier.
   static constexpr EnclaveIdentityType identity_type_ = CODE_IDENTITY;
 
@@ -19,20 +19,24 @@
 #include "asylo/identity/sgx/sgx_local_secret_sealer.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "asylo/crypto/aead_cryptor.h"
 #include "asylo/crypto/algorithms.pb.h"
 #include "asylo/crypto/util/byte_container_util.h"
 #include "asylo/crypto/util/byte_container_view.h"
 #include "asylo/crypto/util/bytes.h"
+#include "asylo/crypto/util/trivial_object_util.h"
 #include "asylo/identity/identity_acl.pb.h"
 #include "asylo/identity/sgx/code_identity.pb.h"
 #include "asylo/identity/sgx/identity_key_management_structs.h"
 #include "asylo/identity/sgx/local_secret_sealer_helpers.h"
 #include "asylo/identity/sgx/sgx_identity.pb.h"
 #include "asylo/identity/sgx/sgx_identity_util.h"
+#include "asylo/platform/storage/utils/random_access_storage.h"
 #include "asylo/util/status_macros.h"
 
 namespace asylo {
@@ -40,6 +44,9 @@ namespace asylo {
 using experimental::AeadCryptor;
 
 constexpr size_t kAes256GcmSivKeySize = 32;
+constexpr char kSealingKeyId[] = "default_key_id";
+
+constexpr size_t SgxLocalSecretSealer::kMaxCachedKeys;
 
 std::unique_ptr<SgxLocalSecretSealer>
 SgxLocalSecretSealer::CreateMrenclaveSecretSealer() {
@@ -128,11 +135,8 @@ Status SgxLocalSecretSealer::Seal(
     const SealedSecretHeader &header,
     ByteContainerView additional_authenticated_data, ByteContainerView secret,
     SealedSecret *sealed_secret) {
-  AeadScheme aead_scheme;
-  SgxIdentityExpectation sgx_expectation;
-  ASYLO_RETURN_IF_ERROR(
-      sgx::internal::ParseKeyGenerationParamsFromSealedSecretHeader(
-          header, &aead_scheme, &sgx_expectation));
+  std::unique_ptr<AeadCryptor> cryptor;
+  ASYLO_ASSIGN_OR_RETURN(cryptor, MakeCryptorForHeader(header));
 
   if (!header.SerializeToString(
           sealed_secret->mutable_sealed_secret_header())) {
@@ -148,13 +152,6 @@ Status SgxLocalSecretSealer::Seal(
                           sealed_secret->sealed_secret_header(),
                           additional_authenticated_data);
 
-  CleansingVector<uint8_t> key;
-  ASYLO_RETURN_IF_ERROR(sgx::internal::GenerateCryptorKey(
-      aead_scheme, "default_key_id", sgx_expectation, kAes256GcmSivKeySize,
-      &key));
-
-  std::unique_ptr<AeadCryptor> cryptor;
-  ASYLO_ASSIGN_OR_RETURN(cryptor, sgx::internal::MakeCryptor(aead_scheme, key));
   return sgx::internal::Seal(cryptor.get(), secret, final_additional_data,
                              sealed_secret);
 }
@@ -167,26 +164,145 @@ Status SgxLocalSecretSealer::Unseal(const SealedSecret &sealed_secret,
                   "Could not parse the sealed secret header");
   }
 
-  AeadScheme aead_scheme;
-  SgxIdentityExpectation sgx_expectation;
-  ASYLO_RETURN_IF_ERROR(
-      sgx::internal::ParseKeyGenerationParamsFromSealedSecretHeader(
-          header, &aead_scheme, &sgx_expectation));
+  std::unique_ptr<AeadCryptor> cryptor;
+  ASYLO_ASSIGN_OR_RETURN(cryptor, MakeCryptorForHeader(header));
 
   std::string final_additional_data;
   SerializeByteContainers(&final_additional_data,
                           sealed_secret.sealed_secret_header(),
                           sealed_secret.additional_authenticated_data());
 
+  return sgx::internal::Open(cryptor.get(), sealed_secret,
+                             final_additional_data, secret);
+}
+
+Status SgxLocalSecretSealer::SealStream(
+    const SealedSecretHeader &header,
+    ByteContainerView additional_authenticated_data,
+    RandomAccessStorage *input, RandomAccessStorage *output) {
+  sgx::internal::StorageStreamReader reader(input);
+  sgx::internal::StorageStreamWriter writer(output);
+  return SealStream(header, additional_authenticated_data, &reader, &writer);
+}
+
+Status SgxLocalSecretSealer::SealStream(
+    const SealedSecretHeader &header,
+    ByteContainerView additional_authenticated_data, int input_fd,
+    int output_fd) {
+  sgx::internal::FdStreamReader reader(input_fd);
+  sgx::internal::FdStreamWriter writer(output_fd);
+  return SealStream(header, additional_authenticated_data, &reader, &writer);
+}
+
+Status SgxLocalSecretSealer::UnsealStream(
+    RandomAccessStorage *input, RandomAccessStorage *output,
+    std::string *additional_authenticated_data) {
+  sgx::internal::StorageStreamReader reader(input);
+  sgx::internal::StorageStreamWriter writer(output);
+  return UnsealStream(&reader, &writer, additional_authenticated_data);
+}
+
+Status SgxLocalSecretSealer::UnsealStream(
+    int input_fd, int output_fd, std::string *additional_authenticated_data) {
+  sgx::internal::FdStreamReader reader(input_fd);
+  sgx::internal::FdStreamWriter writer(output_fd);
+  return UnsealStream(&reader, &writer, additional_authenticated_data);
+}
+
+StatusOr<std::unique_ptr<AeadCryptor>>
+SgxLocalSecretSealer::MakeCryptorForHeader(const SealedSecretHeader &header) {
+  AeadScheme aead_scheme;
+  SgxIdentityExpectation sgx_expectation;
+  ASYLO_RETURN_IF_ERROR(
+      sgx::internal::ParseKeyGenerationParamsFromSealedSecretHeader(
+          header, &aead_scheme, &sgx_expectation));
+
   CleansingVector<uint8_t> key;
+  ASYLO_RETURN_IF_ERROR(GetSealingKey(aead_scheme, sgx_expectation, &key));
+  return sgx::internal::MakeCryptor(aead_scheme, key);
+}
+
+Status SgxLocalSecretSealer::GetSealingKey(
+    AeadScheme aead_scheme, const SgxIdentityExpectation &sgx_expectation,
+    CleansingVector<uint8_t> *key) {
+  // The derived key is fully determined by the AEAD scheme and the KEYREQUEST
+  // fields taken from |sgx_expectation|. The remaining inputs to the key
+  // derivation are fixed for a given enclave.
+  sgx::Keyrequest request;
+  sgx::internal::PopulateSealKeyrequest(sgx_expectation, &request);
+  std::string cache_key = absl::StrCat(
+      AeadScheme_Name(aead_scheme), ":",
+      ConvertTrivialObjectToBinaryString(request));
+
+  {
+    absl::MutexLock lock(&key_cache_mu_);
+    auto it = key_cache_.find(cache_key);
+    if (it != key_cache_.end()) {
+      *key = it->second;
+      return Status::OkStatus();
+    }
+  }
+
   ASYLO_RETURN_IF_ERROR(sgx::internal::GenerateCryptorKey(
-      aead_scheme, "default_key_id", sgx_expectation, kAes256GcmSivKeySize,
-      &key));
+      aead_scheme, kSealingKeyId, sgx_expectation, kAes256GcmSivKeySize, key));
 
+  absl::MutexLock lock(&key_cache_mu_);
+  if (key_cache_.size() >= kMaxCachedKeys &&
+      !key_cache_.contains(cache_key)) {
+    key_cache_.erase(key_cache_.begin());
+  }
+  key_cache_.emplace(std::move(cache_key), *key);
+  return Status::OkStatus();
+}
+
+Status SgxLocalSecretSealer::SealStream(
+    const SealedSecretHeader &header,
+    ByteContainerView additional_authenticated_data,
+    sgx::internal::StreamReader *input, sgx::internal::StreamWriter *output) {
   std::unique_ptr<AeadCryptor> cryptor;
-  ASYLO_ASSIGN_OR_RETURN(cryptor, sgx::internal::MakeCryptor(aead_scheme, key));
-  return sgx::internal::Open(cryptor.get(), sealed_secret,
-                             final_additional_data, secret);
+  ASYLO_ASSIGN_OR_RETURN(cryptor, MakeCryptorForHeader(header));
+
+  SealedSecret preamble;
+  if (!header.SerializeToString(preamble.mutable_sealed_secret_header())) {
+    return Status(error::GoogleError::INTERNAL,
+                  "Header serialization to string failed");
+  }
+  preamble.set_additional_authenticated_data(
+      reinterpret_cast<const char *>(additional_authenticated_data.data()),
+      additional_authenticated_data.size());
+  std::string serialized_preamble;
+  if (!preamble.SerializeToString(&serialized_preamble)) {
+    return Status(error::GoogleError::INTERNAL,
+                  "Sealed stream preamble serialization failed");
+  }
+
+  return sgx::internal::WriteSealedStream(cryptor.get(), serialized_preamble,
+                                          input, output);
+}
+
+Status SgxLocalSecretSealer::UnsealStream(
+    sgx::internal::StreamReader *input, sgx::internal::StreamWriter *output,
+    std::string *additional_authenticated_data) {
+  std::string serialized_preamble;
+  ASYLO_RETURN_IF_ERROR(
+      sgx::internal::ReadSealedStreamPreamble(input, &serialized_preamble));
+  SealedSecret preamble;
+  SealedSecretHeader header;
+  if (!preamble.ParseFromString(serialized_preamble) ||
+      !header.ParseFromString(preamble.sealed_secret_header())) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Could not parse the sealed stream header");
+  }
+
+  std::unique_ptr<AeadCryptor> cryptor;
+  ASYLO_ASSIGN_OR_RETURN(cryptor, MakeCryptorForHeader(header));
+  ASYLO_RETURN_IF_ERROR(sgx::internal::OpenSealedStream(
+      cryptor.get(), serialized_preamble, input, output));
+
+  if (additional_authenticated_data != nullptr) {
+    *additional_authenticated_data = preamble.additional_authenticated_data();
+  }
+  return Status::OkStatus();
 }
 
 }  // namespace asylo
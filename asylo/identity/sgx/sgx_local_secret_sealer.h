@@ -19,18 +19,35 @@
 #ifndef ASYLO_IDENTITY_SGX_SGX_LOCAL_SECRET_SEALER_H_
 #define ASYLO_IDENTITY_SGX_SGX_LOCAL_SECRET_SEALER_H_
 
+#include <cstddef>
 #include <memory>
+#include <string>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "asylo/crypto/aead_cryptor.h"
+#include "asylo/crypto/algorithms.pb.h"
 #include "asylo/crypto/util/byte_container_view.h"
 #include "asylo/identity/identity.pb.h"
 #include "asylo/identity/sealed_secret.pb.h"
 #include "asylo/identity/secret_sealer.h"
 #include "asylo/identity/sgx/code_identity.pb.h"
 #include "asylo/identity/sgx/sgx_identity.pb.h"
+#include "asylo/platform/storage/utils/random_access_storage.h"
 #include "asylo/util/cleansing_types.h"
 #include "asylo/util/status.h"
+#include "asylo/util/statusor.h"
 
 namespace asylo {
+namespace sgx {
+namespace internal {
+
+class StreamReader;
+class StreamWriter;
+
+}  // namespace internal
+}  // namespace sgx
 
 /// An implementation of the SecretSealer abstract interface that binds the
 /// secrets to the enclave identity on a local machine. The secrets sealed by
@@ -100,6 +117,15 @@ namespace asylo {
 ///   // authenticated.
 /// ```
 ///
+/// Secrets too large to hold in memory can be sealed with SealStream() and
+/// unsealed with UnsealStream(). These read their input and write their output
+/// in fixed-size chunks, each of which is individually authenticated, so their
+/// memory use does not depend on the size of the secret.
+///
+/// Sealing keys are derived through EGETKEY the first time a key policy is
+/// used, and are cached inside the sealer for subsequent Seal() and Unseal()
+/// calls.
+///
 /// It should be noted that the SgxLocalSecretSealer's configuration only
 /// affects the default header generated by the sealer. Users can override the
 /// generated default header. A sealer in either MRENCLAVE or MRSIGNER
@@ -139,13 +165,88 @@ class SgxLocalSecretSealer : public SecretSealer {
   Status Unseal(const SealedSecret &sealed_secret,
                 CleansingVector<uint8_t> *secret) override;
 
+  /// Seals the contents of `input` into `output` as a sealed stream.
+  ///
+  /// The stream starts with a SealedSecret holding `header` and
+  /// `additional_authenticated_data`, followed by the secret in fixed-size
+  /// chunks. Each chunk is sealed with its own nonce and is bound to the
+  /// header, the additional authenticated data, its position in the stream,
+  /// and whether it is the last chunk, so chunks cannot be reordered, dropped,
+  /// or moved between streams.
+  ///
+  /// \param header The header for the sealed stream.
+  /// \param additional_authenticated_data Additional data that is
+  ///        authenticated but not encrypted.
+  /// \param input The secret to seal. It is read from offset zero to its end.
+  /// \param[out] output The destination for the sealed stream, which is
+  ///        written from offset zero and truncated to the end of the stream.
+  /// \return A non-OK Status if sealing fails.
+  Status SealStream(const SealedSecretHeader &header,
+                    ByteContainerView additional_authenticated_data,
+                    RandomAccessStorage *input, RandomAccessStorage *output);
+
+  /// Like SealStream() above, but reads the secret from `input_fd` until
+  /// end-of-file and writes the sealed stream to `output_fd`. Neither file
+  /// descriptor needs to be seekable.
+  Status SealStream(const SealedSecretHeader &header,
+                    ByteContainerView additional_authenticated_data,
+                    int input_fd, int output_fd);
+
+  /// Unseals a sealed stream produced by SealStream().
+  ///
+  /// Chunks are written to `output` as soon as they are authenticated. If this
+  /// method returns a non-OK Status, the contents of `output` must be
+  /// discarded.
+  ///
+  /// \param input The sealed stream. It is read from offset zero to its end.
+  /// \param[out] output The destination for the secret, which is written from
+  ///        offset zero and truncated to the size of the secret.
+  /// \param[out] additional_authenticated_data The authenticated additional
+  ///        data of the stream. May be nullptr.
+  /// \return A non-OK Status if the stream could not be unsealed.
+  Status UnsealStream(RandomAccessStorage *input, RandomAccessStorage *output,
+                      std::string *additional_authenticated_data);
+
+  /// Like UnsealStream() above, but reads the sealed stream from `input_fd`
+  /// until end-of-file and writes the secret to `output_fd`. Neither file
+  /// descriptor needs to be seekable.
+  Status UnsealStream(int input_fd, int output_fd,
+                      std::string *additional_authenticated_data);
+
  private:
+  // The maximum number of derived sealing keys held by each sealer.
+  static constexpr size_t kMaxCachedKeys = 16;
+
   // Instantiates LocalSecretSealer that sets client_acl in the default sealed
   // secret header per |default_client_acl|.
   SgxLocalSecretSealer(const SgxIdentityExpectation &default_client_acl);
 
+  // Validates |header| against the identity of the current enclave, and
+  // returns a cryptor for the sealing key it selects.
+  StatusOr<std::unique_ptr<experimental::AeadCryptor>> MakeCryptorForHeader(
+      const SealedSecretHeader &header);
+
+  // Writes the sealing key for |aead_scheme| and |sgx_expectation| to |key|.
+  // The key is derived through EGETKEY only if it is not already cached.
+  Status GetSealingKey(AeadScheme aead_scheme,
+                       const SgxIdentityExpectation &sgx_expectation,
+                       CleansingVector<uint8_t> *key);
+
+  Status SealStream(const SealedSecretHeader &header,
+                    ByteContainerView additional_authenticated_data,
+                    sgx::internal::StreamReader *input,
+                    sgx::internal::StreamWriter *output);
+  Status UnsealStream(sgx::internal::StreamReader *input,
+                      sgx::internal::StreamWriter *output,
+                      std::string *additional_authenticated_data);
+
   // The default client ACL for this SecretSealer.
   SgxIdentityExpectation default_client_acl_;
+
+  // Derived sealing keys, keyed by their AEAD scheme and KEYREQUEST.
+  absl::Mutex key_cache_mu_;
+  absl::flat_hash_map<std::string, CleansingVector<uint8_t>> key_cache_
+      ABSL_GUARDED_BY(key_cache_mu_);
 };
 
 }  // namespace asylo
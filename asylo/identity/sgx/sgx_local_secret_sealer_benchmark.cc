@@ -0,0 +1,111 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/identity/sealed_secret.pb.h"
+#include "asylo/identity/sgx/fake_enclave.h"
+#include "asylo/identity/sgx/sgx_local_secret_sealer.h"
+#include "asylo/platform/storage/utils/fd_closer.h"
+#include "asylo/platform/storage/utils/test_utils.h"
+#include "asylo/platform/storage/utils/untrusted_file.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/cleansing_types.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace {
+
+using ::asylo::platform::storage::FdCloser;
+
+constexpr char kTestAad[] = "Mary had a little lamb";
+
+// Duration of each timed loop.
+constexpr absl::Duration kBenchmarkDuration = absl::Seconds(1);
+
+// Runs each benchmark inside a randomly-initialized fake enclave.
+class SgxLocalSecretSealerBenchmark : public ::testing::Test {
+ protected:
+  SgxLocalSecretSealerBenchmark()
+      : enclave_(sgx::RandomFakeEnclaveFactory::Construct()) {
+    sgx::FakeEnclave::EnterEnclave(*enclave_);
+  }
+
+  ~SgxLocalSecretSealerBenchmark() override {
+    sgx::FakeEnclave::ExitEnclave();
+  }
+
+  std::unique_ptr<sgx::FakeEnclave> enclave_;
+};
+
+// Measures the rate at which small secrets are sealed and unsealed, and the
+// throughput of sealing a large secret both in memory and as a stream, and
+// logs the results.
+TEST_F(SgxLocalSecretSealerBenchmark, SealingThroughput) {
+  std::unique_ptr<SgxLocalSecretSealer> sealer =
+      SgxLocalSecretSealer::CreateMrsignerSecretSealer();
+  SealedSecretHeader header;
+  ASSERT_THAT(sealer->SetDefaultHeader(&header), IsOk());
+
+  CleansingVector<uint8_t> small_secret(1024, 0x5a);
+  uint64_t operations = 0;
+  absl::Time start = absl::Now();
+  while (absl::Now() - start < kBenchmarkDuration) {
+    SealedSecret sealed_secret;
+    ASSERT_THAT(sealer->Seal(header, kTestAad, small_secret, &sealed_secret),
+                IsOk());
+    CleansingVector<uint8_t> output_secret;
+    ASSERT_THAT(sealer->Unseal(sealed_secret, &output_secret), IsOk());
+    ++operations;
+  }
+  absl::Duration elapsed = absl::Now() - start;
+  LOG(INFO) << "1 KiB secrets: "
+            << operations / absl::ToDoubleSeconds(elapsed)
+            << " seal/unseal pairs/s";
+
+  constexpr size_t kLargeSecretSize = 16 * 1024 * 1024;
+  std::string large_secret(kLargeSecretSize, 0x5a);
+  start = absl::Now();
+  SealedSecret sealed_secret;
+  ASSERT_THAT(sealer->Seal(header, kTestAad, large_secret, &sealed_secret),
+              IsOk());
+  elapsed = absl::Now() - start;
+  LOG(INFO) << "16 MiB secret, in memory: "
+            << 16 / absl::ToDoubleSeconds(elapsed) << " MiB/s";
+
+  FdCloser input_fd(CreateEmptyTempFileOrDie("throughput_input"));
+  FdCloser sealed_fd(CreateEmptyTempFileOrDie("throughput_sealed"));
+  UntrustedFile input(input_fd.get());
+  UntrustedFile sealed(sealed_fd.get());
+  ASSERT_THAT(input.Write(large_secret.data(), 0, large_secret.size()),
+              IsOk());
+  start = absl::Now();
+  ASSERT_THAT(sealer->SealStream(header, kTestAad, &input, &sealed), IsOk());
+  elapsed = absl::Now() - start;
+  LOG(INFO) << "16 MiB secret, streamed: "
+            << 16 / absl::ToDoubleSeconds(elapsed) << " MiB/s";
+}
+
+}  // namespace
+}  // namespace asylo
@@ -21,14 +21,19 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <thread>
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "asylo/crypto/algorithms.pb.h"
 #include "asylo/crypto/util/byte_container_view.h"
 #include "asylo/crypto/util/bytes.h"
@@ -49,8 +54,12 @@
 #include "asylo/identity/sgx/self_identity.h"
 #include "asylo/identity/sgx/sgx_identity_util_internal.h"
 #include "asylo/platform/common/singleton.h"
+#include "asylo/platform/storage/utils/fd_closer.h"
+#include "asylo/platform/storage/utils/test_utils.h"
+#include "asylo/platform/storage/utils/untrusted_file.h"
 #include "asylo/test/util/proto_matchers.h"
 #include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
 #include "asylo/util/path.h"
 #include "asylo/util/status.h"
 #include "asylo/util/statusor.h"
@@ -58,6 +67,7 @@
 namespace asylo {
 namespace {
 
+using ::asylo::platform::storage::FdCloser;
 using ::testing::Not;
 
 constexpr char kBadRootName[] = "BAD";
@@ -70,6 +80,23 @@ constexpr char kTestAad[] = "Mary had a little lamb";
 constexpr char kTestSecret[] = "Its fleece was white as snow";
 constexpr size_t kTestSecretSize = sizeof(kTestSecret) - 1;
 
+// Returns |size| bytes of deterministic test data.
+std::string MakeStreamSecret(size_t size) {
+  std::string secret(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    secret[i] = static_cast<char>(i * 31 + i / 251);
+  }
+  return secret;
+}
+
+// Returns the contents of |storage|.
+std::string ReadStorage(RandomAccessStorage *storage) {
+  size_t size = storage->Size().ValueOrDie();
+  std::string contents(size, '\0');
+  CHECK(storage->Read(&contents[0], 0, size).ok());
+  return contents;
+}
+
 // A test fixture is used for initializing state that is commonly used across
 // different tests.
 class SgxLocalSecretSealerTest : public ::testing::Test {
@@ -823,5 +850,167 @@ TEST_F(SgxLocalSecretSealerTest, BackwardCompatibility) {
   }
 }
 
+// Verify that repeated seals with different key policies from one sealer use
+// the correct key for each policy.
+TEST_F(SgxLocalSecretSealerTest, SealUnsealWithCachedKeys) {
+  CleansingVector<uint8_t> input_secret(kTestSecret,
+                                        kTestSecret + kTestSecretSize);
+  std::unique_ptr<SgxLocalSecretSealer> mrenclave_sealer =
+      SgxLocalSecretSealer::CreateMrenclaveSecretSealer();
+  std::unique_ptr<SgxLocalSecretSealer> mrsigner_sealer =
+      SgxLocalSecretSealer::CreateMrsignerSecretSealer();
+  SealedSecretHeader mrenclave_header;
+  PrepareSealedSecretHeader(*mrenclave_sealer, &mrenclave_header);
+  SealedSecretHeader mrsigner_header;
+  PrepareSealedSecretHeader(*mrsigner_sealer, &mrsigner_header);
+
+  for (int i = 0; i < 3; ++i) {
+    SealedSecret mrenclave_secret;
+    ASSERT_THAT(mrenclave_sealer->Seal(mrenclave_header, kTestAad,
+                                       input_secret, &mrenclave_secret),
+                IsOk());
+    SealedSecret mrsigner_secret;
+    ASSERT_THAT(mrenclave_sealer->Seal(mrsigner_header, kTestAad, input_secret,
+                                       &mrsigner_secret),
+                IsOk());
+
+    // The keys cached by |mrenclave_sealer| must match those derived by a
+    // fresh sealer.
+    std::unique_ptr<SgxLocalSecretSealer> sealer =
+        SgxLocalSecretSealer::CreateMrsignerSecretSealer();
+    CleansingVector<uint8_t> output_secret;
+    ASSERT_THAT(sealer->Unseal(mrenclave_secret, &output_secret), IsOk());
+    EXPECT_EQ(input_secret, output_secret);
+    ASSERT_THAT(sealer->Unseal(mrsigner_secret, &output_secret), IsOk());
+    EXPECT_EQ(input_secret, output_secret);
+
+    // Unsealing with a cached key still authenticates the header.
+    SealedSecretHeader other_header = mrenclave_header;
+    other_header.set_secret_name("other name");
+    ASSERT_TRUE(other_header.SerializeToString(
+        mrenclave_secret.mutable_sealed_secret_header()));
+    EXPECT_THAT(mrenclave_sealer->Unseal(mrenclave_secret, &output_secret),
+                Not(IsOk()));
+  }
+}
+
+// Verify that sealed streams of various sizes round-trip through
+// RandomAccessStorage.
+TEST_F(SgxLocalSecretSealerTest, SealUnsealStreamStorage) {
+  std::unique_ptr<SgxLocalSecretSealer> sealer =
+      SgxLocalSecretSealer::CreateMrsignerSecretSealer();
+  SealedSecretHeader header;
+  PrepareSealedSecretHeader(*sealer, &header);
+
+  const size_t chunk_size = sgx::internal::kSealedStreamChunkSize;
+  for (size_t size : {size_t{0}, kTestSecretSize, chunk_size - 1, chunk_size,
+                      3 * chunk_size + 5}) {
+    SCOPED_TRACE(absl::StrCat("size: ", size));
+    std::string secret = MakeStreamSecret(size);
+
+    FdCloser input_fd(CreateEmptyTempFileOrDie("stream_input"));
+    FdCloser sealed_fd(CreateEmptyTempFileOrDie("stream_sealed"));
+    FdCloser output_fd(CreateEmptyTempFileOrDie("stream_output"));
+    UntrustedFile input(input_fd.get());
+    UntrustedFile sealed(sealed_fd.get());
+    UntrustedFile output(output_fd.get());
+    ASSERT_THAT(input.Write(secret.data(), 0, secret.size()), IsOk());
+
+    ASSERT_THAT(sealer->SealStream(header, kTestAad, &input, &sealed), IsOk());
+    EXPECT_GT(sealed.Size().ValueOrDie(), size);
+
+    // Leave stale data in the output to check that it is truncated.
+    ASSERT_THAT(output.Write(kBadExpectation, size, sizeof(kBadExpectation)),
+                IsOk());
+    std::unique_ptr<SgxLocalSecretSealer> sealer2 =
+        SgxLocalSecretSealer::CreateMrsignerSecretSealer();
+    std::string aad;
+    ASSERT_THAT(sealer2->UnsealStream(&sealed, &output, &aad), IsOk());
+    EXPECT_EQ(aad, kTestAad);
+    EXPECT_EQ(ReadStorage(&output), secret);
+  }
+}
+
+// Verify that sealed streams can be produced and consumed through
+// non-seekable file descriptors.
+TEST_F(SgxLocalSecretSealerTest, SealUnsealStreamPipe) {
+  std::unique_ptr<SgxLocalSecretSealer> sealer =
+      SgxLocalSecretSealer::CreateMrenclaveSecretSealer();
+  SealedSecretHeader header;
+  PrepareSealedSecretHeader(*sealer, &header);
+
+  std::string secret =
+      MakeStreamSecret(2 * sgx::internal::kSealedStreamChunkSize + 17);
+  FdCloser input_fd(CreateEmptyTempFileOrDie("pipe_input"));
+  FdCloser output_fd(CreateEmptyTempFileOrDie("pipe_output"));
+  UntrustedFile input(input_fd.get());
+  ASSERT_THAT(input.Write(secret.data(), 0, secret.size()), IsOk());
+  ASSERT_EQ(lseek(input_fd.get(), 0, SEEK_SET), 0);
+
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+  FdCloser read_end(pipe_fds[0]);
+  FdCloser write_end(pipe_fds[1]);
+
+  Status seal_status;
+  std::thread sealing_thread([&] {
+    seal_status = sealer->SealStream(header, kTestAad, input_fd.get(),
+                                     write_end.get());
+    write_end.reset(-1);
+  });
+  std::string aad;
+  Status unseal_status =
+      sealer->UnsealStream(read_end.get(), output_fd.get(), &aad);
+  sealing_thread.join();
+
+  ASSERT_THAT(seal_status, IsOk());
+  ASSERT_THAT(unseal_status, IsOk());
+  EXPECT_EQ(aad, kTestAad);
+  UntrustedFile output(output_fd.get());
+  EXPECT_EQ(ReadStorage(&output), secret);
+}
+
+// Verify that modified, truncated, and extended sealed streams are rejected.
+TEST_F(SgxLocalSecretSealerTest, UnsealStreamFailureModifiedStream) {
+  std::unique_ptr<SgxLocalSecretSealer> sealer =
+      SgxLocalSecretSealer::CreateMrsignerSecretSealer();
+  SealedSecretHeader header;
+  PrepareSealedSecretHeader(*sealer, &header);
+
+  const size_t chunk_size = sgx::internal::kSealedStreamChunkSize;
+  std::string secret = MakeStreamSecret(2 * chunk_size);
+  FdCloser input_fd(CreateEmptyTempFileOrDie("modified_input"));
+  FdCloser sealed_fd(CreateEmptyTempFileOrDie("modified_sealed"));
+  UntrustedFile input(input_fd.get());
+  UntrustedFile sealed(sealed_fd.get());
+  ASSERT_THAT(input.Write(secret.data(), 0, secret.size()), IsOk());
+  ASSERT_THAT(sealer->SealStream(header, kTestAad, &input, &sealed), IsOk());
+  std::string sealed_stream = ReadStorage(&sealed);
+
+  // The secret fills two chunks exactly, so the stream ends with a last chunk
+  // that holds only a nonce and an authentication tag.
+  constexpr size_t kEmptyChunkSize = 12 + 16;
+  std::string flipped = sealed_stream;
+  flipped[flipped.size() / 2] ^= 1;
+  std::string modified_streams[] = {
+      flipped,
+      sealed_stream.substr(0, sealed_stream.size() - 1),
+      sealed_stream.substr(0, sealed_stream.size() - kEmptyChunkSize),
+      sealed_stream +
+          sealed_stream.substr(sealed_stream.size() - kEmptyChunkSize),
+      sealed_stream.substr(0, 2),
+  };
+  for (const std::string &modified : modified_streams) {
+    FdCloser modified_fd(CreateEmptyTempFileOrDie("modified_stream"));
+    FdCloser output_fd(CreateEmptyTempFileOrDie("modified_output"));
+    UntrustedFile modified_file(modified_fd.get());
+    UntrustedFile output(output_fd.get());
+    ASSERT_THAT(modified_file.Write(modified.data(), 0, modified.size()),
+                IsOk());
+    EXPECT_THAT(sealer->UnsealStream(&modified_file, &output, nullptr),
+                Not(IsOk()));
+  }
+}
+
 }  // namespace
 }  // namespace asylo
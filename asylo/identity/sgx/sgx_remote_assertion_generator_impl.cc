@@ -19,8 +19,11 @@
 #include "asylo/identity/sgx/sgx_remote_assertion_generator_impl.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "asylo/crypto/keys.pb.h"
 #include "asylo/grpc/auth/enclave_auth_context.h"
 #include "asylo/identity/descriptions.h"
 #include "asylo/identity/sgx/remote_assertion_util.h"
@@ -50,51 +53,64 @@ Status ExtractSgxIdentity(const EnclaveAuthContext &auth_context,
   return Status::OkStatus();
 }
 
+// Returns a string encoding every authentication property in |auth_context|.
+// Two authentication contexts with the same key describe the same peer.
+std::string AuthContextKey(const ::grpc::AuthContext &auth_context) {
+  std::string key;
+  for (auto it = auth_context.begin(); it != auth_context.end(); ++it) {
+    ::grpc::AuthProperty auth_property = *it;
+    absl::StrAppend(
+        &key, auth_property.first.size(), ":",
+        absl::string_view(auth_property.first.data(),
+                          auth_property.first.size()),
+        auth_property.second.size(), ":",
+        absl::string_view(auth_property.second.data(),
+                          auth_property.second.size()));
+  }
+  return key;
+}
+
 }  // namespace
 
+constexpr size_t SgxRemoteAssertionGeneratorImpl::kMaxCachedPeerIdentities;
+
 SgxRemoteAssertionGeneratorImpl::SgxRemoteAssertionGeneratorImpl()
-    : signing_key_(nullptr),
-      certificate_chains_(std::vector<CertificateChain>()) {}
+    : signing_state_(CreateSigningState(nullptr, {})),
+      peer_identities_(absl::flat_hash_map<std::string, SgxIdentity>()) {}
 
 SgxRemoteAssertionGeneratorImpl::SgxRemoteAssertionGeneratorImpl(
     std::unique_ptr<SigningKey> signing_key,
     const std::vector<CertificateChain> &certificate_chains)
-    : signing_key_(std::move(signing_key)),
-      certificate_chains_(certificate_chains) {}
+    : signing_state_(
+          CreateSigningState(std::move(signing_key), certificate_chains)),
+      peer_identities_(absl::flat_hash_map<std::string, SgxIdentity>()) {}
 
 ::grpc::Status SgxRemoteAssertionGeneratorImpl::GenerateSgxRemoteAssertion(
     ::grpc::ServerContext *context,
     const GenerateSgxRemoteAssertionRequest *request,
     GenerateSgxRemoteAssertionResponse *response) {
-  StatusOr<EnclaveAuthContext> auth_context_result =
-      EnclaveAuthContext::CreateFromAuthContext(*context->auth_context());
-  if (!auth_context_result.ok()) {
-    LOG(ERROR) << "CreateFromServerContext failed: "
-               << auth_context_result.status();
-    return ::grpc::Status(
-        ::grpc::StatusCode::INTERNAL,
-        "Failed to retrieve enclave authentication information");
-  }
-  EnclaveAuthContext auth_context = auth_context_result.ValueOrDie();
-
-  SgxIdentity sgx_identity;
-  Status status = ExtractSgxIdentity(auth_context, &sgx_identity);
-  if (!status.ok()) {
-    return status.ToOtherStatus<::grpc::Status>();
+  StatusOr<SgxIdentity> sgx_identity_result = GetPeerSgxIdentity(*context);
+  if (!sgx_identity_result.ok()) {
+    return sgx_identity_result.status().ToOtherStatus<::grpc::Status>();
   }
-  auto signing_key_locked = signing_key_.ReaderLock();
 
-  if (*signing_key_locked == nullptr) {
+  std::shared_ptr<const SigningState> signing_state =
+      *signing_state_.ReaderLock();
+  if (signing_state->signing_key == nullptr) {
     return ::grpc::Status(::grpc::StatusCode::FAILED_PRECONDITION,
                           "No attestation key available");
   }
 
-  auto certificate_chains_locked = certificate_chains_.ReaderLock();
-  status = MakeRemoteAssertion(request->user_data(), sgx_identity,
-                               **signing_key_locked, *certificate_chains_locked,
-                               response->mutable_assertion());
+  Status status = signing_state->assertion_template.status();
+  if (status.ok()) {
+    sgx::RemoteAssertion *assertion = response->mutable_assertion();
+    *assertion = signing_state->assertion_template.ValueOrDie();
+    status = sgx::SignRemoteAssertion(
+        request->user_data(), sgx_identity_result.ValueOrDie(),
+        *signing_state->signing_key, assertion);
+  }
   if (!status.ok()) {
-    LOG(ERROR) << "MakeRemoteAssertion failed: " << status;
+    LOG(ERROR) << "SignRemoteAssertion failed: " << status;
     return ::grpc::Status(::grpc::StatusCode::INTERNAL,
                           "Failed to generate SGX remote assertion");
   }
@@ -104,10 +120,76 @@ SgxRemoteAssertionGeneratorImpl::SgxRemoteAssertionGeneratorImpl(
 void SgxRemoteAssertionGeneratorImpl::UpdateSigningKeyAndCertificateChains(
     std::unique_ptr<SigningKey> signing_key,
     const std::vector<CertificateChain> &certificate_chains) {
-  auto signing_key_locked = signing_key_.Lock();
-  auto certificate_chains_locked = certificate_chains_.Lock();
-  *signing_key_locked = std::move(signing_key);
-  *certificate_chains_locked = certificate_chains;
+  std::shared_ptr<const SigningState> signing_state =
+      CreateSigningState(std::move(signing_key), certificate_chains);
+  *signing_state_.Lock() = std::move(signing_state);
+}
+
+std::shared_ptr<const SgxRemoteAssertionGeneratorImpl::SigningState>
+SgxRemoteAssertionGeneratorImpl::CreateSigningState(
+    std::unique_ptr<SigningKey> signing_key,
+    const std::vector<CertificateChain> &certificate_chains) {
+  auto signing_state = std::make_shared<SigningState>();
+  signing_state->signing_key = std::move(signing_key);
+  if (signing_state->signing_key == nullptr) {
+    return signing_state;
+  }
+
+  sgx::RemoteAssertion assertion_template;
+  StatusOr<std::unique_ptr<VerifyingKey>> verifying_key_result =
+      signing_state->signing_key->GetVerifyingKey();
+  if (!verifying_key_result.ok()) {
+    signing_state->assertion_template = verifying_key_result.status();
+    return signing_state;
+  }
+  StatusOr<AsymmetricSigningKeyProto> key_proto_result =
+      verifying_key_result.ValueOrDie()->SerializeToKeyProto(
+          ASYMMETRIC_KEY_DER);
+  if (!key_proto_result.ok()) {
+    signing_state->assertion_template = key_proto_result.status();
+    return signing_state;
+  }
+  *assertion_template.mutable_verifying_key() = key_proto_result.ValueOrDie();
+  for (const CertificateChain &chain : certificate_chains) {
+    *assertion_template.add_certificate_chains() = chain;
+  }
+  signing_state->assertion_template = std::move(assertion_template);
+  return signing_state;
+}
+
+StatusOr<SgxIdentity> SgxRemoteAssertionGeneratorImpl::GetPeerSgxIdentity(
+    const ::grpc::ServerContext &context) {
+  std::shared_ptr<const ::grpc::AuthContext> grpc_auth_context =
+      context.auth_context();
+  std::string key;
+  if (grpc_auth_context->IsPeerAuthenticated()) {
+    key = AuthContextKey(*grpc_auth_context);
+    auto peer_identities = peer_identities_.ReaderLock();
+    auto it = peer_identities->find(key);
+    if (it != peer_identities->end()) {
+      return it->second;
+    }
+  }
+
+  StatusOr<EnclaveAuthContext> auth_context_result =
+      EnclaveAuthContext::CreateFromAuthContext(*grpc_auth_context);
+  if (!auth_context_result.ok()) {
+    LOG(ERROR) << "CreateFromServerContext failed: "
+               << auth_context_result.status();
+    return Status(error::GoogleError::INTERNAL,
+                  "Failed to retrieve enclave authentication information");
+  }
+
+  SgxIdentity sgx_identity;
+  ASYLO_RETURN_IF_ERROR(
+      ExtractSgxIdentity(auth_context_result.ValueOrDie(), &sgx_identity));
+
+  auto peer_identities = peer_identities_.Lock();
+  if (peer_identities->size() >= kMaxCachedPeerIdentities) {
+    peer_identities->clear();
+  }
+  peer_identities->emplace(std::move(key), sgx_identity);
+  return sgx_identity;
 }
 
 }  // namespace asylo
@@ -20,13 +20,18 @@
 #define ASYLO_IDENTITY_SGX_SGX_REMOTE_ASSERTION_GENERATOR_IMPL_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "asylo/crypto/certificate.pb.h"
 #include "asylo/crypto/signing_key.h"
+#include "asylo/identity/sgx/remote_assertion.pb.h"
+#include "asylo/identity/sgx/sgx_identity.pb.h"
 #include "asylo/identity/sgx/sgx_remote_assertion_generator.grpc.pb.h"
 #include "asylo/util/mutex_guarded.h"
 #include "asylo/util/status.h"
+#include "asylo/util/statusor.h"
 #include "include/grpcpp/server_context.h"
 
 namespace asylo {
@@ -37,6 +42,13 @@ namespace asylo {
 // This service requires that the peer authenticates with their SGX code
 // identity. The gRPC server's credentials configuration should enforce this
 // authentication policy.
+//
+// Requests are served concurrently. Each request signs with a snapshot of the
+// current signing key, so signing is not serialized with other requests or
+// with key updates. The verifying key and certificate chains are serialized
+// once per key update rather than once per request, and the SGX identities of
+// recent peers are remembered so that repeated requests on a connection do not
+// parse the peer's identity again.
 class SgxRemoteAssertionGeneratorImpl
     : public SgxRemoteAssertionGenerator::Service {
  public:
@@ -65,12 +77,36 @@ class SgxRemoteAssertionGeneratorImpl
       const std::vector<CertificateChain> &certificate_chains);
 
  private:
-  // The key used to sign attestations.
-  MutexGuarded<std::unique_ptr<SigningKey>> signing_key_;
+  // Maximum number of peer identities remembered by the service.
+  static constexpr size_t kMaxCachedPeerIdentities = 1024;
+
+  // A signing key and the parts of an assertion which depend only on it.
+  struct SigningState {
+    // The key used to sign attestations.
+    std::unique_ptr<SigningKey> signing_key;
+
+    // An assertion holding the verifying key for |signing_key| and the
+    // certificate chains that serve to prove the authenticity of signatures it
+    // produces, or an error if the verifying key could not be serialized.
+    StatusOr<sgx::RemoteAssertion> assertion_template;
+  };
+
+  // Creates the signing state for |signing_key| and |certificate_chains|.
+  static std::shared_ptr<const SigningState> CreateSigningState(
+      std::unique_ptr<SigningKey> signing_key,
+      const std::vector<CertificateChain> &certificate_chains);
+
+  // Returns the SGX identity of the peer authenticated in |context|.
+  StatusOr<SgxIdentity> GetPeerSgxIdentity(
+      const ::grpc::ServerContext &context);
+
+  // The current signing state. Requests hold a reference to the state while
+  // signing, so that updates do not wait for in-flight requests.
+  MutexGuarded<std::shared_ptr<const SigningState>> signing_state_;
 
-  // Certificate chains that serve to prove the authenticity of signatures
-  // produced by |signing_key_|.
-  MutexGuarded<std::vector<CertificateChain>> certificate_chains_;
+  // SGX identities of recent peers, keyed by the authentication properties of
+  // their connection.
+  MutexGuarded<absl::flat_hash_map<std::string, SgxIdentity>> peer_identities_;
 };
 
 }  // namespace asylo
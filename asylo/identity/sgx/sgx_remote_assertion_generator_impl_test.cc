@@ -402,6 +402,44 @@ TEST_F(SgxRemoteAssertionGeneratorImplTest,
   }
 }
 
+// Issues requests from many concurrent clients, each on its own connection, and
+// verifies every assertion.
+TEST_F(SgxRemoteAssertionGeneratorImplTest, ConcurrentClients) {
+  std::shared_ptr<::grpc::ServerCredentials> server_credentials =
+      EnclaveServerCredentials(BidirectionalSgxLocalCredentialsOptions());
+  std::unique_ptr<SgxRemoteAssertionGeneratorImpl> service;
+  ASYLO_ASSERT_OK_AND_ASSIGN(service, CreateServiceWithKeyAndCertificate());
+  SetUpServer(service.get(), server_credentials);
+
+  std::shared_ptr<::grpc::ChannelCredentials> channel_credentials =
+      EnclaveChannelCredentials(BidirectionalSgxLocalCredentialsOptions());
+
+  constexpr int kNumClients = 16;
+  constexpr int kRequestsPerClient = 4;
+  std::vector<Thread> threads;
+  threads.reserve(kNumClients);
+  for (int i = 0; i < kNumClients; ++i) {
+    threads.emplace_back([&channel_credentials, this, i] {
+      // A distinct channel argument keeps each client on its own connection.
+      ::grpc::ChannelArguments channel_arguments;
+      channel_arguments.SetInt("asylo.test.client_id", i);
+      std::shared_ptr<::grpc::Channel> channel = ::grpc::CreateCustomChannel(
+          server_address_, channel_credentials, channel_arguments);
+      SgxRemoteAssertionGeneratorClient client(channel);
+
+      for (int j = 0; j < kRequestsPerClient; ++j) {
+        RemoteAssertion assertion;
+        ASYLO_ASSERT_OK_AND_ASSIGN(
+            assertion, client.GenerateSgxRemoteAssertion(kUserData));
+        VerifyRemoteAssertion(assertion, certificate_chains_, *verifying_key_);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.Join();
+  }
+}
+
 // The following tests verify that other configurations of the server and peer
 // credentials result in the expected RPC errors. Note that these credentials
 // configurations are not expected to be used with the
@@ -0,0 +1,36 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/common/fork_generation.h"
+
+#include <atomic>
+
+namespace asylo {
+namespace {
+
+// Restored along with the rest of the enclave data in a forked child, which
+// then advances it past the parent's value.
+std::atomic<uint64_t> fork_generation{0};
+
+}  // namespace
+
+uint64_t GetForkGeneration() { return fork_generation.load(); }
+
+void AdvanceForkGeneration() { fork_generation.fetch_add(1); }
+
+}  // namespace asylo
@@ -0,0 +1,39 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_COMMON_FORK_GENERATION_H_
+#define ASYLO_PLATFORM_COMMON_FORK_GENERATION_H_
+
+#include <cstdint>
+
+namespace asylo {
+
+// Returns a value that changes each time this enclave is restored as the child
+// of a fork(). The child starts from a copy of its parent's memory, so secrets
+// that must only ever be used once, such as precomputed signature nonces,
+// record this value when they are generated and are discarded once it changes.
+uint64_t GetForkGeneration();
+
+// Advances the fork generation. Called by the trusted runtime after the child
+// enclave has been restored from its parent's snapshot, before any other entry
+// into the child is allowed.
+void AdvanceForkGeneration();
+
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_COMMON_FORK_GENERATION_H_
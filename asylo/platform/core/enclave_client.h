@@ -62,6 +62,7 @@ class EnclaveClient {
 
  private:
   friend class EnclaveManager;
+  friend class EnclavePool;
   friend class EnclaveSignalDispatcher;
 
   // Enters the enclave and invokes its initialization entry point.
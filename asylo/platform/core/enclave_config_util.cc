@@ -21,7 +21,13 @@
 #include <errno.h>
 #include <unistd.h>
 
+#include <utility>
+
+#include "asylo/identity/descriptions.h"
+#include "asylo/identity/enclave_assertion_authority_config.pb.h"
+#include "asylo/identity/enclave_assertion_authority_configs.h"
 #include "asylo/util/logging.h"
+#include "asylo/util/statusor.h"
 
 namespace asylo {
 namespace {
@@ -69,6 +75,37 @@ void SetHostConfig(const HostConfig &host_config, EnclaveConfig *config) {
   }
 }
 
+// Fills in the attestation domain of each SGX local assertion authority config
+// in |config| that was left empty, using the local attestation domain from the
+// HostConfig of |config|. This lets enclaves use the domain cached by the
+// EnclaveManager rather than each fetching it separately.
+void SetSgxLocalAssertionAuthorityConfigs(EnclaveConfig *config) {
+  if (!config->host_config().has_local_attestation_domain()) return;
+
+  AssertionDescription sgx_local_description;
+  SetSgxLocalAssertionDescription(&sgx_local_description);
+  for (EnclaveAssertionAuthorityConfig &authority_config :
+       *config->mutable_enclave_assertion_authority_configs()) {
+    const AssertionDescription &description = authority_config.description();
+    if (description.identity_type() != sgx_local_description.identity_type() ||
+        description.authority_type() !=
+            sgx_local_description.authority_type() ||
+        !authority_config.config().empty()) {
+      continue;
+    }
+
+    StatusOr<EnclaveAssertionAuthorityConfig> config_result =
+        CreateSgxLocalAssertionAuthorityConfig(
+            config->host_config().local_attestation_domain());
+    if (!config_result.ok()) {
+      LOG(ERROR) << "Could not create SGX local assertion authority config: "
+                 << config_result.status();
+      return;
+    }
+    authority_config = std::move(config_result).ValueOrDie();
+  }
+}
+
 }  // namespace
 
 void SetEnclaveConfigDefaults(const HostConfig &host_config,
@@ -76,6 +113,7 @@ void SetEnclaveConfigDefaults(const HostConfig &host_config,
   SetDefaultHostName(config);
   SetDefaultCurrentWorkingDirectory(config);
   SetHostConfig(host_config, config);
+  SetSgxLocalAssertionAuthorityConfigs(config);
 }
 
 EnclaveConfig CreateDefaultEnclaveConfig(const HostConfig &host_config) {
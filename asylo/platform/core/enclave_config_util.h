@@ -25,6 +25,9 @@ namespace asylo {
 
 /// Sets uninitialized fields in #config to default values.
 ///
+/// Any SGX local assertion authority config in #config with an empty config
+/// string is given the local attestation domain from #config's HostConfig.
+///
 /// \param host_config Values to set in the host_config field of #config.
 /// \param config[out] EnclaveConfig object to populate.
 void SetEnclaveConfigDefaults(const HostConfig &host_config,
@@ -22,10 +22,18 @@
 #include <sys/ucontext.h>
 #include <time.h>
 
+#include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 
+#include "asylo/daemon/identity/attestation_domain_client.h"
 #include "asylo/enclave.pb.h"
 #include "asylo/util/logging.h"
 #include "asylo/platform/common/time_util.h"
@@ -34,9 +42,13 @@
 #include "asylo/platform/primitives/enclave_loader.h"
 #include "asylo/platform/primitives/sgx/loader.pb.h"
 #include "asylo/platform/primitives/sgx/untrusted_sgx.h"
+#include "asylo/platform/primitives/util/enclave_telemetry.h"
 #include "asylo/util/status.h"
 #include "asylo/util/statusor.h"
 #include "asylo/util/status_macros.h"
+#include "asylo/util/thread.h"
+#include "include/grpcpp/create_channel.h"
+#include "include/grpcpp/security/credentials.h"
 
 namespace asylo {
 namespace {
@@ -71,6 +83,33 @@ void WaitUntil(int64_t deadline) {
   }
 }
 
+// Returns the key identifying the enclave pool serving |load_config|. Load
+// configurations which differ only in their enclave name share a pool.
+std::string EnclavePoolKey(const EnclaveLoadConfig &load_config) {
+  EnclaveLoadConfig key_config = load_config;
+  key_config.clear_name();
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream output(&stream);
+    output.SetSerializationDeterministic(true);
+    key_config.SerializeToCodedStream(&output);
+  }
+  return key;
+}
+
+// Returns the telemetry collector of |client|, or nullptr if |client| does not
+// collect telemetry.
+const primitives::EnclaveTelemetry *GetTelemetryCollector(
+    const EnclaveClient *client) {
+  const auto *generic_client =
+      dynamic_cast<const GenericEnclaveClient *>(client);
+  if (!generic_client || !generic_client->GetPrimitiveClient()) {
+    return nullptr;
+  }
+  return generic_client->GetPrimitiveClient()->telemetry();
+}
+
 }  // namespace
 
 absl::Mutex EnclaveManager::mu_;
@@ -140,8 +179,27 @@ HostConfig EnclaveManager::GetHostConfig() {
     return config_result.ValueOrDie();
   }
 
+  // Fetch the host configuration from the Asylo daemon. This happens once per
+  // EnclaveManager, and the result is shared by every enclave it loads.
   HostConfig config;
-  LOG(ERROR) << "Not implemented";
+  std::string address(options_->get_config_server_address().ValueOrDie());
+  absl::Duration timeout =
+      options_->get_config_server_connection_timeout().ValueOrDie();
+  std::shared_ptr<::grpc::Channel> channel =
+      ::grpc::CreateChannel(address, ::grpc::InsecureChannelCredentials());
+  if (!channel->WaitForConnected(absl::ToChronoTime(absl::Now() + timeout))) {
+    LOG(ERROR) << "Could not connect to config server at " << address;
+    return config;
+  }
+
+  AttestationDomainClient client(channel);
+  StatusOr<std::string> domain_result = client.GetAttestationDomain();
+  if (!domain_result.ok()) {
+    LOG(ERROR) << "Could not retrieve attestation domain: "
+               << domain_result.status();
+    return config;
+  }
+  config.set_local_attestation_domain(domain_result.ValueOrDie());
   return config;
 }
 
@@ -185,6 +243,93 @@ Status EnclaveManager::DestroyEnclave(EnclaveClient *client,
   return finalize_status;
 }
 
+Status EnclaveManager::CreateEnclavePool(const EnclaveLoadConfig &load_config,
+                                         const EnclavePoolOptions &options) {
+  if (!load_config.HasExtension(sgx_load_config)) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Enclave pools are only supported for SGX enclaves");
+  }
+  if (load_config.GetExtension(sgx_load_config).has_fork_config()) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Enclave pools cannot be created for forked enclaves");
+  }
+  if (options.min_idle() == 0 || options.min_idle() > options.max_idle()) {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  absl::StrCat("Invalid enclave pool size limits: min_idle=",
+                               options.min_idle(),
+                               ", max_idle=", options.max_idle()));
+  }
+
+  EnclaveConfig config;
+  if (load_config.has_config()) {
+    config = load_config.config();
+    SetEnclaveConfigDefaults(host_config_, &config);
+  } else {
+    config = CreateDefaultEnclaveConfig(host_config_);
+  }
+
+  bool pre_initialize = options.pre_initialize();
+  auto load = [load_config, config,
+               pre_initialize]() -> StatusOr<std::unique_ptr<EnclaveClient>> {
+    std::shared_ptr<primitives::Client> primitive_client;
+    ASYLO_ASSIGN_OR_RETURN(primitive_client,
+                           asylo::primitives::LoadEnclave(load_config));
+    std::unique_ptr<EnclaveClient> client =
+        GenericEnclaveClient::Create(load_config.name(), primitive_client);
+    if (pre_initialize) {
+      Status status = client->EnterAndInitialize(config);
+      if (!status.ok()) {
+        Status destroy_status = client->DestroyEnclave();
+        LOG_IF(ERROR, !destroy_status.ok())
+            << "DestroyEnclave failed after EnterAndInitialize failure: "
+            << destroy_status;
+        return status;
+      }
+    }
+    return std::move(client);
+  };
+
+  std::string key = EnclavePoolKey(load_config);
+  absl::WriterMutexLock lock(&pool_table_lock_);
+  if (pool_by_key_.find(key) != pool_by_key_.end()) {
+    return Status(error::GoogleError::ALREADY_EXISTS,
+                  "An enclave pool already exists for this configuration");
+  }
+  pool_by_key_.emplace(std::move(key),
+                       absl::make_unique<EnclavePool>(std::move(load), options));
+  return Status::OkStatus();
+}
+
+Status EnclaveManager::DestroyEnclavePool(
+    const EnclaveLoadConfig &load_config) {
+  std::unique_ptr<EnclavePool> pool;
+  {
+    absl::WriterMutexLock lock(&pool_table_lock_);
+    auto it = pool_by_key_.find(EnclavePoolKey(load_config));
+    if (it == pool_by_key_.end()) {
+      return Status(error::GoogleError::NOT_FOUND,
+                    "No enclave pool exists for this configuration");
+    }
+    pool = std::move(it->second);
+    pool_by_key_.erase(it);
+  }
+  // Tear the pool down outside of |pool_table_lock_|, since doing so waits for
+  // any in-progress background load to complete.
+  pool.reset();
+  return Status::OkStatus();
+}
+
+StatusOr<size_t> EnclaveManager::GetEnclavePoolIdleCount(
+    const EnclaveLoadConfig &load_config) const {
+  absl::ReaderMutexLock lock(&pool_table_lock_);
+  auto it = pool_by_key_.find(EnclavePoolKey(load_config));
+  if (it == pool_by_key_.end()) {
+    return Status(error::GoogleError::NOT_FOUND,
+                  "No enclave pool exists for this configuration");
+  }
+  return it->second->idle_count();
+}
+
 EnclaveClient *EnclaveManager::GetClient(absl::string_view name) const {
   absl::ReaderMutexLock lock(&client_table_lock_);
   auto it = client_by_name_.find(name);
@@ -206,6 +351,37 @@ const absl::string_view EnclaveManager::GetName(
   }
 }
 
+StatusOr<primitives::EnclaveTelemetrySnapshot>
+EnclaveManager::GetEnclaveTelemetry(const EnclaveClient *client) const {
+  absl::ReaderMutexLock lock(&client_table_lock_);
+  auto it = name_by_client_.find(client);
+  if (it == name_by_client_.end()) {
+    return Status(error::GoogleError::NOT_FOUND,
+                  "Enclave client is not registered");
+  }
+  const primitives::EnclaveTelemetry *telemetry = GetTelemetryCollector(client);
+  if (!telemetry) {
+    return Status(
+        error::GoogleError::FAILED_PRECONDITION,
+        absl::StrCat("Telemetry is not collected for enclave ", it->second));
+  }
+  return telemetry->Snapshot(it->second);
+}
+
+std::vector<primitives::EnclaveTelemetrySnapshot>
+EnclaveManager::GetEnclaveTelemetry() const {
+  std::vector<primitives::EnclaveTelemetrySnapshot> snapshots;
+  absl::ReaderMutexLock lock(&client_table_lock_);
+  for (const auto &entry : client_by_name_) {
+    const primitives::EnclaveTelemetry *telemetry =
+        GetTelemetryCollector(entry.second.get());
+    if (telemetry) {
+      snapshots.push_back(telemetry->Snapshot(entry.first));
+    }
+  }
+  return snapshots;
+}
+
 EnclaveLoadConfig EnclaveManager::GetLoadConfigFromClient(
     EnclaveClient *client) {
   absl::ReaderMutexLock lock(&client_table_lock_);
@@ -393,28 +569,42 @@ Status EnclaveManager::LoadEnclave(const EnclaveLoadConfig &load_config) {
   }
 
   // Attempt to load the enclave.
-  auto primitive_client =
-      asylo::primitives::LoadEnclave(load_config).ValueOrDie();
+  bool initialized = false;
   StatusOr<std::unique_ptr<EnclaveClient>> result =
-      GenericEnclaveClient::Create(name, primitive_client);
+      CreateClient(load_config, &initialized);
   if (!result.ok()) {
     LOG(ERROR) << "LoadEnclave failed: " << result.status();
     return result.status();
   }
 
-  // Add the client to the lookup tables.
+  // Add the client to the lookup tables, unless another thread bound |name|
+  // while this enclave was being loaded.
   EnclaveClient *client = result.ValueOrDie().get();
+  bool name_taken;
   {
     absl::WriterMutexLock lock(&client_table_lock_);
-    client_by_name_.emplace(name, std::move(result).ValueOrDie());
-    name_by_client_.emplace(client, name);
+    name_taken = client_by_name_.contains(name);
+    if (!name_taken) {
+      client_by_name_.emplace(name, std::move(result).ValueOrDie());
+      name_by_client_.emplace(client, name);
 
-    if (config.enable_fork()) {
-      load_config_by_client_.emplace(client, load_config);
+      if (config.enable_fork()) {
+        load_config_by_client_.emplace(client, load_config);
+      }
     }
   }
+  if (name_taken) {
+    Status destroy_status = client->DestroyEnclave();
+    LOG_IF(ERROR, !destroy_status.ok())
+        << "DestroyEnclave failed after name conflict: " << destroy_status;
+    Status status(error::GoogleError::ALREADY_EXISTS,
+                  absl::StrCat("Name already exists: ", name));
+    LOG(ERROR) << "LoadEnclave failed: " << status;
+    return status;
+  }
 
-  Status status = client->EnterAndInitialize(config);
+  Status status =
+      initialized ? Status::OkStatus() : client->EnterAndInitialize(config);
   // If initialization fails, don't keep the enclave registered. GetClient will
   // return a nullptr rather than an enclave in a bad state.
   if (!status.ok()) {
@@ -433,6 +623,53 @@ Status EnclaveManager::LoadEnclave(const EnclaveLoadConfig &load_config) {
   return status;
 }
 
+StatusOr<std::unique_ptr<EnclaveClient>> EnclaveManager::CreateClient(
+    const EnclaveLoadConfig &load_config, bool *initialized) {
+  {
+    absl::ReaderMutexLock lock(&pool_table_lock_);
+    auto it = pool_by_key_.find(EnclavePoolKey(load_config));
+    if (it != pool_by_key_.end()) {
+      std::unique_ptr<EnclaveClient> client = it->second->Take();
+      if (client) {
+        client->name_ = load_config.name();
+        *initialized = it->second->pre_initialized();
+        return std::move(client);
+      }
+    }
+  }
+
+  *initialized = false;
+  std::shared_ptr<primitives::Client> primitive_client;
+  ASYLO_ASSIGN_OR_RETURN(primitive_client,
+                         asylo::primitives::LoadEnclave(load_config));
+  return std::unique_ptr<EnclaveClient>(
+      GenericEnclaveClient::Create(load_config.name(), primitive_client));
+}
+
+void EnclaveManager::LoadEnclaveAsync(
+    const EnclaveLoadConfig &load_config,
+    std::function<void(const Status &)> callback) {
+  Thread::StartDetached([this, load_config, callback] {
+    callback(LoadEnclave(load_config));
+  });
+}
+
+std::vector<Status> EnclaveManager::LoadEnclaves(
+    const std::vector<EnclaveLoadConfig> &load_configs) {
+  std::vector<Status> statuses(load_configs.size());
+  std::vector<Thread> threads;
+  threads.reserve(load_configs.size());
+  for (size_t i = 0; i < load_configs.size(); ++i) {
+    threads.emplace_back([this, &load_configs, &statuses, i] {
+      statuses[i] = LoadEnclave(load_configs[i]);
+    });
+  }
+  for (Thread &thread : threads) {
+    thread.Join();
+  }
+  return statuses;
+}
+
 void EnclaveManager::RemoveEnclaveReference(absl::string_view name) {
   absl::WriterMutexLock lock(&client_table_lock_);
   EnclaveClient *client = client_by_name_[name].get();
@@ -22,8 +22,10 @@
 // Declares the enclave client API, providing types and methods for loading,
 // accessing, and finalizing enclaves.
 
+#include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
@@ -34,8 +36,10 @@
 #include "asylo/enclave.pb.h"  // IWYU pragma: export
 #include "asylo/platform/core/enclave_client.h"
 #include "asylo/platform/core/enclave_config_util.h"
+#include "asylo/platform/core/enclave_pool.h"
 #include "asylo/platform/core/shared_resource_manager.h"
 #include "asylo/platform/primitives/enclave_type.h"
+#include "asylo/platform/primitives/util/enclave_telemetry.pb.h"
 #include "asylo/platform/primitives/util/message.h"
 #include "asylo/util/status.h"  // IWYU pragma: export
 #include "asylo/util/statusor.h"
@@ -203,6 +207,31 @@ class EnclaveManager {
   /// \param load_config Backend configuration options to load an enclave
   Status LoadEnclave(const EnclaveLoadConfig &load_config);
 
+  /// Loads an enclave in the background.
+  ///
+  /// Behaves like LoadEnclave(const EnclaveLoadConfig &), but returns
+  /// immediately and loads the enclave on a separate thread, so that the caller
+  /// can overlap enclave startup with other work. Once the enclave has been
+  /// loaded and initialized, or loading has failed, |callback| is invoked on the
+  /// loading thread with the result.
+  ///
+  /// \param load_config Backend configuration options to load an enclave.
+  /// \param callback Callback invoked with the status of the load.
+  void LoadEnclaveAsync(const EnclaveLoadConfig &load_config,
+                        std::function<void(const Status &)> callback);
+
+  /// Loads several enclaves concurrently.
+  ///
+  /// Loads each element of |load_configs| as if by
+  /// LoadEnclave(const EnclaveLoadConfig &), on one thread per enclave, and
+  /// waits for all of them to complete. Embedded SGX enclaves loaded this way
+  /// share a single mapping and section index of the host binary.
+  ///
+  /// \param load_configs Backend configuration options of the enclaves to load.
+  /// \return The status of each load, in the order of |load_configs|.
+  std::vector<Status> LoadEnclaves(
+      const std::vector<EnclaveLoadConfig> &load_configs);
+
   /// Loads an enclave.
   ///
   /// Loads a new enclave with default enclave config settings and binds it to a
@@ -251,6 +280,56 @@ class EnclaveManager {
                      EnclaveConfig config, void *base_address = nullptr,
                      const size_t enclave_size = 0);
 
+  /// Creates a pool of warm enclaves.
+  ///
+  /// Loads enclaves described by |load_config| in the background and keeps
+  /// them ready, as configured by |options|. A subsequent call to
+  /// LoadEnclave(const EnclaveLoadConfig &) whose configuration matches
+  /// |load_config| in every field except `name` is served from the pool when
+  /// an idle enclave is available, and falls back to loading a new enclave
+  /// otherwise. The `name` field of |load_config| is only used to initialize
+  /// enclaves when EnclavePoolOptions::pre_initialize() is set.
+  ///
+  /// Only SGX load configurations can be pooled. It is an error to create a
+  /// second pool for an equivalent configuration.
+  ///
+  /// Example:
+  /// ```
+  ///  EnclaveLoadConfig load_config;
+  ///  load_config.SetExtension(sgx_load_config, sgx_config);
+  ///  CreateEnclavePool(load_config,
+  ///                    EnclavePoolOptions().set_min_idle(2).set_max_idle(4));
+  ///  ...
+  ///  load_config.set_name("/tenant_a");
+  ///  LoadEnclave(load_config);  // Served from the pool.
+  /// ```
+  ///
+  /// \param load_config Backend configuration options shared by all enclaves
+  ///                    in the pool.
+  /// \param options Pool size limits and behavior.
+  Status CreateEnclavePool(const EnclaveLoadConfig &load_config,
+                           const EnclavePoolOptions &options)
+      ABSL_LOCKS_EXCLUDED(pool_table_lock_);
+
+  /// Destroys a pool of warm enclaves.
+  ///
+  /// Destroys every idle enclave held by the pool created for a configuration
+  /// equivalent to |load_config|. Enclaves previously handed out by the pool
+  /// are not affected.
+  ///
+  /// \param load_config The configuration the pool was created with.
+  Status DestroyEnclavePool(const EnclaveLoadConfig &load_config)
+      ABSL_LOCKS_EXCLUDED(pool_table_lock_);
+
+  /// Returns the number of idle enclaves in a pool.
+  ///
+  /// \param load_config The configuration the pool was created with.
+  /// \return The number of enclaves ready to be handed out, or an error if no
+  ///         pool exists for |load_config|.
+  StatusOr<size_t> GetEnclavePoolIdleCount(
+      const EnclaveLoadConfig &load_config) const
+      ABSL_LOCKS_EXCLUDED(pool_table_lock_);
+
   /// Fetches a client to a loaded enclave.
   ///
   /// \param name The name of an EnclaveClient that may be registered in the
@@ -289,6 +368,25 @@ class EnclaveManager {
                         bool skip_finalize = false)
       ABSL_LOCKS_EXCLUDED(client_table_lock_);
 
+  /// Returns the telemetry collected for an enclave.
+  ///
+  /// Telemetry covers enclave entries and exits made through the primitives
+  /// layer, and is only collected for enclaves loaded with the `telemetry`
+  /// field of their EnclaveLoadConfig set.
+  ///
+  /// \param client A client attached to the enclave to report on.
+  /// \return A snapshot of the enclave's telemetry, or an error if `client` is
+  ///         not registered or does not collect telemetry.
+  StatusOr<primitives::EnclaveTelemetrySnapshot> GetEnclaveTelemetry(
+      const EnclaveClient *client) const
+      ABSL_LOCKS_EXCLUDED(client_table_lock_);
+
+  /// Returns the telemetry collected for every enclave that collects it.
+  ///
+  /// \return One snapshot per registered enclave loaded with telemetry enabled.
+  std::vector<primitives::EnclaveTelemetrySnapshot> GetEnclaveTelemetry() const
+      ABSL_LOCKS_EXCLUDED(client_table_lock_);
+
   /// Fetches the shared resource manager object.
   ///
   /// \return The SharedResourceManager instance.
@@ -330,6 +428,13 @@ class EnclaveManager {
                          const size_t enclave_size = 0)
       ABSL_LOCKS_EXCLUDED(client_table_lock_);
 
+  // Loads a new enclave for |load_config| and creates a client for it, or
+  // takes one from a matching enclave pool. Sets |initialized| to true if the
+  // returned enclave does not need to be initialized.
+  StatusOr<std::unique_ptr<EnclaveClient>> CreateClient(
+      const EnclaveLoadConfig &load_config, bool *initialized)
+      ABSL_LOCKS_EXCLUDED(pool_table_lock_);
+
   // Deletes an enclave client reference that points to an enclave that no
   // longer exists. This should only happen during fork.
   void RemoveEnclaveReference(absl::string_view name)
@@ -365,6 +470,14 @@ class EnclaveManager {
   absl::flat_hash_map<const EnclaveClient *, EnclaveLoadConfig>
       load_config_by_client_ ABSL_GUARDED_BY(client_table_lock_);
 
+  // A mutex guarding |pool_by_key_|.
+  mutable absl::Mutex pool_table_lock_;
+
+  // Enclave pools, keyed by the serialized EnclaveLoadConfig they were created
+  // with, excluding the enclave name.
+  absl::flat_hash_map<std::string, std::unique_ptr<EnclavePool>> pool_by_key_
+      ABSL_GUARDED_BY(pool_table_lock_);
+
   // A part of the configuration for enclaves launched by the enclave manager
   // comes from the Asylo daemon. This member caches such configuration.
   HostConfig host_config_;
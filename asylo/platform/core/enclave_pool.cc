@@ -0,0 +1,116 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/core/enclave_pool.h"
+
+#include <utility>
+
+#include "absl/time/time.h"
+#include "asylo/enclave.pb.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/status.h"
+
+namespace asylo {
+namespace {
+
+// Delay before the refill thread retries after failing to load an enclave.
+constexpr absl::Duration kRefillRetryDelay = absl::Seconds(1);
+
+}  // namespace
+
+EnclavePool::EnclavePool(LoadFunction load, const EnclavePoolOptions &options)
+    : load_(std::move(load)),
+      options_(options),
+      refill_thread_([this] { RefillLoop(); }) {}
+
+EnclavePool::~EnclavePool() {
+  {
+    absl::MutexLock lock(&mu_);
+    shutting_down_ = true;
+  }
+  refill_thread_.Join();
+
+  absl::MutexLock lock(&mu_);
+  for (std::unique_ptr<EnclaveClient> &client : idle_) {
+    if (options_.pre_initialize()) {
+      Status status = client->EnterAndFinalize(EnclaveFinal());
+      LOG_IF(ERROR, !status.ok())
+          << "Failed to finalize pooled enclave: " << status;
+    }
+    Status status = client->DestroyEnclave();
+    LOG_IF(ERROR, !status.ok())
+        << "Failed to destroy pooled enclave: " << status;
+  }
+  idle_.clear();
+}
+
+std::unique_ptr<EnclaveClient> EnclavePool::Take() {
+  absl::MutexLock lock(&mu_);
+  if (idle_.empty()) {
+    return nullptr;
+  }
+  std::unique_ptr<EnclaveClient> client = std::move(idle_.front());
+  idle_.pop_front();
+  return client;
+}
+
+size_t EnclavePool::idle_count() const {
+  absl::MutexLock lock(&mu_);
+  return idle_.size();
+}
+
+bool EnclavePool::RefillRequested() const {
+  return shutting_down_ || idle_.size() < options_.min_idle();
+}
+
+void EnclavePool::RefillLoop() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &EnclavePool::RefillRequested));
+      if (shutting_down_) {
+        return;
+      }
+    }
+
+    // Top the pool up to its high watermark. Enclaves are loaded without
+    // holding |mu_| so that Take() is never blocked behind a load.
+    while (true) {
+      {
+        absl::MutexLock lock(&mu_);
+        if (shutting_down_ || idle_.size() >= options_.max_idle()) {
+          break;
+        }
+      }
+
+      StatusOr<std::unique_ptr<EnclaveClient>> result = load_();
+      if (!result.ok()) {
+        LOG(ERROR) << "Failed to load pooled enclave: " << result.status();
+        absl::MutexLock lock(&mu_);
+        mu_.AwaitWithTimeout(absl::Condition(&shutting_down_),
+                             kRefillRetryDelay);
+        break;
+      }
+
+      absl::MutexLock lock(&mu_);
+      idle_.push_back(std::move(result).ValueOrDie());
+    }
+  }
+}
+
+}  // namespace asylo
@@ -0,0 +1,140 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_CORE_ENCLAVE_POOL_H_
+#define ASYLO_PLATFORM_CORE_ENCLAVE_POOL_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+#include "asylo/platform/core/enclave_client.h"
+#include "asylo/util/statusor.h"
+#include "asylo/util/thread.h"
+
+namespace asylo {
+
+/// Enclave pool configuration.
+///
+/// An enclave pool keeps a number of idle enclaves, all loaded from the same
+/// EnclaveLoadConfig, ready to be handed out by EnclaveManager::LoadEnclave.
+/// The pool holds at most `max_idle` enclaves and starts loading replacements
+/// in the background as soon as fewer than `min_idle` enclaves remain.
+class EnclavePoolOptions {
+ public:
+  /// Constructs a default EnclavePoolOptions object, which keeps exactly one
+  /// loaded but uninitialized enclave in the pool.
+  EnclavePoolOptions() = default;
+
+  /// Sets the number of idle enclaves below which the pool is refilled.
+  ///
+  /// \return A reference to this EnclavePoolOptions object.
+  EnclavePoolOptions &set_min_idle(size_t min_idle) {
+    min_idle_ = min_idle;
+    return *this;
+  }
+
+  /// Sets the maximum number of idle enclaves held by the pool.
+  ///
+  /// \return A reference to this EnclavePoolOptions object.
+  EnclavePoolOptions &set_max_idle(size_t max_idle) {
+    max_idle_ = max_idle;
+    return *this;
+  }
+
+  /// Sets whether pooled enclaves are entered and initialized in the
+  /// background, in addition to being loaded.
+  ///
+  /// A pre-initialized enclave is initialized with the enclave name that the
+  /// pool was created with rather than the name it is later bound to, so this
+  /// option should only be set for enclaves that do not depend on their name.
+  ///
+  /// \return A reference to this EnclavePoolOptions object.
+  EnclavePoolOptions &set_pre_initialize(bool pre_initialize) {
+    pre_initialize_ = pre_initialize;
+    return *this;
+  }
+
+  /// Returns the number of idle enclaves below which the pool is refilled.
+  size_t min_idle() const { return min_idle_; }
+
+  /// Returns the maximum number of idle enclaves held by the pool.
+  size_t max_idle() const { return max_idle_; }
+
+  /// Returns true if pooled enclaves are initialized in the background.
+  bool pre_initialize() const { return pre_initialize_; }
+
+ private:
+  size_t min_idle_ = 1;
+  size_t max_idle_ = 1;
+  bool pre_initialize_ = false;
+};
+
+// A set of idle enclaves that is refilled by a background thread. The pool
+// owns its idle enclaves; enclaves handed out by Take() are owned by the
+// caller. This class is an implementation detail of EnclaveManager.
+class EnclavePool {
+ public:
+  // Loads, and optionally initializes, a single enclave for the pool.
+  using LoadFunction =
+      std::function<StatusOr<std::unique_ptr<EnclaveClient>>()>;
+
+  // Creates a pool and starts its refill thread. |options| must have been
+  // validated by the caller.
+  EnclavePool(LoadFunction load, const EnclavePoolOptions &options);
+
+  // Stops the refill thread and destroys every idle enclave.
+  ~EnclavePool();
+
+  EnclavePool(const EnclavePool &) = delete;
+  EnclavePool &operator=(const EnclavePool &) = delete;
+
+  // Removes an idle enclave from the pool and returns it, or returns nullptr
+  // if the pool is currently empty.
+  std::unique_ptr<EnclaveClient> Take() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of idle enclaves currently held by the pool.
+  size_t idle_count() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if enclaves handed out by this pool are already initialized.
+  bool pre_initialized() const { return options_.pre_initialize(); }
+
+ private:
+  // Top level loop run by the refill thread.
+  void RefillLoop() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the refill thread has work to do.
+  bool RefillRequested() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const LoadFunction load_;
+  const EnclavePoolOptions options_;
+
+  mutable absl::Mutex mu_;
+  std::deque<std::unique_ptr<EnclaveClient>> idle_ ABSL_GUARDED_BY(mu_);
+  bool shutting_down_ ABSL_GUARDED_BY(mu_) = false;
+
+  // Background thread keeping |idle_| filled. Declared last so that it starts
+  // after every other member has been initialized.
+  Thread refill_thread_;
+};
+
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_CORE_ENCLAVE_POOL_H_
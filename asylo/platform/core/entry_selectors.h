@@ -35,6 +35,10 @@ static constexpr uint64_t kSelectorAsyloRun = primitives::kSelectorUser + 1;
 // Enclave finalization entry point selector.
 static constexpr uint64_t kSelectorAsyloFini = primitives::kSelectorUser + 2;
 
+// Enclave run entry point selector which passes raw bytes instead of
+// EnclaveInput and EnclaveOutput messages.
+static constexpr uint64_t kSelectorAsyloRunRaw = primitives::kSelectorUser + 3;
+
 }  // namespace asylo
 
 #endif  // ASYLO_PLATFORM_CORE_ENTRY_SELECTORS_H_
@@ -19,20 +19,50 @@
 #include "asylo/platform/core/generic_enclave_client.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "asylo/enclave.pb.h"  // IWYU pragma: export
 #include "asylo/platform/core/entry_selectors.h"
 #include "asylo/platform/host_call/untrusted/host_call_handlers_initializer.h"
 #include "asylo/platform/primitives/extent.h"
+#include "asylo/platform/primitives/primitive_status.h"
 #include "asylo/platform/primitives/primitives.h"
 #include "asylo/platform/primitives/util/message.h"
+#include "asylo/platform/primitives/util/status_conversions.h"
 #include "asylo/util/posix_error_space.h"
 #include "asylo/util/status.h"
 #include "asylo/util/status_macros.h"
 
 namespace asylo {
+namespace {
+
+// Reads the output of the protobuf-free run entry point from |out|. Returns the
+// status returned by TrustedApplication::RunRaw, and on success stores its
+// output in |output| if |output| is not nullptr.
+Status ReadRunRawOutput(primitives::MessageReader *out, std::string *output) {
+  ASYLO_RETURN_IF_INCORRECT_READER_ARGUMENTS(*out, 3);
+  auto code_extent = out->next();
+  auto message_extent = out->next();
+  auto output_extent = out->next();
+  if (code_extent.size() != sizeof(int32_t)) {
+    return Status(error::GoogleError::INTERNAL,
+                  "Malformed output from the enclave run entry point");
+  }
+  Status status = primitives::MakeStatus(primitives::PrimitiveStatus(
+      *code_extent.As<int32_t>(), message_extent.As<char>(),
+      message_extent.size()));
+  if (status.ok() && output) {
+    output->assign(output_extent.As<char>(), output_extent.size());
+  }
+  return status;
+}
+
+}  // namespace
 
 std::unique_ptr<GenericEnclaveClient> GenericEnclaveClient::Create(
     const absl::string_view name,
@@ -150,6 +180,50 @@ Status GenericEnclaveClient::EnterAndRun(const EnclaveInput &input,
   return status;
 }
 
+Status GenericEnclaveClient::EnterAndRunRaw(absl::string_view input,
+                                            std::string *output) {
+  primitives::MessageWriter in;
+  in.PushByReference(primitives::Extent{input.data(), input.size()});
+  primitives::MessageReader out;
+  ASYLO_RETURN_IF_ERROR(
+      primitive_client_->EnclaveCall(kSelectorAsyloRunRaw, &in, &out));
+  return ReadRunRawOutput(&out, output);
+}
+
+Status GenericEnclaveClient::EnterAndRunRawBatch(
+    absl::Span<const absl::string_view> inputs,
+    std::vector<StatusOr<std::string>> *results) {
+  std::vector<primitives::MessageWriter> writers(inputs.size());
+  std::vector<std::pair<uint64_t, primitives::MessageWriter *>> calls;
+  calls.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    writers[i].PushByReference(
+        primitives::Extent{inputs[i].data(), inputs[i].size()});
+    calls.emplace_back(kSelectorAsyloRunRaw, &writers[i]);
+  }
+
+  std::vector<primitives::Client::BatchCallResult> call_results;
+  ASYLO_RETURN_IF_ERROR(
+      primitive_client_->EnclaveCallBatch(calls, &call_results));
+
+  results->clear();
+  results->reserve(call_results.size());
+  for (auto &call_result : call_results) {
+    if (!call_result.status.ok()) {
+      results->push_back(call_result.status);
+      continue;
+    }
+    std::string output;
+    Status status = ReadRunRawOutput(&call_result.output, &output);
+    if (status.ok()) {
+      results->push_back(std::move(output));
+    } else {
+      results->push_back(status);
+    }
+  }
+  return Status::OkStatus();
+}
+
 Status GenericEnclaveClient::EnterAndFinalize(const EnclaveFinal &final_input) {
   std::string buf;
   if (!final_input.SerializeToString(&buf)) {
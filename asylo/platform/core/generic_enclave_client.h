@@ -19,10 +19,16 @@
 #ifndef ASYLO_PLATFORM_CORE_GENERIC_ENCLAVE_CLIENT_H_
 #define ASYLO_PLATFORM_CORE_GENERIC_ENCLAVE_CLIENT_H_
 
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "asylo/enclave.pb.h"  // IWYU pragma: export
 #include "asylo/platform/core/enclave_client.h"
 #include "asylo/platform/primitives/untrusted_primitives.h"
 #include "asylo/util/status.h"  // IWYU pragma: export
+#include "asylo/util/statusor.h"
 
 namespace asylo {
 
@@ -35,6 +41,18 @@ class GenericEnclaveClient : public EnclaveClient {
 
   Status EnterAndRun(const EnclaveInput &input, EnclaveOutput *output) override;
 
+  // Enters the enclave and invokes TrustedApplication::RunRaw with |input|.
+  // Returns the status returned by RunRaw, and on success stores its output in
+  // |output| if |output| is not nullptr.
+  Status EnterAndRunRaw(absl::string_view input, std::string *output);
+
+  // Enters the enclave once and invokes TrustedApplication::RunRaw with each of
+  // |inputs| in order. Returns an error if the enclave could not be entered;
+  // otherwise |results| holds the output of RunRaw or the error it returned for
+  // each input, in the order of |inputs|.
+  Status EnterAndRunRawBatch(absl::Span<const absl::string_view> inputs,
+                             std::vector<StatusOr<std::string>> *results);
+
   std::shared_ptr<primitives::Client> GetPrimitiveClient() const {
     return primitive_client_;
   }
@@ -0,0 +1,114 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/enclave.pb.h"
+#include "asylo/identity/descriptions.h"
+#include "asylo/identity/enclave_assertion_authority_configs.h"
+#include "asylo/platform/core/enclave_manager.h"
+#include "asylo/platform/primitives/sgx/loader.pb.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/status.h"
+
+ABSL_FLAG(std::string, enclave_path, "", "Path to enclave to load");
+
+namespace asylo {
+namespace {
+
+// Number of enclaves loaded by each startup measurement.
+constexpr int kStartupIterations = 16;
+
+// Attestation domain provided to the EnclaveManager through its HostConfig.
+constexpr char kAttestationDomain[] = "A 16-byte domain";
+
+class AssertionAuthorityStartupTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    HostConfig host_config;
+    host_config.set_local_attestation_domain(kAttestationDomain);
+    EnclaveManager::Configure(
+        EnclaveManagerOptions().set_host_config(host_config));
+    StatusOr<EnclaveManager *> manager_result = EnclaveManager::Instance();
+    if (!manager_result.ok()) {
+      LOG(FATAL) << manager_result.status();
+    }
+    manager_ = manager_result.ValueOrDie();
+  }
+
+  // Returns a load config for an enclave named |name| that uses the null and
+  // SGX local assertion authorities. The SGX local authority config is left
+  // empty, so the EnclaveManager fills it in from its HostConfig.
+  EnclaveLoadConfig MakeLoadConfig(const std::string &name, bool lazy) {
+    EnclaveLoadConfig load_config;
+    load_config.set_name(name);
+    SgxLoadConfig *sgx_config = load_config.MutableExtension(sgx_load_config);
+    sgx_config->mutable_file_enclave_config()->set_enclave_path(
+        absl::GetFlag(FLAGS_enclave_path));
+    sgx_config->set_debug(true);
+
+    EnclaveConfig *config = load_config.mutable_config();
+    *config->add_enclave_assertion_authority_configs() =
+        CreateNullAssertionAuthorityConfig();
+    SetSgxLocalAssertionDescription(
+        config->add_enclave_assertion_authority_configs()
+            ->mutable_description());
+    config->set_lazy_assertion_authority_initialization(lazy);
+    return load_config;
+  }
+
+  // Loads and destroys |kStartupIterations| enclaves and returns the mean
+  // latency of LoadEnclave.
+  absl::Duration MeasureStartupLatency(const std::string &prefix, bool lazy) {
+    absl::Duration total;
+    for (int i = 0; i < kStartupIterations; ++i) {
+      std::string name = absl::StrCat(prefix, i);
+      absl::Time start = absl::Now();
+      EXPECT_THAT(manager_->LoadEnclave(MakeLoadConfig(name, lazy)), IsOk());
+      total += absl::Now() - start;
+      EXPECT_THAT(
+          manager_->DestroyEnclave(manager_->GetClient(name), EnclaveFinal()),
+          IsOk());
+    }
+    return total / kStartupIterations;
+  }
+
+  static EnclaveManager *manager_;
+};
+
+EnclaveManager *AssertionAuthorityStartupTest::manager_ = nullptr;
+
+// Reports enclave startup latency with assertion authorities initialized
+// during enclave initialization and on first use.
+TEST_F(AssertionAuthorityStartupTest, StartupLatency) {
+  absl::Duration eager_latency =
+      MeasureStartupLatency("/eager", /*lazy=*/false);
+  absl::Duration lazy_latency = MeasureStartupLatency("/lazy", /*lazy=*/true);
+
+  LOG(INFO) << "Mean LoadEnclave latency: eager=" << eager_latency
+            << " lazy=" << lazy_latency;
+}
+
+}  // namespace
+}  // namespace asylo
@@ -0,0 +1,169 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/enclave.pb.h"
+#include "asylo/platform/core/enclave_manager.h"
+#include "asylo/platform/primitives/sgx/loader.pb.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/status.h"
+
+ABSL_FLAG(std::string, enclave_path, "", "Path to enclave to load");
+
+namespace asylo {
+namespace {
+
+using ::testing::Eq;
+
+// Number of enclaves loaded by each latency measurement.
+constexpr int kLatencyIterations = 8;
+
+class EnclavePoolTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    EnclaveManager::Configure(EnclaveManagerOptions());
+    StatusOr<EnclaveManager *> manager_result = EnclaveManager::Instance();
+    if (!manager_result.ok()) {
+      LOG(FATAL) << manager_result.status();
+    }
+    manager_ = manager_result.ValueOrDie();
+  }
+
+  EnclaveLoadConfig MakeLoadConfig(const std::string &name) {
+    EnclaveLoadConfig load_config;
+    load_config.set_name(name);
+    SgxLoadConfig *sgx_config =
+        load_config.MutableExtension(sgx_load_config);
+    sgx_config->mutable_file_enclave_config()->set_enclave_path(
+        absl::GetFlag(FLAGS_enclave_path));
+    sgx_config->set_debug(true);
+    return load_config;
+  }
+
+  // Waits until the pool for |load_config| holds |count| idle enclaves.
+  void WaitForIdleCount(const EnclaveLoadConfig &load_config, size_t count) {
+    while (true) {
+      StatusOr<size_t> idle_result =
+          manager_->GetEnclavePoolIdleCount(load_config);
+      ASSERT_THAT(idle_result, IsOk());
+      if (idle_result.ValueOrDie() >= count) {
+        return;
+      }
+      absl::SleepFor(absl::Milliseconds(10));
+    }
+  }
+
+  // Loads and destroys |kLatencyIterations| enclaves and returns the mean
+  // latency of LoadEnclave.
+  absl::Duration MeasureLoadLatency(const std::string &prefix) {
+    absl::Duration total;
+    for (int i = 0; i < kLatencyIterations; ++i) {
+      std::string name = absl::StrCat(prefix, i);
+      absl::Time start = absl::Now();
+      EXPECT_THAT(manager_->LoadEnclave(MakeLoadConfig(name)), IsOk());
+      total += absl::Now() - start;
+      EXPECT_THAT(
+          manager_->DestroyEnclave(manager_->GetClient(name), EnclaveFinal()),
+          IsOk());
+    }
+    return total / kLatencyIterations;
+  }
+
+  static EnclaveManager *manager_;
+};
+
+EnclaveManager *EnclavePoolTest::manager_ = nullptr;
+
+TEST_F(EnclavePoolTest, InvalidSizeLimitsAreRejected) {
+  EnclaveLoadConfig load_config = MakeLoadConfig("/invalid_pool");
+  EXPECT_THAT(manager_->CreateEnclavePool(
+                  load_config, EnclavePoolOptions().set_min_idle(0)),
+              StatusIs(error::GoogleError::INVALID_ARGUMENT));
+  EXPECT_THAT(manager_->CreateEnclavePool(
+                  load_config,
+                  EnclavePoolOptions().set_min_idle(3).set_max_idle(2)),
+              StatusIs(error::GoogleError::INVALID_ARGUMENT));
+}
+
+TEST_F(EnclavePoolTest, PooledEnclaveIsUsable) {
+  EnclaveLoadConfig pool_config = MakeLoadConfig("/pool");
+  ASSERT_THAT(manager_->CreateEnclavePool(
+                  pool_config,
+                  EnclavePoolOptions().set_min_idle(1).set_max_idle(2)),
+              IsOk());
+  EXPECT_THAT(manager_->CreateEnclavePool(pool_config, EnclavePoolOptions()),
+              StatusIs(error::GoogleError::ALREADY_EXISTS));
+  WaitForIdleCount(pool_config, 2);
+
+  ASSERT_THAT(manager_->LoadEnclave(MakeLoadConfig("/pooled")), IsOk());
+  EnclaveClient *client = manager_->GetClient("/pooled");
+  ASSERT_NE(client, nullptr);
+  EXPECT_THAT(client->get_name(), Eq("/pooled"));
+  EXPECT_THAT(client->EnterAndRun(EnclaveInput(), nullptr), IsOk());
+  EXPECT_THAT(manager_->DestroyEnclave(client, EnclaveFinal()), IsOk());
+
+  EXPECT_THAT(manager_->DestroyEnclavePool(pool_config), IsOk());
+  EXPECT_THAT(manager_->GetEnclavePoolIdleCount(pool_config).status(),
+              StatusIs(error::GoogleError::NOT_FOUND));
+}
+
+TEST_F(EnclavePoolTest, PreInitializedEnclaveIsUsable) {
+  EnclaveLoadConfig pool_config = MakeLoadConfig("/initialized_pool");
+  ASSERT_THAT(manager_->CreateEnclavePool(
+                  pool_config, EnclavePoolOptions().set_pre_initialize(true)),
+              IsOk());
+  WaitForIdleCount(pool_config, 1);
+
+  ASSERT_THAT(manager_->LoadEnclave(MakeLoadConfig("/initialized")), IsOk());
+  EnclaveClient *client = manager_->GetClient("/initialized");
+  ASSERT_NE(client, nullptr);
+  EXPECT_THAT(client->EnterAndRun(EnclaveInput(), nullptr), IsOk());
+  EXPECT_THAT(manager_->DestroyEnclave(client, EnclaveFinal()), IsOk());
+  EXPECT_THAT(manager_->DestroyEnclavePool(pool_config), IsOk());
+}
+
+// Reports LoadEnclave latency with and without a warm pool. The pool is sized
+// so that every measured load is served by an idle enclave.
+TEST_F(EnclavePoolTest, LoadLatency) {
+  absl::Duration cold_latency = MeasureLoadLatency("/cold");
+
+  EnclaveLoadConfig pool_config = MakeLoadConfig("/latency_pool");
+  ASSERT_THAT(manager_->CreateEnclavePool(
+                  pool_config, EnclavePoolOptions()
+                                   .set_min_idle(kLatencyIterations)
+                                   .set_max_idle(kLatencyIterations)
+                                   .set_pre_initialize(true)),
+              IsOk());
+  WaitForIdleCount(pool_config, kLatencyIterations);
+  absl::Duration warm_latency = MeasureLoadLatency("/warm");
+  EXPECT_THAT(manager_->DestroyEnclavePool(pool_config), IsOk());
+
+  LOG(INFO) << "Mean LoadEnclave latency: cold=" << cold_latency
+            << " warm=" << warm_latency;
+}
+
+}  // namespace
+}  // namespace asylo
@@ -24,12 +24,14 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <string>
 #include <utility>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "asylo/util/logging.h"
 #include "asylo/identity/init.h"
@@ -53,6 +55,7 @@
 
 using ::asylo::primitives::EntryHandler;
 using ::asylo::primitives::Extent;
+using ::asylo::primitives::MakePrimitiveStatus;
 using ::asylo::primitives::MessageReader;
 using ::asylo::primitives::MessageWriter;
 using ::asylo::primitives::PrimitiveStatus;
@@ -136,6 +139,35 @@ PrimitiveStatus Run(void *context, MessageReader *in, MessageWriter *out) {
   return PrimitiveStatus(result);
 }
 
+// Handler installed by the runtime to invoke the protobuf-free enclave run
+// entry point. Pushes the status code and status message returned by the
+// application followed by its output.
+PrimitiveStatus RunRaw(void *context, MessageReader *in, MessageWriter *out) {
+  ASYLO_RETURN_IF_INCORRECT_READER_ARGUMENTS(*in, 1);
+  auto input_extent = in->next();
+  Status status;
+  std::string output;
+  TrustedApplication *trusted_application = GetApplicationInstance();
+  if (trusted_application->GetState() != EnclaveState::kRunning) {
+    status = Status(error::GoogleError::FAILED_PRECONDITION,
+                    "Enclave not in state RUNNING");
+  } else {
+    try {
+      status = trusted_application->RunRaw(
+          absl::string_view(input_extent.As<char>(), input_extent.size()),
+          &output);
+    } catch (...) {
+      TrustedPrimitives::BestEffortAbort("Uncaught exception in enclave");
+    }
+  }
+  PrimitiveStatus primitive_status = MakePrimitiveStatus(status);
+  out->Push<int32_t>(primitive_status.error_code());
+  out->PushString(primitive_status.error_message(),
+                  strlen(primitive_status.error_message()));
+  out->PushByCopy(Extent{output.data(), output.size()});
+  return PrimitiveStatus::OkStatus();
+}
+
 // Handler installed by the runtime to invoke the enclave finalization entry
 // point.
 PrimitiveStatus Finalize(void *context, MessageReader *in, MessageWriter *out) {
@@ -238,9 +270,15 @@ Status TrustedApplication::InitializeInternal(const EnclaveConfig &config) {
   }
   SetEnclaveConfig(config);
   // This call can fail, but it should not stop the enclave from running.
-  status = InitializeEnclaveAssertionAuthorities(
-      config.enclave_assertion_authority_configs().begin(),
-      config.enclave_assertion_authority_configs().end());
+  if (config.lazy_assertion_authority_initialization()) {
+    status = DeferEnclaveAssertionAuthorityInitialization(
+        config.enclave_assertion_authority_configs().begin(),
+        config.enclave_assertion_authority_configs().end());
+  } else {
+    status = InitializeEnclaveAssertionAuthorities(
+        config.enclave_assertion_authority_configs().begin(),
+        config.enclave_assertion_authority_configs().end());
+  }
   if (!status.ok()) {
     LOG(WARNING) << "Initialization of enclave assertion authorities failed: "
                  << status;
@@ -283,6 +321,10 @@ void InitializeIO(const EnclaveConfig &config) {
 
   // Set the current working directory so that relative paths can be handled.
   io_manager.SetCurrentWorkingDirectory(config.current_working_directory());
+
+  // Pipes buffered in enclave memory are not shared with a forked child, so
+  // enclaves that may fork keep creating host pipes.
+  io_manager.SetUseHostPipes(config.enable_fork());
 }
 
 // Asylo enclave entry points.
@@ -410,6 +452,14 @@ extern "C" PrimitiveStatus asylo_enclave_init() {
     TrustedPrimitives::BestEffortAbort("Could not register entry handler");
   }
 
+  // Register the protobuf-free enclave run entry handler.
+  EntryHandler run_raw_handler{asylo::RunRaw};
+  if (!TrustedPrimitives::RegisterEntryHandler(asylo::kSelectorAsyloRunRaw,
+                                               run_raw_handler)
+           .ok()) {
+    TrustedPrimitives::BestEffortAbort("Could not register entry handler");
+  }
+
   // Register the enclave finalization entry handler.
   EntryHandler finalize_handler{asylo::Finalize};
   if (!TrustedPrimitives::RegisterEntryHandler(asylo::kSelectorAsyloFini,
@@ -23,6 +23,7 @@
 
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "asylo/enclave.pb.h"
 #include "asylo/platform/core/entry_points.h"
 #include "asylo/util/status.h"
@@ -108,6 +109,22 @@ class TrustedApplication {
     return Status::OkStatus();
   }
 
+  /// Implements the protobuf-free enclave execution entry-point.
+  ///
+  /// Unlike Run, this entry-point exchanges raw bytes with the untrusted
+  /// caller, which avoids serializing and parsing an EnclaveInput and an
+  /// EnclaveOutput on every call. It is invoked by
+  /// GenericEnclaveClient::EnterAndRunRaw and
+  /// GenericEnclaveClient::EnterAndRunRawBatch.
+  ///
+  /// \param input Bytes passed by the untrusted caller.
+  /// \param[out] output Bytes passed back to the untrusted caller.
+  /// \return OK status or error
+  virtual Status RunRaw(absl::string_view input, std::string *output) {
+    return Status(error::GoogleError::UNIMPLEMENTED,
+                  "RunRaw is not implemented by this enclave");
+  }
+
   /// Implements enclave finalization behavior.
   ///
   /// \param final_input Message passed on enclave finalization.
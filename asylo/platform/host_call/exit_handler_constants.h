@@ -127,9 +127,23 @@ static constexpr uint64_t kInotifyReadHandler =
 static constexpr uint64_t kClockGettimeHandler =
     primitives::kSelectorHostCall + 27;
 
+// Exit handler constant for |MmapSharedHandler|.
+static constexpr uint64_t kMmapSharedHandler =
+    primitives::kSelectorHostCall + 28;
+
+// Exit handler constant for |MsyncHandler|.
+static constexpr uint64_t kMsyncHandler = primitives::kSelectorHostCall + 29;
+
+// Exit handler constant for |MunmapHandler|.
+static constexpr uint64_t kMunmapHandler = primitives::kSelectorHostCall + 30;
+
+// Exit handler constant for |InotifyReadBatchHandler|.
+static constexpr uint64_t kInotifyReadBatchHandler =
+    primitives::kSelectorHostCall + 31;
+
 // Assert that the largest host call handler lies in
 // [kSelectorHostCall, kSelectorRemote).
-static_assert(kOpenLogHandler < primitives::kSelectorRemote,
+static_assert(kInotifyReadBatchHandler < primitives::kSelectorRemote,
               "Cannot have host call handler constant spill over into "
               "|kSelectorRemote|.");
 
@@ -20,6 +20,8 @@
 
 #include <ifaddrs.h>
 
+#include <vector>
+
 #include "asylo/platform/system_call/type_conversions/types_functions.h"
 #include "asylo/util/status_macros.h"
 
@@ -60,6 +62,13 @@ size_t GetNumAddrinfos(struct addrinfo *addrs) {
   return ret;
 }
 
+// Rounds |size| up to the alignment of the sockaddrs stored in a compact
+// addrinfo list.
+size_t AlignForSockaddr(size_t size) {
+  constexpr size_t kAlignment = alignof(struct sockaddr_storage);
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
 size_t GetSocklen(struct sockaddr *sock,
                   void (*abort_handler)(const char *message)) {
   if (!sock) return 0;
@@ -119,25 +128,19 @@ bool DeserializeAddrinfo(primitives::MessageReader *in, struct addrinfo **out,
   size_t num_addrs = in->next<size_t>();
 
   if (num_addrs == 0) {
-    if (out) {
-      *out = nullptr;
-    }
+    *out = nullptr;
     return true;
   }
   // 6 entries per addrinfo expected on |in| for deserialization.
   if (in->size() < num_addrs * 6) return false;
 
-  struct addrinfo *prev_info = nullptr;
-  for (int i = 0; i < num_addrs; i++) {
-    auto info = static_cast<struct addrinfo *>(malloc(sizeof(struct addrinfo)));
-    if (!info) {
-      // Roll back info and linked list constructed until now.
-      freeaddrinfo(info);
-      freeaddrinfo(*out);
-      return false;
-    }
-    memset(info, 0, sizeof(struct addrinfo));
-
+  // Build the list in temporary storage first, with canonical names referring
+  // to the extents held by |in|, so that the result can be copied into a single
+  // allocation once its size is known.
+  std::vector<struct addrinfo> infos(num_addrs);
+  std::vector<struct sockaddr_storage> socks(num_addrs);
+  for (size_t i = 0; i < num_addrs; i++) {
+    struct addrinfo *info = &infos[i];
     info->ai_flags = FromkLinuxAddressInfoFlag(in->next<int>());
     info->ai_family = FromkLinuxAfFamily(in->next<int>());
     info->ai_socktype = FromkLinuxSocketType(in->next<int>());
@@ -145,51 +148,83 @@ bool DeserializeAddrinfo(primitives::MessageReader *in, struct addrinfo **out,
     Extent klinux_sockaddr_buf = in->next();
     Extent ai_canonname = in->next();
 
-    if (info->ai_socktype == -1) {
-      // Roll back info and linked list constructed until now.
-      freeaddrinfo(info);
-      freeaddrinfo(*out);
-      return false;
-    }
+    if (info->ai_socktype == -1) return false;
 
     // Optionally set ai_addr and ai_addrlen.
     if (!klinux_sockaddr_buf.empty()) {
       const struct klinux_sockaddr *klinux_sock =
           klinux_sockaddr_buf.As<struct klinux_sockaddr>();
-      struct sockaddr_storage sock {};
       socklen_t socklen = sizeof(struct sockaddr_storage);
       if (!FromkLinuxSockAddr(klinux_sock, klinux_sockaddr_buf.size(),
-                              reinterpret_cast<sockaddr *>(&sock), &socklen,
-                              abort_handler)) {
-        // Roll back info and linked list constructed until now.
-        freeaddrinfo(info);
-        freeaddrinfo(*out);
+                              reinterpret_cast<sockaddr *>(&socks[i]),
+                              &socklen, abort_handler)) {
         return false;
       }
       info->ai_addrlen = socklen;
-      info->ai_addr = MallocAndCopy<sockaddr>(&sock, socklen);
-    } else {
-      info->ai_addr = nullptr;
-      info->ai_addrlen = 0;
+      info->ai_addr = reinterpret_cast<struct sockaddr *>(&socks[i]);
     }
 
-    // Optionally set ai_canonname.
-    info->ai_canonname =
-        ai_canonname.empty() ? nullptr : strdup(ai_canonname.As<char>());
+    // Optionally set ai_canonname, which must be NUL-terminated.
+    if (!ai_canonname.empty()) {
+      char *canonname = ai_canonname.As<char>();
+      if (canonname[ai_canonname.size() - 1] != '\0') return false;
+      info->ai_canonname = canonname;
+    }
 
-    // Construct addrinfo linked list.
-    info->ai_next = nullptr;
-    if (!prev_info) {
-      *out = info;
+    if (i > 0) infos[i - 1].ai_next = info;
+  }
+
+  *out = CopyAddrinfo(infos.data());
+  return *out != nullptr;
+}
+
+struct addrinfo *CopyAddrinfo(const struct addrinfo *list) {
+  if (!list) return nullptr;
+
+  size_t num_addrs = 0;
+  size_t sock_bytes = 0;
+  size_t name_bytes = 0;
+  for (const struct addrinfo *info = list; info != nullptr;
+       info = info->ai_next) {
+    num_addrs++;
+    if (info->ai_addr) sock_bytes += AlignForSockaddr(info->ai_addrlen);
+    if (info->ai_canonname) name_bytes += strlen(info->ai_canonname) + 1;
+  }
+  size_t node_bytes = AlignForSockaddr(num_addrs * sizeof(struct addrinfo));
+
+  char *block =
+      static_cast<char *>(malloc(node_bytes + sock_bytes + name_bytes));
+  if (!block) return nullptr;
+
+  // The nodes come first so that the head of the list is the start of the
+  // allocation, followed by the sockaddrs and then the canonical names.
+  auto nodes = reinterpret_cast<struct addrinfo *>(block);
+  char *sock_cursor = block + node_bytes;
+  char *name_cursor = sock_cursor + sock_bytes;
+  struct addrinfo *copy = nodes;
+  for (const struct addrinfo *info = list; info != nullptr;
+       info = info->ai_next, copy++) {
+    *copy = *info;
+    copy->ai_next = info->ai_next ? copy + 1 : nullptr;
+    if (info->ai_addr) {
+      memcpy(sock_cursor, info->ai_addr, info->ai_addrlen);
+      copy->ai_addr = reinterpret_cast<struct sockaddr *>(sock_cursor);
+      sock_cursor += AlignForSockaddr(info->ai_addrlen);
     } else {
-      prev_info->ai_next = info;
+      copy->ai_addrlen = 0;
+    }
+    if (info->ai_canonname) {
+      size_t len = strlen(info->ai_canonname) + 1;
+      memcpy(name_cursor, info->ai_canonname, len);
+      copy->ai_canonname = name_cursor;
+      name_cursor += len;
     }
-    prev_info = info;
   }
-
-  return true;
+  return nodes;
 }
 
+void FreeDeserializedAddrinfo(struct addrinfo *info) { free(info); }
+
 bool DeserializeIfAddrs(primitives::MessageReader *in, struct ifaddrs **out,
                         void (*abort_handler)(const char *message)) {
   if (!in || !out || in->empty()) return false;
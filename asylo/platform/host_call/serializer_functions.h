@@ -34,10 +34,22 @@ namespace asylo {
 namespace host_call {
 
 // Deserializes a MessageReader containing serialized linked list of addrinfos
-// into |*out|.
+// into |*out|. The resulting list is a single allocation as returned by
+// CopyAddrinfo().
 bool DeserializeAddrinfo(primitives::MessageReader *in, struct addrinfo **out,
                          void (*abort_handler)(const char *message));
 
+// Copies the addrinfo linked list |list| into a single allocation holding all
+// of its nodes, sockaddrs and canonical names. The head of the returned list is
+// the start of the allocation, so the whole list is released by passing it to
+// free() or FreeDeserializedAddrinfo(). Returns nullptr if |list| is empty or
+// the allocation fails.
+struct addrinfo *CopyAddrinfo(const struct addrinfo *list);
+
+// Frees up an addrinfo list that was allocated by DeserializeAddrinfo() or by
+// CopyAddrinfo().
+void FreeDeserializedAddrinfo(struct addrinfo *info);
+
 // Deserializes a MessageReader containing serialized linked list of ifaddrs
 // into |*out|.
 bool DeserializeIfAddrs(primitives::MessageReader *in, struct ifaddrs **out,
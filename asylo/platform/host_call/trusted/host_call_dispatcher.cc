@@ -22,6 +22,7 @@
 #include "asylo/platform/primitives/extent.h"
 #include "asylo/platform/primitives/trusted_primitives.h"
 #include "asylo/platform/primitives/util/message.h"
+#include "asylo/platform/primitives/util/scratch_buffer.h"
 #include "asylo/util/status_macros.h"
 
 namespace asylo {
@@ -54,9 +55,16 @@ primitives::PrimitiveStatus SystemCallDispatcher(const uint8_t* request_buffer,
   *response_size = response.size();
 
   // Copy |response| to *response_buffer before it goes out of scope.
-  // *response_buffer is expected to be owned by the caller, so we wouldn't
-  // worry about freeing the memory we allocate here.
-  *response_buffer = reinterpret_cast<uint8_t*>(malloc(*response_size));
+  // *response_buffer is owned by the caller, which releases it with
+  // ReleaseScratchBuffer() once the response has been parsed.
+  *response_buffer =
+      reinterpret_cast<uint8_t*>(primitives::AcquireScratchBuffer(
+          primitives::ScratchSlot::kResponse, *response_size));
+  if (*response_buffer == nullptr) {
+    return primitives::PrimitiveStatus{
+        error::GoogleError::RESOURCE_EXHAUSTED,
+        "Failed to allocate the host call response buffer."};
+  }
   memcpy(*response_buffer, response.As<uint8_t>(), *response_size);
 
   return primitives::PrimitiveStatus::OkStatus();
@@ -0,0 +1,236 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/host_call/trusted/host_call_dispatcher.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "asylo/platform/host_call/exit_handler_constants.h"
+#include "asylo/platform/primitives/trusted_primitives.h"
+#include "asylo/platform/primitives/util/message.h"
+#include "asylo/platform/system_call/system_call.h"
+#include "asylo/platform/system_call/untrusted_invoke.h"
+
+// Allocations made by the calling thread while |count_allocations| is set are
+// counted in |allocation_count|. The host side of a host call runs with
+// counting disabled, so that only allocations made by the trusted side of the
+// call are counted.
+namespace {
+
+thread_local bool count_allocations = false;
+thread_local int allocation_count = 0;
+
+void CountAllocation() {
+  if (count_allocations) {
+    ++allocation_count;
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+  CountAllocation();
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  CountAllocation();
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  CountAllocation();
+  return __libc_realloc(ptr, size);
+}
+
+}  // extern "C"
+
+namespace asylo {
+namespace primitives {
+
+// Runs the host side of a host call in-process. System call requests are
+// invoked locally, and any other message is echoed back to the caller.
+PrimitiveStatus TrustedPrimitives::UntrustedCall(uint64_t untrusted_selector,
+                                                 MessageWriter *input,
+                                                 MessageReader *output) {
+  bool counting = count_allocations;
+  count_allocations = false;
+  std::vector<char> request(input->MessageSize());
+  input->Serialize(request.data());
+  MessageReader host_input;
+  host_input.Deserialize(request.data(), request.size());
+
+  MessageWriter host_output;
+  Extent response;
+  if (untrusted_selector == host_call::kSystemCallHandler) {
+    PrimitiveStatus status =
+        system_call::UntrustedInvoke(host_input.next(), &response);
+    if (!status.ok()) {
+      count_allocations = counting;
+      return status;
+    }
+    host_output.PushByReference(response);
+  } else {
+    while (host_input.hasNext()) {
+      host_output.PushByReference(host_input.next());
+    }
+  }
+  std::vector<char> serialized(host_output.MessageSize());
+  host_output.Serialize(serialized.data());
+  free(response.data());
+
+  count_allocations = counting;
+  output->Deserialize(serialized.data(), serialized.size());
+  count_allocations = false;
+  return PrimitiveStatus::OkStatus();
+}
+
+}  // namespace primitives
+
+namespace host_call {
+namespace {
+
+using ::testing::Eq;
+using ::testing::StrEq;
+
+// Number of host calls made after warm-up in each allocation test.
+constexpr int kIterations = 100;
+
+class HostCallDispatcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override { enc_set_dispatch_syscall(SystemCallDispatcher); }
+
+  // Runs |host_calls| once to warm up the per-thread scratch buffers, then
+  // kIterations more times, and returns the number of allocations made by the
+  // trusted side of the calls after warm-up.
+  template <typename HostCalls>
+  int CountSteadyStateAllocations(HostCalls host_calls) {
+    host_calls();
+    allocation_count = 0;
+    count_allocations = true;
+    for (int i = 0; i < kIterations; ++i) {
+      host_calls();
+    }
+    count_allocations = false;
+    return allocation_count;
+  }
+};
+
+// Verifies that the allocation counter observes allocations, so that the tests
+// below cannot pass vacuously.
+TEST_F(HostCallDispatcherTest, CountsAllocations) {
+  EXPECT_THAT(CountSteadyStateAllocations([] {
+                void *volatile allocation = malloc(1);
+                free(allocation);
+              }),
+              Eq(kIterations));
+}
+
+// Verifies that common system calls make no allocations on the trusted side
+// once the per-thread scratch buffers have been sized.
+TEST_F(HostCallDispatcherTest, SystemCallsDoNotAllocate) {
+  int fds[2];
+  ASSERT_THAT(pipe(fds), Eq(0));
+  int64_t pid = 0;
+  int64_t written = 0;
+  int64_t read_bytes = 0;
+  int64_t stat_result = -1;
+  int64_t clock_result = -1;
+  char buffer[64];
+
+  EXPECT_THAT(CountSteadyStateAllocations([&] {
+                pid = enc_untrusted_syscall(SYS_getpid);
+                struct stat stat_buffer;
+                stat_result =
+                    enc_untrusted_syscall(SYS_fstat, fds[0], &stat_buffer);
+                written = enc_untrusted_syscall(SYS_write, fds[1], "message",
+                                                sizeof("message"));
+                read_bytes = enc_untrusted_syscall(SYS_read, fds[0], buffer,
+                                                   sizeof(buffer));
+                struct timespec ts;
+                clock_result = enc_untrusted_syscall(SYS_clock_gettime,
+                                                     CLOCK_MONOTONIC, &ts);
+              }),
+              Eq(0));
+
+  EXPECT_THAT(pid, Eq(getpid()));
+  EXPECT_THAT(stat_result, Eq(0));
+  EXPECT_THAT(written, Eq(sizeof("message")));
+  EXPECT_THAT(read_bytes, Eq(sizeof("message")));
+  EXPECT_THAT(buffer, StrEq("message"));
+  EXPECT_THAT(clock_result, Eq(0));
+  EXPECT_THAT(enc_untrusted_syscall(SYS_close, fds[0]), Eq(0));
+  EXPECT_THAT(enc_untrusted_syscall(SYS_close, fds[1]), Eq(0));
+}
+
+// Verifies that host calls which are not system calls make no allocations on
+// the trusted side for small messages.
+TEST_F(HostCallDispatcherTest, NonSystemCallsDoNotAllocate) {
+  int result = 0;
+  EXPECT_THAT(CountSteadyStateAllocations([&result] {
+                primitives::MessageWriter input;
+                input.Push<int>(42);
+                input.PushString("payload");
+                primitives::MessageReader output;
+                if (NonSystemCallDispatcher(kIsAttyHandler, &input, &output)
+                        .ok()) {
+                  result = output.next<int>();
+                }
+              }),
+              Eq(0));
+  EXPECT_THAT(result, Eq(42));
+}
+
+// Verifies that requests and responses larger than the per-thread scratch
+// buffers spill to the heap and are still delivered intact.
+TEST_F(HostCallDispatcherTest, LargeMessagesSpillToHeap) {
+  std::vector<char> data(256 * 1024, 'x');
+  int fd = open("/dev/null", O_WRONLY);
+  ASSERT_GE(fd, 0);
+  EXPECT_THAT(enc_untrusted_syscall(SYS_write, fd, data.data(), data.size()),
+              Eq(data.size()));
+  close(fd);
+
+  std::vector<char> cwd(256 * 1024);
+  char expected[4096];
+  ASSERT_NE(getcwd(expected, sizeof(expected)), nullptr);
+  EXPECT_THAT(enc_untrusted_syscall(SYS_getcwd, cwd.data(), cwd.size()),
+              Eq(strlen(expected) + 1));
+  EXPECT_THAT(cwd.data(), StrEq(expected));
+}
+
+}  // namespace
+}  // namespace host_call
+}  // namespace asylo
@@ -1130,14 +1130,7 @@ int enc_untrusted_getaddrinfo(const char *node, const char *service,
 }
 
 void enc_freeaddrinfo(struct addrinfo *res) {
-  struct addrinfo *prev_info = nullptr;
-  for (struct addrinfo *info = res; info != nullptr; info = info->ai_next) {
-    if (prev_info) free(prev_info);
-    if (info->ai_addr) free(info->ai_addr);
-    if (info->ai_canonname) free(info->ai_canonname);
-    prev_info = info;
-  }
-  if (prev_info) free(prev_info);
+  asylo::host_call::FreeDeserializedAddrinfo(res);
 }
 
 int enc_untrusted_poll(struct pollfd *fds, nfds_t nfds, int timeout) {
@@ -1554,4 +1547,88 @@ int enc_untrusted_inotify_read(int fd, size_t count, char **serialized_events,
   return result;
 }
 
+ssize_t enc_untrusted_inotify_read_batch(int fd, void *batch,
+                                         size_t capacity) {
+  MessageWriter input;
+  input.Push<int>(fd);
+  input.Push(reinterpret_cast<uint64_t>(batch));
+  input.Push<uint64_t>(capacity);
+  MessageReader output;
+  const auto status = ::asylo::host_call::NonSystemCallDispatcher(
+      ::asylo::host_call::kInotifyReadBatchHandler, &input, &output);
+  CheckStatusAndParamCount(status, output, "enc_untrusted_inotify_read_batch",
+                           2);
+
+  int64_t result = output.next<int64_t>();
+  int klinux_errno = output.next<int>();
+  if (result == -1) {
+    errno = FromkLinuxErrorNumber(klinux_errno);
+    return -1;
+  }
+  if (result < 0 || static_cast<uint64_t>(result) > capacity) {
+    errno = EBADE;
+    return -1;
+  }
+  return result;
+}
+
+void *enc_untrusted_mmap_shared(int fd, size_t length) {
+  MessageWriter input;
+  input.Push<int>(fd);
+  input.Push<uint64_t>(length);
+  MessageReader output;
+  const auto status = ::asylo::host_call::NonSystemCallDispatcher(
+      ::asylo::host_call::kMmapSharedHandler, &input, &output);
+  CheckStatusAndParamCount(status, output, "enc_untrusted_mmap_shared", 2);
+
+  void *result = output.next<void *>();
+  int klinux_errno = output.next<int>();
+  if (!result) {
+    errno = FromkLinuxErrorNumber(klinux_errno);
+    return nullptr;
+  }
+
+  // The enclave reads and writes the mapping directly, so it must not alias
+  // trusted memory.
+  if (!TrustedPrimitives::IsOutsideEnclave(result, length)) {
+    TrustedPrimitives::BestEffortAbort(
+        "enc_untrusted_mmap_shared: mapping overlaps the enclave");
+  }
+  return result;
+}
+
+int enc_untrusted_msync(void *addr, size_t length) {
+  MessageWriter input;
+  input.Push(reinterpret_cast<uint64_t>(addr));
+  input.Push<uint64_t>(length);
+  MessageReader output;
+  const auto status = ::asylo::host_call::NonSystemCallDispatcher(
+      ::asylo::host_call::kMsyncHandler, &input, &output);
+  CheckStatusAndParamCount(status, output, "enc_untrusted_msync", 2);
+
+  int result = output.next<int>();
+  int klinux_errno = output.next<int>();
+  if (result == -1) {
+    errno = FromkLinuxErrorNumber(klinux_errno);
+  }
+  return result;
+}
+
+int enc_untrusted_munmap(void *addr, size_t length) {
+  MessageWriter input;
+  input.Push(reinterpret_cast<uint64_t>(addr));
+  input.Push<uint64_t>(length);
+  MessageReader output;
+  const auto status = ::asylo::host_call::NonSystemCallDispatcher(
+      ::asylo::host_call::kMunmapHandler, &input, &output);
+  CheckStatusAndParamCount(status, output, "enc_untrusted_munmap", 2);
+
+  int result = output.next<int>();
+  int klinux_errno = output.next<int>();
+  if (result == -1) {
+    errno = FromkLinuxErrorNumber(klinux_errno);
+  }
+  return result;
+}
+
 }  // extern "C"
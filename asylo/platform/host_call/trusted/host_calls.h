@@ -166,6 +166,19 @@ void enc_untrusted_openlog(const char *ident, int option, int facility);
 int enc_untrusted_inotify_read(int fd, size_t count, char **serialized_events,
                                size_t *serialized_events_len);
 
+// Reads the events available on the inotify file descriptor |fd| into |batch|,
+// a buffer of |capacity| bytes in untrusted memory, as a sequence of
+// klinux_inotify_event records. Returns the number of bytes written to |batch|,
+// or -1 and sets errno on failure.
+ssize_t enc_untrusted_inotify_read_batch(int fd, void *batch, size_t capacity);
+
+// Maps the first |length| bytes of the file |fd| into untrusted memory,
+// read-write and shared with the file. Returns nullptr and sets errno on
+// failure.
+void *enc_untrusted_mmap_shared(int fd, size_t length);
+int enc_untrusted_msync(void *addr, size_t length);
+int enc_untrusted_munmap(void *addr, size_t length);
+
 // Calls that are not delegated to the host are defined below.
 void enc_freeaddrinfo(struct addrinfo *res);
 void enc_freeifaddrs(struct ifaddrs *ifa);
@@ -23,8 +23,11 @@
 #include <ifaddrs.h>
 #include <net/if.h>
 #include <netdb.h>
+#include <poll.h>
 #include <pwd.h>
 #include <signal.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <syslog.h>
 #include <unistd.h>
@@ -35,6 +38,7 @@
 #include "asylo/platform/host_call/serializer_functions.h"
 #include "asylo/platform/primitives/util/message.h"
 #include "asylo/platform/primitives/util/status_conversions.h"
+#include "asylo/platform/system_call/type_conversions/types_functions.h"
 #include "asylo/platform/system_call/untrusted_invoke.h"
 #include "asylo/util/hex_util.h"
 #include "asylo/util/status_macros.h"
@@ -564,5 +568,81 @@ Status ClockGettimeHandler(const std::shared_ptr<primitives::Client> &client,
   return Status::OkStatus();
 }
 
+Status MmapSharedHandler(const std::shared_ptr<primitives::Client> &client,
+                         void *context, primitives::MessageReader *input,
+                         primitives::MessageWriter *output) {
+  ASYLO_RETURN_IF_INCORRECT_READER_ARGUMENTS(*input, 2);
+  int fd = input->next<int>();
+  size_t length = input->next<size_t>();
+  void *address =
+      mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  output->Push(
+      reinterpret_cast<uint64_t>(address == MAP_FAILED ? nullptr : address));
+  output->Push<int>(errno);
+  return Status::OkStatus();
+}
+
+Status MsyncHandler(const std::shared_ptr<primitives::Client> &client,
+                    void *context, primitives::MessageReader *input,
+                    primitives::MessageWriter *output) {
+  ASYLO_RETURN_IF_INCORRECT_READER_ARGUMENTS(*input, 2);
+  void *address = input->next<void *>();
+  size_t length = input->next<size_t>();
+  output->Push<int>(msync(address, length, MS_SYNC));
+  output->Push<int>(errno);
+  return Status::OkStatus();
+}
+
+Status MunmapHandler(const std::shared_ptr<primitives::Client> &client,
+                     void *context, primitives::MessageReader *input,
+                     primitives::MessageWriter *output) {
+  ASYLO_RETURN_IF_INCORRECT_READER_ARGUMENTS(*input, 2);
+  void *address = input->next<void *>();
+  size_t length = input->next<size_t>();
+  output->Push<int>(munmap(address, length));
+  output->Push<int>(errno);
+  return Status::OkStatus();
+}
+
+Status InotifyReadBatchHandler(
+    const std::shared_ptr<primitives::Client> &client, void *context,
+    primitives::MessageReader *input, primitives::MessageWriter *output) {
+  ASYLO_RETURN_IF_INCORRECT_READER_ARGUMENTS(*input, 3);
+  int fd = input->next<int>();
+  char *batch = input->next<char *>();
+  size_t capacity = input->next<size_t>();
+
+  // read() fails with EINVAL unless the buffer can hold the next event, so
+  // events are only drained while an event of the largest size still fits.
+  constexpr size_t kMaxEventSize = sizeof(struct inotify_event) + NAME_MAX + 1;
+  ssize_t bytes_read = read(fd, batch, capacity);
+  if (bytes_read < 0) {
+    output->Push<int64_t>(-1);
+    output->Push<int>(errno);
+    return Status::OkStatus();
+  }
+  size_t total = bytes_read;
+  struct pollfd pfd = {fd, POLLIN, 0};
+  while (capacity - total >= kMaxEventSize && poll(&pfd, 1, 0) == 1 &&
+         (pfd.revents & POLLIN)) {
+    bytes_read = read(fd, batch + total, capacity - total);
+    if (bytes_read <= 0) {
+      break;
+    }
+    total += bytes_read;
+  }
+
+  // The kernel's event layout matches klinux_inotify_event, so only the masks
+  // need converting.
+  for (size_t offset = 0; offset < total;) {
+    auto *event = reinterpret_cast<struct inotify_event *>(batch + offset);
+    event->mask = TokLinuxInotifyEventMask(event->mask);
+    offset += sizeof(struct inotify_event) + event->len;
+  }
+  output->Push<int64_t>(total);
+  output->Push<int>(0);
+  return Status::OkStatus();
+}
+
 }  // namespace host_call
 }  // namespace asylo
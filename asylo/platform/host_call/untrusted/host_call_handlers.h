@@ -215,6 +215,35 @@ Status ClockGettimeHandler(const std::shared_ptr<primitives::Client> &client,
                            void *context, primitives::MessageReader *input,
                            primitives::MessageWriter *output);
 
+// mmap library call handler on the host; maps a file shared and read-write
+// from offset zero. Expects [int fd, size_t length] and returns
+// [void *address, int errno]. |address| is null on failure.
+Status MmapSharedHandler(const std::shared_ptr<primitives::Client> &client,
+                         void *context, primitives::MessageReader *input,
+                         primitives::MessageWriter *output);
+
+// msync library call handler on the host; synchronously writes back a shared
+// mapping. Expects [void *address, size_t length] and returns [int, int errno].
+Status MsyncHandler(const std::shared_ptr<primitives::Client> &client,
+                    void *context, primitives::MessageReader *input,
+                    primitives::MessageWriter *output);
+
+// munmap library call handler on the host; expects [void *address,
+// size_t length] and returns [int, int errno].
+Status MunmapHandler(const std::shared_ptr<primitives::Client> &client,
+                     void *context, primitives::MessageReader *input,
+                     primitives::MessageWriter *output);
+
+// Handler for host call enc_untrusted_inotify_read_batch(). Expects [int fd,
+// void *batch, size_t capacity], reads the events available on |fd| directly
+// into the untrusted buffer |batch| as klinux_inotify_event records, and
+// returns [int64_t /*bytes read*/, int /*errno*/] on the MessageWriter. Blocks
+// for the first event unless |fd| is non-blocking, then drains any further
+// events without blocking while the largest possible event still fits.
+Status InotifyReadBatchHandler(
+    const std::shared_ptr<primitives::Client> &client, void *context,
+    primitives::MessageReader *input, primitives::MessageWriter *output);
+
 }  // namespace host_call
 }  // namespace asylo
 
@@ -109,6 +109,19 @@ Status AddHostCallHandlersToExitCallProvider(
   ASYLO_RETURN_IF_ERROR(exit_call_provider->RegisterExitHandler(
       kClockGettimeHandler, primitives::ExitHandler{ClockGettimeHandler}));
 
+  ASYLO_RETURN_IF_ERROR(exit_call_provider->RegisterExitHandler(
+      kMmapSharedHandler, primitives::ExitHandler{MmapSharedHandler}));
+
+  ASYLO_RETURN_IF_ERROR(exit_call_provider->RegisterExitHandler(
+      kMsyncHandler, primitives::ExitHandler{MsyncHandler}));
+
+  ASYLO_RETURN_IF_ERROR(exit_call_provider->RegisterExitHandler(
+      kMunmapHandler, primitives::ExitHandler{MunmapHandler}));
+
+  ASYLO_RETURN_IF_ERROR(exit_call_provider->RegisterExitHandler(
+      kInotifyReadBatchHandler,
+      primitives::ExitHandler{InotifyReadBatchHandler}));
+
   return Status::OkStatus();
 }
 
@@ -16,6 +16,7 @@
  *
  */
 
+#include <errno.h>
 #include <sys/epoll.h>
 #include <unistd.h>
 #include <chrono>
@@ -289,5 +290,57 @@ TEST_F(EpollTest, LevelTriggeredBehavior) { LevelEdgeBehaviorTest(false); }
 
 TEST_F(EpollTest, EdgeTriggeredBehavior) { LevelEdgeBehaviorTest(true); }
 
+// An edge-triggered registration is reported again once new data arrives, even
+// though the stream stayed readable in between.
+TEST_F(EpollTest, EdgeTriggeredReportsNewData) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  int epfd = epoll_create(1);
+  ASSERT_NE(epfd, -1);
+  struct epoll_event ev;
+  ev.events = EPOLLIN | EPOLLET;
+  ev.data.fd = fds[kRead];
+  ASSERT_NE(epoll_ctl(epfd, EPOLL_CTL_ADD, fds[kRead], &ev), -1);
+
+  struct epoll_event events[1];
+  EXPECT_THAT(WriteData(fds[kWrite], kTestString), IsOk());
+  ASSERT_EQ(epoll_wait(epfd, events, 1, 0), 1);
+  EXPECT_EQ(events[0].data.fd, fds[kRead]);
+  ASSERT_EQ(epoll_wait(epfd, events, 1, 0), 0);
+
+  EXPECT_THAT(WriteData(fds[kWrite], kTestString), IsOk());
+  ASSERT_EQ(epoll_wait(epfd, events, 1, 0), 1);
+  EXPECT_EQ(events[0].data.fd, fds[kRead]);
+  ASSERT_EQ(epoll_wait(epfd, events, 1, 0), 0);
+
+  // Modifying the registration rearms it.
+  ASSERT_NE(epoll_ctl(epfd, EPOLL_CTL_MOD, fds[kRead], &ev), -1);
+  ASSERT_EQ(epoll_wait(epfd, events, 1, 0), 1);
+
+  ASSERT_EQ(close(epfd), 0);
+  ASSERT_EQ(close(fds[kRead]), 0);
+  ASSERT_EQ(close(fds[kWrite]), 0);
+}
+
+TEST_F(EpollTest, EpollCtlRequiresEvent) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  int epfd = epoll_create(1);
+  ASSERT_NE(epfd, -1);
+  EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, fds[kRead], nullptr), -1);
+  EXPECT_EQ(errno, EFAULT);
+
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = fds[kRead];
+  ASSERT_NE(epoll_ctl(epfd, EPOLL_CTL_ADD, fds[kRead], &ev), -1);
+  EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, fds[kRead], nullptr), -1);
+  EXPECT_EQ(errno, EFAULT);
+
+  ASSERT_EQ(close(epfd), 0);
+  ASSERT_EQ(close(fds[kRead]), 0);
+  ASSERT_EQ(close(fds[kWrite]), 0);
+}
+
 }  // namespace
 }  // namespace asylo
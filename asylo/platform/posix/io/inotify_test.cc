@@ -17,9 +17,11 @@
  */
 #include <fcntl.h>
 #include <limits.h>
+#include <poll.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/inotify.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <chrono>
@@ -38,6 +40,9 @@ const char *str = "Testing inotify.";
 constexpr size_t kSleepDur = 100;
 constexpr size_t kEventBufSize = 4096;
 
+// Number of events generated by the burst test.
+constexpr int kBurstEvents = 2000;
+
 class InotifyTest : public ::testing::Test {
  protected:
   InotifyTest() {
@@ -218,11 +223,8 @@ TEST_F(InotifyTest, EventsQueued) {
   size_t len = strlen(str);
   EXPECT_EQ(write(fd1_, str, len), len);
   EXPECT_EQ(close(fd1_), 0);
-  // This buffer can accommodate only one event. However, the enclave version
-  // creates a buffer of size sizeof(struct inotify_event) + NAME_MAX + 1, which
-  // can accommodate multiple events. Thus, the enclave will be forced to queue
-  // up some events. We are required to read from infd_ multiple times to
-  // register all of the events.
+  // This buffer can accommodate only one event, so we are required to read
+  // from infd_ multiple times to register all of the events.
   char buf[sizeof(struct inotify_event)];
   // Check to see if the events are registered by inotify.
   ASSERT_GT(read(infd_, buf, sizeof(buf)), 0);
@@ -253,5 +255,69 @@ TEST_F(InotifyTest, BufferTooSmall) {
   CloseFds();
 }
 
+// Events left unread after a partial read must keep the descriptor readable.
+TEST_F(InotifyTest, PollAfterPartialRead) {
+  int wd1 =
+      inotify_add_watch(infd_, file1_.c_str(), IN_MODIFY | IN_CLOSE_WRITE);
+  ASSERT_GT(wd1, 0);
+  size_t len = strlen(str);
+  EXPECT_EQ(write(fd1_, str, len), len);
+  EXPECT_EQ(close(fd1_), 0);
+  char buf[sizeof(struct inotify_event)];
+  ASSERT_EQ(read(infd_, buf, sizeof(buf)), sizeof(buf));
+  struct inotify_event *event = reinterpret_cast<struct inotify_event *>(buf);
+  EXPECT_TRUE(event->mask & IN_MODIFY);
+
+  struct pollfd pfd = {infd_, POLLIN, 0};
+  ASSERT_EQ(poll(&pfd, 1, /*timeout=*/1000), 1);
+  EXPECT_TRUE(pfd.revents & POLLIN);
+  ASSERT_EQ(read(infd_, buf, sizeof(buf)), sizeof(buf));
+  event = reinterpret_cast<struct inotify_event *>(buf);
+  EXPECT_TRUE(event->mask & IN_CLOSE_WRITE);
+
+  pfd.revents = 0;
+  EXPECT_EQ(poll(&pfd, 1, /*timeout=*/0), 0);
+  close(fd2_);
+  close(fd3_);
+  close(infd_);
+}
+
+// Creates a burst of files in a watched directory and verifies that every
+// resulting event is read back, across several batched reads.
+TEST_F(InotifyTest, ReadsBurstOfEvents) {
+  std::string dir = absl::StrCat(absl::GetFlag(FLAGS_test_tmpdir), "/burst");
+  ASSERT_TRUE(mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST);
+  int wd = inotify_add_watch(infd_, dir.c_str(), IN_CREATE);
+  ASSERT_GT(wd, 0);
+  for (int i = 0; i < kBurstEvents; ++i) {
+    int fd = open(absl::StrCat(dir, "/file", i).c_str(), O_CREAT | O_WRONLY,
+                  0644);
+    ASSERT_GE(fd, 0);
+    close(fd);
+  }
+
+  char buf[kEventBufSize];
+  int events = 0;
+  while (events < kBurstEvents) {
+    ssize_t bytes_read = read(infd_, buf, sizeof(buf));
+    ASSERT_GT(bytes_read, 0);
+    for (char *curr_event_ptr = buf; curr_event_ptr < buf + bytes_read;) {
+      struct inotify_event *curr_event =
+          reinterpret_cast<struct inotify_event *>(curr_event_ptr);
+      EXPECT_EQ(curr_event->wd, wd);
+      EXPECT_TRUE(curr_event->mask & IN_CREATE);
+      curr_event_ptr += sizeof(struct inotify_event) + curr_event->len;
+      ++events;
+    }
+  }
+  EXPECT_EQ(events, kBurstEvents);
+
+  for (int i = 0; i < kBurstEvents; ++i) {
+    remove(absl::StrCat(dir, "/file", i).c_str());
+  }
+  rmdir(dir.c_str());
+  CloseFds();
+}
+
 }  // namespace
 }  // namespace asylo
@@ -19,15 +19,55 @@
 
 #include <errno.h>
 #include <openssl/rand.h>
+#include <poll.h>
 #include <stdint.h>
 
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "asylo/platform/host_call/trusted/host_calls.h"
 
 namespace asylo {
 namespace io {
 
+namespace {
+
+// The host epoll key of the wakeup pipe. Keys of host file descriptors are
+// random and never take this value.
+constexpr uint64_t kWakeupKey = 0;
+
+// Translates poll(2) event flags, as returned by IOContext::PollEvents(), to
+// epoll event flags.
+uint32_t PollToEpollEvents(int poll_events) {
+  uint32_t events = 0;
+  if (poll_events & POLLIN) events |= EPOLLIN;
+  if (poll_events & POLLPRI) events |= EPOLLPRI;
+  if (poll_events & POLLOUT) events |= EPOLLOUT;
+  if (poll_events & POLLERR) events |= EPOLLERR;
+  if (poll_events & POLLHUP) events |= EPOLLHUP;
+  if (poll_events & POLLRDHUP) events |= EPOLLRDHUP;
+  return events;
+}
+
+// Translates epoll event flags to poll(2) event flags.
+int EpollToPollEvents(uint32_t epoll_events) {
+  int events = 0;
+  if (epoll_events & EPOLLIN) events |= POLLIN;
+  if (epoll_events & EPOLLPRI) events |= POLLPRI;
+  if (epoll_events & EPOLLOUT) events |= POLLOUT;
+  if (epoll_events & EPOLLERR) events |= POLLERR;
+  if (epoll_events & EPOLLHUP) events |= POLLHUP;
+  if (epoll_events & EPOLLRDHUP) events |= POLLRDHUP;
+  return events;
+}
+
+}  // namespace
+
 int IOContextEpoll::EpollCtl(int op, int hostfd, struct epoll_event *event) {
+  if ((op == EPOLL_CTL_ADD || op == EPOLL_CTL_MOD) && !event) {
+    errno = EFAULT;
+    return -1;
+  }
   struct epoll_event event_copy;
   if (event) {
     event_copy.events = event->events;
@@ -40,7 +80,7 @@ int IOContextEpoll::EpollCtl(int op, int hostfd, struct epoll_event *event) {
         errno = EBADE;
         return -1;
       }
-    } while (key_to_data.find(key) != key_to_data.end());
+    } while (key == kWakeupKey || key_to_data.find(key) != key_to_data.end());
     key_to_data[key] = event->data.u64;
     fd_to_key[hostfd] = key;
     event_copy.data.u64 = key;
@@ -67,8 +107,116 @@ int IOContextEpoll::EpollCtl(int op, int hostfd, struct epoll_event *event) {
   return enc_untrusted_epoll_ctl(host_fd_, op, hostfd, &event_copy);
 }
 
+int IOContextEpoll::EpollCtl(int op, int fd, std::shared_ptr<IOContext> context,
+                             struct epoll_event *event) {
+  if (context->PollEvents() < 0) {
+    // As with regular files on Linux, streams without readiness cannot be
+    // watched.
+    errno = EPERM;
+    return -1;
+  }
+  if ((op == EPOLL_CTL_ADD || op == EPOLL_CTL_MOD) && !event) {
+    errno = EFAULT;
+    return -1;
+  }
+  {
+    absl::MutexLock lock(&virtual_mutex_);
+    auto it = virtual_fds_.find(fd);
+    if (op == EPOLL_CTL_ADD) {
+      if (it != virtual_fds_.end()) {
+        errno = EEXIST;
+        return -1;
+      }
+      virtual_fds_[fd] = {context, event->events, event->data.u64, false,
+                          false, 0};
+      context->AddReadinessWaiter(waiter_);
+    } else if (op == EPOLL_CTL_MOD) {
+      if (it == virtual_fds_.end()) {
+        errno = ENOENT;
+        return -1;
+      }
+      it->second.events = event->events;
+      it->second.data = event->data.u64;
+      it->second.disabled = false;
+      it->second.reported = false;
+    } else if (op == EPOLL_CTL_DEL) {
+      if (it == virtual_fds_.end()) {
+        errno = ENOENT;
+        return -1;
+      }
+      context->RemoveReadinessWaiter(waiter_.get());
+      virtual_fds_.erase(it);
+    } else {
+      errno = EINVAL;
+      return -1;
+    }
+  }
+  // Let blocked waits pick up the new interest set.
+  waiter_->Notify();
+  return 0;
+}
+
 int IOContextEpoll::EpollWait(struct epoll_event *events, int maxevents,
                               int timeout) {
+  if (maxevents <= 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  {
+    absl::MutexLock lock(&virtual_mutex_);
+    if (virtual_fds_.empty()) {
+      return HostEpollWait(events, maxevents, timeout);
+    }
+  }
+
+  absl::Time deadline = TimeoutToDeadline(timeout);
+  while (true) {
+    uint64_t generation = waiter_->generation();
+    int ready = CollectVirtualEvents(events, maxevents);
+    if (ready > 0) {
+      // Report host file descriptors that are also ready, without blocking.
+      if (ready < maxevents && !fd_to_key.empty()) {
+        int host_ready = HostEpollWait(events + ready, maxevents - ready, 0);
+        if (host_ready > 0) ready += host_ready;
+      }
+      return ready;
+    }
+
+    if (fd_to_key.empty()) {
+      // Only enclave-virtual streams are watched, so wait without exiting.
+      if (!waiter_->Wait(generation, deadline)) return 0;
+      continue;
+    }
+
+    // Wait on the host, with the wakeup pipe in the host epoll set so that a
+    // readiness change inside the enclave interrupts the wait.
+    if (!wakeup_registered_) {
+      int wakeup_fd = waiter_->GetHostWakeupFd();
+      if (wakeup_fd == -1) return -1;
+      struct epoll_event wakeup_event;
+      wakeup_event.events = EPOLLIN;
+      wakeup_event.data.u64 = kWakeupKey;
+      if (enc_untrusted_epoll_ctl(host_fd_, EPOLL_CTL_ADD, wakeup_fd,
+                                  &wakeup_event) == -1 &&
+          errno != EEXIST) {
+        return -1;
+      }
+      wakeup_registered_ = true;
+    }
+    waiter_->BeginHostWait();
+    int host_ready = 0;
+    if (waiter_->generation() == generation) {
+      host_ready =
+          HostEpollWait(events, maxevents, DeadlineToTimeout(deadline));
+    }
+    waiter_->EndHostWait();
+    if (host_ready != 0) return host_ready;
+    if (absl::Now() >= deadline) return 0;
+  }
+}
+
+int IOContextEpoll::HostEpollWait(struct epoll_event *events, int maxevents,
+                                  int timeout) {
   int ret = enc_untrusted_epoll_wait(host_fd_, events, maxevents, timeout);
   if (ret == -1) {
     // errno is set in enc_untrusted_epoll_wait.
@@ -76,15 +224,58 @@ int IOContextEpoll::EpollWait(struct epoll_event *events, int maxevents,
   }
   // Convert the random bits in the data field back to the original data using
   // the key_to_data map.
+  int count = 0;
   for (int i = 0; i < ret; ++i) {
     uint64_t key = events[i].data.u64;
+    if (key == kWakeupKey) continue;
     if (key_to_data.find(key) == key_to_data.end()) {
       errno = EBADE;
       return -1;
     }
-    events[i].data.u64 = key_to_data[key];
+    events[count].events = events[i].events;
+    events[count].data.u64 = key_to_data[key];
+    ++count;
+  }
+  return count;
+}
+
+int IOContextEpoll::CollectVirtualEvents(struct epoll_event *events,
+                                         int maxevents) {
+  absl::MutexLock lock(&virtual_mutex_);
+  int count = 0;
+  for (auto it = virtual_fds_.begin();
+       it != virtual_fds_.end() && count < maxevents;) {
+    VirtualRegistration &registration = it->second;
+    std::shared_ptr<IOContext> context = registration.context.lock();
+    if (!context) {
+      // The stream was destroyed, which implicitly removes it.
+      virtual_fds_.erase(it++);
+      continue;
+    }
+    // Read the generation before the events, so that a change racing with
+    // this check is reported by the next one.
+    uint64_t generation = context->ReadinessGeneration(
+        EpollToPollEvents(registration.events | EPOLLERR | EPOLLHUP));
+    bool edge_triggered = registration.events & EPOLLET;
+    uint32_t ready = 0;
+    if (!registration.disabled &&
+        !(edge_triggered && registration.reported &&
+          registration.reported_generation == generation)) {
+      // EPOLLERR and EPOLLHUP are always reported.
+      ready = PollToEpollEvents(context->PollEvents()) &
+              (registration.events | EPOLLERR | EPOLLHUP);
+    }
+    if (ready) {
+      events[count].events = ready;
+      events[count].data.u64 = registration.data;
+      ++count;
+      if (registration.events & EPOLLONESHOT) registration.disabled = true;
+      registration.reported = true;
+      registration.reported_generation = generation;
+    }
+    ++it;
   }
-  return ret;
+  return count;
 }
 
 int IOContextEpoll::GetHostFileDescriptor() { return host_fd_; }
@@ -100,7 +291,17 @@ ssize_t IOContextEpoll::Write(const void *buf, size_t count) {
   return -1;
 }
 
-int IOContextEpoll::Close() { return enc_untrusted_close(host_fd_); }
+int IOContextEpoll::Close() {
+  {
+    absl::MutexLock lock(&virtual_mutex_);
+    for (const auto &entry : virtual_fds_) {
+      std::shared_ptr<IOContext> context = entry.second.context.lock();
+      if (context) context->RemoveReadinessWaiter(waiter_.get());
+    }
+    virtual_fds_.clear();
+  }
+  return enc_untrusted_close(host_fd_);
+}
 
 }  // namespace io
 }  // namespace asylo
@@ -19,18 +19,32 @@
 #ifndef ASYLO_PLATFORM_POSIX_IO_IO_CONTEXT_EPOLL_H_
 #define ASYLO_PLATFORM_POSIX_IO_IO_CONTEXT_EPOLL_H_
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "asylo/platform/posix/io/io_manager.h"
+#include "asylo/platform/posix/io/readiness.h"
 
 namespace asylo {
 namespace io {
-// IOContext implementation wrapping an epoll file descriptor
+// IOContext implementation wrapping an epoll file descriptor. Host file
+// descriptors are watched by the host epoll instance. Enclave-virtual streams
+// are watched inside the enclave through their readiness notifications, and a
+// host wakeup pipe in the host epoll set interrupts a host wait when one of
+// them becomes ready.
 class IOContextEpoll : public IOManager::IOContext {
  public:
-  explicit IOContextEpoll(int host_fd) : host_fd_(host_fd) {}
+  explicit IOContextEpoll(int host_fd)
+      : host_fd_(host_fd), waiter_(std::make_shared<ReadinessWaiter>()) {}
   // It's important to note that adding dup'd file descriptors here won't work
   // the same as it would in POSIX.
   int EpollCtl(int op, int hostfd, struct epoll_event *event) override;
+  int EpollCtl(int op, int fd, std::shared_ptr<IOContext> context,
+               struct epoll_event *event) override;
   int EpollWait(struct epoll_event *events, int maxevents,
                 int timeout) override;
   int GetHostFileDescriptor() override;
@@ -39,12 +53,45 @@ class IOContextEpoll : public IOManager::IOContext {
   int Close();
 
  private:
+  // An enclave-virtual stream registered with this epoll instance.
+  struct VirtualRegistration {
+    std::weak_ptr<IOContext> context;
+    uint32_t events;
+    uint64_t data;
+    // Set once an EPOLLONESHOT registration has been reported.
+    bool disabled;
+    // Whether an EPOLLET registration has been reported since it was added or
+    // modified, and the ReadinessGeneration() of the stream when it was. It is
+    // only reported again once the generation advances.
+    bool reported;
+    uint64_t reported_generation;
+  };
+
+  // Waits on the host epoll instance and translates the returned keys,
+  // dropping wakeup events.
+  int HostEpollWait(struct epoll_event *events, int maxevents, int timeout);
+
+  // Fills |events| with the ready enclave-virtual streams and returns how many
+  // there are.
+  int CollectVirtualEvents(struct epoll_event *events, int maxevents);
+
   // Host file descriptor implementing this stream.
   int host_fd_;
   absl::flat_hash_map<uint64_t, uint64_t> key_to_data;
   // Manages a mapping from the host file descriptor to a random key to enable
   // updates to the above map durring deletions/modifications.
   absl::flat_hash_map<int, uint64_t> fd_to_key;
+
+  // Enclave-virtual streams, keyed by enclave file descriptor.
+  absl::Mutex virtual_mutex_;
+  absl::flat_hash_map<int, VirtualRegistration> virtual_fds_
+      ABSL_GUARDED_BY(virtual_mutex_);
+
+  // Notified by the enclave-virtual streams registered above.
+  const std::shared_ptr<ReadinessWaiter> waiter_;
+
+  // Whether the wakeup pipe of |waiter_| is in the host epoll set.
+  std::atomic<bool> wakeup_registered_{false};
 };
 
 }  // namespace io
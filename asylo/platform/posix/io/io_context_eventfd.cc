@@ -17,6 +17,8 @@
  */
 #include "asylo/platform/posix/io/io_context_eventfd.h"
 
+#include <poll.h>
+
 constexpr uint64_t kMaxCounter = 0xfffffffffffffffe;
 constexpr ssize_t kCounterBufSize = sizeof(uint64_t);
 
@@ -28,21 +30,26 @@ ssize_t IOContextEventFd::Read(void *buf, size_t count) {
     errno = EINVAL;
     return -1;
   }
-  absl::MutexLock counter_mutex_lock(&counter_mutex_);
-  if (nonblock_ && (counter_ == 0)) {
-    errno = EAGAIN;
-    return -1;
-  } else {
-    auto ready = [this]() { return counter_ > 0; };
-    counter_mutex_.Await(absl::Condition(&ready));
-  }
-  if (semaphore_) {
-    *reinterpret_cast<uint64_t *>(buf) = 1;
-    --counter_;
-  } else {
-    *reinterpret_cast<uint64_t *>(buf) = counter_;
-    counter_ = 0;
+  {
+    absl::MutexLock counter_mutex_lock(&counter_mutex_);
+    if (nonblock_ && (counter_ == 0)) {
+      errno = EAGAIN;
+      return -1;
+    } else {
+      auto ready = [this]() { return counter_ > 0; };
+      counter_mutex_.Await(absl::Condition(&ready));
+    }
+    if (semaphore_) {
+      *reinterpret_cast<uint64_t *>(buf) = 1;
+      --counter_;
+    } else {
+      *reinterpret_cast<uint64_t *>(buf) = counter_;
+      counter_ = 0;
+    }
+    ++writable_generation_;
   }
+  // Notify() may exit the enclave, so it is called without the counter lock.
+  notifier_.Notify();
   return kCounterBufSize;
 }
 
@@ -56,15 +63,19 @@ ssize_t IOContextEventFd::Write(const void *buf, size_t count) {
     errno = EINVAL;
     return -1;
   }
-  absl::MutexLock counter_mutex_lock(&counter_mutex_);
-  if (nonblock_ && (counter_ + add > kMaxCounter)) {
-    errno = EAGAIN;
-    return -1;
-  } else {
-    auto ready = [this, add]() { return (counter_ + add) <= kMaxCounter; };
-    counter_mutex_.Await(absl::Condition(&ready));
+  {
+    absl::MutexLock counter_mutex_lock(&counter_mutex_);
+    if (nonblock_ && (counter_ + add > kMaxCounter)) {
+      errno = EAGAIN;
+      return -1;
+    } else {
+      auto ready = [this, add]() { return (counter_ + add) <= kMaxCounter; };
+      counter_mutex_.Await(absl::Condition(&ready));
+    }
+    counter_ += add;
+    ++readable_generation_;
   }
-  counter_ += add;
+  notifier_.Notify();
   return kCounterBufSize;
 }
 
@@ -72,5 +83,30 @@ int IOContextEventFd::Close() {
   return 0;
 }
 
+int IOContextEventFd::PollEvents() {
+  absl::MutexLock counter_mutex_lock(&counter_mutex_);
+  int events = 0;
+  if (counter_ > 0) events |= POLLIN | POLLRDNORM;
+  if (counter_ < kMaxCounter) events |= POLLOUT | POLLWRNORM;
+  return events;
+}
+
+void IOContextEventFd::AddReadinessWaiter(
+    const std::shared_ptr<ReadinessWaiter> &waiter) {
+  notifier_.AddWaiter(waiter);
+}
+
+void IOContextEventFd::RemoveReadinessWaiter(const ReadinessWaiter *waiter) {
+  notifier_.RemoveWaiter(waiter);
+}
+
+uint64_t IOContextEventFd::ReadinessGeneration(int events) {
+  absl::MutexLock counter_mutex_lock(&counter_mutex_);
+  uint64_t generation = 0;
+  if (events & POLLIN) generation += readable_generation_;
+  if (events & POLLOUT) generation += writable_generation_;
+  return generation;
+}
+
 }  // namespace io
 }  // namespace asylo
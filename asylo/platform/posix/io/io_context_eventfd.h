@@ -25,6 +25,7 @@
 
 #include "absl/synchronization/mutex.h"
 #include "asylo/platform/posix/io/io_manager.h"
+#include "asylo/platform/posix/io/readiness.h"
 
 namespace asylo {
 namespace io {
@@ -48,6 +49,11 @@ class IOContextEventFd : public IOManager::IOContext {
   ssize_t Read(void *buf, size_t count) override;
   ssize_t Write(const void *buf, size_t count) override;
   int Close() override;
+  int PollEvents() override;
+  void AddReadinessWaiter(
+      const std::shared_ptr<ReadinessWaiter> &waiter) override;
+  void RemoveReadinessWaiter(const ReadinessWaiter *waiter) override;
+  uint64_t ReadinessGeneration(int events) override;
 
  private:
   // Host file descriptor implementing this stream.
@@ -55,6 +61,11 @@ class IOContextEventFd : public IOManager::IOContext {
   bool semaphore_;
   bool nonblock_;
   absl::Mutex counter_mutex_;
+  // Advanced by writes, which may make the counter readable, and by reads,
+  // which may make it writable.
+  uint64_t readable_generation_ = 0;
+  uint64_t writable_generation_ = 0;
+  ReadinessNotifier notifier_;
 };
 
 }  // namespace io
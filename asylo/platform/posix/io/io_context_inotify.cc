@@ -17,15 +17,26 @@
  */
 #include "asylo/platform/posix/io/io_context_inotify.h"
 
+#include <errno.h>
 #include <sys/inotify.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include "asylo/platform/common/memory.h"
 #include "asylo/platform/host_call/serializer_functions.h"
 #include "asylo/platform/host_call/trusted/host_calls.h"
+#include "asylo/platform/primitives/trusted_primitives.h"
+#include "asylo/platform/system_call/type_conversions/types.h"
+#include "asylo/platform/system_call/type_conversions/types_functions.h"
 
 namespace asylo {
 namespace io {
 
+using primitives::TrustedPrimitives;
+
+IOContextInotify::~IOContextInotify() { FreeBatch(); }
+
 int IOContextInotify::GetHostFileDescriptor() { return host_fd_; }
 
 int IOContextInotify::InotifyAddWatch(const char *pathname, uint32_t mask) {
@@ -36,6 +47,47 @@ int IOContextInotify::InotifyRmWatch(int wd) {
   return enc_untrusted_inotify_rm_watch(host_fd_, wd);
 }
 
+ssize_t IOContextInotify::TransferFromBatchToBuffer(char *buf_ptr,
+                                                    size_t count) {
+  size_t num_bytes_written = 0;
+  while (batch_offset_ < batch_size_) {
+    // The batch lives in untrusted memory, so each event header is copied in
+    // before it is validated and used.
+    const char *event_ptr = batch_ + batch_offset_;
+    size_t remaining = batch_size_ - batch_offset_;
+    struct klinux_inotify_event header;
+    if (remaining < sizeof(header)) {
+      batch_offset_ = batch_size_;
+      errno = EBADE;
+      return -1;
+    }
+    memcpy(&header, event_ptr, sizeof(header));
+    if (header.klinux_len > remaining - sizeof(header)) {
+      batch_offset_ = batch_size_;
+      errno = EBADE;
+      return -1;
+    }
+
+    size_t event_len = sizeof(struct inotify_event) + header.klinux_len;
+    if (count < event_len) {
+      break;
+    }
+    struct inotify_event event;
+    event.wd = header.klinux_wd;
+    event.mask = FromkLinuxInotifyEventMask(header.klinux_mask);
+    event.cookie = header.klinux_cookie;
+    event.len = header.klinux_len;
+    memcpy(buf_ptr, &event, sizeof(event));
+    memcpy(buf_ptr + sizeof(event), event_ptr + sizeof(header), event.len);
+
+    buf_ptr += event_len;
+    num_bytes_written += event_len;
+    count -= event_len;
+    batch_offset_ += sizeof(header) + header.klinux_len;
+  }
+  return num_bytes_written;
+}
+
 size_t IOContextInotify::TransferFromQueueToBuffer(char *buf_ptr,
                                                    size_t count) {
   size_t num_bytes_written = 0;
@@ -56,11 +108,49 @@ size_t IOContextInotify::TransferFromQueueToBuffer(char *buf_ptr,
 }
 
 ssize_t IOContextInotify::Read(void *buf, size_t count) {
+  if (!batch_ && !batch_unavailable_) {
+    batch_ = static_cast<char *>(
+        TrustedPrimitives::UntrustedLocalAlloc(kBatchCapacity));
+    batch_unavailable_ = batch_ == nullptr;
+  }
+  if (batch_unavailable_) {
+    return ReadQueued(buf, count);
+  }
+
+  if (count == 0) {
+    return 0;
+  }
+
+  // Have the host drain no more than |count| bytes. Events take the same space
+  // in the batch as in |buf|, so the whole batch is copied out below, and any
+  // events still pending keep the host file descriptor readable. The host
+  // fails with EINVAL if the first event does not fit.
+  ssize_t batch_size = enc_untrusted_inotify_read_batch(
+      host_fd_, batch_, std::min(count, kBatchCapacity));
+  if (batch_size < 0) {
+    // errno is set by enc_untrusted_inotify_read_batch.
+    return -1;
+  }
+  batch_size_ = batch_size;
+  batch_offset_ = 0;
+  ssize_t num_bytes_written =
+      TransferFromBatchToBuffer(static_cast<char *>(buf), count);
+  if (num_bytes_written >= 0 && batch_offset_ < batch_size_) {
+    // The host returned events that do not fit in |buf|.
+    batch_offset_ = batch_size_;
+    errno = EBADE;
+    return -1;
+  }
+  return num_bytes_written;
+}
+
+ssize_t IOContextInotify::ReadQueued(void *buf, size_t count) {
   // Remove events from queue, if there are any.
   char *buf_ptr = static_cast<char *>(buf);
   size_t num_bytes_written = TransferFromQueueToBuffer(buf_ptr, count);
   buf_ptr += num_bytes_written;
-  count -= num_bytes_written;  if (!event_queue_.empty() && (num_bytes_written == 0)) {
+  count -= num_bytes_written;
+  if (!event_queue_.empty() && (num_bytes_written == 0)) {
     errno = EINVAL;
     return -1;
   } else if (!event_queue_.empty() || count == 0) {
@@ -96,7 +186,19 @@ ssize_t IOContextInotify::Write(const void *buf, size_t count) {
   return -1;
 }
 
-int IOContextInotify::Close() { return enc_untrusted_close(host_fd_); }
+int IOContextInotify::Close() {
+  FreeBatch();
+  return enc_untrusted_close(host_fd_);
+}
+
+void IOContextInotify::FreeBatch() {
+  if (batch_) {
+    TrustedPrimitives::UntrustedLocalFree(batch_);
+    batch_ = nullptr;
+  }
+  batch_size_ = 0;
+  batch_offset_ = 0;
+}
 
 }  // namespace io
 }  // namespace asylo
@@ -21,15 +21,26 @@
 
 #include <sys/inotify.h>
 
+#include <cstddef>
 #include <queue>
+
 #include "asylo/platform/posix/io/io_manager.h"
 
 namespace asylo {
 namespace io {
-// IOContext implementation wrapping an epoll file descriptor
+// IOContext implementation wrapping an inotify file descriptor. Events are read
+// from the host in bulk into a batch buffer in untrusted memory, which the host
+// drains the inotify file descriptor into. Each read drains no more than the
+// caller asked for, so events are never held in the enclave between reads,
+// where polling the host file descriptor would not see them.
 class IOContextInotify : public IOManager::IOContext {
  public:
+  // Capacity of the untrusted batch buffer the host drains events into, which
+  // bounds the bytes returned by one read.
+  static constexpr size_t kBatchCapacity = 64 * 1024;
+
   explicit IOContextInotify(int host_fd) : host_fd_(host_fd) {}
+  ~IOContextInotify() override;
   // It's important to note that adding dup'd file descriptors here won't work
   // the same as it would in POSIX.
   int GetHostFileDescriptor() override;
@@ -40,9 +51,32 @@ class IOContextInotify : public IOManager::IOContext {
   int Close() override;
 
  private:
+  // Copies whole events from the batch buffer into |buf_ptr|, which has room
+  // for |count| bytes, and returns the number of bytes copied. Returns -1 and
+  // sets errno if the batch holds a malformed event, discarding the batch.
+  ssize_t TransferFromBatchToBuffer(char *buf_ptr, size_t count);
+
+  // Reads events through enc_untrusted_inotify_read() and the event queue,
+  // used if the batch buffer cannot be allocated.
+  ssize_t ReadQueued(void *buf, size_t count);
   size_t TransferFromQueueToBuffer(char *buf_ptr, size_t count);
+
+  void FreeBatch();
+
   // Host file descriptor implementing this stream.
   int host_fd_;
+
+  // Batch buffer in untrusted memory, holding |batch_size_| bytes of
+  // klinux_inotify_event records of which the first |batch_offset_| bytes have
+  // been consumed. The batch is always consumed in full by the read that
+  // filled it.
+  char *batch_ = nullptr;
+  size_t batch_size_ = 0;
+  size_t batch_offset_ = 0;
+
+  // Whether allocating the batch buffer failed, in which case events are read
+  // through |event_queue_|.
+  bool batch_unavailable_ = false;
   std::queue<struct inotify_event *> event_queue_;
 };
 
@@ -0,0 +1,573 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/posix/io/io_context_pipe.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "asylo/platform/posix/io/readiness.h"
+
+namespace asylo {
+namespace io {
+namespace {
+
+constexpr size_t kPageSize = 4096;
+
+}  // namespace
+
+// A ring buffer of bytes with one reading end and one writing end. Storage is
+// allocated lazily and doubled as needed up to |capacity_|, so idle pipes cost
+// little enclave memory. In packet mode (O_DIRECT), each write of up to
+// PIPE_BUF bytes is a packet, and each read consumes at most one packet.
+class PipeBuffer {
+ public:
+  explicit PipeBuffer(bool packet_mode)
+      : packet_mode_(packet_mode),
+        capacity_(IOContextPipe::kDefaultPipeSize),
+        head_(0),
+        size_(0),
+        reader_open_(true),
+        writer_open_(true) {}
+
+  bool packet_mode() const { return packet_mode_; }
+
+  // Reads up to |count| bytes into |buf|. Blocks until data is available unless
+  // |nonblock| is set. Returns 0 at end-of-file.
+  ssize_t Read(void *buf, size_t count, bool nonblock) {
+    if (count == 0) return 0;
+    size_t length;
+    {
+      absl::MutexLock lock(&mu_);
+      if (size_ == 0 && writer_open_) {
+        if (nonblock) {
+          errno = EAGAIN;
+          return -1;
+        }
+        mu_.Await(absl::Condition(this, &PipeBuffer::ReadableLocked));
+      }
+      if (size_ == 0) return 0;
+
+      length = std::min(count, size_);
+      size_t consumed = length;
+      if (packet_mode_) {
+        consumed = packets_.front();
+        packets_.pop_front();
+        length = std::min(count, consumed);
+      }
+      CopyOutLocked(static_cast<char *>(buf), length);
+      head_ = (head_ + consumed) % storage_.size();
+      size_ -= consumed;
+      ++writer_generation_;
+    }
+    notifier_.Notify();
+    return length;
+  }
+
+  // Writes |count| bytes from |buf|. Writes of at most PIPE_BUF bytes are
+  // atomic. Blocks until all data is written unless |nonblock| is set, in which
+  // case as much as fits is written. Fails with EPIPE if the reader is closed.
+  ssize_t Write(const void *buf, size_t count, bool nonblock) {
+    if (count == 0) return 0;
+    const char *data = static_cast<const char *>(buf);
+    mu_.Lock();
+    size_t written = 0;
+    size_t notified = 0;
+    while (written < count && reader_open_) {
+      // Writes of at most PIPE_BUF bytes, and each packet in packet mode, are
+      // written in one piece. Larger stream writes may be split.
+      size_t remaining = count - written;
+      size_t needed = packet_mode_ ? std::min<size_t>(remaining, PIPE_BUF)
+                                   : (count <= PIPE_BUF ? remaining : 1);
+      if (capacity_ - size_ < needed) {
+        if (nonblock) break;
+        // Let pollers of the read end see what has been written so far, then
+        // check for space again, since |mu_| is released to notify them.
+        if (written > notified) {
+          ++reader_generation_;
+          notified = written;
+          mu_.Unlock();
+          notifier_.Notify();
+          mu_.Lock();
+          continue;
+        }
+        auto writable = [this, needed] {
+          return capacity_ - size_ >= needed || !reader_open_;
+        };
+        mu_.Await(absl::Condition(&writable));
+        continue;
+      }
+      size_t chunk =
+          packet_mode_ ? needed : std::min(remaining, capacity_ - size_);
+      CopyInLocked(data + written, chunk);
+      if (packet_mode_) packets_.push_back(chunk);
+      written += chunk;
+    }
+    if (written > notified) ++reader_generation_;
+    bool reader_open = reader_open_;
+    mu_.Unlock();
+    if (written > 0) {
+      if (written > notified) notifier_.Notify();
+      return written;
+    }
+    errno = reader_open ? EAGAIN : EPIPE;
+    return -1;
+  }
+
+  // Returns the number of bytes the buffer can hold.
+  size_t capacity() {
+    absl::MutexLock lock(&mu_);
+    return capacity_;
+  }
+
+  // Implements F_SETPIPE_SZ.
+  int SetCapacity(int64_t size) {
+    if (size < 0) {
+      errno = EINVAL;
+      return -1;
+    }
+    size_t capacity = std::max<size_t>(
+        (size + kPageSize - 1) / kPageSize * kPageSize, kPageSize);
+    if (capacity > IOContextPipe::kMaxPipeSize) {
+      errno = EPERM;
+      return -1;
+    }
+    {
+      absl::MutexLock lock(&mu_);
+      if (capacity < size_) {
+        errno = EBUSY;
+        return -1;
+      }
+      if (storage_.size() > capacity) ResizeLocked(capacity);
+      capacity_ = capacity;
+      ++writer_generation_;
+    }
+    notifier_.Notify();
+    return capacity;
+  }
+
+  void CloseReader() {
+    {
+      absl::MutexLock lock(&mu_);
+      reader_open_ = false;
+      ++reader_generation_;
+      ++writer_generation_;
+    }
+    notifier_.Notify();
+  }
+
+  void CloseWriter() {
+    {
+      absl::MutexLock lock(&mu_);
+      writer_open_ = false;
+      ++reader_generation_;
+      ++writer_generation_;
+    }
+    notifier_.Notify();
+  }
+
+  // Returns the poll(2) events pending on the reading end.
+  int ReaderEvents() {
+    absl::MutexLock lock(&mu_);
+    int events = size_ > 0 ? POLLIN | POLLRDNORM : 0;
+    if (!writer_open_) events |= POLLHUP;
+    return events;
+  }
+
+  // Returns the poll(2) events pending on the writing end. As on Linux, the
+  // writing end is writable once a PIPE_BUF-sized write would not block.
+  int WriterEvents() {
+    absl::MutexLock lock(&mu_);
+    if (!reader_open_) return POLLERR;
+    return capacity_ - size_ >= PIPE_BUF ? POLLOUT | POLLWRNORM : 0;
+  }
+
+  // Return counters advanced whenever the events of the reading and writing
+  // end, respectively, may have newly become pending.
+  uint64_t reader_generation() {
+    absl::MutexLock lock(&mu_);
+    return reader_generation_;
+  }
+  uint64_t writer_generation() {
+    absl::MutexLock lock(&mu_);
+    return writer_generation_;
+  }
+
+  // Notifies waiters of changes to either end's events. Notify() may exit the
+  // enclave to wake a host wait, so it is only called without |mu_| held, after
+  // the generation of the affected end has been advanced under |mu_|.
+  ReadinessNotifier *notifier() { return &notifier_; }
+
+ private:
+  bool ReadableLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return size_ > 0 || !writer_open_;
+  }
+
+  // Moves the buffered data to the front of new storage of |size| bytes.
+  void ResizeLocked(size_t size) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    std::vector<char> storage(size);
+    CopyOutLocked(storage.data(), size_);
+    storage_.swap(storage);
+    head_ = 0;
+  }
+
+  // Copies |count| bytes from the front of the buffer to |buf| without
+  // consuming them.
+  void CopyOutLocked(char *buf, size_t count) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (count == 0) return;
+    size_t first = std::min(count, storage_.size() - head_);
+    memcpy(buf, storage_.data() + head_, first);
+    memcpy(buf + first, storage_.data(), count - first);
+  }
+
+  // Appends |count| bytes from |buf|, growing the storage if needed. The
+  // caller ensures that the data fits within |capacity_|.
+  void CopyInLocked(const char *buf, size_t count)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (size_ + count > storage_.size()) {
+      size_t size = std::max<size_t>(storage_.size(), kPageSize);
+      while (size < size_ + count) size *= 2;
+      ResizeLocked(std::min(size, capacity_));
+    }
+    size_t tail = (head_ + size_) % storage_.size();
+    size_t first = std::min(count, storage_.size() - tail);
+    memcpy(storage_.data() + tail, buf, first);
+    memcpy(storage_.data(), buf + first, count - first);
+    size_ += count;
+  }
+
+  const bool packet_mode_;
+
+  absl::Mutex mu_;
+  std::vector<char> storage_ ABSL_GUARDED_BY(mu_);
+  size_t capacity_ ABSL_GUARDED_BY(mu_);
+
+  // The offset of the first buffered byte in |storage_|, and the number of
+  // buffered bytes.
+  size_t head_ ABSL_GUARDED_BY(mu_);
+  size_t size_ ABSL_GUARDED_BY(mu_);
+
+  // The lengths of the buffered packets in packet mode.
+  std::deque<size_t> packets_ ABSL_GUARDED_BY(mu_);
+
+  bool reader_open_ ABSL_GUARDED_BY(mu_);
+  bool writer_open_ ABSL_GUARDED_BY(mu_);
+
+  uint64_t reader_generation_ ABSL_GUARDED_BY(mu_) = 0;
+  uint64_t writer_generation_ ABSL_GUARDED_BY(mu_) = 0;
+
+  ReadinessNotifier notifier_;
+};
+
+IOContextPipe::IOContextPipe(std::shared_ptr<PipeBuffer> read_buffer,
+                             std::shared_ptr<PipeBuffer> write_buffer,
+                             bool is_socket, bool nonblock, bool cloexec)
+    : read_buffer_(std::move(read_buffer)),
+      write_buffer_(std::move(write_buffer)),
+      read_open_(read_buffer_ != nullptr),
+      write_open_(write_buffer_ != nullptr),
+      is_socket_(is_socket),
+      nonblock_(nonblock),
+      cloexec_(cloexec) {}
+
+void IOContextPipe::CreatePipe(int flags,
+                               std::unique_ptr<IOContextPipe> *read_end,
+                               std::unique_ptr<IOContextPipe> *write_end) {
+  auto buffer = std::make_shared<PipeBuffer>(flags & O_DIRECT);
+  bool nonblock = flags & O_NONBLOCK;
+  bool cloexec = flags & O_CLOEXEC;
+  read_end->reset(new IOContextPipe(buffer, nullptr, /*is_socket=*/false,
+                                    nonblock, cloexec));
+  write_end->reset(new IOContextPipe(nullptr, buffer, /*is_socket=*/false,
+                                     nonblock, cloexec));
+}
+
+void IOContextPipe::CreateSocketPair(int flags,
+                                     std::unique_ptr<IOContextPipe> *first,
+                                     std::unique_ptr<IOContextPipe> *second) {
+  auto first_to_second = std::make_shared<PipeBuffer>(/*packet_mode=*/false);
+  auto second_to_first = std::make_shared<PipeBuffer>(/*packet_mode=*/false);
+  bool nonblock = flags & SOCK_NONBLOCK;
+  bool cloexec = flags & SOCK_CLOEXEC;
+  first->reset(new IOContextPipe(second_to_first, first_to_second,
+                                 /*is_socket=*/true, nonblock, cloexec));
+  second->reset(new IOContextPipe(first_to_second, second_to_first,
+                                  /*is_socket=*/true, nonblock, cloexec));
+}
+
+ssize_t IOContextPipe::Read(void *buf, size_t count) {
+  return DoRead(buf, count, nonblock_);
+}
+
+ssize_t IOContextPipe::Write(const void *buf, size_t count) {
+  return DoWrite(buf, count, nonblock_);
+}
+
+ssize_t IOContextPipe::DoRead(void *buf, size_t count, bool nonblock) {
+  if (!read_buffer_) {
+    errno = EBADF;
+    return -1;
+  }
+  if (!read_open_) return 0;
+  return read_buffer_->Read(buf, count, nonblock);
+}
+
+ssize_t IOContextPipe::DoWrite(const void *buf, size_t count, bool nonblock) {
+  if (!write_buffer_) {
+    errno = EBADF;
+    return -1;
+  }
+  if (!write_open_) {
+    errno = EPIPE;
+    return -1;
+  }
+  return write_buffer_->Write(buf, count, nonblock);
+}
+
+void IOContextPipe::CloseRead() {
+  if (read_open_.exchange(false)) read_buffer_->CloseReader();
+}
+
+void IOContextPipe::CloseWrite() {
+  if (write_open_.exchange(false)) write_buffer_->CloseWriter();
+}
+
+int IOContextPipe::Close() {
+  CloseRead();
+  CloseWrite();
+  return 0;
+}
+
+int IOContextPipe::FCntl(int cmd, int64_t arg) {
+  // Pipe size commands apply to the buffer this end writes to, or reads from
+  // for the read end of a pipe.
+  PipeBuffer *buffer = write_buffer_ ? write_buffer_.get() : read_buffer_.get();
+  switch (cmd) {
+    case F_GETFL: {
+      int flags = is_socket_ ? O_RDWR : (read_buffer_ ? O_RDONLY : O_WRONLY);
+      if (nonblock_) flags |= O_NONBLOCK;
+      if (buffer->packet_mode()) flags |= O_DIRECT;
+      return flags;
+    }
+    case F_SETFL:
+      nonblock_ = arg & O_NONBLOCK;
+      return 0;
+    case F_GETFD:
+      return cloexec_ ? FD_CLOEXEC : 0;
+    case F_SETFD:
+      cloexec_ = arg & FD_CLOEXEC;
+      return 0;
+    case F_GETPIPE_SZ:
+      if (is_socket_) break;
+      return buffer->capacity();
+    case F_SETPIPE_SZ:
+      if (is_socket_) break;
+      return buffer->SetCapacity(arg);
+  }
+  errno = EINVAL;
+  return -1;
+}
+
+int IOContextPipe::FStat(struct stat *st) {
+  memset(st, 0, sizeof(*st));
+  st->st_mode =
+      is_socket_ ? S_IFSOCK | S_IRWXU | S_IRWXG | S_IRWXO : S_IFIFO | 0600;
+  st->st_nlink = 1;
+  st->st_blksize = kPageSize;
+  return 0;
+}
+
+ssize_t IOContextPipe::Readv(const struct iovec *iov, int iovcnt) {
+  ssize_t total = 0;
+  for (int i = 0; i < iovcnt; ++i) {
+    if (iov[i].iov_len == 0) continue;
+    // Only the first read may block; later ones take what is already buffered.
+    ssize_t result =
+        DoRead(iov[i].iov_base, iov[i].iov_len, nonblock_ || total > 0);
+    if (result < 0) return total > 0 ? total : result;
+    total += result;
+    if (static_cast<size_t>(result) < iov[i].iov_len) break;
+  }
+  return total;
+}
+
+ssize_t IOContextPipe::Writev(const struct iovec *iov, int iovcnt) {
+  ssize_t total = 0;
+  for (int i = 0; i < iovcnt; ++i) {
+    if (iov[i].iov_len == 0) continue;
+    ssize_t result = Write(iov[i].iov_base, iov[i].iov_len);
+    if (result < 0) return total > 0 ? total : result;
+    total += result;
+    if (static_cast<size_t>(result) < iov[i].iov_len) break;
+  }
+  return total;
+}
+
+int IOContextPipe::Shutdown(int how) {
+  if (!is_socket_) {
+    errno = ENOTSOCK;
+    return -1;
+  }
+  switch (how) {
+    case SHUT_RD:
+      CloseRead();
+      return 0;
+    case SHUT_WR:
+      CloseWrite();
+      return 0;
+    case SHUT_RDWR:
+      CloseRead();
+      CloseWrite();
+      return 0;
+  }
+  errno = EINVAL;
+  return -1;
+}
+
+ssize_t IOContextPipe::Send(const void *buf, size_t len, int flags) {
+  if (!is_socket_) {
+    errno = ENOTSOCK;
+    return -1;
+  }
+  return DoWrite(buf, len, nonblock_ || (flags & MSG_DONTWAIT));
+}
+
+ssize_t IOContextPipe::RecvFrom(void *buf, size_t len, int flags,
+                                struct sockaddr *src_addr,
+                                socklen_t *addrlen) {
+  if (!is_socket_) {
+    errno = ENOTSOCK;
+    return -1;
+  }
+  // The peer of a socket pair is unnamed.
+  if (src_addr && addrlen) *addrlen = 0;
+  return DoRead(buf, len, nonblock_ || (flags & MSG_DONTWAIT));
+}
+
+int IOContextPipe::SetSockOpt(int level, int option_name,
+                              const void *option_value, socklen_t option_len) {
+  if (!is_socket_) {
+    errno = ENOTSOCK;
+    return -1;
+  }
+  errno = ENOPROTOOPT;
+  return -1;
+}
+
+int IOContextPipe::GetSockOpt(int level, int optname, void *optval,
+                              socklen_t *optlen) {
+  if (!is_socket_) {
+    errno = ENOTSOCK;
+    return -1;
+  }
+  int value;
+  if (level == SOL_SOCKET && optname == SO_TYPE) {
+    value = SOCK_STREAM;
+  } else if (level == SOL_SOCKET && optname == SO_ERROR) {
+    value = 0;
+  } else {
+    errno = ENOPROTOOPT;
+    return -1;
+  }
+  if (!optval || !optlen) {
+    errno = EFAULT;
+    return -1;
+  }
+  memcpy(optval, &value, std::min<size_t>(*optlen, sizeof(value)));
+  *optlen = std::min<socklen_t>(*optlen, sizeof(value));
+  return 0;
+}
+
+int IOContextPipe::GetSockName(struct sockaddr *addr, socklen_t *addrlen) {
+  return GetUnnamedAddress(addr, addrlen);
+}
+
+int IOContextPipe::GetPeerName(struct sockaddr *addr, socklen_t *addrlen) {
+  return GetUnnamedAddress(addr, addrlen);
+}
+
+int IOContextPipe::GetUnnamedAddress(struct sockaddr *addr,
+                                     socklen_t *addrlen) {
+  if (!is_socket_) {
+    errno = ENOTSOCK;
+    return -1;
+  }
+  if (!addr || !addrlen) {
+    errno = EFAULT;
+    return -1;
+  }
+  // Both ends of a socket pair are unnamed AF_UNIX sockets, whose address is
+  // only the address family.
+  sa_family_t family = AF_UNIX;
+  memcpy(addr, &family, std::min<size_t>(*addrlen, sizeof(family)));
+  *addrlen = sizeof(family);
+  return 0;
+}
+
+int IOContextPipe::PollEvents() {
+  int events = 0;
+  if (read_buffer_) {
+    int read_events = read_open_ ? read_buffer_->ReaderEvents() : POLLHUP;
+    // A socket whose peer stopped writing is readable at end-of-file, but is
+    // only hung up once both directions are shut down.
+    if (is_socket_ && (read_events & POLLHUP)) {
+      read_events = (read_events & ~POLLHUP) | POLLIN | POLLRDHUP;
+    }
+    events |= read_events;
+  }
+  if (write_buffer_ && write_open_) {
+    events |= write_buffer_->WriterEvents();
+  }
+  return events;
+}
+
+void IOContextPipe::AddReadinessWaiter(
+    const std::shared_ptr<ReadinessWaiter> &waiter) {
+  if (read_buffer_) read_buffer_->notifier()->AddWaiter(waiter);
+  if (write_buffer_) write_buffer_->notifier()->AddWaiter(waiter);
+}
+
+void IOContextPipe::RemoveReadinessWaiter(const ReadinessWaiter *waiter) {
+  if (read_buffer_) read_buffer_->notifier()->RemoveWaiter(waiter);
+  if (write_buffer_) write_buffer_->notifier()->RemoveWaiter(waiter);
+}
+
+uint64_t IOContextPipe::ReadinessGeneration(int events) {
+  // The sum advances whenever either of its terms does.
+  uint64_t generation = 0;
+  if (read_buffer_ && (events & POLLIN)) {
+    generation += read_buffer_->reader_generation();
+  }
+  if (write_buffer_ && (events & POLLOUT)) {
+    generation += write_buffer_->writer_generation();
+  }
+  return generation;
+}
+
+}  // namespace io
+}  // namespace asylo
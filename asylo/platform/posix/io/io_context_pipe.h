@@ -0,0 +1,128 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_POSIX_IO_IO_CONTEXT_PIPE_H_
+#define ASYLO_PLATFORM_POSIX_IO_IO_CONTEXT_PIPE_H_
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "asylo/platform/posix/io/io_manager.h"
+
+namespace asylo {
+namespace io {
+
+// The buffer shared by the two ends of one direction of an enclave-resident
+// pipe. Defined in io_context_pipe.cc.
+class PipeBuffer;
+
+// IOContext implementation of one end of a pipe or an AF_UNIX stream socket
+// pair whose data never leaves enclave memory. Each direction is backed by a
+// ring buffer that grows on demand up to the pipe size, and blocked readers and
+// writers wait on the buffer's mutex rather than exiting the enclave.
+class IOContextPipe : public IOManager::IOContext {
+ public:
+  // The capacity of a new pipe. This matches the Linux default of 16 pages.
+  static constexpr size_t kDefaultPipeSize = 16 * 4096;
+
+  // The largest capacity F_SETPIPE_SZ accepts, matching the default Linux
+  // limit for unprivileged processes.
+  static constexpr size_t kMaxPipeSize = 1024 * 1024;
+
+  // Creates the read and write ends of a pipe. |flags| is any combination of
+  // O_CLOEXEC, O_DIRECT, and O_NONBLOCK, as accepted by pipe2().
+  static void CreatePipe(int flags, std::unique_ptr<IOContextPipe> *read_end,
+                         std::unique_ptr<IOContextPipe> *write_end);
+
+  // Creates the two connected ends of a stream socket pair. |flags| is any
+  // combination of SOCK_CLOEXEC and SOCK_NONBLOCK, as accepted by
+  // socketpair().
+  static void CreateSocketPair(int flags, std::unique_ptr<IOContextPipe> *first,
+                               std::unique_ptr<IOContextPipe> *second);
+
+  ssize_t Read(void *buf, size_t count) override;
+  ssize_t Write(const void *buf, size_t count) override;
+  int Close() override;
+  int FCntl(int cmd, int64_t arg) override;
+  int FStat(struct stat *st) override;
+  ssize_t Readv(const struct iovec *iov, int iovcnt) override;
+  ssize_t Writev(const struct iovec *iov, int iovcnt) override;
+  int Shutdown(int how) override;
+  ssize_t Send(const void *buf, size_t len, int flags) override;
+  ssize_t RecvFrom(void *buf, size_t len, int flags, struct sockaddr *src_addr,
+                   socklen_t *addrlen) override;
+  int SetSockOpt(int level, int option_name, const void *option_value,
+                 socklen_t option_len) override;
+  int GetSockOpt(int level, int optname, void *optval,
+                 socklen_t *optlen) override;
+  int GetSockName(struct sockaddr *addr, socklen_t *addrlen) override;
+  int GetPeerName(struct sockaddr *addr, socklen_t *addrlen) override;
+  int PollEvents() override;
+  void AddReadinessWaiter(
+      const std::shared_ptr<ReadinessWaiter> &waiter) override;
+  void RemoveReadinessWaiter(const ReadinessWaiter *waiter) override;
+  uint64_t ReadinessGeneration(int events) override;
+
+ private:
+  IOContextPipe(std::shared_ptr<PipeBuffer> read_buffer,
+                std::shared_ptr<PipeBuffer> write_buffer, bool is_socket,
+                bool nonblock, bool cloexec);
+
+  ssize_t DoRead(void *buf, size_t count, bool nonblock);
+  ssize_t DoWrite(const void *buf, size_t count, bool nonblock);
+
+  // Implements getsockname() and getpeername(). Fails with ENOTSOCK for the
+  // ends of a pipe.
+  int GetUnnamedAddress(struct sockaddr *addr, socklen_t *addrlen);
+
+  // Releases this end's hold on its read or write buffer, so that the peer
+  // observes end-of-file or EPIPE. Each is idempotent.
+  void CloseRead();
+  void CloseWrite();
+
+  // The buffer this end reads from, or nullptr for the write end of a pipe.
+  const std::shared_ptr<PipeBuffer> read_buffer_;
+
+  // The buffer this end writes to, or nullptr for the read end of a pipe.
+  const std::shared_ptr<PipeBuffer> write_buffer_;
+
+  // Whether the read and write directions of this end are still open.
+  std::atomic<bool> read_open_;
+  std::atomic<bool> write_open_;
+
+  // Whether this is an end of a socket pair rather than a pipe.
+  const bool is_socket_;
+
+  // Whether O_NONBLOCK is set on this end.
+  std::atomic<bool> nonblock_;
+
+  // Whether FD_CLOEXEC is set on this end.
+  std::atomic<bool> cloexec_;
+};
+
+}  // namespace io
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_POSIX_IO_IO_CONTEXT_PIPE_H_
@@ -22,20 +22,24 @@
 #include <poll.h>
 
 #include <cerrno>
+#include <climits>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
-#include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_set.h"
-#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "asylo/platform/host_call/trusted/host_calls.h"
 #include "asylo/platform/posix/io/io_context_epoll.h"
 #include "asylo/platform/posix/io/io_context_eventfd.h"
 #include "asylo/platform/posix/io/io_context_inotify.h"
+#include "asylo/platform/posix/io/io_context_pipe.h"
 #include "asylo/platform/posix/io/native_paths.h"
 #include "asylo/platform/posix/io/util.h"
 #include "asylo/util/posix_error_space.h"
+#include "asylo/util/status_macros.h"
 #include "asylo/util/statusor.h"
 
 namespace asylo {
@@ -168,52 +172,54 @@ int IOManager::Close(int fd) {
 
 IOManager::VirtualPathHandler *IOManager::HandlerForPath(
     absl::string_view path) const {
-  // Start by looking for a full match.
-  std::string current_prefix(path);
-
-  // Keep looking until we find a match or run out of handlers to check.
-  while (true) {
-    // Find the first handler with a prefix greater or equal to this path.
-    // If there is an exact match, this will be it.  Otherwise, any match must
-    // be before this.
-    auto iter = prefix_to_handler_.lower_bound(current_prefix);
-
-    // iter->first is the registered prefix.
-    // iter->second.get() is a pointer to the registered handler.
-
-    // lower_bound can land directory on a match.
-    if (iter != prefix_to_handler_.end() && current_prefix == iter->first) {
-      return iter->second.get();
-    }
-
-    // Since we started with the lower_bound, any prefixes will be found
-    // before that iterator.  If there are none, we're done.
-    if (iter == prefix_to_handler_.begin()) break;
-    --iter;
-
-    // Determine how much this handler's prefix and the current prefix have in
-    // common.
-    std::string::const_iterator end_prefix, end_path;
-    std::tie(end_prefix, end_path) =
-        absl::c_mismatch(iter->first, current_prefix);
-
-    // If the entire prefix is in the current prefix up to a /, it's a match.
-    if (end_prefix == iter->first.end() && *end_path == '/') {
-      return iter->second.get();
+  // Walk the trie one path component at a time, remembering the handler with
+  // the longest matching prefix seen so far.
+  const PrefixTrieNode *node = &prefix_trie_[0];
+  VirtualPathHandler *handler = node->handler;
+  size_t current = 0;
+  while (current < path.size() && path[current] == '/') {
+    size_t next = path.find('/', current + 1);
+    if (next == absl::string_view::npos) next = path.size();
+    auto iter =
+        node->children.find(path.substr(current + 1, next - current - 1));
+    if (iter == node->children.end()) break;
+    node = &prefix_trie_[iter->second];
+    if (node->handler) handler = node->handler;
+    current = next;
+  }
+  return handler;
+}
+
+void IOManager::RebuildPrefixTrie() {
+  prefix_trie_.assign(1, PrefixTrieNode());
+  for (const auto &entry : prefix_to_handler_) {
+    // Registered prefixes are either empty or begin with '/', so every
+    // component after the first '/' labels one edge.
+    absl::string_view prefix = entry.first;
+    size_t node = 0;
+    size_t current = 0;
+    while (current < prefix.size()) {
+      size_t next = prefix.find('/', current + 1);
+      if (next == absl::string_view::npos) next = prefix.size();
+      std::string component(prefix.substr(current + 1, next - current - 1));
+      auto iter = prefix_trie_[node].children.find(component);
+      if (iter == prefix_trie_[node].children.end()) {
+        prefix_trie_[node].children.emplace(std::move(component),
+                                            prefix_trie_.size());
+        node = prefix_trie_.size();
+        prefix_trie_.emplace_back();
+      } else {
+        node = iter->second;
+      }
+      current = next;
     }
-
-    // Back up the prefix to nearest directory.  We know there can't be a
-    // matching handler with a longer prefix match or we would have found it by
-    // now.
-    while (*end_prefix != '/') --end_prefix;
-
-    // The next iteration of the loop will look for a matching handler using
-    // that directory prefix.
-    current_prefix = std::string(iter->first.begin(), end_prefix);
+    prefix_trie_[node].handler = entry.second.get();
   }
 
-  // Didn't find a handler.
-  return nullptr;
+  current_working_directory_handler_ =
+      current_working_directory_.empty()
+          ? nullptr
+          : HandlerForPath(current_working_directory_);
 }
 
 int IOManager::Open(const char *path, int flags, mode_t mode) {
@@ -269,85 +275,107 @@ int IOManager::Dup2(int oldfd, int newfd) {
 }
 
 int IOManager::Pipe(int pipefd[2], int flags) {
-  int res = enc_untrusted_pipe2(pipefd, flags);
-  if (res != -1) {
-    pipefd[0] = RegisterHostFileDescriptor(pipefd[0]);
-    pipefd[1] = RegisterHostFileDescriptor(pipefd[1]);
-    if (pipefd[0] < 0 || pipefd[1] < 0) {
-      errno = EMFILE;
-      return -1;
+  if (use_host_pipes_) {
+    int res = enc_untrusted_pipe2(pipefd, flags);
+    if (res != -1) {
+      pipefd[0] = RegisterHostFileDescriptor(pipefd[0]);
+      pipefd[1] = RegisterHostFileDescriptor(pipefd[1]);
+      if (pipefd[0] < 0 || pipefd[1] < 0) {
+        errno = EMFILE;
+        return -1;
+      }
     }
+    return res;
+  }
+
+  if (flags & ~(O_CLOEXEC | O_DIRECT | O_NONBLOCK)) {
+    errno = EINVAL;
+    return -1;
+  }
+  std::unique_ptr<IOContextPipe> read_end, write_end;
+  IOContextPipe::CreatePipe(flags, &read_end, &write_end);
+  return InsertPair(std::move(read_end), std::move(write_end), pipefd);
+}
+
+int IOManager::SocketPair(int domain, int type, int protocol, int sv[2]) {
+  if (domain != AF_UNIX) {
+    errno = EAFNOSUPPORT;
+    return -1;
+  }
+  int flags = type & (SOCK_CLOEXEC | SOCK_NONBLOCK);
+  if ((type & ~flags) != SOCK_STREAM) {
+    errno = EOPNOTSUPP;
+    return -1;
+  }
+  if (protocol != 0) {
+    errno = EPROTONOSUPPORT;
+    return -1;
+  }
+  std::unique_ptr<IOContextPipe> first, second;
+  IOContextPipe::CreateSocketPair(flags, &first, &second);
+  return InsertPair(std::move(first), std::move(second), sv);
+}
+
+int IOManager::InsertPair(std::unique_ptr<IOContext> first,
+                          std::unique_ptr<IOContext> second, int fds[2]) {
+  absl::WriterMutexLock lock(&fd_table_lock_);
+  int first_fd = fd_table_.Insert(first.get());
+  if (first_fd < 0) {
+    errno = EMFILE;
+    return -1;
+  }
+  first.release();
+  int second_fd = fd_table_.Insert(second.get());
+  if (second_fd < 0) {
+    fd_table_.Delete(first_fd);
+    errno = EMFILE;
+    return -1;
   }
-  return res;
+  second.release();
+  fds[0] = first_fd;
+  fds[1] = second_fd;
+  return 0;
 }
 
 int IOManager::Select(int nfds, fd_set *readfds, fd_set *writefds,
                       fd_set *exceptfds, struct timeval *timeout) {
-  if (nfds < 0) {
+  if (nfds < 0 || nfds > FD_SETSIZE) {
     errno = EINVAL;
     return -1;
   }
 
-  // Translate the fd_sets into host file descriptors.
-  fd_set host_readfds, host_writefds, host_exceptfds;
-  FD_ZERO(&host_readfds);
-  FD_ZERO(&host_writefds);
-  FD_ZERO(&host_exceptfds);
-
-  int host_nfds = 0;
+  // Translate the fd_sets into a poll set.
+  std::vector<struct pollfd> fds;
   for (int fd = 0; fd < nfds; ++fd) {
+    short events = 0;
     if (readfds && FD_ISSET(fd, readfds)) {
-      std::shared_ptr<IOContext> context = fd_table_.Get(fd);
-      if (context) {
-        int host_fd = context->GetHostFileDescriptor();
-        FD_SET(host_fd, &host_readfds);
-        host_nfds = std::max(host_nfds, host_fd + 1);
-      }
+      events |= POLLIN;
     }
     if (writefds && FD_ISSET(fd, writefds)) {
-      std::shared_ptr<IOContext> context = fd_table_.Get(fd);
-      if (context) {
-        int host_fd = context->GetHostFileDescriptor();
-        FD_SET(host_fd, &host_writefds);
-        host_nfds = std::max(host_nfds, host_fd + 1);
-      }
+      events |= POLLOUT;
     }
     if (exceptfds && FD_ISSET(fd, exceptfds)) {
-      std::shared_ptr<IOContext> context = fd_table_.Get(fd);
-      if (context) {
-        int host_fd = context->GetHostFileDescriptor();
-        FD_SET(host_fd, &host_exceptfds);
-        host_nfds = std::max(host_nfds, host_fd + 1);
-      }
+      events |= POLLPRI;
+    }
+    if (events) {
+      fds.push_back({fd, events, 0});
     }
   }
-  int ret = enc_untrusted_select(host_nfds, &host_readfds, &host_writefds,
-                                 &host_exceptfds, timeout);
 
-  // On error, errno should have been set by the host.
+  int poll_timeout = -1;
+  if (timeout) {
+    if (timeout->tv_sec < 0 || timeout->tv_usec < 0) {
+      errno = EINVAL;
+      return -1;
+    }
+    poll_timeout = DeadlineToTimeout(absl::Now() +
+                                     absl::DurationFromTimeval(*timeout));
+  }
+  int ret = Poll(fds.data(), fds.size(), poll_timeout);
   if (ret < 0) {
     return ret;
   }
 
-  // Add the returned fd_sets into absl::flat_hash_set.
-  absl::flat_hash_set<int> host_readfds_set, host_writefds_set,
-      host_exceptfds_set;
-  for (int fd = 0; fd < nfds; ++fd) {
-    std::shared_ptr<IOContext> context = fd_table_.Get(fd);
-    if (context) {
-      int host_fd = context->GetHostFileDescriptor();
-      if (FD_ISSET(host_fd, &host_readfds)) {
-        host_readfds_set.insert(host_fd);
-      }
-      if (FD_ISSET(host_fd, &host_writefds)) {
-        host_writefds_set.insert(host_fd);
-      }
-      if (FD_ISSET(host_fd, &host_exceptfds)) {
-        host_exceptfds_set.insert(host_fd);
-      }
-    }
-  }
-
   if (readfds) {
     FD_ZERO(readfds);
   }
@@ -357,24 +385,21 @@ int IOManager::Select(int nfds, fd_set *readfds, fd_set *writefds,
   if (exceptfds) {
     FD_ZERO(exceptfds);
   }
-  // Go through the file descriptor table, if any host file descriptor is
-  // included in any of the sets, add the corresponding enclave fd to the
-  // enclave fd_set.
-  for (int fd = 0; fd < nfds; ++fd) {
-    std::shared_ptr<IOContext> context = fd_table_.Get(fd);
-    if (context) {
-      int host_fd = context->GetHostFileDescriptor();
-      if (readfds && host_readfds_set.find(host_fd) != host_readfds_set.end()) {
-        FD_SET(fd, readfds);
-      }
-      if (writefds &&
-          host_writefds_set.find(host_fd) != host_writefds_set.end()) {
-        FD_SET(fd, writefds);
-      }
-      if (exceptfds &&
-          host_exceptfds_set.find(host_fd) != host_exceptfds_set.end()) {
-        FD_SET(fd, exceptfds);
-      }
+  // As with select(2), the result counts each set membership separately.
+  ret = 0;
+  for (const struct pollfd &entry : fds) {
+    if ((entry.events & POLLIN) &&
+        (entry.revents & (POLLIN | POLLHUP | POLLERR))) {
+      FD_SET(entry.fd, readfds);
+      ++ret;
+    }
+    if ((entry.events & POLLOUT) && (entry.revents & (POLLOUT | POLLERR))) {
+      FD_SET(entry.fd, writefds);
+      ++ret;
+    }
+    if ((entry.events & POLLPRI) && (entry.revents & POLLPRI)) {
+      FD_SET(entry.fd, exceptfds);
+      ++ret;
     }
   }
   return ret;
@@ -382,6 +407,7 @@ int IOManager::Select(int nfds, fd_set *readfds, fd_set *writefds,
 
 int IOManager::Poll(struct pollfd *fds, nfds_t nfds, int timeout) {
   std::vector<int> enclave_fd(nfds);
+  std::vector<std::shared_ptr<IOContext>> virtual_contexts;
   {
     absl::ReaderMutexLock lock(&fd_table_lock_);
     for (int i = 0; i < nfds; ++i) {
@@ -389,18 +415,137 @@ int IOManager::Poll(struct pollfd *fds, nfds_t nfds, int timeout) {
       std::shared_ptr<IOContext> context = fd_table_.Get(enclave_fd[i]);
       if (context) {
         fds[i].fd = context->GetHostFileDescriptor();
+        if (fds[i].fd == -1 && context->PollEvents() >= 0) {
+          // An enclave-virtual stream, which the host cannot watch.
+          virtual_contexts.resize(nfds);
+          virtual_contexts[i] = std::move(context);
+        }
       } else {
         fds[i].fd = -1;
       }
     }
   }
-  int ret = enc_untrusted_poll(fds, nfds, timeout);
+  int ret = virtual_contexts.empty()
+                ? enc_untrusted_poll(fds, nfds, timeout)
+                : PollVirtual(fds, nfds, virtual_contexts, timeout);
   for (int i = 0; i < nfds; ++i) {
     fds[i].fd = enclave_fd[i];
   }
   return ret;
 }
 
+int IOManager::PollVirtual(
+    struct pollfd *fds, nfds_t nfds,
+    const std::vector<std::shared_ptr<IOContext>> &virtual_contexts,
+    int timeout) {
+  std::shared_ptr<ReadinessWaiter> waiter = AcquireReadinessWaiter();
+  for (const auto &context : virtual_contexts) {
+    if (context) context->AddReadinessWaiter(waiter);
+  }
+
+  // The host file descriptors of the set, with room for the wakeup pipe.
+  std::vector<struct pollfd> host_fds;
+  std::vector<nfds_t> host_index;
+  for (nfds_t i = 0; i < nfds; ++i) {
+    if (!virtual_contexts[i] && fds[i].fd >= 0) {
+      host_fds.push_back(fds[i]);
+      host_index.push_back(i);
+    }
+  }
+  const size_t host_count = host_fds.size();
+  host_fds.push_back({-1, POLLIN, 0});
+
+  absl::Time deadline = TimeoutToDeadline(timeout);
+  int ret;
+  while (true) {
+    // Record the generation first, so that a change after the check below
+    // ends the wait.
+    uint64_t generation = waiter->generation();
+    int ready = 0;
+    for (nfds_t i = 0; i < nfds; ++i) {
+      fds[i].revents = 0;
+      if (virtual_contexts[i]) {
+        // POLLERR and POLLHUP are always reported.
+        fds[i].revents = virtual_contexts[i]->PollEvents() &
+                         (fds[i].events | POLLERR | POLLHUP);
+        if (fds[i].revents) ++ready;
+      }
+    }
+    for (struct pollfd &entry : host_fds) {
+      entry.revents = 0;
+    }
+
+    int host_ready = 0;
+    if (ready > 0 || host_count == 0) {
+      // Only report host file descriptors that are ready now.
+      if (host_count > 0) {
+        host_ready = enc_untrusted_poll(host_fds.data(), host_count, 0);
+      }
+    } else {
+      host_fds.back().fd = waiter->GetHostWakeupFd();
+      if (host_fds.back().fd == -1) {
+        ret = -1;
+        break;
+      }
+      waiter->BeginHostWait();
+      if (waiter->generation() == generation) {
+        host_ready = enc_untrusted_poll(host_fds.data(), host_fds.size(),
+                                        DeadlineToTimeout(deadline));
+      }
+      waiter->EndHostWait();
+      if (host_ready > 0 && host_fds.back().revents) {
+        --host_ready;
+      }
+    }
+    if (host_ready < 0) {
+      // errno is set by the host.
+      ret = -1;
+      break;
+    }
+    for (size_t i = 0; i < host_count; ++i) {
+      fds[host_index[i]].revents = host_fds[i].revents;
+    }
+    if (ready + host_ready > 0) {
+      ret = ready + host_ready;
+      break;
+    }
+    if (host_count == 0) {
+      // Only enclave-virtual streams are watched, so wait without exiting.
+      if (!waiter->Wait(generation, deadline)) {
+        ret = 0;
+        break;
+      }
+    } else if (absl::Now() >= deadline) {
+      ret = 0;
+      break;
+    }
+  }
+
+  for (const auto &context : virtual_contexts) {
+    if (context) context->RemoveReadinessWaiter(waiter.get());
+  }
+  ReleaseReadinessWaiter(std::move(waiter));
+  return ret;
+}
+
+std::shared_ptr<ReadinessWaiter> IOManager::AcquireReadinessWaiter() {
+  {
+    absl::MutexLock lock(&waiters_lock_);
+    if (!idle_waiters_.empty()) {
+      std::shared_ptr<ReadinessWaiter> waiter = std::move(idle_waiters_.back());
+      idle_waiters_.pop_back();
+      return waiter;
+    }
+  }
+  return std::make_shared<ReadinessWaiter>();
+}
+
+void IOManager::ReleaseReadinessWaiter(
+    std::shared_ptr<ReadinessWaiter> waiter) {
+  absl::MutexLock lock(&waiters_lock_);
+  idle_waiters_.push_back(std::move(waiter));
+}
+
 int IOManager::EpollCreate(int size) {
   if (size < 1) {
     errno = EINVAL;
@@ -427,11 +572,18 @@ int IOManager::EpollCtl(int epfd, int op, int fd, struct epoll_event *event) {
     absl::ReaderMutexLock lock(&fd_table_lock_);
     context = fd_table_.Get(fd);
   }
-  int hostfd = context ? context->GetHostFileDescriptor() : -1;
-  if (hostfd == -1) {
+  if (!context) {
     errno = EBADF;
     return -1;
   }
+  int hostfd = context->GetHostFileDescriptor();
+  if (hostfd == -1) {
+    // Enclave-virtual streams are watched by the epoll instance itself.
+    return CallWithContext(epfd, [op, fd, &context, event](
+                                     std::shared_ptr<IOContext> epoll_context) {
+      return epoll_context->EpollCtl(op, fd, context, event);
+    });
+  }
   return CallWithContext(
       epfd, [op, hostfd, event](std::shared_ptr<IOContext> epoll_context) {
         return epoll_context->EpollCtl(op, hostfd, event);
@@ -526,17 +678,17 @@ ReturnType IOManager::CallWithContext(int fd, IOAction action) {
 
 template <typename IOAction, typename ReturnType>
 ReturnType IOManager::CallWithHandler(const char *path, IOAction action) {
-  StatusOr<std::string> status = CanonicalizePath(path);
+  char canonical_path[PATH_MAX];
+  VirtualPathHandler *handler;
+  Status status = CanonicalizePath(path, canonical_path, &handler);
   if (!status.ok()) {
-    errno = status.status().error_code();
+    errno = status.error_code();
     return ErrorValue<ReturnType>::value;
   }
 
-  absl::string_view canonical_path = status.ValueOrDie();
-  VirtualPathHandler *handler = HandlerForPath(canonical_path);
   if (handler) {
     // Invoke the path handler if one is installed.
-    return action(handler, canonical_path.data());
+    return action(handler, canonical_path);
   }
 
   errno = ENOENT;
@@ -546,21 +698,21 @@ ReturnType IOManager::CallWithHandler(const char *path, IOAction action) {
 template <typename IOAction, typename ReturnType>
 ReturnType IOManager::CallWithHandler(const char *path1, const char *path2,
                                       IOAction action) {
-  StatusOr<std::string> status1 = CanonicalizePath(path1);
-  if (!status1.ok()) {
-    errno = status1.status().error_code();
+  char canonical_path1[PATH_MAX];
+  VirtualPathHandler *handler1;
+  Status status = CanonicalizePath(path1, canonical_path1, &handler1);
+  if (!status.ok()) {
+    errno = status.error_code();
     return ErrorValue<ReturnType>::value;
   }
-  StatusOr<std::string> status2 = CanonicalizePath(path2);
-  if (!status2.ok()) {
-    errno = status2.status().error_code();
+  char canonical_path2[PATH_MAX];
+  VirtualPathHandler *handler2;
+  status = CanonicalizePath(path2, canonical_path2, &handler2);
+  if (!status.ok()) {
+    errno = status.error_code();
     return ErrorValue<ReturnType>::value;
   }
 
-  absl::string_view canonical_path1 = status1.ValueOrDie();
-  absl::string_view canonical_path2 = status2.ValueOrDie();
-  VirtualPathHandler *handler1 = HandlerForPath(canonical_path1);
-  VirtualPathHandler *handler2 = HandlerForPath(canonical_path2);
   if (handler1 != handler2) {
     errno = EXDEV;
     return ErrorValue<ReturnType>::value;
@@ -568,7 +720,7 @@ ReturnType IOManager::CallWithHandler(const char *path1, const char *path2,
 
   if (handler1) {
     // Invoke the path handler if one is installed.
-    return action(handler1, canonical_path1.data(), canonical_path2.data());
+    return action(handler1, canonical_path1, canonical_path2);
   }
 
   errno = ENOENT;
@@ -590,11 +742,13 @@ bool IOManager::RegisterVirtualPathHandler(
   }
 
   prefix_to_handler_.emplace(path_prefix, std::move(handler));
+  RebuildPrefixTrie();
   return true;
 }
 
 void IOManager::DeregisterVirtualPathHandler(const std::string &path_prefix) {
   prefix_to_handler_.erase(path_prefix);
+  RebuildPrefixTrie();
 }
 
 Status IOManager::SetCurrentWorkingDirectory(absl::string_view path) {
@@ -602,6 +756,8 @@ Status IOManager::SetCurrentWorkingDirectory(absl::string_view path) {
   Status status = working_directory.status();
   if (status.ok()) {
     current_working_directory_ = working_directory.ValueOrDie();
+    current_working_directory_handler_ =
+        HandlerForPath(current_working_directory_);
   }
 
   return status;
@@ -613,49 +769,51 @@ std::string IOManager::GetCurrentWorkingDirectory() const {
 
 StatusOr<std::string> IOManager::CanonicalizePath(
     absl::string_view path) const {
+  char buffer[PATH_MAX];
+  VirtualPathHandler *handler;
+  ASYLO_RETURN_IF_ERROR(CanonicalizePath(path, buffer, &handler));
+  return std::string(buffer);
+}
+
+Status IOManager::CanonicalizePath(absl::string_view path, char *buffer,
+                                   VirtualPathHandler **handler) const {
   // Cannot resolve an empty path.
   if (path.empty()) {
     return Status(error::PosixError::P_ENOENT,
                   "Cannot canonicalize empty path");
   }
 
-  // In some cases, the handler may be restricted for a given path.
-  // By default, though, any handler is fine.
-  VirtualPathHandler *required_handler = nullptr;
-
   // Handle relative paths.
-  std::string relative_path;
+  absl::string_view working_directory;
   if (path.front() != '/') {
-    std::string working_directory = GetCurrentWorkingDirectory();
-
     // If the current working directory has not yet been set, cannot
     // canonicalize relative paths.
-    if (working_directory.empty()) {
+    if (current_working_directory_.empty()) {
       return Status(error::PosixError::P_ENOENT,
                     "Canonicalization of relative path before initialization");
     }
 
-    // Prepend the working directory to the given path. Don't worry about
-    // possible duplicate '/' characters, as NormalizePath will strip them out.
-    relative_path = absl::StrCat(working_directory, "/", path);
-    path = relative_path;
-
-    // Relative paths are only allowed to resolve to the same handler as the
-    // working directory.
-    required_handler = HandlerForPath(working_directory);
+    // The working directory is stored in canonical form, so the path can be
+    // normalized relative to it directly.
+    working_directory = current_working_directory_;
   }
 
   // Normalize the path to remove any directory traversals.
-  std::string ret = util::NormalizePath(path);
+  if (util::NormalizePath(working_directory, path, buffer, PATH_MAX) == 0) {
+    return Status(error::PosixError::P_ENAMETOOLONG,
+                  "Canonical path exceeds PATH_MAX");
+  }
+  *handler = HandlerForPath(buffer);
 
-  // If the allowed handler for this path is restricted, check that it matches
-  // the requirement.
-  if (required_handler && HandlerForPath(ret) != required_handler) {
+  // Relative paths are only allowed to resolve to the same handler as the
+  // working directory.
+  if (!working_directory.empty() &&
+      *handler != current_working_directory_handler_) {
     return Status(error::PosixError::P_EACCES,
                   "Relative path resolution across access domains");
   }
 
-  return ret;
+  return Status::OkStatus();
 }
 
 int IOManager::Write(int fd, const char *buf, size_t count) {
@@ -672,18 +830,16 @@ int IOManager::Chown(const char *path, uid_t owner, gid_t group) {
 }
 
 char *IOManager::RealPath(const char *path, char *resolved_path) {
-  StatusOr<std::string> path_str_or = CanonicalizePath(path);
-  if (!path_str_or.ok()) {
-    errno = path_str_or.status().error_code();
+  char buffer[PATH_MAX];
+  VirtualPathHandler *handler;
+  Status status = CanonicalizePath(
+      path, resolved_path ? resolved_path : buffer, &handler);
+  if (!status.ok()) {
+    errno = status.error_code();
 
     return nullptr;
   }
-  std::string path_str = path_str_or.ValueOrDie();
-  if (resolved_path) {
-    snprintf(resolved_path, PATH_MAX, "%s", path_str.c_str());
-    return resolved_path;
-  }
-  return strdup(path_str.c_str());
+  return resolved_path ? resolved_path : strdup(buffer);
 }
 
 int IOManager::Link(const char *from, const char *to) {
@@ -1068,5 +1224,15 @@ int IOManager::RegisterHostFileDescriptor(int host_fd) {
   return -1;
 }
 
+int IOManager::GetHostFileDescriptor(int fd) {
+  int host_fd = CallWithContext(fd, [](std::shared_ptr<IOContext> context) {
+    return context->GetHostFileDescriptor();
+  });
+  if (host_fd < 0) {
+    errno = EBADF;
+  }
+  return host_fd;
+}
+
 }  // namespace io
 }  // namespace asylo
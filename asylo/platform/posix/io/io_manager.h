@@ -38,11 +38,14 @@
 #include <memory>
 #include <queue>
 #include <type_traits>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "asylo/platform/posix/io/readiness.h"
 #include "asylo/platform/storage/secure/enclave_storage_secure.h"
 #include "asylo/util/statusor.h"
 
@@ -268,8 +271,37 @@ class IOManager {
 
     virtual int GetHostFileDescriptor() { return -1; }
 
+    // Returns the poll(2) events currently pending on this stream if it is
+    // implemented inside the enclave, or -1 if its readiness is determined by
+    // its host file descriptor.
+    virtual int PollEvents() { return -1; }
+
+    // Registers |waiter| to be notified whenever the result of PollEvents() may
+    // have changed. Only meaningful for streams implemented inside the enclave.
+    virtual void AddReadinessWaiter(
+        const std::shared_ptr<ReadinessWaiter> &waiter) {}
+
+    // Unregisters a waiter added with AddReadinessWaiter().
+    virtual void RemoveReadinessWaiter(const ReadinessWaiter *waiter) {}
+
+    // Returns a counter that advances whenever one of the poll(2) |events| may
+    // have newly become pending, which edge-triggered epoll uses to tell a new
+    // readiness change from one it has already reported. Only meaningful for
+    // streams implemented inside the enclave.
+    virtual uint64_t ReadinessGeneration(int events) { return 0; }
+
+    // Implements epoll_ctl for an enclave-virtual stream |context| referred to
+    // by the enclave file descriptor |fd|.
+    virtual int EpollCtl(int op, int fd, std::shared_ptr<IOContext> context,
+                         struct epoll_event *event) {
+      errno = EINVAL;
+      return -1;
+    }
+
    private:
     friend class IOManager;
+    // Watches enclave-virtual streams through their readiness interface.
+    friend class IOContextEpoll;
   };
 
   // A VirtualPathHandler maps file paths to appropriate behavior
@@ -530,8 +562,16 @@ class IOManager {
   // combination of O_CLOEXEC, O_DIRECT, and O_NONBLOCK. The array |pipefd| is
   // used to return two file descriptors referring to the ends of the pipe.
   // |pipefd[0]| refers to the read end while |pipefd[1]| refers to the write
-  // end.
-  int Pipe(int pipefd[2], int flags);
+  // end. The pipe is buffered in enclave memory and never exits the enclave,
+  // unless host pipes were selected with SetUseHostPipes().
+  int Pipe(int pipefd[2], int flags) ABSL_LOCKS_EXCLUDED(fd_table_lock_);
+
+  // Selects whether Pipe() creates host pipes rather than enclave-resident
+  // ones. A pipe buffered in enclave memory is not shared with a child created
+  // by fork(), so enclaves that fork need host pipes to talk to their children.
+  void SetUseHostPipes(bool use_host_pipes) {
+    use_host_pipes_ = use_host_pipes;
+  }
 
   // Reads up to |count| bytes from the stream into |buf|, returning the number
   // of bytes read on success or -1 on error.
@@ -589,9 +629,9 @@ class IOManager {
   // Implements ftruncate(2).
   int FTruncate(int fd, off_t length);
 
-  // Implements select(2).
+  // Implements select(2) on top of Poll().
   int Select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
-             struct timeval *timeout);
+             struct timeval *timeout) ABSL_LOCKS_EXCLUDED(fd_table_lock_);
 
   // Implements poll(2).
   int Poll(struct pollfd *fds, nfds_t nfds, int timeout)
@@ -601,7 +641,8 @@ class IOManager {
   int EpollCreate(int size) ABSL_LOCKS_EXCLUDED(fd_table_lock_);
 
   // Implements epoll_ctl(2);
-  int EpollCtl(int epfd, int op, int fd, struct epoll_event *event);
+  int EpollCtl(int epfd, int op, int fd, struct epoll_event *event)
+      ABSL_LOCKS_EXCLUDED(fd_table_lock_);
 
   // Implements epoll_wait(2);
   int EpollWait(int epfd, struct epoll_event *events, int maxevents,
@@ -686,6 +727,11 @@ class IOManager {
   // Implements socket(2).
   int Socket(int domain, int type, int protocol);
 
+  // Implements socketpair(2) for AF_UNIX stream sockets. Like Pipe(), the
+  // connection is buffered in enclave memory and never exits the enclave.
+  int SocketPair(int domain, int type, int protocol, int sv[2])
+      ABSL_LOCKS_EXCLUDED(fd_table_lock_);
+
   // Implements eventfd(2).
   int EventFd(unsigned int initval, int flags)
       ABSL_LOCKS_EXCLUDED(fd_table_lock_);
@@ -708,6 +754,11 @@ class IOManager {
   int RegisterHostFileDescriptor(int host_fd)
       ABSL_LOCKS_EXCLUDED(fd_table_lock_);
 
+  // Returns the host file descriptor which an enclave file descriptor delegates
+  // to, or -1 with errno set to EBADF if |fd| is not open or is not backed by a
+  // host file descriptor.
+  int GetHostFileDescriptor(int fd) ABSL_LOCKS_EXCLUDED(fd_table_lock_);
+
   // Registers the handler responsible for a given path prefix.
   // When processing a path, the handler with the longest prefix shared with the
   // path will be chosen.  Prefixes are considered shared only on whole
@@ -734,16 +785,49 @@ class IOManager {
   // relative paths and path normalization.
   StatusOr<std::string> CanonicalizePath(absl::string_view path) const;
 
+  // Canonicalizes |path| as above into |buffer|, which must hold at least
+  // PATH_MAX bytes, and sets |handler| to the VirtualPathHandler for the
+  // result, or nullptr if there is none. Performs no allocation on success.
+  Status CanonicalizePath(absl::string_view path, char *buffer,
+                          VirtualPathHandler **handler) const;
+
   // Closes a file descriptor by removing it from |fd_table_|, and closing the
   // corresponding host file descriptor if this is the last reference to it.
   // This method does not obtain a locker. Caller of this method is responsible
   // for obtaining |fd_table_lock_|.
   int CloseFileDescriptor(int fd) ABSL_EXCLUSIVE_LOCKS_REQUIRED(fd_table_lock_);
 
+  // Inserts the two ends of a pipe or socket pair into |fd_table_|, taking
+  // ownership of them, and returns their file descriptors in |fds|.
+  int InsertPair(std::unique_ptr<IOContext> first,
+                 std::unique_ptr<IOContext> second, int fds[2])
+      ABSL_LOCKS_EXCLUDED(fd_table_lock_);
+
+  // Implements Poll() for a set that includes enclave-virtual streams.
+  // |virtual_contexts| holds the context of each entry of |fds| that is such a
+  // stream and nullptr elsewhere; the other entries of |fds| already hold host
+  // file descriptors.
+  int PollVirtual(
+      struct pollfd *fds, nfds_t nfds,
+      const std::vector<std::shared_ptr<IOContext>> &virtual_contexts,
+      int timeout) ABSL_LOCKS_EXCLUDED(waiters_lock_);
+
+  // Takes a ReadinessWaiter from |idle_waiters_|, or creates one, and returns
+  // it to the pool. Pooling keeps the host wakeup pipe of a waiter alive across
+  // calls to Poll().
+  std::shared_ptr<ReadinessWaiter> AcquireReadinessWaiter()
+      ABSL_LOCKS_EXCLUDED(waiters_lock_);
+  void ReleaseReadinessWaiter(std::shared_ptr<ReadinessWaiter> waiter)
+      ABSL_LOCKS_EXCLUDED(waiters_lock_);
+
   // Fetches the VirtualFileHandler associated with a given path, or
   // nullptr if no entry is found.
   VirtualPathHandler *HandlerForPath(absl::string_view path) const;
 
+  // Rebuilds |prefix_trie_| and |current_working_directory_handler_| from
+  // |prefix_to_handler_|. Called whenever the set of handlers changes.
+  void RebuildPrefixTrie();
+
   // Locks the mutex corresponding to |fd| and performs thread safe action.
   template <typename IOAction, typename ReturnType = typename std::result_of<
                                    IOAction(std::shared_ptr<IOContext>)>::type>
@@ -771,12 +855,40 @@ class IOManager {
   // A map from path prefix to VirtualPathHandler.
   std::map<std::string, std::unique_ptr<VirtualPathHandler>> prefix_to_handler_;
 
+  // A node in the trie of registered path prefixes. Each edge is labelled with
+  // one path component, so that a lookup walks a canonical path one component
+  // at a time.
+  struct PrefixTrieNode {
+    // The handler registered for the prefix ending at this node, if any.
+    VirtualPathHandler *handler = nullptr;
+
+    // Indices into |prefix_trie_| of the children of this node, keyed by path
+    // component.
+    absl::flat_hash_map<std::string, size_t> children;
+  };
+
+  // The nodes of the prefix trie. The root node, which corresponds to the
+  // empty prefix, is at index 0.
+  std::vector<PrefixTrieNode> prefix_trie_ = std::vector<PrefixTrieNode>(1);
+
   FileDescriptorTable fd_table_;
 
   // A mutex that locks the fd_table_.
   absl::Mutex fd_table_lock_;
 
+  // Idle waiters for Poll() calls that watch enclave-virtual streams.
+  absl::Mutex waiters_lock_;
+  std::vector<std::shared_ptr<ReadinessWaiter>> idle_waiters_
+      ABSL_GUARDED_BY(waiters_lock_);
+
+  // The current working directory, in canonical form.
   std::string current_working_directory_;
+
+  // The handler for |current_working_directory_|.
+  VirtualPathHandler *current_working_directory_handler_ = nullptr;
+
+  // Whether Pipe() creates host pipes.
+  std::atomic<bool> use_host_pipes_{false};
 };
 
 }  // namespace io
@@ -0,0 +1,80 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <limits.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/platform/posix/io/util.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace io {
+namespace util {
+namespace {
+
+// Normalizes a set of relative paths typical of file system workloads for one
+// second using both variants of NormalizePath, and logs the achieved rates.
+TEST(PathNormalizationBenchmark, Throughput) {
+  constexpr absl::Duration kBenchmarkDuration = absl::Seconds(1);
+  const std::vector<std::string> paths = {
+      "data/db/000123.sst",
+      "./data/db/../db/MANIFEST-000001",
+      "logs//2019/10/01/server.log",
+      "../../../usr/share/zoneinfo/America/Los_Angeles",
+  };
+  const std::string base = "/home/enclave/working/directory";
+
+  uint64_t iterations = 0;
+  absl::Time start = absl::Now();
+  while (absl::Now() - start < kBenchmarkDuration) {
+    for (const std::string &path : paths) {
+      std::string normalized = NormalizePath(absl::StrCat(base, "/", path));
+      ASSERT_FALSE(normalized.empty());
+    }
+    ++iterations;
+  }
+  double string_rate = iterations * paths.size() /
+                       absl::ToDoubleSeconds(absl::Now() - start);
+
+  char buffer[PATH_MAX];
+  iterations = 0;
+  start = absl::Now();
+  while (absl::Now() - start < kBenchmarkDuration) {
+    for (const std::string &path : paths) {
+      ASSERT_NE(NormalizePath(base, path, buffer, PATH_MAX), 0);
+    }
+    ++iterations;
+  }
+  double buffer_rate = iterations * paths.size() /
+                       absl::ToDoubleSeconds(absl::Now() - start);
+
+  LOG(INFO) << "std::string: " << string_rate << " paths/s, buffer: "
+            << buffer_rate << " paths/s";
+}
+
+}  // namespace
+}  // namespace util
+}  // namespace io
+}  // namespace asylo
@@ -16,6 +16,9 @@
  *
  */
 
+#include <limits.h>
+
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -59,6 +62,44 @@ TEST_P(PathNormalizationTest, HasExpectedResult) {
   EXPECT_EQ(NormalizePath(params.first), params.second);
 }
 
+// Verifies that the buffer variant of NormalizePath produces the same output
+// and reports its length.
+TEST_P(PathNormalizationTest, BufferHasExpectedResult) {
+  PathParams::value_type params = GetParam();
+  char buffer[PATH_MAX];
+  size_t length = NormalizePath(/*base=*/"", params.first, buffer, PATH_MAX);
+  EXPECT_EQ(absl::string_view(buffer, length), params.second);
+  EXPECT_EQ(buffer[length], '\0');
+}
+
+// Verifies that paths are resolved relative to |base|, and that ".."
+// components may back up through it.
+TEST(PathNormalizationBufferTest, ResolvesRelativeToBase) {
+  char buffer[PATH_MAX];
+  EXPECT_EQ(absl::string_view(buffer, NormalizePath("/foo/bar", "baz", buffer,
+                                                    PATH_MAX)),
+            "/foo/bar/baz");
+  EXPECT_EQ(absl::string_view(
+                buffer, NormalizePath("/foo/bar", "../../..//baz/.", buffer,
+                                      PATH_MAX)),
+            "/baz");
+  EXPECT_EQ(absl::string_view(buffer, NormalizePath("/", "./baz", buffer,
+                                                    PATH_MAX)),
+            "/baz");
+  EXPECT_EQ(absl::string_view(buffer,
+                              NormalizePath("/foo", "..", buffer, PATH_MAX)),
+            "/");
+}
+
+// Verifies that NormalizePath fails rather than overflowing a short buffer.
+TEST(PathNormalizationBufferTest, RejectsShortBuffer) {
+  char buffer[8];
+  EXPECT_EQ(NormalizePath("", "/foo/bar", buffer, sizeof(buffer)), 0);
+  EXPECT_EQ(NormalizePath("", "/foo/ba", buffer, sizeof(buffer)), 7);
+  EXPECT_EQ(NormalizePath("/foo/bar/baz", "..", buffer, sizeof(buffer)), 0);
+  EXPECT_EQ(NormalizePath("", "/", buffer, 1), 0);
+}
+
 // Returns a mapping of inputs to outputs to be verified.
 PathParams GetTestPathParams() {
   return {
@@ -0,0 +1,141 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/posix/io/readiness.h"
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+
+#include "absl/time/clock.h"
+
+#include "asylo/platform/host_call/trusted/host_calls.h"
+
+namespace asylo {
+namespace io {
+
+ReadinessWaiter::~ReadinessWaiter() {
+  absl::MutexLock lock(&mu_);
+  if (wakeup_read_fd_ != -1) {
+    enc_untrusted_close(wakeup_read_fd_);
+    enc_untrusted_close(wakeup_write_fd_);
+  }
+}
+
+void ReadinessWaiter::Notify() {
+  absl::MutexLock lock(&mu_);
+  generation_.fetch_add(1);
+  // Only exit the enclave if a thread is actually blocked on the host, and
+  // only once until that wakeup is drained.
+  if (host_waiters_ > 0 && !wakeup_pending_) {
+    char byte = 0;
+    if (enc_untrusted_write(wakeup_write_fd_, &byte, 1) == 1) {
+      wakeup_pending_ = true;
+    }
+  }
+}
+
+bool ReadinessWaiter::Wait(uint64_t generation, absl::Time deadline) {
+  auto changed = [this, generation] { return generation_ != generation; };
+  absl::MutexLock lock(&mu_);
+  return mu_.AwaitWithDeadline(absl::Condition(&changed), deadline);
+}
+
+int ReadinessWaiter::GetHostWakeupFd() {
+  absl::MutexLock lock(&mu_);
+  if (wakeup_read_fd_ == -1) {
+    int pipe_fds[2];
+    if (enc_untrusted_pipe2(pipe_fds, O_CLOEXEC | O_NONBLOCK) == -1) {
+      return -1;
+    }
+    wakeup_read_fd_ = pipe_fds[0];
+    wakeup_write_fd_ = pipe_fds[1];
+  }
+  return wakeup_read_fd_;
+}
+
+void ReadinessWaiter::BeginHostWait() {
+  absl::MutexLock lock(&mu_);
+  ++host_waiters_;
+}
+
+void ReadinessWaiter::EndHostWait() {
+  absl::MutexLock lock(&mu_);
+  if (--host_waiters_ == 0 && wakeup_pending_) {
+    char byte;
+    enc_untrusted_read(wakeup_read_fd_, &byte, 1);
+    wakeup_pending_ = false;
+  }
+}
+
+void ReadinessNotifier::AddWaiter(
+    const std::shared_ptr<ReadinessWaiter> &waiter) {
+  absl::MutexLock lock(&mu_);
+  waiters_.push_back(waiter);
+  size_ = waiters_.size();
+}
+
+void ReadinessNotifier::RemoveWaiter(const ReadinessWaiter *waiter) {
+  absl::MutexLock lock(&mu_);
+  // Also prune waiters that have been destroyed.
+  waiters_.erase(std::remove_if(waiters_.begin(), waiters_.end(),
+                                [waiter](const std::weak_ptr<ReadinessWaiter>
+                                             &entry) {
+                                  std::shared_ptr<ReadinessWaiter> locked =
+                                      entry.lock();
+                                  return !locked || locked.get() == waiter;
+                                }),
+                 waiters_.end());
+  size_ = waiters_.size();
+}
+
+void ReadinessNotifier::Notify() {
+  if (size_ == 0) return;
+  std::vector<std::shared_ptr<ReadinessWaiter>> waiters;
+  {
+    absl::MutexLock lock(&mu_);
+    waiters.reserve(waiters_.size());
+    for (const auto &entry : waiters_) {
+      std::shared_ptr<ReadinessWaiter> waiter = entry.lock();
+      if (waiter) waiters.push_back(std::move(waiter));
+    }
+  }
+  // Notify outside |mu_|, since notifying may exit the enclave.
+  for (const auto &waiter : waiters) {
+    waiter->Notify();
+  }
+}
+
+absl::Time TimeoutToDeadline(int timeout) {
+  if (timeout < 0) return absl::InfiniteFuture();
+  return absl::Now() + absl::Milliseconds(timeout);
+}
+
+int DeadlineToTimeout(absl::Time deadline) {
+  if (deadline == absl::InfiniteFuture()) return -1;
+  absl::Duration remaining = deadline - absl::Now();
+  if (remaining <= absl::ZeroDuration()) return 0;
+  return static_cast<int>(std::min<int64_t>(
+      absl::ToInt64Milliseconds(absl::Ceil(remaining, absl::Milliseconds(1))),
+      std::numeric_limits<int>::max()));
+}
+
+}  // namespace io
+}  // namespace asylo
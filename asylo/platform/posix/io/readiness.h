@@ -0,0 +1,115 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_POSIX_IO_READINESS_H_
+#define ASYLO_PLATFORM_POSIX_IO_READINESS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace asylo {
+namespace io {
+
+// A ReadinessWaiter blocks a thread in poll(), select() or epoll_wait() until
+// an enclave-virtual stream it watches may have changed readiness. Streams call
+// Notify(), which advances the waiter's generation. A waiting thread records
+// the generation before checking readiness, so notifications that race with the
+// check are never lost.
+//
+// When a wait also covers host file descriptors, the thread blocks on the host
+// instead, and Notify() interrupts that wait by writing to a host pipe whose
+// read end is included in the host wait.
+class ReadinessWaiter {
+ public:
+  ReadinessWaiter() = default;
+  ReadinessWaiter(const ReadinessWaiter &other) = delete;
+  ReadinessWaiter &operator=(const ReadinessWaiter &other) = delete;
+  ~ReadinessWaiter();
+
+  // Returns the number of notifications received so far.
+  uint64_t generation() const { return generation_.load(); }
+
+  // Records a possible readiness change and wakes any waiting thread.
+  void Notify();
+
+  // Blocks inside the enclave until generation() differs from |generation| or
+  // |deadline| passes. Returns false on timeout.
+  bool Wait(uint64_t generation, absl::Time deadline);
+
+  // Returns a host file descriptor that becomes readable when Notify() is
+  // called between BeginHostWait() and EndHostWait(), creating it on first
+  // use. Returns -1 and sets errno on failure.
+  int GetHostWakeupFd();
+
+  // Brackets a blocking host wait that includes GetHostWakeupFd(). Several
+  // threads may be in a host wait on the same waiter at once. EndHostWait()
+  // drains any pending wakeup once the last of them returns.
+  void BeginHostWait();
+  void EndHostWait();
+
+ private:
+  std::atomic<uint64_t> generation_{0};
+
+  absl::Mutex mu_;
+
+  // The ends of the host wakeup pipe, or -1 if it has not been created.
+  int wakeup_read_fd_ ABSL_GUARDED_BY(mu_) = -1;
+  int wakeup_write_fd_ ABSL_GUARDED_BY(mu_) = -1;
+
+  // The number of threads in a host wait, and whether a wakeup has been written
+  // to the pipe and not yet drained.
+  int host_waiters_ ABSL_GUARDED_BY(mu_) = 0;
+  bool wakeup_pending_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+// The set of waiters watching one enclave-virtual stream. Waiters are held by
+// weak reference, so a stream never keeps a waiter alive and a waiter that is
+// destroyed without being removed is simply skipped.
+class ReadinessNotifier {
+ public:
+  void AddWaiter(const std::shared_ptr<ReadinessWaiter> &waiter)
+      ABSL_LOCKS_EXCLUDED(mu_);
+  void RemoveWaiter(const ReadinessWaiter *waiter) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Notifies every registered waiter. This is cheap when there are none.
+  void Notify() ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  std::atomic<size_t> size_{0};
+  absl::Mutex mu_;
+  std::vector<std::weak_ptr<ReadinessWaiter>> waiters_ ABSL_GUARDED_BY(mu_);
+};
+
+// Converts a poll(2)-style timeout in milliseconds, where a negative value
+// means no timeout, to a deadline.
+absl::Time TimeoutToDeadline(int timeout);
+
+// Converts |deadline| back to a poll(2)-style timeout, rounding up so that a
+// host wait never returns before the deadline.
+int DeadlineToTimeout(absl::Time deadline);
+
+}  // namespace io
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_POSIX_IO_READINESS_H_
@@ -18,10 +18,8 @@
 
 #include "asylo/platform/posix/io/util.h"
 
-#include <vector>
+#include <cstring>
 
-#include "absl/strings/str_cat.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 
 namespace asylo {
@@ -29,36 +27,57 @@ namespace io {
 namespace util {
 
 std::string NormalizePath(absl::string_view path) {
-  // Collects the current view of the directories in the path.
-  std::vector<absl::string_view> directories;
+  // The normalized path is never more than one character longer than |path|.
+  std::string result(path.size() + 2, '\0');
+  result.resize(NormalizePath(/*base=*/"", path, &result[0], result.size()));
+  return result;
+}
+
+size_t NormalizePath(absl::string_view base, absl::string_view path,
+                     char *buffer, size_t size) {
+  // |length| is the length of the path written to |buffer| so far. The root
+  // directory is tracked as an empty path so that every directory appended
+  // below can be written as "/name".
+  size_t length = base == "/" ? 0 : base.size();
+  if (length >= size) return 0;
+  memcpy(buffer, base.data(), length);
 
-  // Scan through the path, finding the directories.
-  size_t current_directory = 0;
-  while (current_directory < path.size()) {
+  const char *current = path.data();
+  const char *end = path.data() + path.size();
+  while (current < end) {
     // Extract the next directory name.
-    size_t next_directory = path.find_first_of('/', current_directory);
-    if (next_directory == std::string::npos) next_directory = path.size();
-    absl::string_view name =
-        path.substr(current_directory, next_directory - current_directory);
+    const char *next = static_cast<const char *>(
+        memchr(current, '/', end - current));
+    if (!next) next = end;
+    absl::string_view name(current, next - current);
 
     // Advance past the "/".
-    current_directory = next_directory + 1;
+    current = next + 1;
 
     // If the directory name is empty or ".", leave it out entirely.
     if (name.empty() || name == ".") continue;
 
-    // If the directory name is "..", back up by one.
+    // If the directory name is "..", back up by one. If already at the root,
+    // stay at the root.
     if (name == "..") {
-      // If already at the root, stay at the root.
-      if (!directories.empty()) directories.pop_back();
+      while (length > 0 && buffer[--length] != '/') {
+      }
       continue;
     }
 
-    // Otherwise, keep track of this directory.
-    directories.push_back(name);
+    // Otherwise, append this directory, leaving room for the terminator.
+    if (length + name.size() + 2 > size) return 0;
+    buffer[length++] = '/';
+    memcpy(buffer + length, name.data(), name.size());
+    length += name.size();
   }
 
-  return absl::StrCat("/", absl::StrJoin(directories, "/"));
+  if (length == 0) {
+    if (size < 2) return 0;
+    buffer[length++] = '/';
+  }
+  buffer[length] = '\0';
+  return length;
 }
 
 }  // namespace util
@@ -19,14 +19,27 @@
 #ifndef ASYLO_PLATFORM_POSIX_IO_UTIL_H_
 #define ASYLO_PLATFORM_POSIX_IO_UTIL_H_
 
+#include <cstddef>
+#include <string>
+
 #include "absl/strings/string_view.h"
 
 namespace asylo {
 namespace io {
 namespace util {
 
+// Returns |path| with empty, "." and ".." components resolved. The result is
+// always absolute.
 std::string NormalizePath(absl::string_view path);
 
+// Normalizes |path| as if it were appended to the directory |base| and writes
+// the NUL-terminated result to |buffer|, which holds |size| bytes. |base| must
+// be empty or an already-normalized absolute path, and ".." components may
+// back up into it. Performs no allocation. Returns the length of the result,
+// or 0 if it does not fit in |buffer|.
+size_t NormalizePath(absl::string_view base, absl::string_view path,
+                     char *buffer, size_t size);
+
 }  // namespace util
 }  // namespace io
 }  // namespace asylo
@@ -0,0 +1,171 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Measures the latency of pipes and of readiness wakeups on pipes. It is run
+// inside an enclave and on the host for comparison.
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ge;
+
+// Measures the round-trip latency of a small message between two threads over
+// a pair of pipes and over a socket pair, and logs the results.
+TEST(PipeBenchmark, PingPongLatency) {
+  constexpr absl::Duration kBenchmarkDuration = absl::Seconds(1);
+  constexpr char kStop = 0;
+
+  // Bounces single bytes back over |write_fd| until |kStop| is received.
+  auto echo = [](int read_fd, int write_fd) {
+    char message;
+    while (read(read_fd, &message, 1) == 1 && message != kStop) {
+      ASSERT_THAT(write(write_fd, &message, 1), Eq(1)) << strerror(errno);
+    }
+  };
+
+  // Sends single bytes over |write_fd| and waits for them to be echoed on
+  // |read_fd|, returning the mean round-trip time.
+  auto ping = [](int read_fd, int write_fd) {
+    uint64_t round_trips = 0;
+    char message = 1;
+    absl::Time start = absl::Now();
+    while (absl::Now() - start < kBenchmarkDuration) {
+      EXPECT_THAT(write(write_fd, &message, 1), Eq(1)) << strerror(errno);
+      EXPECT_THAT(read(read_fd, &message, 1), Eq(1)) << strerror(errno);
+      ++round_trips;
+    }
+    absl::Duration elapsed = absl::Now() - start;
+    message = kStop;
+    EXPECT_THAT(write(write_fd, &message, 1), Eq(1)) << strerror(errno);
+    return elapsed / round_trips;
+  };
+
+  int ping_fds[2];
+  int pong_fds[2];
+  ASSERT_THAT(pipe(ping_fds), Eq(0)) << strerror(errno);
+  ASSERT_THAT(pipe(pong_fds), Eq(0)) << strerror(errno);
+  std::thread pipe_echo(echo, ping_fds[0], pong_fds[1]);
+  absl::Duration pipe_latency = ping(pong_fds[0], ping_fds[1]);
+  pipe_echo.join();
+  for (int fd : {ping_fds[0], ping_fds[1], pong_fds[0], pong_fds[1]}) {
+    EXPECT_THAT(close(fd), Eq(0)) << strerror(errno);
+  }
+
+  int socket_fds[2];
+  ASSERT_THAT(socketpair(AF_UNIX, SOCK_STREAM, 0, socket_fds), Eq(0))
+      << strerror(errno);
+  std::thread socket_echo(echo, socket_fds[1], socket_fds[1]);
+  absl::Duration socket_latency = ping(socket_fds[0], socket_fds[0]);
+  socket_echo.join();
+  for (int fd : socket_fds) {
+    EXPECT_THAT(close(fd), Eq(0)) << strerror(errno);
+  }
+
+  LOG(INFO) << "Round trip over pipes: " << pipe_latency
+            << ", over a socket pair: " << socket_latency;
+}
+
+// Measures the latency of waking a thread blocked in poll() or epoll_wait() on
+// a pipe with a write from another thread, and logs the results.
+TEST(PipeBenchmark, WakeupLatency) {
+  constexpr absl::Duration kBenchmarkDuration = absl::Seconds(1);
+  constexpr char kStop = 0;
+
+  // Waits for readiness with |wait|, then bounces the byte read back over
+  // |write_fd|, until |kStop| is received.
+  auto echo = [](int read_fd, int write_fd, std::function<void()> wait) {
+    char message;
+    do {
+      wait();
+      ASSERT_THAT(read(read_fd, &message, 1), Eq(1)) << strerror(errno);
+      ASSERT_THAT(write(write_fd, &message, 1), Eq(1)) << strerror(errno);
+    } while (message != kStop);
+  };
+
+  // Sends single bytes over |write_fd| and waits for them to be echoed on
+  // |read_fd|, returning the mean round-trip time.
+  auto ping = [](int read_fd, int write_fd) {
+    uint64_t round_trips = 0;
+    char message = 1;
+    absl::Time start = absl::Now();
+    while (absl::Now() - start < kBenchmarkDuration) {
+      EXPECT_THAT(write(write_fd, &message, 1), Eq(1)) << strerror(errno);
+      EXPECT_THAT(read(read_fd, &message, 1), Eq(1)) << strerror(errno);
+      ++round_trips;
+    }
+    absl::Duration elapsed = absl::Now() - start;
+    message = kStop;
+    EXPECT_THAT(write(write_fd, &message, 1), Eq(1)) << strerror(errno);
+    EXPECT_THAT(read(read_fd, &message, 1), Eq(1)) << strerror(errno);
+    return elapsed / round_trips;
+  };
+
+  int ping_fds[2];
+  int pong_fds[2];
+  ASSERT_THAT(pipe(ping_fds), Eq(0)) << strerror(errno);
+  ASSERT_THAT(pipe(pong_fds), Eq(0)) << strerror(errno);
+  int epoll_fd = epoll_create(1);
+  ASSERT_THAT(epoll_fd, Ge(0)) << strerror(errno);
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  ASSERT_THAT(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ping_fds[0], &event), Eq(0))
+      << strerror(errno);
+
+  int read_fd = ping_fds[0];
+  std::thread poll_echo(echo, ping_fds[0], pong_fds[1], [read_fd] {
+    struct pollfd fds = {read_fd, POLLIN, 0};
+    ASSERT_THAT(poll(&fds, 1, -1), Eq(1)) << strerror(errno);
+  });
+  absl::Duration poll_latency = ping(pong_fds[0], ping_fds[1]);
+  poll_echo.join();
+
+  std::thread epoll_echo(echo, ping_fds[0], pong_fds[1], [epoll_fd] {
+    struct epoll_event ready;
+    ASSERT_THAT(epoll_wait(epoll_fd, &ready, 1, -1), Eq(1)) << strerror(errno);
+  });
+  absl::Duration epoll_latency = ping(pong_fds[0], ping_fds[1]);
+  epoll_echo.join();
+
+  for (int fd :
+       {ping_fds[0], ping_fds[1], pong_fds[0], pong_fds[1], epoll_fd}) {
+    EXPECT_THAT(close(fd), Eq(0)) << strerror(errno);
+  }
+
+  LOG(INFO) << "Round trip with poll() wakeups: " << poll_latency
+            << ", with epoll_wait() wakeups: " << epoll_latency;
+}
+
+}  // namespace
+}  // namespace asylo
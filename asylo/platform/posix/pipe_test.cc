@@ -17,7 +17,8 @@
  */
 
 // This test checks the POSIX-compliance of Asylo's implementations of pipe(),
-// pipe2(), and the F_(GET|SET)PIPE_SZ commands to fcntl(). It is run inside an
+// pipe2(), the F_(GET|SET)PIPE_SZ commands to fcntl(), and readiness reporting
+// of pipes through poll(), select() and epoll. It is run inside an
 // enclave. It is also independently run on the host to confirm the test logic.
 
 // For pipe2().
@@ -26,20 +27,27 @@
 #endif  // _GNU_SOURCE
 
 #include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/select.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <algorithm>
 #include <bitset>
 #include <cerrno>
 #include <climits>
 #include <cstdint>
 #include <cstring>
 #include <ostream>
+#include <thread>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "asylo/util/cleanup.h"
 
@@ -823,5 +831,155 @@ TEST_F(PipeTest, FcntlCannotShrinkPipeBelowCurrentlyHeldBytes) {
   EXPECT_THAT(errno, Eq(EBUSY));
 }
 
+// Tests that reads from a pipe whose write end is closed return end-of-file
+// once the buffered data is consumed.
+TEST_F(PipeTest, ReadsAfterWriteEndIsClosedReturnEof) {
+  int pipe_fds[2];
+  ASSERT_THAT(pipe(pipe_fds), Eq(0)) << strerror(errno);
+  int read_fd = pipe_fds[0];
+  Cleanup close_read(
+      [read_fd] { ASSERT_THAT(close(read_fd), Eq(0)) << strerror(errno); });
+
+  ASSERT_THAT(write(pipe_fds[1], small_data_.data(), small_data_.size()),
+              Eq(small_data_.size()))
+      << strerror(errno);
+  ASSERT_THAT(close(pipe_fds[1]), Eq(0)) << strerror(errno);
+
+  std::vector<uint8_t> read_buf(medium_data_.size());
+  ASSERT_THAT(read(read_fd, read_buf.data(), read_buf.size()),
+              Eq(small_data_.size()))
+      << strerror(errno);
+  EXPECT_THAT(read(read_fd, read_buf.data(), read_buf.size()), Eq(0));
+}
+
+// Tests that data larger than the pipe's buffer is transferred intact between
+// a blocking writer and a blocking reader on another thread.
+TEST_F(PipeTest, BlockingTransferBetweenThreadsPreservesData) {
+  int pipe_fds[2];
+  ASSERT_THAT(pipe(pipe_fds), Eq(0)) << strerror(errno);
+  int read_fd = pipe_fds[0];
+  int write_fd = pipe_fds[1];
+  Cleanup close_read(
+      [read_fd] { ASSERT_THAT(close(read_fd), Eq(0)) << strerror(errno); });
+
+  std::thread writer([this, write_fd] {
+    EXPECT_THAT(write(write_fd, large_data_.data(), large_data_.size()),
+                Eq(large_data_.size()))
+        << strerror(errno);
+    EXPECT_THAT(close(write_fd), Eq(0)) << strerror(errno);
+  });
+
+  std::vector<uint8_t> read_buf(large_data_.size());
+  size_t total = 0;
+  ssize_t read_result;
+  while ((read_result = read(read_fd, read_buf.data() + total,
+                             read_buf.size() - total)) > 0) {
+    total += read_result;
+  }
+  writer.join();
+  ASSERT_THAT(read_result, Eq(0)) << strerror(errno);
+  ASSERT_THAT(total, Eq(large_data_.size()));
+  EXPECT_THAT(read_buf.data(), MemEq(large_data_.data(), large_data_.size()));
+}
+
+// Tests that poll() reports the read end of a pipe as readable once data is
+// written, and as hung up once the write end is closed.
+TEST_F(PipeTest, PollReportsPipeReadiness) {
+  int pipe_fds[2];
+  ASSERT_THAT(pipe(pipe_fds), Eq(0)) << strerror(errno);
+  Cleanup close_read([&pipe_fds] {
+    ASSERT_THAT(close(pipe_fds[0]), Eq(0)) << strerror(errno);
+  });
+
+  struct pollfd fds[2] = {{pipe_fds[0], POLLIN, 0}, {pipe_fds[1], POLLOUT, 0}};
+  ASSERT_THAT(poll(fds, 2, 0), Eq(1)) << strerror(errno);
+  EXPECT_THAT(fds[0].revents, Eq(0));
+  EXPECT_THAT(fds[1].revents, Eq(POLLOUT));
+
+  ASSERT_THAT(write(pipe_fds[1], small_data_.data(), small_data_.size()),
+              Eq(small_data_.size()))
+      << strerror(errno);
+  ASSERT_THAT(poll(fds, 1, 0), Eq(1)) << strerror(errno);
+  EXPECT_THAT(fds[0].revents, Eq(POLLIN));
+
+  ASSERT_THAT(close(pipe_fds[1]), Eq(0)) << strerror(errno);
+  ASSERT_THAT(poll(fds, 1, 0), Eq(1)) << strerror(errno);
+  EXPECT_THAT(fds[0].revents, Eq(POLLIN | POLLHUP));
+}
+
+// Tests that select() reports the ends of a pipe as ready.
+TEST_F(PipeTest, SelectReportsPipeReadiness) {
+  int pipe_fds[2];
+  ASSERT_THAT(pipe(pipe_fds), Eq(0)) << strerror(errno);
+  Cleanup close_pipe([&pipe_fds] {
+    ASSERT_THAT(close(pipe_fds[0]), Eq(0)) << strerror(errno);
+    ASSERT_THAT(close(pipe_fds[1]), Eq(0)) << strerror(errno);
+  });
+  int nfds = std::max(pipe_fds[0], pipe_fds[1]) + 1;
+
+  fd_set read_fds;
+  fd_set write_fds;
+  FD_ZERO(&read_fds);
+  FD_ZERO(&write_fds);
+  FD_SET(pipe_fds[0], &read_fds);
+  FD_SET(pipe_fds[1], &write_fds);
+  struct timeval timeout = {0, 0};
+  ASSERT_THAT(select(nfds, &read_fds, &write_fds, nullptr, &timeout), Eq(1))
+      << strerror(errno);
+  EXPECT_FALSE(FD_ISSET(pipe_fds[0], &read_fds));
+  EXPECT_TRUE(FD_ISSET(pipe_fds[1], &write_fds));
+
+  ASSERT_THAT(write(pipe_fds[1], small_data_.data(), small_data_.size()),
+              Eq(small_data_.size()))
+      << strerror(errno);
+  FD_ZERO(&read_fds);
+  FD_SET(pipe_fds[0], &read_fds);
+  ASSERT_THAT(select(nfds, &read_fds, nullptr, nullptr, &timeout), Eq(1))
+      << strerror(errno);
+  EXPECT_TRUE(FD_ISSET(pipe_fds[0], &read_fds));
+}
+
+// Tests that a thread blocked in poll() or epoll_wait() on a pipe is woken by a
+// write from another thread.
+TEST_F(PipeTest, WaitsAreWokenByWritesFromAnotherThread) {
+  int pipe_fds[2];
+  ASSERT_THAT(pipe(pipe_fds), Eq(0)) << strerror(errno);
+  Cleanup close_pipe([&pipe_fds] {
+    ASSERT_THAT(close(pipe_fds[0]), Eq(0)) << strerror(errno);
+    ASSERT_THAT(close(pipe_fds[1]), Eq(0)) << strerror(errno);
+  });
+  int epoll_fd = epoll_create(1);
+  ASSERT_THAT(epoll_fd, Ge(0)) << strerror(errno);
+  Cleanup close_epoll(
+      [epoll_fd] { ASSERT_THAT(close(epoll_fd), Eq(0)) << strerror(errno); });
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = 42;
+  ASSERT_THAT(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event), Eq(0))
+      << strerror(errno);
+
+  auto write_later = [&pipe_fds] {
+    absl::SleepFor(absl::Milliseconds(10));
+    char message = 1;
+    EXPECT_THAT(write(pipe_fds[1], &message, 1), Eq(1)) << strerror(errno);
+  };
+  char message;
+
+  std::thread poll_writer(write_later);
+  struct pollfd fds = {pipe_fds[0], POLLIN, 0};
+  EXPECT_THAT(poll(&fds, 1, -1), Eq(1)) << strerror(errno);
+  EXPECT_THAT(fds.revents, Eq(POLLIN));
+  poll_writer.join();
+  ASSERT_THAT(read(pipe_fds[0], &message, 1), Eq(1)) << strerror(errno);
+
+  std::thread epoll_writer(write_later);
+  struct epoll_event ready = {};
+  EXPECT_THAT(epoll_wait(epoll_fd, &ready, 1, -1), Eq(1)) << strerror(errno);
+  EXPECT_THAT(ready.events, Eq(EPOLLIN));
+  EXPECT_THAT(ready.data.u64, Eq(42));
+  epoll_writer.join();
+  ASSERT_THAT(read(pipe_fds[0], &message, 1), Eq(1)) << strerror(errno);
+}
+
 }  // namespace
 }  // namespace asylo
@@ -0,0 +1,160 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// This test checks the behavior of Asylo's implementation of socketpair() for
+// AF_UNIX stream sockets. It is run inside an enclave. It is also independently
+// run on the host to confirm the test logic.
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "asylo/util/cleanup.h"
+
+namespace asylo {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ne;
+using ::testing::StrEq;
+
+class SocketPairTest : public ::testing::Test {
+ protected:
+  // Creates a socket pair of the given |type| in |fds_|.
+  void CreateSocketPair(int type) {
+    ASSERT_THAT(socketpair(AF_UNIX, type, 0, fds_), Eq(0)) << strerror(errno);
+  }
+
+  void TearDown() override {
+    for (int fd : fds_) {
+      if (fd >= 0) EXPECT_THAT(close(fd), Eq(0)) << strerror(errno);
+    }
+  }
+
+  int fds_[2] = {-1, -1};
+};
+
+// Tests that data written to either end of a socket pair is read from the
+// other end.
+TEST_F(SocketPairTest, DataFlowsInBothDirections) {
+  CreateSocketPair(SOCK_STREAM);
+  char buf[16] = {};
+
+  ASSERT_THAT(write(fds_[0], "ping", 5), Eq(5)) << strerror(errno);
+  ASSERT_THAT(read(fds_[1], buf, sizeof(buf)), Eq(5)) << strerror(errno);
+  EXPECT_THAT(buf, StrEq("ping"));
+
+  ASSERT_THAT(send(fds_[1], "pong", 5, 0), Eq(5)) << strerror(errno);
+  ASSERT_THAT(recv(fds_[0], buf, sizeof(buf), 0), Eq(5)) << strerror(errno);
+  EXPECT_THAT(buf, StrEq("pong"));
+}
+
+// Tests that the file descriptors of a socket pair refer to sockets.
+TEST_F(SocketPairTest, FdsAreSockets) {
+  CreateSocketPair(SOCK_STREAM);
+
+  struct stat statbuf;
+  ASSERT_THAT(fstat(fds_[0], &statbuf), Eq(0)) << strerror(errno);
+  EXPECT_TRUE(S_ISSOCK(statbuf.st_mode));
+}
+
+// Tests that both ends of a socket pair are unnamed AF_UNIX stream sockets.
+TEST_F(SocketPairTest, EndsAreUnnamedStreamSockets) {
+  CreateSocketPair(SOCK_STREAM);
+
+  for (int fd : fds_) {
+    struct sockaddr_storage addr = {};
+    socklen_t addrlen = sizeof(addr);
+    ASSERT_THAT(
+        getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &addrlen),
+        Eq(0))
+        << strerror(errno);
+    EXPECT_THAT(addrlen, Eq(sizeof(sa_family_t)));
+    EXPECT_THAT(addr.ss_family, Eq(AF_UNIX));
+
+    addr = {};
+    addrlen = sizeof(addr);
+    ASSERT_THAT(
+        getpeername(fd, reinterpret_cast<struct sockaddr *>(&addr), &addrlen),
+        Eq(0))
+        << strerror(errno);
+    EXPECT_THAT(addrlen, Eq(sizeof(sa_family_t)));
+    EXPECT_THAT(addr.ss_family, Eq(AF_UNIX));
+
+    int type = 0;
+    socklen_t optlen = sizeof(type);
+    ASSERT_THAT(getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &optlen), Eq(0))
+        << strerror(errno);
+    EXPECT_THAT(type, Eq(SOCK_STREAM));
+  }
+}
+
+// Tests that SOCK_NONBLOCK socket pairs fail reads with EAGAIN when empty, and
+// that MSG_DONTWAIT does the same on a blocking socket pair.
+TEST_F(SocketPairTest, NonBlockingReadsFailWithEAgain) {
+  CreateSocketPair(SOCK_STREAM | SOCK_NONBLOCK);
+  char buf;
+
+  int fd_flags = fcntl(fds_[0], F_GETFL, 0);
+  ASSERT_THAT(fd_flags, Ne(-1)) << strerror(errno);
+  EXPECT_TRUE(fd_flags & O_NONBLOCK);
+
+  ASSERT_THAT(read(fds_[0], &buf, 1), Eq(-1));
+  EXPECT_THAT(errno, Eq(EAGAIN));
+
+  ASSERT_THAT(fcntl(fds_[0], F_SETFL, fd_flags & ~O_NONBLOCK), Eq(0))
+      << strerror(errno);
+  ASSERT_THAT(recv(fds_[0], &buf, 1, MSG_DONTWAIT), Eq(-1));
+  EXPECT_THAT(errno, Eq(EAGAIN));
+}
+
+// Tests that shutting down the writing side of one end is seen as end-of-file
+// by the other end, while data still flows in the opposite direction.
+TEST_F(SocketPairTest, ShutdownWriteGivesEofToPeer) {
+  CreateSocketPair(SOCK_STREAM);
+  char buf;
+
+  ASSERT_THAT(shutdown(fds_[0], SHUT_WR), Eq(0)) << strerror(errno);
+  EXPECT_THAT(read(fds_[1], &buf, 1), Eq(0));
+
+  ASSERT_THAT(write(fds_[1], "x", 1), Eq(1)) << strerror(errno);
+  ASSERT_THAT(read(fds_[0], &buf, 1), Eq(1)) << strerror(errno);
+  EXPECT_THAT(buf, Eq('x'));
+}
+
+// Tests that closing one end is seen as end-of-file by the other end.
+TEST_F(SocketPairTest, CloseGivesEofToPeer) {
+  CreateSocketPair(SOCK_STREAM);
+  char buf;
+
+  ASSERT_THAT(write(fds_[0], "x", 1), Eq(1)) << strerror(errno);
+  ASSERT_THAT(close(fds_[0]), Eq(0)) << strerror(errno);
+  fds_[0] = -1;
+
+  EXPECT_THAT(read(fds_[1], &buf, 1), Eq(1));
+  EXPECT_THAT(read(fds_[1], &buf, 1), Eq(0));
+}
+
+}  // namespace
+}  // namespace asylo
@@ -0,0 +1,193 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/posix/sockets/addrinfo_cache.h"
+
+#include <time.h>
+
+#include <cstdlib>
+#include <iterator>
+#include <utility>
+
+#include "asylo/platform/host_call/serializer_functions.h"
+#include "asylo/platform/host_call/trusted/host_calls.h"
+
+namespace asylo {
+
+using host_call::CopyAddrinfo;
+using host_call::FreeDeserializedAddrinfo;
+
+bool AddrinfoCache::Key::operator==(const Key &other) const {
+  return has_node == other.has_node && node == other.node &&
+         has_service == other.has_service && service == other.service &&
+         has_hints == other.has_hints && flags == other.flags &&
+         family == other.family && socktype == other.socktype &&
+         protocol == other.protocol;
+}
+
+AddrinfoCache::AddrinfoCache(ResolveFunction resolve, ClockFunction clock)
+    : resolve_(resolve), clock_(clock) {}
+
+AddrinfoCache::~AddrinfoCache() { Clear(); }
+
+absl::Time AddrinfoCache::MonotonicNow() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    return absl::InfiniteFuture();
+  }
+  return absl::UnixEpoch() + absl::DurationFromTimespec(ts);
+}
+
+AddrinfoCache *AddrinfoCache::Instance() {
+  static AddrinfoCache *instance =
+      new AddrinfoCache(enc_untrusted_getaddrinfo);
+  return instance;
+}
+
+void AddrinfoCache::Configure(const AddrinfoCacheOptions &options) {
+  absl::MutexLock lock(&mu_);
+  options_ = options;
+  Trim(options_.capacity);
+}
+
+AddrinfoCacheOptions AddrinfoCache::options() const {
+  absl::MutexLock lock(&mu_);
+  return options_;
+}
+
+int AddrinfoCache::GetAddrinfo(const char *node, const char *service,
+                               const struct addrinfo *hints,
+                               struct addrinfo **res) {
+  Key key = MakeKey(node, service, hints);
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      EntryList::iterator entry = it->second;
+      if (clock_() < entry->expiry) {
+        entries_.splice(entries_.begin(), entries_, entry);
+        if (entry->status != 0) return entry->status;
+        *res = CopyAddrinfo(entry->result);
+        return *res ? 0 : EAI_MEMORY;
+      }
+      Evict(entry);
+    }
+  }
+
+  // Resolve without holding the lock, since the lookup exits the enclave.
+  // Concurrent misses on the same key each resolve, and the last one to
+  // finish is cached.
+  struct addrinfo *result = nullptr;
+  int status = resolve_(node, service, hints, &result);
+
+  absl::MutexLock lock(&mu_);
+  absl::Duration ttl = TtlFor(status);
+  if (options_.capacity == 0 || ttl <= absl::ZeroDuration() ||
+      (status == 0 && !result)) {
+    if (status == 0) *res = result;
+    return status;
+  }
+
+  // A clock that cannot be read reports the infinite future. That expires
+  // entries on lookup, but would make a new entry never expire.
+  absl::Time expiry = clock_() + ttl;
+  if (expiry == absl::InfiniteFuture()) {
+    if (status == 0) *res = result;
+    return status;
+  }
+
+  struct addrinfo *cached = nullptr;
+  if (status == 0) {
+    cached = CopyAddrinfo(result);
+    if (!cached) {
+      *res = result;
+      return status;
+    }
+  }
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    Evict(it->second);
+  }
+  entries_.push_front(Entry{key, status, cached, expiry});
+  index_.emplace(std::move(key), entries_.begin());
+  Trim(options_.capacity);
+
+  if (status == 0) *res = result;
+  return status;
+}
+
+void AddrinfoCache::Clear() {
+  absl::MutexLock lock(&mu_);
+  Trim(0);
+}
+
+size_t AddrinfoCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+AddrinfoCache::Key AddrinfoCache::MakeKey(const char *node,
+                                          const char *service,
+                                          const struct addrinfo *hints) {
+  Key key;
+  if (node) {
+    key.has_node = true;
+    key.node = node;
+  }
+  if (service) {
+    key.has_service = true;
+    key.service = service;
+  }
+  if (hints) {
+    key.has_hints = true;
+    key.flags = hints->ai_flags;
+    key.family = hints->ai_family;
+    key.socktype = hints->ai_socktype;
+    key.protocol = hints->ai_protocol;
+  }
+  return key;
+}
+
+absl::Duration AddrinfoCache::TtlFor(int status) const {
+  switch (status) {
+    case 0:
+      return options_.ttl;
+    case EAI_NONAME:
+    case EAI_NODATA:
+    case EAI_ADDRFAMILY:
+    case EAI_SERVICE:
+      return options_.negative_ttl;
+    default:
+      return absl::ZeroDuration();
+  }
+}
+
+void AddrinfoCache::Evict(EntryList::iterator it) {
+  index_.erase(it->key);
+  FreeDeserializedAddrinfo(it->result);
+  entries_.erase(it);
+}
+
+void AddrinfoCache::Trim(size_t capacity) {
+  while (entries_.size() > capacity) {
+    Evict(std::prev(entries_.end()));
+  }
+}
+
+}  // namespace asylo
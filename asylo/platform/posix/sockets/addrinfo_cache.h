@@ -0,0 +1,175 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_POSIX_SOCKETS_ADDRINFO_CACHE_H_
+#define ASYLO_PLATFORM_POSIX_SOCKETS_ADDRINFO_CACHE_H_
+
+#include <netdb.h>
+
+#include <cstddef>
+#include <list>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace asylo {
+
+// Options controlling the lifetime and number of results kept by an
+// AddrinfoCache.
+struct AddrinfoCacheOptions {
+  // Maximum number of lookups kept in the cache. A capacity of zero disables
+  // caching.
+  size_t capacity = 64;
+
+  // How long a successful lookup is reused. getaddrinfo() does not report the
+  // TTL of the underlying DNS records, so this bounds how stale a cached
+  // address may become.
+  absl::Duration ttl = absl::Seconds(30);
+
+  // How long a lookup that failed because the name or service does not exist
+  // is reused. Transient failures such as EAI_AGAIN are never cached.
+  absl::Duration negative_ttl = absl::Seconds(5);
+};
+
+// AddrinfoCache keeps the results of recent getaddrinfo() lookups inside the
+// enclave so that repeated resolutions of the same name are not forwarded to
+// the host resolver. Lookups are keyed on the node, service and hints, and the
+// least recently used lookup is evicted once the cache is full.
+//
+// Expiry is measured against CLOCK_MONOTONIC, which the enclave reads from the
+// host, so every lookup, including a cache hit, still costs one clock_gettime()
+// exit. The host controls that clock: it cannot move it backwards, but it can
+// stall it to keep serving a result past its TTL, or advance it to expire
+// results early. The TTLs are therefore only a freshness hint and must not be
+// relied on to bound how long the host can replay a stale result.
+//
+// Every addrinfo list handed out by the cache is a single allocation in the
+// layout produced by host_call::CopyAddrinfo(), and is released with
+// freeaddrinfo().
+class AddrinfoCache {
+ public:
+  // Performs an uncached lookup with the semantics of getaddrinfo(). On
+  // success, |*res| must be a single allocation in the layout produced by
+  // host_call::CopyAddrinfo().
+  using ResolveFunction = int (*)(const char *node, const char *service,
+                                  const struct addrinfo *hints,
+                                  struct addrinfo **res);
+
+  // Returns the current time. Only differences between returned times are
+  // used, so the clock need not track wall-clock time.
+  using ClockFunction = absl::Time (*)();
+
+  explicit AddrinfoCache(ResolveFunction resolve,
+                         ClockFunction clock = MonotonicNow);
+  ~AddrinfoCache();
+
+  AddrinfoCache(const AddrinfoCache &other) = delete;
+  AddrinfoCache &operator=(const AddrinfoCache &other) = delete;
+
+  // Returns the cache used by getaddrinfo() inside the enclave.
+  static AddrinfoCache *Instance();
+
+  // Returns the time elapsed on CLOCK_MONOTONIC as an offset from the Unix
+  // epoch, or absl::InfiniteFuture() if the clock cannot be read.
+  static absl::Time MonotonicNow();
+
+  // Replaces the options of this cache, evicting lookups that no longer fit
+  // in the new capacity.
+  void Configure(const AddrinfoCacheOptions &options) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the options of this cache.
+  AddrinfoCacheOptions options() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Looks up |node| and |service| with the semantics of getaddrinfo(),
+  // returning a cached result if an unexpired one is available.
+  int GetAddrinfo(const char *node, const char *service,
+                  const struct addrinfo *hints, struct addrinfo **res)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Drops all cached lookups.
+  void Clear() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of cached lookups, including expired ones that have not
+  // been evicted yet.
+  size_t size() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Identifies a lookup by its arguments.
+  struct Key {
+    bool has_node = false;
+    std::string node;
+    bool has_service = false;
+    std::string service;
+    bool has_hints = false;
+    int flags = 0;
+    int family = 0;
+    int socktype = 0;
+    int protocol = 0;
+
+    bool operator==(const Key &other) const;
+
+    template <typename H>
+    friend H AbslHashValue(H hash, const Key &key) {
+      return H::combine(std::move(hash), key.has_node, key.node,
+                        key.has_service, key.service, key.has_hints, key.flags,
+                        key.family, key.socktype, key.protocol);
+    }
+  };
+
+  // A cached lookup. |result| is owned by the entry and is null for failed
+  // lookups.
+  struct Entry {
+    Key key;
+    int status;
+    struct addrinfo *result;
+    absl::Time expiry;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  static Key MakeKey(const char *node, const char *service,
+                     const struct addrinfo *hints);
+
+  // Returns the lifetime of a lookup that completed with |status|, or zero if
+  // it must not be cached.
+  absl::Duration TtlFor(int status) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Removes the entry at |it| and releases its result.
+  void Evict(EntryList::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Evicts least recently used entries until at most |capacity| remain.
+  void Trim(size_t capacity) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const ResolveFunction resolve_;
+  const ClockFunction clock_;
+
+  mutable absl::Mutex mu_;
+  AddrinfoCacheOptions options_ ABSL_GUARDED_BY(mu_);
+
+  // Cached lookups ordered from most to least recently used, and an index of
+  // the same entries by key.
+  EntryList entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<Key, EntryList::iterator> index_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_POSIX_SOCKETS_ADDRINFO_CACHE_H_
@@ -0,0 +1,253 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/posix/sockets/addrinfo_cache.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/time/time.h"
+#include "asylo/platform/host_call/serializer_functions.h"
+
+namespace asylo {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::Ne;
+using ::testing::NotNull;
+using ::testing::StrEq;
+
+constexpr char kHost[] = "localhost";
+constexpr char kOtherHost[] = "otherhost";
+constexpr char kMissingHost[] = "missing.invalid";
+constexpr char kFlakyHost[] = "flaky";
+
+int resolve_count = 0;
+absl::Time fake_now;
+
+absl::Time FakeNow() { return fake_now; }
+
+// Resolves every name other than kMissingHost and kFlakyHost to an IPv4 and an
+// IPv6 loopback address, with the canonical name set to the name looked up.
+int FakeResolve(const char *node, const char *service,
+                const struct addrinfo *hints, struct addrinfo **res) {
+  ++resolve_count;
+  if (strcmp(node, kMissingHost) == 0) return EAI_NONAME;
+  if (strcmp(node, kFlakyHost) == 0) return EAI_AGAIN;
+
+  struct sockaddr_in6 sin6 = {};
+  sin6.sin6_family = AF_INET6;
+  sin6.sin6_addr = in6addr_loopback;
+  struct sockaddr_in sin = {};
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  struct addrinfo infos[2] = {};
+  infos[0].ai_family = AF_INET;
+  infos[0].ai_socktype = SOCK_STREAM;
+  infos[0].ai_addr = reinterpret_cast<struct sockaddr *>(&sin);
+  infos[0].ai_addrlen = sizeof(sin);
+  infos[0].ai_canonname = const_cast<char *>(node);
+  infos[0].ai_next = &infos[1];
+  infos[1].ai_family = AF_INET6;
+  infos[1].ai_socktype = SOCK_STREAM;
+  infos[1].ai_addr = reinterpret_cast<struct sockaddr *>(&sin6);
+  infos[1].ai_addrlen = sizeof(sin6);
+
+  *res = host_call::CopyAddrinfo(infos);
+  return *res ? 0 : EAI_MEMORY;
+}
+
+class AddrinfoCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    resolve_count = 0;
+    fake_now = absl::UnixEpoch();
+    options_.capacity = 4;
+    options_.ttl = absl::Seconds(30);
+    options_.negative_ttl = absl::Seconds(5);
+    cache_ = absl::make_unique<AddrinfoCache>(FakeResolve, FakeNow);
+    cache_->Configure(options_);
+  }
+
+  // Looks up |node| through the cache and checks that the result matches
+  // FakeResolve(), then releases it.
+  void ExpectLoopback(const char *node, const struct addrinfo *hints) {
+    struct addrinfo *res = nullptr;
+    ASSERT_THAT(cache_->GetAddrinfo(node, nullptr, hints, &res), Eq(0));
+    ASSERT_THAT(res, NotNull());
+    EXPECT_THAT(res->ai_family, Eq(AF_INET));
+    ASSERT_THAT(res->ai_canonname, NotNull());
+    EXPECT_THAT(res->ai_canonname, StrEq(node));
+    ASSERT_THAT(res->ai_addr, NotNull());
+    EXPECT_THAT(
+        reinterpret_cast<struct sockaddr_in *>(res->ai_addr)->sin_addr.s_addr,
+        Eq(htonl(INADDR_LOOPBACK)));
+
+    struct addrinfo *next = res->ai_next;
+    ASSERT_THAT(next, NotNull());
+    EXPECT_THAT(next->ai_family, Eq(AF_INET6));
+    EXPECT_THAT(next->ai_addrlen, Eq(sizeof(struct sockaddr_in6)));
+    EXPECT_THAT(next->ai_canonname, IsNull());
+    EXPECT_THAT(next->ai_next, IsNull());
+
+    // The whole list lives in the allocation that starts at its head.
+    char *begin = reinterpret_cast<char *>(res);
+    char *end = res->ai_canonname + strlen(res->ai_canonname) + 1;
+    EXPECT_THAT(reinterpret_cast<char *>(next->ai_addr) > begin, Eq(true));
+    EXPECT_THAT(reinterpret_cast<char *>(next->ai_addr) < end, Eq(true));
+    host_call::FreeDeserializedAddrinfo(res);
+  }
+
+  AddrinfoCacheOptions options_;
+  std::unique_ptr<AddrinfoCache> cache_;
+};
+
+TEST_F(AddrinfoCacheTest, RepeatedLookupsAreResolvedOnce) {
+  ExpectLoopback(kHost, nullptr);
+  ExpectLoopback(kHost, nullptr);
+  ExpectLoopback(kHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(1));
+  EXPECT_THAT(cache_->size(), Eq(1));
+}
+
+TEST_F(AddrinfoCacheTest, ResultsAreIndependentCopies) {
+  struct addrinfo *first = nullptr;
+  struct addrinfo *second = nullptr;
+  ASSERT_THAT(cache_->GetAddrinfo(kHost, nullptr, nullptr, &first), Eq(0));
+  ASSERT_THAT(cache_->GetAddrinfo(kHost, nullptr, nullptr, &second), Eq(0));
+  EXPECT_THAT(first, Ne(second));
+  EXPECT_THAT(first->ai_addr, Ne(second->ai_addr));
+  host_call::FreeDeserializedAddrinfo(first);
+  ExpectLoopback(kHost, nullptr);
+  host_call::FreeDeserializedAddrinfo(second);
+}
+
+TEST_F(AddrinfoCacheTest, LookupsAreKeyedOnHints) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  ExpectLoopback(kHost, nullptr);
+  ExpectLoopback(kHost, &hints);
+  hints.ai_flags = AI_CANONNAME;
+  ExpectLoopback(kHost, &hints);
+  ExpectLoopback(kHost, &hints);
+  EXPECT_THAT(resolve_count, Eq(3));
+}
+
+TEST_F(AddrinfoCacheTest, LookupsExpire) {
+  ExpectLoopback(kHost, nullptr);
+  fake_now += options_.ttl - absl::Nanoseconds(1);
+  ExpectLoopback(kHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(1));
+
+  fake_now += absl::Nanoseconds(1);
+  ExpectLoopback(kHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(2));
+}
+
+TEST_F(AddrinfoCacheTest, MissingNamesAreCachedForNegativeTtl) {
+  struct addrinfo *res = nullptr;
+  EXPECT_THAT(cache_->GetAddrinfo(kMissingHost, nullptr, nullptr, &res),
+              Eq(EAI_NONAME));
+  EXPECT_THAT(cache_->GetAddrinfo(kMissingHost, nullptr, nullptr, &res),
+              Eq(EAI_NONAME));
+  EXPECT_THAT(resolve_count, Eq(1));
+
+  fake_now += options_.negative_ttl;
+  EXPECT_THAT(cache_->GetAddrinfo(kMissingHost, nullptr, nullptr, &res),
+              Eq(EAI_NONAME));
+  EXPECT_THAT(resolve_count, Eq(2));
+  EXPECT_THAT(res, IsNull());
+}
+
+TEST_F(AddrinfoCacheTest, TransientFailuresAreNotCached) {
+  struct addrinfo *res = nullptr;
+  EXPECT_THAT(cache_->GetAddrinfo(kFlakyHost, nullptr, nullptr, &res),
+              Eq(EAI_AGAIN));
+  EXPECT_THAT(cache_->GetAddrinfo(kFlakyHost, nullptr, nullptr, &res),
+              Eq(EAI_AGAIN));
+  EXPECT_THAT(resolve_count, Eq(2));
+  EXPECT_THAT(cache_->size(), Eq(0));
+}
+
+TEST_F(AddrinfoCacheTest, LeastRecentlyUsedLookupIsEvicted) {
+  options_.capacity = 2;
+  cache_->Configure(options_);
+  ExpectLoopback(kHost, nullptr);
+  ExpectLoopback(kOtherHost, nullptr);
+  ExpectLoopback(kHost, nullptr);
+
+  // Evicts kOtherHost, which was used least recently.
+  struct addrinfo *res = nullptr;
+  EXPECT_THAT(cache_->GetAddrinfo(kMissingHost, nullptr, nullptr, &res),
+              Eq(EAI_NONAME));
+  EXPECT_THAT(cache_->size(), Eq(2));
+  EXPECT_THAT(resolve_count, Eq(3));
+
+  ExpectLoopback(kHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(3));
+  ExpectLoopback(kOtherHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(4));
+}
+
+TEST_F(AddrinfoCacheTest, ConfigureTrimsToCapacity) {
+  ExpectLoopback(kHost, nullptr);
+  ExpectLoopback(kOtherHost, nullptr);
+  options_.capacity = 1;
+  cache_->Configure(options_);
+  EXPECT_THAT(cache_->size(), Eq(1));
+  ExpectLoopback(kOtherHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(2));
+}
+
+TEST_F(AddrinfoCacheTest, ZeroCapacityDisablesCaching) {
+  options_.capacity = 0;
+  cache_->Configure(options_);
+  ExpectLoopback(kHost, nullptr);
+  ExpectLoopback(kHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(2));
+  EXPECT_THAT(cache_->size(), Eq(0));
+}
+
+TEST_F(AddrinfoCacheTest, UnreadableClockDisablesCaching) {
+  fake_now = absl::InfiniteFuture();
+  ExpectLoopback(kHost, nullptr);
+  ExpectLoopback(kHost, nullptr);
+  EXPECT_THAT(resolve_count, Eq(2));
+  EXPECT_THAT(cache_->size(), Eq(0));
+}
+
+TEST_F(AddrinfoCacheTest, MonotonicClockAdvances) {
+  absl::Time first = AddrinfoCache::MonotonicNow();
+  absl::Time second = AddrinfoCache::MonotonicNow();
+  EXPECT_THAT(first, Ne(absl::InfiniteFuture()));
+  EXPECT_THAT(second >= first, Eq(true));
+}
+
+}  // namespace
+}  // namespace asylo
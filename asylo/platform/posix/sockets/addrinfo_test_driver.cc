@@ -17,13 +17,19 @@
  */
 
 #include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "asylo/platform/posix/sockets/socket_test.pb.h"
 #include "asylo/test/util/enclave_test.h"
 #include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
 
 namespace asylo {
 namespace {
 
+// Number of lookups made by each run of the repeated lookup benchmark.
+constexpr int kBenchmarkLookups = 2000;
+
 class AddrinfoTest : public EnclaveTest {
  protected:
   void SetEnclaveInput(EnclaveInput *enclave_input,
@@ -55,5 +61,25 @@ TEST_F(AddrinfoTest, AddrinfoIpHintsTest) {
   EXPECT_THAT(client_->EnterAndRun(enclave_input, nullptr), IsOk());
 }
 
+// Logs the rate of repeated lookups of the same name inside the enclave with
+// the addrinfo cache disabled and enabled.
+TEST_F(AddrinfoTest, RepeatedLookupRate) {
+  for (int capacity : {0, 64}) {
+    EnclaveInput enclave_input;
+    SetEnclaveInput(&enclave_input, AddrInfoTestInput::REPEATED_LOOKUPS);
+    AddrInfoTestInput *test_input =
+        enclave_input.MutableExtension(addrinfo_test_input);
+    test_input->set_lookups(kBenchmarkLookups);
+    test_input->set_cache_capacity(capacity);
+
+    absl::Time start = absl::Now();
+    ASSERT_THAT(client_->EnterAndRun(enclave_input, nullptr), IsOk());
+    absl::Duration elapsed = absl::Now() - start;
+    LOG(INFO) << "cache capacity " << capacity << ": "
+              << kBenchmarkLookups / absl::ToDoubleSeconds(elapsed)
+              << " lookups/s";
+  }
+}
+
 }  // namespace
 }  // namespace asylo
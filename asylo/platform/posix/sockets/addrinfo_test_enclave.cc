@@ -23,6 +23,7 @@
 
 #include <string>
 
+#include "asylo/platform/posix/sockets/addrinfo_cache.h"
 #include "asylo/platform/posix/sockets/socket_test.pb.h"
 #include "asylo/test/util/enclave_test_application.h"
 
@@ -38,8 +39,9 @@ class AddrinfoTestEnclave : public EnclaveTestCase {
                     "addrinfo test input use addrinfo hints not found");
     }
 
-    AddrInfoTestInput::TestMode mode =
-        input.GetExtension(addrinfo_test_input).mode();
+    const AddrInfoTestInput &test_input =
+        input.GetExtension(addrinfo_test_input);
+    AddrInfoTestInput::TestMode mode = test_input.mode();
 
     switch (mode) {
       case AddrInfoTestInput::NO_HINTS:
@@ -48,6 +50,8 @@ class AddrinfoTestEnclave : public EnclaveTestCase {
         return AddrInfoTest_UnspecHints();
       case AddrInfoTestInput::IP_HINTS:
         return AddrInfoTest_IpHints();
+      case AddrInfoTestInput::REPEATED_LOOKUPS:
+        return AddrInfoTest_RepeatedLookups(test_input);
       default:
         return Status(error::GoogleError::INTERNAL,
                       "unknown addrinfo test mode");
@@ -159,6 +163,27 @@ class AddrinfoTestEnclave : public EnclaveTestCase {
     freeaddrinfo(info);
     return Status::OkStatus();
   }
+
+  Status AddrInfoTest_RepeatedLookups(const AddrInfoTestInput &test_input) {
+    AddrinfoCacheOptions options;
+    options.capacity = test_input.cache_capacity();
+    AddrinfoCache::Instance()->Configure(options);
+    AddrinfoCache::Instance()->Clear();
+    for (int i = 0; i < test_input.lookups(); ++i) {
+      struct addrinfo *info = nullptr;
+      if (!GetAddrInfoForLocalHost(/*hints=*/nullptr, &info)) {
+        return Status(error::GoogleError::INTERNAL,
+                      "getaddrinfo() system call failed");
+      }
+      if (!VerifyLocalHostAddrInfoAddress(info)) {
+        freeaddrinfo(info);
+        return Status(error::GoogleError::INTERNAL,
+                      "getaddrinfo() returned incorrect address string");
+      }
+      freeaddrinfo(info);
+    }
+    return Status::OkStatus();
+  }
 };
 
 TrustedApplication *BuildTrustedApplication() {
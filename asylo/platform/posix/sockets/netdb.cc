@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include "asylo/platform/host_call/trusted/host_calls.h"
+#include "asylo/platform/posix/sockets/addrinfo_cache.h"
 
 extern "C" {
 
@@ -28,7 +29,8 @@ const char *gai_strerror(int ecode) { abort(); }
 
 int getaddrinfo(const char *node, const char *service,
                 const struct addrinfo *hints, struct addrinfo **res) {
-  return enc_untrusted_getaddrinfo(node, service, hints, res);
+  return asylo::AddrinfoCache::Instance()->GetAddrinfo(node, service, hints,
+                                                        res);
 }
 
 void freeaddrinfo(struct addrinfo *res) { enc_freeaddrinfo(res); }
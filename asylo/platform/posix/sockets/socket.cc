@@ -190,6 +190,8 @@ ssize_t recvfrom(int socket, void *buffer, size_t length, int flags,
                                            address, address_len);
 }
 
-int socketpair(int domain, int type, int protocol, int sv[2]) { abort(); }
+int socketpair(int domain, int type, int protocol, int sv[2]) {
+  return IOManager::GetInstance().SocketPair(domain, type, protocol, sv);
+}
 
 }  // extern "C"
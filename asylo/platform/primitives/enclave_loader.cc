@@ -84,6 +84,10 @@ StatusOr<std::shared_ptr<primitives::Client>> LoadSgxEnclave(
     return Status(error::GoogleError::INVALID_ARGUMENT,
                   "SGX enclave source not set");
   }
+  if (sgx_config.queue_signals()) {
+    std::static_pointer_cast<SgxEnclaveClient>(primitive_client)
+        ->EnableSignalQueue();
+  }
   return std::move(primitive_client);
 }
 
@@ -111,14 +115,19 @@ StatusOr<std::shared_ptr<Client>> LoadRemoteEnclave(
 
 StatusOr<std::shared_ptr<Client>> LoadEnclave(
     const EnclaveLoadConfig &load_config) {
+  std::shared_ptr<Client> client;
   if (load_config.HasExtension(sgx_load_config)) {
-    return LoadSgxEnclave(load_config);
+    ASYLO_ASSIGN_OR_RETURN(client, LoadSgxEnclave(load_config));
+  } else if (load_config.HasExtension(remote_load_config)) {
+    ASYLO_ASSIGN_OR_RETURN(client, LoadRemoteEnclave(load_config));
+  } else {
+    return Status(error::GoogleError::INVALID_ARGUMENT,
+                  "Enclave backend not supported in asylo");
   }
-  if (load_config.HasExtension(remote_load_config)) {
-    return LoadRemoteEnclave(load_config);
+  if (load_config.telemetry()) {
+    client->EnableTelemetry();
   }
-  return Status(error::GoogleError::INVALID_ARGUMENT,
-                "Enclave backend not supported in asylo");
+  return client;
 }
 
 }  // namespace primitives
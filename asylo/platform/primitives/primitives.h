@@ -41,6 +41,37 @@ static constexpr uint64_t kSelectorAsyloDonateThread = 2;
 // Enclave finalization entry point selector.
 static constexpr uint64_t kSelectorAsyloFini = 3;
 
+// Enclave entry point selector which only delivers pending signals.
+static constexpr uint64_t kSelectorAsyloDeliverPendingSignals = 4;
+
+// Enclave entry point selector which dispatches a batch of entry calls made
+// through Client::EnclaveCallBatch. The input message holds the number of calls
+// as a uint64_t followed by, for each call, a BatchCallHeader and the call's
+// input extents. The output message holds the number of calls followed by, for
+// each call, a BatchCallResultHeader, the status message of the call and the
+// call's output extents. Only selectors of `kSelectorUser` and above may be
+// batched.
+static constexpr uint64_t kSelectorAsyloBatchCall = 5;
+
+// Describes a single call in the input of a kSelectorAsyloBatchCall entry.
+struct BatchCallHeader {
+  // Entry point selector of the call.
+  uint64_t selector;
+
+  // Number of input extents following the header.
+  uint64_t extent_count;
+};
+
+// Describes the result of a single call in the output of a
+// kSelectorAsyloBatchCall entry.
+struct BatchCallResultHeader {
+  // Status code returned by the entry handler.
+  int64_t status_code;
+
+  // Number of output extents following the status message.
+  uint64_t extent_count;
+};
+
 //////////////////////////////////////
 //      Exit handler selectors      //
 //////////////////////////////////////
@@ -25,6 +25,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -34,6 +35,7 @@
 #include "asylo/platform/primitives/remote/grpc_server_impl.h"
 #include "asylo/platform/primitives/remote/grpc_service.grpc.pb.h"
 #include "asylo/platform/primitives/remote/grpc_service.pb.h"
+#include "asylo/platform/primitives/remote/shared_memory_impl.h"
 #include "asylo/util/cleanup.h"
 #include "asylo/util/mutex_guarded.h"
 #include "asylo/util/status.h"
@@ -45,6 +47,10 @@
 #include "include/grpcpp/security/server_credentials.h"
 #include "include/grpcpp/server_builder.h"
 
+ABSL_FLAG(bool, remote_shared_memory_transport, true,
+          "For host side only: exchange messages with a target Communicator "
+          "running on the same machine through shared memory");
+
 namespace asylo {
 namespace primitives {
 
@@ -293,14 +299,66 @@ Status Communicator::Connect(const RemoteProxyConfig &config,
   ASYLO_RETURN_IF_ERROR(CreateStub(config, remote_address));
   // Success.
   is_client_ready_.store(true);
+  // The host connects after the target, so both directions are up by now.
+  if (is_host() && absl::GetFlag(FLAGS_remote_shared_memory_transport)) {
+    EstablishSharedMemory();
+  }
+  return Status::OkStatus();
+}
+
+void Communicator::EstablishSharedMemory() {
+  auto shared_memory_result = SharedMemoryImpl::Create(this);
+  if (!shared_memory_result.ok()) {
+    LOG(WARNING) << "Shared memory transport not available, status="
+                 << shared_memory_result.status();
+    return;
+  }
+  auto shared_memory = std::move(shared_memory_result).ValueOrDie();
+  const Status attach_status = client_->SendAttachSharedMemory(
+      shared_memory->name(), shared_memory->nonce());
+  // Once the target has mapped the segment (or failed to), its name is no
+  // longer needed.
+  shared_memory->Unlink();
+  if (!attach_status.ok()) {
+    // Expected when the target runs on a different machine.
+    LOG(INFO) << "Target did not attach to shared memory, status="
+              << attach_status;
+    return;
+  }
+  shared_memory->Start();
+  shared_memory_ = std::move(shared_memory);
+  is_shared_memory_attached_.store(true);
+}
+
+Status Communicator::AttachSharedMemory(absl::string_view name,
+                                        absl::string_view nonce) {
+  if (is_host()) {
+    return Status(error::GoogleError::FAILED_PRECONDITION,
+                  "Only target side attaches to shared memory");
+  }
+  if (shared_memory_) {
+    return Status(error::GoogleError::ALREADY_EXISTS,
+                  "Shared memory already attached");
+  }
+  ASYLO_ASSIGN_OR_RETURN(shared_memory_,
+                         SharedMemoryImpl::Attach(name, nonce, this));
+  shared_memory_->Start();
+  is_shared_memory_attached_.store(true);
   return Status::OkStatus();
 }
 
+void Communicator::CloseSharedMemory() {
+  if (is_shared_memory_attached_.load()) {
+    shared_memory_->Close();
+  }
+}
+
 Communicator::Communicator(bool is_host)
     : is_host_(is_host),
       is_server_ready_(false),
       is_client_ready_(false),
-      last_host_time_nanos_(absl::nullopt) {
+      is_shared_memory_attached_(false),
+      last_host_time_(HostTime()) {
   if (is_host) {
     // For host: register communicator in the static set.
     CHECK(active_communicators()->Lock()->emplace(this).second);
@@ -338,6 +396,7 @@ std::string Communicator::WaitForEndPointAddress() {
 }
 
 void Communicator::Disconnect() {
+  CloseSharedMemory();
   if (is_client_ready_.exchange(false)) {
     client_->SendDisconnect();
   }
@@ -410,6 +469,12 @@ void Communicator::Invoke(
 }
 
 Status Communicator::SendCommunication(const CommunicationMessage &message) {
+  if (is_shared_memory_attached_.load()) {
+    ASYLO_RETURN_IF_ERROR(IsMessageValid(message));
+    if (shared_memory_->Send(message)) {
+      return Status::OkStatus();
+    }
+  }
   return client_->SendCommunication(message);
 }
 
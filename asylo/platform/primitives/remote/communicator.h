@@ -30,8 +30,10 @@
 #include "absl/base/attributes.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/flags/declare.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
@@ -53,6 +55,8 @@
 #include "include/grpcpp/server.h"
 #include "include/grpcpp/support/channel_arguments.h"
 
+ABSL_DECLARE_FLAG(bool, remote_shared_memory_transport);
+
 namespace asylo {
 namespace primitives {
 
@@ -77,6 +81,13 @@ namespace primitives {
 // 3.  start the service loop with ServerRPCLoop() (in its own thread on host,
 //     in a donated thread on target),
 // 4.  connect the client to the counterpart's server with Connect()
+//
+// When both Communicators run on the same machine, the host side additionally
+// sets up a shared memory transport while connecting (unless disabled with
+// --remote_shared_memory_transport=false), and from then on invocations and
+// their results travel through shared memory rings rather than as
+// Communicate RPCs. gRPC remains in use for control messages and for
+// messages too large for the rings.
 class Communicator {
  public:
   // A record representing an Invoke operation on both caller and callee side.
@@ -128,6 +139,8 @@ class Communicator {
 
   // Connects gRPC client to the gRPC server with 'remote_address' using
   // 'channel_creds' channel credentials and 'channel_args' channel arguments.
+  // On the host side, which connects last, also attempts to switch to the
+  // shared memory transport; failing to do so is not an error.
   // Returns OK or error status, if connection failed.
   ASYLO_MUST_USE_RESULT Status Connect(const RemoteProxyConfig &config,
                                        absl::string_view remote_address);
@@ -168,6 +181,12 @@ class Communicator {
   // reads and writes.
   ASYLO_MUST_USE_RESULT bool IsConnected() const;
 
+  // Returns true if messages to the counterpart are sent through shared
+  // memory.
+  bool is_shared_memory_attached() const {
+    return is_shared_memory_attached_.load();
+  }
+
   // Installs a server-side handler function that processes each incoming RPC.
   // When certain host thread runs a series of Invoke calls with remote backend
   // primitives, target side Communicator needs to run respective handlers on
@@ -206,13 +225,15 @@ class Communicator {
   // Accessor to the last time received from the host (valid only
   // on target Communicator, has no use on the host one).
   absl::optional<int64_t> last_host_time_nanos() const {
-    return *last_host_time_nanos_.ReaderLock();
+    return last_host_time_.ReaderLock()->nanos;
   }
 
  private:
   class ClientImpl;
   // gRPC service and client implementation.
   class ServiceImpl;
+  // Shared memory transport used when the counterpart is co-located.
+  class SharedMemoryImpl;
   // A queue of each worker thread that handles messages dispatched to it with
   // QueueMessageForThread. A new queue is added whenever the first Invoke call
   // takes place on a specific host thread.
@@ -239,6 +260,17 @@ class Communicator {
   ASYLO_MUST_USE_RESULT Status CreateStub(const RemoteProxyConfig &config,
                                           absl::string_view remote_address);
 
+  // Host side: creates a shared memory segment and asks the target to attach
+  // to it. Keeps using gRPC if the target cannot do so.
+  void EstablishSharedMemory();
+
+  // Target side: attaches to the shared memory segment |name| created by the
+  // host, verifying that it holds |nonce|.
+  Status AttachSharedMemory(absl::string_view name, absl::string_view nonce);
+
+  // Stops the shared memory transport, if any.
+  void CloseSharedMemory();
+
   // Verifies that CommunicationMessage is correctly formed.
   // Returns status if not.
   static Status IsMessageValid(const CommunicationMessage &message);
@@ -246,10 +278,16 @@ class Communicator {
   // Setters for the last time received from the host (valid only
   // on target Communicator, have no use on the host one).
   void set_host_time_nanos(int64_t time_nanos) {
-    *last_host_time_nanos_.Lock() = time_nanos;
+    auto locked_host_time = last_host_time_.Lock();
+    locked_host_time->nanos = time_nanos;
+    locked_host_time->received = absl::Now();
   }
-  void invalidate_host_time_nanos() {
-    *last_host_time_nanos_.Lock() = absl::nullopt;
+  // Forgets the host time if it was received more than |expiration| ago.
+  void expire_host_time_nanos(absl::Duration expiration) {
+    auto locked_host_time = last_host_time_.Lock();
+    if (absl::Now() - locked_host_time->received >= expiration) {
+      locked_host_time->nanos = absl::nullopt;
+    }
   }
 
   // Static map of registered communicators, used by host thread exiter callback
@@ -264,6 +302,12 @@ class Communicator {
   std::unique_ptr<ClientImpl> client_;
   std::unique_ptr<ServiceImpl> service_;
 
+  // Shared memory transport, set at most once when the connection is
+  // established and then kept until destruction. Only accessed after
+  // is_shared_memory_attached_ is observed to be true.
+  std::unique_ptr<SharedMemoryImpl> shared_memory_;
+  std::atomic<bool> is_shared_memory_attached_;
+
   // Flags indicating whether server and client are ready.
   // Set to false by constructor, switched to true when server and client are
   // connected (respectively), reset to false by either Disconnect call or
@@ -271,9 +315,14 @@ class Communicator {
   std::atomic<bool> is_server_ready_;
   std::atomic<bool> is_client_ready_;
 
-  // Last time stamp received from the host (set only on target Communicator).
-  // Expires after time specified by --host_time_nanos_expiration flag.
-  MutexGuarded<absl::optional<int64_t>> last_host_time_nanos_;
+  // Last time stamp received from the host (set only on target Communicator)
+  // and the local time it was received at. Expires after time specified by
+  // --host_time_expiration_ms flag.
+  struct HostTime {
+    absl::optional<int64_t> nanos;
+    absl::Time received = absl::InfinitePast();
+  };
+  MutexGuarded<HostTime> last_host_time_;
 
   // Host-side only: exit callback stored in thread-local storage and
   // automatically invoked when the thread exits and thread-local objects are
@@ -30,6 +30,7 @@
 #include <iterator>
 #include <memory>
 #include <set>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -38,6 +39,7 @@
 #include <gtest/gtest.h>
 #include "absl/base/macros.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
@@ -159,6 +161,9 @@ class CommunicatorTestFixture : public ::testing::Test {
   // Runs host-side action. Must be overridden.
   virtual void RunAction(Communicator *communicator) = 0;
 
+  // Returns whether the host should set up the shared memory transport.
+  virtual bool UseSharedMemory() const { return true; }
+
   // Runs the host or target side of the test, expecting fds_ socketpair
   // to be set for the cross-process communication.
   // Creates Communicator, starts its server, exchanges ports with counterpart,
@@ -198,6 +203,7 @@ class CommunicatorTestFixture : public ::testing::Test {
                                                       "test_name");
 
       // Establish connection to the target server.
+      absl::SetFlag(&FLAGS_remote_shared_memory_transport, UseSharedMemory());
       ASYLO_ASSERT_OK(communicator->Connect(*proxy_config, end_point));
     } else {
       // For target: receive host server port.
@@ -708,6 +714,115 @@ class UnknownSelectorTest : public CommunicatorTestFixture {
   }
 };
 
+class SharedMemoryAttachedTest : public CommunicatorTestFixture {
+ public:
+  SharedMemoryAttachedTest() = default;
+
+ private:
+  void RunAction(Communicator *communicator) override {
+    // Host and target run on the same machine.
+    EXPECT_TRUE(communicator->is_shared_memory_attached());
+  }
+};
+
+class LargeMessageTest : public CommunicatorTestFixture {
+ public:
+  LargeMessageTest() = default;
+
+ private:
+  const uint64_t kSelector = 1234;
+  // Sizes below and above the largest message carried by shared memory.
+  const std::vector<size_t> kSizes = {0, 1, 4096, 1 << 19, 3 << 20};
+
+  void SetTargetHandler(ServerHandlerMock *handler,
+                        Communicator *communicator) override {
+    EXPECT_CALL(*handler, Call(NotNull()))
+        .Times(kSizes.size())
+        .WillRepeatedly(
+            [](std::unique_ptr<Communicator::Invocation> invocation) {
+              ASYLO_ASSERT_OK(invocation->status);
+              // Make output identical to input.
+              while (invocation->reader.hasNext()) {
+                invocation->writer.PushByCopy(invocation->reader.next());
+              }
+            });
+  }
+
+  void RunAction(Communicator *communicator) override {
+    for (const size_t size : kSizes) {
+      const std::string data(size, static_cast<char>('a' + size % 26));
+      communicator->Invoke(
+          kSelector,
+          [&data](Communicator::Invocation *invocation) {
+            invocation->writer.PushByReference({data.data(), data.size()});
+            invocation->writer.Push<uint64_t>(data.size());
+          },
+          [&data](std::unique_ptr<Communicator::Invocation> invocation) {
+            ASYLO_ASSERT_OK(invocation->status);
+            ASSERT_THAT(invocation->reader, SizeIs(2));
+            const auto echo = invocation->reader.next();
+            ASSERT_THAT(echo, SizeIs(data.size()));
+            EXPECT_THAT(memcmp(echo.data(), data.data(), data.size()), Eq(0));
+            EXPECT_THAT(invocation->reader.next<uint64_t>(), Eq(data.size()));
+          });
+    }
+  }
+};
+
+// Verifies that many consecutive small Invokes round trip over gRPC and over
+// shared memory.
+class InvokeRoundTripTest : public CommunicatorTestFixture {
+ protected:
+  explicit InvokeRoundTripTest(bool use_shared_memory)
+      : use_shared_memory_(use_shared_memory) {}
+
+ private:
+  const uint64_t kSelector = 1234;
+  const int64_t kIterations = 200;
+
+  bool UseSharedMemory() const override { return use_shared_memory_; }
+
+  void SetTargetHandler(ServerHandlerMock *handler,
+                        Communicator *communicator) override {
+    EXPECT_CALL(*handler, Call(NotNull()))
+        .Times(kIterations)
+        .WillRepeatedly(
+            [](std::unique_ptr<Communicator::Invocation> invocation) {
+              invocation->writer.Push(invocation->reader.next<int64_t>());
+            });
+  }
+
+  void RunAction(Communicator *communicator) override {
+    EXPECT_THAT(communicator->is_shared_memory_attached(),
+                Eq(use_shared_memory_));
+    for (int64_t i = 0; i < kIterations; ++i) {
+      communicator->Invoke(
+          kSelector,
+          [i](Communicator::Invocation *invocation) {
+            invocation->writer.Push(i);
+          },
+          [i](std::unique_ptr<Communicator::Invocation> invocation) {
+            ASYLO_ASSERT_OK(invocation->status);
+            EXPECT_THAT(invocation->reader.next<int64_t>(), Eq(i));
+          });
+    }
+  }
+
+  const bool use_shared_memory_;
+};
+
+class GrpcInvokeRoundTripTest : public InvokeRoundTripTest {
+ public:
+  GrpcInvokeRoundTripTest()
+      : InvokeRoundTripTest(/*use_shared_memory=*/false) {}
+};
+
+class SharedMemoryInvokeRoundTripTest : public InvokeRoundTripTest {
+ public:
+  SharedMemoryInvokeRoundTripTest()
+      : InvokeRoundTripTest(/*use_shared_memory=*/true) {}
+};
+
 class OpenCensusClientTest : public CommunicatorTestFixture {
  public:
   OpenCensusClientTest() = default;
@@ -771,6 +886,10 @@ void RegisterAllTests() {
   CommunicatorTestFixture::Register<MultithreadedWithThreadLocalStorageTest>();
   CommunicatorTestFixture::Register<DuplexNestedMultithreadedInvokesTest>();
   CommunicatorTestFixture::Register<UnknownSelectorTest>();
+  CommunicatorTestFixture::Register<SharedMemoryAttachedTest>();
+  CommunicatorTestFixture::Register<LargeMessageTest>();
+  CommunicatorTestFixture::Register<GrpcInvokeRoundTripTest>();
+  CommunicatorTestFixture::Register<SharedMemoryInvokeRoundTripTest>();
   CommunicatorTestFixture::Register<OpenCensusClientTest>();
 }
 
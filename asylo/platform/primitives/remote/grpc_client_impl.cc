@@ -96,7 +96,7 @@ Status Communicator::ClientImpl::RunInvocation(
     CommunicationMessage request;
     SerializeIntoRequest(&request, invocation);
     request.set_request_sequence_number(request_sequence_number);
-    ASYLO_RETURN_IF_ERROR(SendCommunication(request));
+    ASYLO_RETURN_IF_ERROR(communicator_->SendCommunication(request));
   }
 
   // Loop until response is received, in a mean time processing requests on the
@@ -177,6 +177,28 @@ Status Communicator::ClientImpl::SendCommunication(
   return Status::OkStatus();
 }
 
+Status Communicator::ClientImpl::SendAttachSharedMemory(
+    absl::string_view name, absl::string_view nonce) {
+  AttachSharedMemoryRequest request;
+  request.set_name(name.data(), name.size());
+  request.set_nonce(nonce.data(), nonce.size());
+  AttachSharedMemoryReply reply;
+  ::grpc::ClientContext context;
+  gpr_timespec absolute_deadline = gpr_time_add(
+      gpr_now(GPR_CLOCK_REALTIME), gpr_time_from_seconds(5, GPR_TIMESPAN));
+  context.set_deadline(absolute_deadline);
+  const auto grpc_status =
+      grpc_stub_->AttachSharedMemory(&context, request, &reply);
+  if (!grpc_status.ok()) {
+    return Status(grpc_status);
+  }
+  Status status;
+  if (reply.has_status()) {
+    status.RestoreFrom(reply.status());
+  }
+  return status;
+}
+
 void Communicator::ClientImpl::SendDisconnect() {
   DisconnectRequest request;
   DisconnectReply reply;
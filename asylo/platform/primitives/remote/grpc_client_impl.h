@@ -57,6 +57,11 @@ class Communicator::ClientImpl {
   // Communicator.
   Status SendCommunication(const CommunicationMessage &message);
 
+  // Asks the target Communicator to attach to the shared memory segment |name|
+  // holding |nonce|. Returns OK if the target has attached.
+  Status SendAttachSharedMemory(absl::string_view name,
+                                absl::string_view nonce);
+
   // Sends disconnect request to the Communicator counterpart, triggering it to
   // shut down.
   void SendDisconnect();
@@ -283,6 +283,7 @@ class Communicator::ServiceImpl::DisconnectRpcInstance
 
     service()->communicator_->is_client_ready_.store(false);
     service()->communicator_->is_server_ready_.store(false);
+    service()->communicator_->CloseSharedMemory();
     // Copy service() out, because after Complete() we cannot rely on 'this'
     // anymore. And we do not want to delay Complete() until after
     // WaitForDisconnect() finishes.
@@ -396,6 +397,55 @@ class Communicator::ServiceImpl::EndPointAddressRpcInstance
   ::grpc::ServerAsyncResponseWriter<EndPointAddressReply> responder_;
 };
 
+class Communicator::ServiceImpl::AttachSharedMemoryRpcInstance
+    : public Communicator::ServiceImpl::RpcInstance {
+ public:
+  // Take in the "service" instance (in this case representing an asynchronous
+  // server) and the "completion_queue" used for asynchronous communication
+  // with the gRPC runtime.
+  explicit AttachSharedMemoryRpcInstance(Communicator::ServiceImpl *service)
+      : Communicator::ServiceImpl::RpcInstance(service), responder_(context()) {
+    // Request* that the system start processing Send requests. In this request,
+    // "this" acts as the tag uniquely identifying the request, in this case
+    // the memory address of this AttachSharedMemoryRpcInstance.
+    service->RequestAttachSharedMemory(context(), &request_, &responder_,
+                                       completion_queue(), completion_queue(),
+                                       this);
+  }
+
+ private:
+  void RespondRpc() override {
+    // And we are done! Let the gRPC runtime know we've finished, using the
+    // memory address of this instance as the uniquely identifying tag for
+    // the event.
+    responder_.Finish(confirmation_, ::grpc::Status::OK, this);
+  }
+
+  void ExecuteRpc() override {
+    // Spawn a new AttachSharedMemoryRpcInstance instance to serve new clients
+    // while we process the one for this AttachSharedMemoryRpcInstance. The
+    // instance will deallocate itself once completed.
+    new AttachSharedMemoryRpcInstance(service());
+
+    const Status status = service()->communicator_->AttachSharedMemory(
+        request_.name(), request_.nonce());
+    if (!status.ok()) {
+      status.SaveTo(confirmation_.mutable_status());
+    }
+    Complete();
+  }
+
+  // What we get from the client.
+  AttachSharedMemoryRequest request_;
+
+  // What we send back to the client.
+  AttachSharedMemoryReply confirmation_;
+
+  // The means to get back to the client (must always be the last: destruct
+  // it before request_ and confirmation_).
+  ::grpc::ServerAsyncResponseWriter<AttachSharedMemoryReply> responder_;
+};
+
 StatusOr<std::unique_ptr<Communicator::ServiceImpl>>
 Communicator::ServiceImpl::Create(
     int requested_port, const std::shared_ptr<::grpc::ServerCredentials> &creds,
@@ -433,6 +483,7 @@ void Communicator::ServiceImpl::ServerRpcLoop() {
   new DisconnectRpcInstance(this);
   new DisposeOfThreadRpcInstance(this);
   new EndPointAddressRpcInstance(this);
+  new AttachSharedMemoryRpcInstance(this);
 
   void *tag;  // uniquely identifies a request.
   bool ok;
@@ -452,7 +503,9 @@ void Communicator::ServiceImpl::ServerRpcLoop() {
       break;
     }
     if (next_status == grpc::CompletionQueue::TIMEOUT) {
-      communicator_->invalidate_host_time_nanos();
+      // Host time may still be fresh if it arrived through shared memory.
+      communicator_->expire_host_time_nanos(absl::Milliseconds(
+          absl::GetFlag(FLAGS_host_time_expiration_ms)));
       continue;
     }
     CHECK_EQ(next_status, grpc::CompletionQueue::GOT_EVENT);
@@ -89,6 +89,7 @@ class Communicator::ServiceImpl
   class DisconnectRpcInstance;
   class DisposeOfThreadRpcInstance;
   class EndPointAddressRpcInstance;
+  class AttachSharedMemoryRpcInstance;
 
   // Constructor is called by Create() factory only.
   explicit ServiceImpl(Communicator *communicator)
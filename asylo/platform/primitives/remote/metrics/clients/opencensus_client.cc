@@ -25,6 +25,7 @@
 #include "absl/synchronization/notification.h"
 #include "asylo/platform/primitives/remote/metrics/clients/opencensus_client_config.h"
 #include "asylo/platform/primitives/remote/metrics/clients/proc_system_service_client.h"
+#include "asylo/platform/primitives/util/enclave_telemetry.pb.h"
 #include "asylo/util/path.h"
 #include "asylo/util/status_macros.h"
 #include "asylo/util/thread.h"
@@ -64,6 +65,12 @@ std::unique_ptr<OpenCensusClient> OpenCensusClient::Create(
   client->RssSLimMeasure();
   client->GuestTimeMeasure();
   client->ChildrenGuestTimeMeasure();
+  client->EnclaveEntriesMeasure();
+  client->EnclaveExitsMeasure();
+  client->EnclaveBytesMarshalledMeasure();
+  client->EnclaveTimeInsideMeasure();
+  client->EnclaveTimeInExitsMeasure();
+  client->EnclaveThreadsInsideMeasure();
 
   // Register Views.
   client->RegisterMinorFaultsView();
@@ -80,6 +87,12 @@ std::unique_ptr<OpenCensusClient> OpenCensusClient::Create(
   client->RegisterRssSLimView();
   client->RegisterGuestTimeView();
   client->RegisterChildrenGuestTimeView();
+  client->RegisterEnclaveEntriesView();
+  client->RegisterEnclaveExitsView();
+  client->RegisterEnclaveBytesMarshalledView();
+  client->RegisterEnclaveTimeInsideView();
+  client->RegisterEnclaveTimeInExitsView();
+  client->RegisterEnclaveThreadsInsideView();
 
   // Start the census.
   client->StartCensus();
@@ -210,11 +223,41 @@ void OpenCensusClient::RecordChildrenGuestTime(
          {{MethodKey(), absl::StrCat("OpenCensusClient::", __func__)}});
 }
 
+void OpenCensusClient::RecordEnclaveTelemetry(
+    const EnclaveTelemetrySnapshot &snapshot) const {
+  int64_t entries = 0;
+  int64_t exits = 0;
+  int64_t bytes_marshalled = 0;
+  for (const TransitionStats &stats : snapshot.entries()) {
+    entries += stats.count();
+    bytes_marshalled += stats.input_bytes() + stats.output_bytes();
+  }
+  for (const TransitionStats &stats : snapshot.exits()) {
+    exits += stats.count();
+    bytes_marshalled += stats.input_bytes() + stats.output_bytes();
+  }
+
+  Record({{EnclaveEntriesMeasure(), entries},
+          {EnclaveExitsMeasure(), exits},
+          {EnclaveBytesMarshalledMeasure(), bytes_marshalled},
+          {EnclaveTimeInsideMeasure(), snapshot.time_inside_ns()},
+          {EnclaveTimeInExitsMeasure(), snapshot.time_in_exits_ns()},
+          {EnclaveThreadsInsideMeasure(),
+           static_cast<int64_t>(snapshot.threads_inside())}},
+         {{MethodKey(), absl::StrCat("OpenCensusClient::", __func__)},
+          {EnclaveKey(), snapshot.enclave_name()}});
+}
+
 TagKey OpenCensusClient::MethodKey() const {
   static const auto key = TagKey::Register("method");
   return key;
 }
 
+TagKey OpenCensusClient::EnclaveKey() const {
+  static const auto key = TagKey::Register("enclave");
+  return key;
+}
+
 MeasureInt64 OpenCensusClient::MinorFaultsMeasure() const {
   static const auto measure = MeasureInt64::Register(
       kMinorFaultsMeasureName, kMinorFaultsMeasureDescription, units::kCount);
@@ -302,6 +345,48 @@ MeasureInt64 OpenCensusClient::ChildrenGuestTimeMeasure() const {
   return measure;
 }
 
+MeasureInt64 OpenCensusClient::EnclaveEntriesMeasure() const {
+  static const auto measure =
+      MeasureInt64::Register(kEnclaveEntriesMeasureName,
+                             kEnclaveEntriesMeasureDescription, units::kCount);
+  return measure;
+}
+
+MeasureInt64 OpenCensusClient::EnclaveExitsMeasure() const {
+  static const auto measure =
+      MeasureInt64::Register(kEnclaveExitsMeasureName,
+                             kEnclaveExitsMeasureDescription, units::kCount);
+  return measure;
+}
+
+MeasureInt64 OpenCensusClient::EnclaveBytesMarshalledMeasure() const {
+  static const auto measure = MeasureInt64::Register(
+      kEnclaveBytesMarshalledMeasureName,
+      kEnclaveBytesMarshalledMeasureDescription, units::kBytes);
+  return measure;
+}
+
+MeasureInt64 OpenCensusClient::EnclaveTimeInsideMeasure() const {
+  static const auto measure = MeasureInt64::Register(
+      kEnclaveTimeInsideMeasureName, kEnclaveTimeInsideMeasureDescription,
+      units::kNanoseconds);
+  return measure;
+}
+
+MeasureInt64 OpenCensusClient::EnclaveTimeInExitsMeasure() const {
+  static const auto measure = MeasureInt64::Register(
+      kEnclaveTimeInExitsMeasureName, kEnclaveTimeInExitsMeasureDescription,
+      units::kNanoseconds);
+  return measure;
+}
+
+MeasureInt64 OpenCensusClient::EnclaveThreadsInsideMeasure() const {
+  static const auto measure = MeasureInt64::Register(
+      kEnclaveThreadsInsideMeasureName, kEnclaveThreadsInsideMeasureDescription,
+      units::kCount);
+  return measure;
+}
+
 void OpenCensusClient::RegisterView(
     ViewDescriptor *view_descriptor, const absl::string_view measure_name,
     const absl::string_view measure_description) {
@@ -387,5 +472,54 @@ void OpenCensusClient::RegisterChildrenGuestTimeView() {
                kChildrenGuestTimeMeasureDescription);
 }
 
+void OpenCensusClient::RegisterEnclaveView(
+    ViewDescriptor *view_descriptor, const absl::string_view measure_name,
+    const absl::string_view measure_description) {
+  *view_descriptor =
+      ViewDescriptor()
+          .set_name(asylo::JoinPath(config_.view_name_root, measure_name))
+          .set_description(measure_description)
+          .set_measure(measure_name)
+          .set_aggregation(opencensus::stats::Aggregation::LastValue())
+          .add_column(MethodKey())
+          .add_column(EnclaveKey());
+  view_descriptor->RegisterForExport();
+}
+
+void OpenCensusClient::RegisterEnclaveEntriesView() {
+  RegisterEnclaveView(&enclave_entries_view_descriptor_,
+                      kEnclaveEntriesMeasureName,
+                      kEnclaveEntriesMeasureDescription);
+}
+
+void OpenCensusClient::RegisterEnclaveExitsView() {
+  RegisterEnclaveView(&enclave_exits_view_descriptor_, kEnclaveExitsMeasureName,
+                      kEnclaveExitsMeasureDescription);
+}
+
+void OpenCensusClient::RegisterEnclaveBytesMarshalledView() {
+  RegisterEnclaveView(&enclave_bytes_marshalled_view_descriptor_,
+                      kEnclaveBytesMarshalledMeasureName,
+                      kEnclaveBytesMarshalledMeasureDescription);
+}
+
+void OpenCensusClient::RegisterEnclaveTimeInsideView() {
+  RegisterEnclaveView(&enclave_time_inside_view_descriptor_,
+                      kEnclaveTimeInsideMeasureName,
+                      kEnclaveTimeInsideMeasureDescription);
+}
+
+void OpenCensusClient::RegisterEnclaveTimeInExitsView() {
+  RegisterEnclaveView(&enclave_time_in_exits_view_descriptor_,
+                      kEnclaveTimeInExitsMeasureName,
+                      kEnclaveTimeInExitsMeasureDescription);
+}
+
+void OpenCensusClient::RegisterEnclaveThreadsInsideView() {
+  RegisterEnclaveView(&enclave_threads_inside_view_descriptor_,
+                      kEnclaveThreadsInsideMeasureName,
+                      kEnclaveThreadsInsideMeasureDescription);
+}
+
 }  // namespace primitives
 }  // namespace asylo
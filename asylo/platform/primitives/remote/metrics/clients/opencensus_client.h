@@ -23,6 +23,7 @@
 #include "absl/synchronization/notification.h"
 #include "asylo/platform/primitives/remote/metrics/clients/opencensus_client_config.h"
 #include "asylo/platform/primitives/remote/metrics/clients/proc_system_service_client.h"
+#include "asylo/platform/primitives/util/enclave_telemetry.pb.h"
 #include "asylo/util/mutex_guarded.h"
 #include "asylo/util/thread.h"
 #include "opencensus/stats/stats.h"
@@ -36,6 +37,7 @@ namespace units {
 ABSL_CONST_INIT static const absl::string_view kCount = "1";
 ABSL_CONST_INIT static const absl::string_view kBytes = "Bytes";
 ABSL_CONST_INIT static const absl::string_view kTicks = "Clock Ticks";
+ABSL_CONST_INIT static const absl::string_view kNanoseconds = "ns";
 
 }  // namespace units
 
@@ -46,6 +48,10 @@ class OpenCensusClient {
       const std::shared_ptr<::grpc::Channel> &channel,
       const OpenCensusClientConfig &config);
 
+  // Records the per-enclave telemetry in |snapshot|, as returned by
+  // EnclaveManager::GetEnclaveTelemetry, tagged with the enclave name.
+  void RecordEnclaveTelemetry(const EnclaveTelemetrySnapshot &snapshot) const;
+
  private:
   OpenCensusClient() = delete;
   OpenCensusClient(const OpenCensusClient &other) = delete;
@@ -62,6 +68,7 @@ class OpenCensusClient {
 
   // Tag Keys
   ::opencensus::tags::TagKey MethodKey() const;
+  ::opencensus::tags::TagKey EnclaveKey() const;
 
   // Measure metric generation
   ::opencensus::stats::MeasureInt64 MinorFaultsMeasure() const;
@@ -78,11 +85,21 @@ class OpenCensusClient {
   ::opencensus::stats::MeasureInt64 RssSLimMeasure() const;
   ::opencensus::stats::MeasureInt64 GuestTimeMeasure() const;
   ::opencensus::stats::MeasureInt64 ChildrenGuestTimeMeasure() const;
+  ::opencensus::stats::MeasureInt64 EnclaveEntriesMeasure() const;
+  ::opencensus::stats::MeasureInt64 EnclaveExitsMeasure() const;
+  ::opencensus::stats::MeasureInt64 EnclaveBytesMarshalledMeasure() const;
+  ::opencensus::stats::MeasureInt64 EnclaveTimeInsideMeasure() const;
+  ::opencensus::stats::MeasureInt64 EnclaveTimeInExitsMeasure() const;
+  ::opencensus::stats::MeasureInt64 EnclaveThreadsInsideMeasure() const;
 
   // Measure view registration
   void RegisterView(::opencensus::stats::ViewDescriptor *view_descriptor,
                     const absl::string_view measure_name,
                     const absl::string_view measure_description);
+  void RegisterEnclaveView(
+      ::opencensus::stats::ViewDescriptor *view_descriptor,
+      const absl::string_view measure_name,
+      const absl::string_view measure_description);
 
   void RegisterMinorFaultsView();
   void RegisterChildrenMinorFaultsView();
@@ -98,6 +115,12 @@ class OpenCensusClient {
   void RegisterRssSLimView();
   void RegisterGuestTimeView();
   void RegisterChildrenGuestTimeView();
+  void RegisterEnclaveEntriesView();
+  void RegisterEnclaveExitsView();
+  void RegisterEnclaveBytesMarshalledView();
+  void RegisterEnclaveTimeInsideView();
+  void RegisterEnclaveTimeInExitsView();
+  void RegisterEnclaveThreadsInsideView();
 
   // Record metrics
   typedef void (OpenCensusClient::*Recorder)(const ProcStatResponse &) const;
@@ -132,6 +155,16 @@ class OpenCensusClient {
   const absl::string_view kGuestTimeMeasureName = "proc/stat/guesttime";
   const absl::string_view kChildrenGuestTimeMeasureName =
       "proc/stat/cguesttime";
+  const absl::string_view kEnclaveEntriesMeasureName = "enclave/entries";
+  const absl::string_view kEnclaveExitsMeasureName = "enclave/exits";
+  const absl::string_view kEnclaveBytesMarshalledMeasureName =
+      "enclave/bytes_marshalled";
+  const absl::string_view kEnclaveTimeInsideMeasureName =
+      "enclave/time_inside";
+  const absl::string_view kEnclaveTimeInExitsMeasureName =
+      "enclave/time_in_exits";
+  const absl::string_view kEnclaveThreadsInsideMeasureName =
+      "enclave/threads_inside";
 
   // Measure descriptions
   const absl::string_view kMinorFaultsMeasureDescription =
@@ -169,6 +202,20 @@ class OpenCensusClient {
       "Guest time of the process. Reported in clock ticks.";
   const absl::string_view kChildrenGuestTimeMeasureDescription =
       "Guest time of the process' children. Reported in clock ticks.";
+  const absl::string_view kEnclaveEntriesMeasureDescription =
+      "The number of times the enclave has been entered.";
+  const absl::string_view kEnclaveExitsMeasureDescription =
+      "The number of exit calls the enclave has made.";
+  const absl::string_view kEnclaveBytesMarshalledMeasureDescription =
+      "Bytes marshalled across the enclave boundary by entries and exits.";
+  const absl::string_view kEnclaveTimeInsideMeasureDescription =
+      "Time spent inside the enclave, excluding exit calls, summed over host"
+      " threads. Reported in nanoseconds.";
+  const absl::string_view kEnclaveTimeInExitsMeasureDescription =
+      "Time spent handling exit calls of the enclave, summed over host"
+      " threads. Reported in nanoseconds.";
+  const absl::string_view kEnclaveThreadsInsideMeasureDescription =
+      "The number of host threads currently inside the enclave.";
 
   // View descriptors
   ::opencensus::stats::ViewDescriptor minor_faults_view_descriptor_;
@@ -185,6 +232,12 @@ class OpenCensusClient {
   ::opencensus::stats::ViewDescriptor rss_slim_view_descriptor_;
   ::opencensus::stats::ViewDescriptor guest_time_view_descriptor_;
   ::opencensus::stats::ViewDescriptor children_guest_time_view_descriptor_;
+  ::opencensus::stats::ViewDescriptor enclave_entries_view_descriptor_;
+  ::opencensus::stats::ViewDescriptor enclave_exits_view_descriptor_;
+  ::opencensus::stats::ViewDescriptor enclave_bytes_marshalled_view_descriptor_;
+  ::opencensus::stats::ViewDescriptor enclave_time_inside_view_descriptor_;
+  ::opencensus::stats::ViewDescriptor enclave_time_in_exits_view_descriptor_;
+  ::opencensus::stats::ViewDescriptor enclave_threads_inside_view_descriptor_;
 
   // ProcSystemServiceClient for gathering metrics.
   const std::unique_ptr<ProcSystemServiceClient> proc_client_;
@@ -0,0 +1,504 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/primitives/remote/shared_memory_impl.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/random/random.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "asylo/platform/common/futex.h"
+#include "asylo/platform/primitives/remote/communicator.h"
+#include "asylo/platform/primitives/remote/grpc_service.pb.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/posix_error_space.h"
+#include "asylo/util/status.h"
+#include "asylo/util/status_macros.h"
+#include "asylo/util/statusor.h"
+#include "asylo/util/thread.h"
+
+namespace asylo {
+namespace primitives {
+
+namespace {
+
+// Identifies a segment created by this implementation.
+constexpr uint64_t kSegmentMagic = 0x6f6c7973612d6d73;  // "sm-asylo"
+
+constexpr size_t kNonceSize = 16;
+
+// Number of times a waiter polls the ring before going to sleep on the futex
+// on a multi-core machine. A synchronous enclave call usually gets its
+// response within a few microseconds, which is less than the cost of a futex
+// round trip. On a single core spinning only delays the counterpart.
+constexpr int kSpinIterations = 2000;
+
+int SpinIterations() {
+  static const int spin_iterations =
+      std::thread::hardware_concurrency() > 1 ? kSpinIterations : 0;
+  return spin_iterations;
+}
+
+// Frame flags.
+constexpr uint32_t kFrameHasStatus = 1 << 0;
+constexpr uint32_t kFrameHasHostTime = 1 << 1;
+
+// Fixed part of a frame in a ring. It is followed by |status_size| bytes of
+// serialized StatusProto and then by |item_count| items, each encoded as a
+// 4-byte length followed by the item bytes. Frames are stored unaligned and
+// may wrap around the end of the ring.
+struct FrameHeader {
+  uint32_t frame_size;
+  uint32_t flags;
+  uint64_t invocation_thread_id;
+  uint64_t selector;
+  uint64_t request_sequence_number;
+  int64_t host_time_nanos;
+  uint32_t status_size;
+  uint32_t item_count;
+};
+
+// Blocks until |ready| returns true or |closed| is set. |event| is the futex
+// word bumped by the other side whenever the condition may have changed, and
+// |waiting| tells it whether a futex wake is needed.
+template <typename Predicate>
+void WaitFor(std::atomic<int32_t> *event, std::atomic<int32_t> *waiting,
+             const std::atomic<int32_t> &closed, Predicate ready) {
+  for (int i = 0; i < SpinIterations(); ++i) {
+    if (ready() || closed.load()) {
+      return;
+    }
+  }
+  for (;;) {
+    waiting->store(1);
+    const int32_t observed = event->load();
+    if (ready() || closed.load()) {
+      break;
+    }
+    sys_futex_wait(reinterpret_cast<int32_t *>(event), observed);
+  }
+  waiting->store(0);
+}
+
+// Signals a waiter in WaitFor() on |event|.
+void Notify(std::atomic<int32_t> *event, std::atomic<int32_t> *waiting) {
+  event->fetch_add(1);
+  if (waiting->load()) {
+    sys_futex_wake(reinterpret_cast<int32_t *>(event));
+  }
+}
+
+}  // namespace
+
+constexpr size_t Communicator::SharedMemoryImpl::kRingSize;
+constexpr size_t Communicator::SharedMemoryImpl::kMaxFrameSize;
+
+// One direction of the transport. |head| and |tail| count the bytes ever
+// written and consumed, modulo 2^32; since kRingSize divides 2^32, the offset
+// of a position in |data| is simply its low bits.
+struct Communicator::SharedMemoryImpl::Ring {
+  std::atomic<int32_t> head;
+  std::atomic<int32_t> tail;
+
+  // Futex words bumped when data is published and when space is released.
+  std::atomic<int32_t> data_event;
+  std::atomic<int32_t> space_event;
+
+  // Set while the consumer (producer) is about to sleep on |data_event|
+  // (|space_event|).
+  std::atomic<int32_t> consumer_waiting;
+  std::atomic<int32_t> producer_waiting;
+
+  alignas(64) uint8_t data[kRingSize];
+
+  static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t),
+                "Futex words must be plain 32-bit integers");
+  static_assert((kRingSize & (kRingSize - 1)) == 0,
+                "Ring size must be a power of two");
+};
+
+// Layout of the shared memory segment. The segment is zero-filled by
+// ftruncate, which is a valid initial state for all the atomics.
+struct Communicator::SharedMemoryImpl::Segment {
+  uint64_t magic;
+  uint8_t nonce[kNonceSize];
+  std::atomic<int32_t> closed;
+
+  // rings[0] carries messages from host to target, rings[1] from target to
+  // host.
+  alignas(64) Ring rings[2];
+};
+
+namespace {
+
+// Copies |size| bytes from |data| into |ring_data| at |position|, wrapping
+// around the end of the ring.
+void CopyToRing(uint8_t *ring_data, size_t ring_size, uint32_t position,
+                const void *data, size_t size) {
+  const size_t offset = position & (ring_size - 1);
+  const size_t first = std::min(size, ring_size - offset);
+  memcpy(ring_data + offset, data, first);
+  memcpy(ring_data, static_cast<const uint8_t *>(data) + first, size - first);
+}
+
+// Copies |size| bytes at |position| of |ring_data| into |data|, wrapping
+// around the end of the ring.
+void CopyFromRing(const uint8_t *ring_data, size_t ring_size,
+                  uint32_t position, void *data, size_t size) {
+  const size_t offset = position & (ring_size - 1);
+  const size_t first = std::min(size, ring_size - offset);
+  memcpy(data, ring_data + offset, first);
+  memcpy(static_cast<uint8_t *>(data) + first, ring_data, size - first);
+}
+
+// Maps |fd| as a Segment, closing the descriptor.
+StatusOr<void *> MapSegment(int fd, size_t size) {
+  void *address =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, /*offset=*/0);
+  const int mmap_errno = errno;
+  close(fd);
+  if (address == MAP_FAILED) {
+    return Status(static_cast<error::PosixError>(mmap_errno),
+                  "Failed to map shared memory segment");
+  }
+  return address;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<Communicator::SharedMemoryImpl>>
+Communicator::SharedMemoryImpl::Create(Communicator *communicator) {
+  absl::BitGen random;
+  const std::string name =
+      absl::StrCat("/asylo_communicator_", getpid(), "_",
+                   absl::Hex(absl::Uniform<uint64_t>(random)));
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    return Status(
+        static_cast<error::PosixError>(errno),
+        absl::StrCat("Failed to create shared memory segment ", name));
+  }
+  if (ftruncate(fd, sizeof(Segment)) != 0) {
+    const int ftruncate_errno = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    return Status(static_cast<error::PosixError>(ftruncate_errno),
+                  "Failed to size shared memory segment");
+  }
+  auto address_result = MapSegment(fd, sizeof(Segment));
+  if (!address_result.ok()) {
+    shm_unlink(name.c_str());
+    return address_result.status();
+  }
+
+  auto segment = static_cast<Segment *>(address_result.ValueOrDie());
+  for (size_t i = 0; i < kNonceSize; i += sizeof(uint64_t)) {
+    const uint64_t word = absl::Uniform<uint64_t>(random);
+    memcpy(segment->nonce + i, &word, sizeof(word));
+  }
+  segment->magic = kSegmentMagic;
+  return absl::WrapUnique(new SharedMemoryImpl(communicator, segment, name));
+}
+
+StatusOr<std::unique_ptr<Communicator::SharedMemoryImpl>>
+Communicator::SharedMemoryImpl::Attach(absl::string_view name,
+                                       absl::string_view nonce,
+                                       Communicator *communicator) {
+  const std::string segment_name(name);
+  int fd = shm_open(segment_name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    // Most likely the counterpart runs on a different machine.
+    return Status(static_cast<error::PosixError>(errno),
+                  absl::StrCat("Failed to open shared memory segment ", name));
+  }
+  struct stat segment_stat;
+  if (fstat(fd, &segment_stat) != 0 ||
+      segment_stat.st_size != static_cast<off_t>(sizeof(Segment))) {
+    close(fd);
+    return Status(error::GoogleError::FAILED_PRECONDITION,
+                  "Shared memory segment has unexpected size");
+  }
+  void *address;
+  ASYLO_ASSIGN_OR_RETURN(address, MapSegment(fd, sizeof(Segment)));
+
+  auto segment = static_cast<Segment *>(address);
+  if (segment->magic != kSegmentMagic || nonce.size() != kNonceSize ||
+      memcmp(segment->nonce, nonce.data(), kNonceSize) != 0) {
+    munmap(address, sizeof(Segment));
+    return Status(error::GoogleError::FAILED_PRECONDITION,
+                  "Shared memory segment does not belong to the counterpart");
+  }
+  return absl::WrapUnique(
+      new SharedMemoryImpl(communicator, segment, segment_name));
+}
+
+Communicator::SharedMemoryImpl::SharedMemoryImpl(Communicator *communicator,
+                                                 Segment *segment,
+                                                 std::string name)
+    : communicator_(CHECK_NOTNULL(communicator)),
+      segment_(segment),
+      name_(std::move(name)),
+      closed_(false) {}
+
+Communicator::SharedMemoryImpl::~SharedMemoryImpl() {
+  Close();
+  if (communicator_->is_host()) {
+    Unlink();
+  }
+  munmap(segment_, sizeof(Segment));
+}
+
+std::string Communicator::SharedMemoryImpl::nonce() const {
+  return std::string(reinterpret_cast<const char *>(segment_->nonce),
+                     kNonceSize);
+}
+
+void Communicator::SharedMemoryImpl::Unlink() {
+  // ENOENT is expected if the name has already been removed.
+  shm_unlink(name_.c_str());
+}
+
+Communicator::SharedMemoryImpl::Ring *
+Communicator::SharedMemoryImpl::outgoing() const {
+  return &segment_->rings[communicator_->is_host() ? 0 : 1];
+}
+
+Communicator::SharedMemoryImpl::Ring *
+Communicator::SharedMemoryImpl::incoming() const {
+  return &segment_->rings[communicator_->is_host() ? 1 : 0];
+}
+
+void Communicator::SharedMemoryImpl::Start() {
+  CHECK(!receiver_thread_);
+  receiver_thread_ = absl::make_unique<Thread>([this] { ReceiveLoop(); });
+}
+
+bool Communicator::SharedMemoryImpl::Send(const CommunicationMessage &message) {
+  if (closed_.load() || segment_->closed.load()) {
+    return false;
+  }
+
+  FrameHeader header = {};
+  header.frame_size = sizeof(header);
+  header.invocation_thread_id = message.invocation_thread_id();
+  header.selector = message.selector();
+  header.request_sequence_number = message.request_sequence_number();
+  std::string status;
+  if (message.has_status()) {
+    header.flags |= kFrameHasStatus;
+    if (!message.status().SerializeToString(&status)) {
+      return false;
+    }
+    header.status_size = status.size();
+    header.frame_size += status.size();
+  }
+  if (communicator_->is_host()) {
+    header.flags |= kFrameHasHostTime;
+    header.host_time_nanos = absl::GetCurrentTimeNanos();
+  }
+  header.item_count = message.items_size();
+  for (const auto &item : message.items()) {
+    if (item.size() > kMaxFrameSize) {
+      return false;
+    }
+    header.frame_size += sizeof(uint32_t) + item.size();
+    if (header.frame_size > kMaxFrameSize) {
+      return false;
+    }
+  }
+
+  absl::MutexLock lock(&send_mu_);
+  Ring *const ring = outgoing();
+  bool corrupted = false;
+  auto has_space = [this, ring, &header, &corrupted] {
+    const uint32_t used = head_ - static_cast<uint32_t>(ring->tail.load());
+    corrupted = used > kRingSize;
+    return corrupted || kRingSize - used >= header.frame_size;
+  };
+  WaitFor(&ring->space_event, &ring->producer_waiting, segment_->closed,
+          has_space);
+  if (corrupted) {
+    LOG(ERROR) << "Shared memory ring position is corrupted";
+    return false;
+  }
+  if (segment_->closed.load()) {
+    return false;
+  }
+
+  uint32_t position = head_;
+  CopyToRing(ring->data, kRingSize, position, &header, sizeof(header));
+  position += sizeof(header);
+  CopyToRing(ring->data, kRingSize, position, status.data(), status.size());
+  position += status.size();
+  for (const auto &item : message.items()) {
+    const uint32_t item_size = item.size();
+    CopyToRing(ring->data, kRingSize, position, &item_size, sizeof(item_size));
+    position += sizeof(item_size);
+    CopyToRing(ring->data, kRingSize, position, item.data(), item.size());
+    position += item.size();
+  }
+  head_ = position;
+  ring->head.store(static_cast<int32_t>(head_));
+  Notify(&ring->data_event, &ring->consumer_waiting);
+  return true;
+}
+
+void Communicator::SharedMemoryImpl::Close() {
+  if (closed_.exchange(true)) {
+    return;
+  }
+  segment_->closed.store(1);
+  for (Ring &ring : segment_->rings) {
+    Notify(&ring.data_event, &ring.consumer_waiting);
+    Notify(&ring.space_event, &ring.producer_waiting);
+  }
+  if (receiver_thread_) {
+    receiver_thread_->Join();
+    receiver_thread_.reset();
+  }
+}
+
+void Communicator::SharedMemoryImpl::ReceiveLoop() {
+  for (;;) {
+    const uint32_t available = WaitForIncoming();
+    if (available == 0) {
+      return;
+    }
+    std::unique_ptr<CommunicationMessage> message = ReadFrame(available);
+    if (!message) {
+      // The counterpart cannot be trusted to keep the ring consistent any
+      // longer; stop reading and let both sides fall back to gRPC.
+      segment_->closed.store(1);
+      Ring *const ring = incoming();
+      Notify(&ring->space_event, &ring->producer_waiting);
+      return;
+    }
+    if (!communicator_->is_host() && message->has_host_time_nanos()) {
+      communicator_->set_host_time_nanos(message->host_time_nanos());
+    }
+    CommunicationMessage *const raw_message = message.release();
+    communicator_->QueueMessageForThread(CommunicationMessagePtr(
+        raw_message,
+        WrappedMessageDeleter([raw_message] { delete raw_message; })));
+  }
+}
+
+uint32_t Communicator::SharedMemoryImpl::WaitForIncoming() {
+  Ring *const ring = incoming();
+  uint32_t available = 0;
+  WaitFor(&ring->data_event, &ring->consumer_waiting, segment_->closed,
+          [this, ring, &available] {
+            available = static_cast<uint32_t>(ring->head.load()) - tail_;
+            return available != 0;
+          });
+  if (segment_->closed.load()) {
+    return 0;
+  }
+  return available;
+}
+
+std::unique_ptr<CommunicationMessage>
+Communicator::SharedMemoryImpl::ReadFrame(uint32_t available) {
+  Ring *const ring = incoming();
+  FrameHeader header;
+  if (available > kRingSize || available < sizeof(header)) {
+    LOG(ERROR) << "Shared memory ring position is corrupted";
+    return nullptr;
+  }
+  CopyFromRing(ring->data, kRingSize, tail_, &header, sizeof(header));
+  if (header.frame_size < sizeof(header) || header.frame_size > available ||
+      header.frame_size > kMaxFrameSize) {
+    LOG(ERROR) << "Malformed shared memory frame, size=" << header.frame_size;
+    return nullptr;
+  }
+
+  auto message = absl::make_unique<CommunicationMessage>();
+  message->set_invocation_thread_id(header.invocation_thread_id);
+  message->set_selector(header.selector);
+  message->set_request_sequence_number(header.request_sequence_number);
+  if (header.flags & kFrameHasHostTime) {
+    message->set_host_time_nanos(header.host_time_nanos);
+  }
+
+  uint32_t position = tail_ + sizeof(header);
+  uint32_t remaining = header.frame_size - sizeof(header);
+  if (header.flags & kFrameHasStatus) {
+    if (header.status_size > remaining) {
+      LOG(ERROR) << "Malformed shared memory frame status";
+      return nullptr;
+    }
+    std::string status(header.status_size, '\0');
+    CopyFromRing(ring->data, kRingSize, position, &status[0], status.size());
+    if (!message->mutable_status()->ParseFromString(status)) {
+      LOG(ERROR) << "Malformed shared memory frame status";
+      return nullptr;
+    }
+    position += header.status_size;
+    remaining -= header.status_size;
+  }
+  for (uint32_t i = 0; i < header.item_count; ++i) {
+    uint32_t item_size;
+    if (remaining < sizeof(item_size)) {
+      LOG(ERROR) << "Malformed shared memory frame items";
+      return nullptr;
+    }
+    CopyFromRing(ring->data, kRingSize, position, &item_size,
+                 sizeof(item_size));
+    position += sizeof(item_size);
+    remaining -= sizeof(item_size);
+    if (item_size > remaining) {
+      LOG(ERROR) << "Malformed shared memory frame items";
+      return nullptr;
+    }
+    std::string *const item = message->add_items();
+    item->resize(item_size);
+    CopyFromRing(ring->data, kRingSize, position, &(*item)[0], item_size);
+    position += item_size;
+    remaining -= item_size;
+  }
+  if (remaining != 0) {
+    LOG(ERROR) << "Malformed shared memory frame, " << remaining
+               << " trailing bytes";
+    return nullptr;
+  }
+
+  tail_ += header.frame_size;
+  ring->tail.store(static_cast<int32_t>(tail_));
+  Notify(&ring->space_event, &ring->producer_waiting);
+  return message;
+}
+
+}  // namespace primitives
+}  // namespace asylo
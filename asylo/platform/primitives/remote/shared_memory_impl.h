@@ -0,0 +1,146 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_PRIMITIVES_REMOTE_SHARED_MEMORY_IMPL_H_
+#define ASYLO_PLATFORM_PRIMITIVES_REMOTE_SHARED_MEMORY_IMPL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "asylo/platform/primitives/remote/communicator.h"
+#include "asylo/platform/primitives/remote/grpc_service.pb.h"
+#include "asylo/util/asylo_macros.h"
+#include "asylo/util/status.h"
+#include "asylo/util/statusor.h"
+#include "asylo/util/thread.h"
+
+namespace asylo {
+namespace primitives {
+
+// Shared-memory data plane of a Communicator whose counterpart runs on the same
+// machine.
+//
+// The host side creates a POSIX shared memory segment holding two byte rings,
+// one per direction, and a random nonce. The segment name and the nonce are
+// sent to the target over gRPC (the control plane); the target proves that it
+// is co-located by opening the segment and finding the same nonce in it. Once
+// attached, CommunicationMessages that fit into a ring are written into it
+// as raw frames instead of being sent as Communicate RPCs, and the receiving
+// side is woken up with a futex on the ring indices. Messages too large for
+// the ring and all control RPCs (Disconnect, DisposeOfThread etc.) still use
+// gRPC.
+//
+// Each ring has a single producer process and a single consumer thread:
+// writers in the producer process are serialized by a mutex, and a dedicated
+// receiver thread in the consumer process drains the ring and hands the
+// messages to Communicator::QueueMessageForThread, exactly like the gRPC
+// service does.
+class Communicator::SharedMemoryImpl {
+ public:
+  // Size of each of the two rings in the segment. Must be a power of two.
+  static constexpr size_t kRingSize = 1 << 20;
+
+  // Largest frame that is sent through a ring; larger messages are left to
+  // gRPC.
+  static constexpr size_t kMaxFrameSize = kRingSize / 4;
+
+  // Factory method used by the host side. Creates a new shared memory segment.
+  static StatusOr<std::unique_ptr<SharedMemoryImpl>> Create(
+      Communicator *communicator);
+
+  // Factory method used by the target side. Maps the segment |name| created by
+  // the host, and fails unless it carries |nonce|.
+  static StatusOr<std::unique_ptr<SharedMemoryImpl>> Attach(
+      absl::string_view name, absl::string_view nonce,
+      Communicator *communicator);
+
+  ~SharedMemoryImpl();
+
+  SharedMemoryImpl(const SharedMemoryImpl &other) = delete;
+  SharedMemoryImpl &operator=(const SharedMemoryImpl &other) = delete;
+
+  // Name of the segment and the nonce stored in it, to be sent to the target.
+  const std::string &name() const { return name_; }
+  std::string nonce() const;
+
+  // Removes the segment name from the system. Called by the host once the
+  // target has mapped the segment, so that nothing is left behind if either
+  // process dies.
+  void Unlink();
+
+  // Starts the receiver thread.
+  void Start();
+
+  // Writes |message| into the outgoing ring. Returns false if the message is
+  // too large for the ring or the transport is closed, in which case the
+  // caller is expected to send it over gRPC.
+  ASYLO_MUST_USE_RESULT bool Send(const CommunicationMessage &message);
+
+  // Closes both rings, wakes up all waiters on either side and joins the
+  // receiver thread. Repeated calls have no effect.
+  void Close();
+
+ private:
+  struct Ring;
+  struct Segment;
+
+  SharedMemoryImpl(Communicator *communicator, Segment *segment,
+                   std::string name);
+
+  // The rings this side writes to and reads from.
+  Ring *outgoing() const;
+  Ring *incoming() const;
+
+  // Receiver thread body: waits for frames in the incoming ring and queues
+  // them for processing until the transport is closed.
+  void ReceiveLoop();
+
+  // Waits until at least one byte is available in the incoming ring. Returns
+  // the number of available bytes, or 0 if the transport is closed.
+  uint32_t WaitForIncoming();
+
+  // Reads one frame from the incoming ring. Returns nullptr (and logs) if the
+  // frame is malformed.
+  std::unique_ptr<CommunicationMessage> ReadFrame(uint32_t available);
+
+  Communicator *const communicator_;
+  Segment *const segment_;
+  const std::string name_;
+
+  // Serializes writers to the outgoing ring. The write position is kept in
+  // private memory so that the counterpart cannot corrupt it.
+  absl::Mutex send_mu_;
+  uint32_t head_ ABSL_GUARDED_BY(send_mu_) = 0;
+
+  // Read position in the incoming ring, owned by the receiver thread.
+  uint32_t tail_ = 0;
+
+  std::unique_ptr<Thread> receiver_thread_;
+  std::atomic<bool> closed_;
+};
+
+}  // namespace primitives
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_PRIMITIVES_REMOTE_SHARED_MEMORY_IMPL_H_
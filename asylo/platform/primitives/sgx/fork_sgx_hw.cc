@@ -37,6 +37,7 @@
 #include "asylo/identity/identity_acl_evaluator.h"
 #include "asylo/identity/sgx/sgx_identity_expectation_matcher.h"
 #include "asylo/identity/sgx/sgx_identity_util.h"
+#include "asylo/platform/common/fork_generation.h"
 #include "asylo/platform/host_call/trusted/host_calls.h"
 #include "asylo/platform/posix/memory/memory.h"
 #include "asylo/platform/primitives/sgx/fork_internal.h"
@@ -664,6 +665,10 @@ Status RestoreForFork(const char *input, size_t input_len) {
     return Status(error_code, error_message);
   }
 
+  // The restored data carries the parent's fork generation. Advance it so that
+  // one-time secrets copied from the parent are discarded rather than reused.
+  AdvanceForkGeneration();
+
   // Only unblock other entries if restoring the child enclave succeeds.
   // Otherwise this enclave blocks all entries. The entries are blocked at this
   // point because they were blocked when the snapshot is taken, and inherited
@@ -511,17 +511,27 @@ int ocall_dispatch_untrusted_call(uint64_t selector, void *buffer) {
   ::asylo::primitives::MessageReader in;
   if (sgx_params->input) {
     in.Deserialize(sgx_params->input, sgx_params->input_size);
-    free(const_cast<void *>(sgx_params->input));
+    if (!sgx_params->output_buffer) {
+      free(const_cast<void *>(sgx_params->input));
+    }
   }
   sgx_params->output_size = 0;
   sgx_params->output = nullptr;
   ::asylo::primitives::MessageWriter out;
   const auto status =
       ::asylo::primitives::Client::ExitCallback(selector, &in, &out);
+  // Hand any signals queued while the enclave was running to the enclave on
+  // its way back in.
+  auto client = dynamic_cast<::asylo::primitives::SgxEnclaveClient *>(
+      ::asylo::primitives::Client::current_client());
+  sgx_params->pending_signals = client ? client->TakePendingSignals() : 0;
   if (status.ok()) {
     sgx_params->output_size = out.MessageSize();
     if (sgx_params->output_size > 0) {
-      sgx_params->output = malloc(sgx_params->output_size);
+      sgx_params->output =
+          sgx_params->output_size <= sgx_params->output_capacity
+              ? sgx_params->output_buffer
+              : malloc(sgx_params->output_size);
       out.Serialize(sgx_params->output);
     }
   }
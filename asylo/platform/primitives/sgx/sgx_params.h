@@ -23,8 +23,8 @@
 
 namespace asylo {
 
-// Helper structure needed for passing 4 parameters to and from SGX layer
-// in a single message, referred to as void *buffer.
+// Helper structure needed for passing parameters to and from SGX layer in a
+// single message, referred to as void *buffer.
 struct SgxParams {
   // Serialized input parameters - if input != nullptr, input_size is its size,
   // otherwise input_size = 0.
@@ -34,6 +34,18 @@ struct SgxParams {
   // otherwise output_size = 0.
   void *output;
   uint64_t output_size;
+  // Signals queued by the untrusted runtime for delivery inside the enclave,
+  // set by the host on every enclave entry and on return from every host call.
+  // Bit (n - 1) is set if host signal number n is pending.
+  uint64_t pending_signals;
+  // Untrusted buffer of output_capacity bytes, set by the enclave on a host
+  // call to receive the serialized results. If the results fit, the host
+  // serializes them into output_buffer and sets output to it; otherwise output
+  // is allocated by the host as usual. When output_buffer is set, input is
+  // owned by the enclave and is not freed by the host. Unused on enclave entry,
+  // where output_buffer is nullptr.
+  void *output_buffer;
+  uint64_t output_capacity;
 };
 
 }  // namespace asylo
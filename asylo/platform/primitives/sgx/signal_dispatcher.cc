@@ -105,6 +105,9 @@ int EnclaveSignalDispatcher::EnterEnclaveAndHandleSignal(int signum,
   if (!client) {
     return -1;
   }
+  if (client->QueueSignal(signum)) {
+    return 0;
+  }
   EnclaveSignal enclave_signal;
   enclave_signal.set_signum(signum);
   enclave_signal.set_code(info->si_code);
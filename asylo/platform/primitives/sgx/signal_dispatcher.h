@@ -55,7 +55,9 @@ class EnclaveSignalDispatcher {
 
   // Looks for the enclave client that registered |signum|, and calls
   // EnterAndHandleSignal() with that enclave client. |signum|, |info| and
-  // |ucontext| are passed into the enclave.
+  // |ucontext| are passed into the enclave. If the enclave client queues
+  // signals, |signum| is queued for delivery at the next enclave transition
+  // instead.
   int EnterEnclaveAndHandleSignal(int signum, siginfo_t *info, void *ucontext);
 
  private:
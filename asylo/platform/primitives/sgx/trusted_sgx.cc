@@ -22,8 +22,11 @@
 #include <signal.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
+#include "absl/base/attributes.h"
 #include "absl/strings/str_cat.h"
 #include "asylo/enclave.pb.h"
 #include "asylo/util/logging.h"
@@ -42,7 +45,6 @@
 #include "asylo/platform/primitives/util/trusted_runtime_helper.h"
 #include "asylo/platform/primitives/x86/spin_lock.h"
 #include "asylo/platform/system_call/type_conversions/types_functions.h"
-#include "asylo/util/cleanup.h"
 #include "asylo/util/status.h"
 #include "asylo/util/status_macros.h"
 #include "include/sgx_trts.h"
@@ -64,6 +66,87 @@ namespace {
     }                                                                        \
   } while (0)
 
+// Delivers the signals in |pending_signals|, queued by the untrusted runtime in
+// the layout described in SgxParams, to the handlers registered inside the
+// enclave. Queued signals carry no siginfo beyond the signal number.
+void DeliverPendingSignals(uint64_t pending_signals) {
+  SignalManager *signal_manager = SignalManager::GetInstance();
+  while (pending_signals != 0) {
+    int klinux_signum = __builtin_ctzll(pending_signals) + 1;
+    pending_signals &= pending_signals - 1;
+
+    int signum = FromkLinuxSignalNumber(klinux_signum);
+    if (signum < 0) {
+      continue;
+    }
+    // As in DeliverSignal, a signal that is blocked inside the enclave is
+    // dropped.
+    const sigset_t mask = signal_manager->GetSignalMask();
+    if (sigismember(&mask, signum)) {
+      continue;
+    }
+    siginfo_t info = {};
+    info.si_signo = signum;
+    signal_manager->HandleSignal(signum, &info, /*ucontext=*/nullptr);
+  }
+}
+
+// Largest per-thread untrusted buffer retained for host calls. Host calls
+// with larger messages allocate untrusted memory for each call.
+constexpr size_t kMaxUntrustedCallBufferSize = 64 * 1024;
+
+// Smallest area reserved for the results of a host call in the per-thread
+// untrusted buffer.
+constexpr size_t kMinUntrustedCallOutputSize = 256;
+
+// Per-thread buffer in untrusted memory which holds the SgxParams, serialized
+// input and serialized output of a host call, so that steady-state host calls
+// make no allocation ocalls. The output area is sized by the largest output
+// observed on the thread. |in_use| guards against a host call made by a signal
+// handler while another host call on the thread is in flight. Thread-local
+// state must be trivially destructible, so the buffer is not freed on thread
+// exit.
+struct UntrustedCallBuffer {
+  void *data;
+  size_t capacity;
+  size_t output_reserve;
+  bool in_use;
+};
+
+ABSL_CONST_INIT thread_local UntrustedCallBuffer untrusted_call_buffer;
+
+size_t AlignUp(size_t size) {
+  constexpr size_t kAlignment = alignof(std::max_align_t);
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// Returns the per-thread buffer, grown to hold a host call with |input_size|
+// bytes of input, or nullptr if the buffer is in use or the call is too large.
+UntrustedCallBuffer *AcquireUntrustedCallBuffer(size_t input_size) {
+  UntrustedCallBuffer *buffer = &untrusted_call_buffer;
+  size_t size = AlignUp(sizeof(SgxParams)) + AlignUp(input_size) +
+                std::max(buffer->output_reserve, kMinUntrustedCallOutputSize);
+  if (buffer->in_use || size > kMaxUntrustedCallBufferSize) {
+    return nullptr;
+  }
+  if (size > buffer->capacity) {
+    size_t capacity = 2 * kMinUntrustedCallOutputSize;
+    while (capacity < size) {
+      capacity *= 2;
+    }
+    if (buffer->data) {
+      TrustedPrimitives::UntrustedLocalFree(buffer->data);
+    }
+    buffer->data = TrustedPrimitives::UntrustedLocalAlloc(capacity);
+    buffer->capacity = buffer->data ? capacity : 0;
+    if (!buffer->data) {
+      return nullptr;
+    }
+  }
+  buffer->in_use = true;
+  return buffer;
+}
+
 }  // namespace
 
 int RegisterSignalHandler(
@@ -130,6 +213,17 @@ PrimitiveStatus FinalizeEnclave(void *context, MessageReader *in,
   return asylo_enclave_fini();
 }
 
+// Entry handler installed by the runtime to deliver queued signals to an
+// otherwise idle enclave. The signals themselves are delivered by
+// asylo_enclave_call before any entry handler runs.
+PrimitiveStatus HandlePendingSignals(void *context, MessageReader *in,
+                                     MessageWriter *out) {
+  if (in) {
+    ASYLO_RETURN_IF_READER_NOT_EMPTY(*in);
+  }
+  return PrimitiveStatus::OkStatus();
+}
+
 // Entry handler installed by the runtime to start the created thread.
 PrimitiveStatus DonateThread(void *context, MessageReader *in,
                              MessageWriter *out) {
@@ -165,6 +259,15 @@ void RegisterInternalHandlers() {
     TrustedPrimitives::BestEffortAbort(
         "Could not register entry handler: FinalizeEnclave");
   }
+
+  // Register the pending signal delivery entry handler.
+  if (!TrustedPrimitives::RegisterEntryHandler(
+           kSelectorAsyloDeliverPendingSignals,
+           EntryHandler{HandlePendingSignals})
+           .ok()) {
+    TrustedPrimitives::BestEffortAbort(
+        "Could not register entry handler: HandlePendingSignals");
+  }
 }
 
 void TrustedPrimitives::BestEffortAbort(const char *message) {
@@ -203,6 +306,8 @@ int asylo_enclave_call(uint64_t selector, void *buffer) {
     }
   }
 
+  DeliverPendingSignals(sgx_params->pending_signals);
+
   PrimitiveStatus status =
       InvokeEntryHandler(selector, input, input_size, &output, &output_size);
 
@@ -274,31 +379,66 @@ PrimitiveStatus TrustedPrimitives::UntrustedCall(uint64_t untrusted_selector,
                                                  MessageReader *output) {
   int ret;
 
-  SgxParams *const sgx_params = reinterpret_cast<SgxParams *>(
-      TrustedPrimitives::UntrustedLocalAlloc(sizeof(SgxParams)));
-  Cleanup clean_up(
-      [sgx_params] { TrustedPrimitives::UntrustedLocalFree(sgx_params); });
-  sgx_params->input_size = 0;
-  sgx_params->input = nullptr;
-  if (input) {
-    sgx_params->input_size = input->MessageSize();
-    if (sgx_params->input_size > 0) {
-      sgx_params->input =
-          TrustedPrimitives::UntrustedLocalAlloc(sgx_params->input_size);
-      // Copy data to |input_buffer|.
-      input->Serialize(const_cast<void *>(sgx_params->input));
-    }
+  const size_t input_size = input ? input->MessageSize() : 0;
+  UntrustedCallBuffer *const buffer = AcquireUntrustedCallBuffer(input_size);
+  SgxParams *sgx_params;
+  void *output_area = nullptr;
+  if (buffer) {
+    // Lay out the SgxParams, input and output area in the per-thread buffer.
+    char *const data = reinterpret_cast<char *>(buffer->data);
+    const size_t input_offset = AlignUp(sizeof(SgxParams));
+    const size_t output_offset = input_offset + AlignUp(input_size);
+    sgx_params = reinterpret_cast<SgxParams *>(data);
+    sgx_params->input = input_size > 0 ? data + input_offset : nullptr;
+    output_area = data + output_offset;
+    sgx_params->output_buffer = output_area;
+    sgx_params->output_capacity = buffer->capacity - output_offset;
+  } else {
+    sgx_params = reinterpret_cast<SgxParams *>(
+        TrustedPrimitives::UntrustedLocalAlloc(sizeof(SgxParams)));
+    sgx_params->input =
+        input_size > 0 ? TrustedPrimitives::UntrustedLocalAlloc(input_size)
+                       : nullptr;
+    sgx_params->output_buffer = nullptr;
+    sgx_params->output_capacity = 0;
+  }
+  sgx_params->input_size = input_size;
+  if (sgx_params->input) {
+    // Copy data to |input_buffer|.
+    input->Serialize(const_cast<void *>(sgx_params->input));
   }
   sgx_params->output_size = 0;
   sgx_params->output = nullptr;
+  sgx_params->pending_signals = 0;
   CHECK_OCALL(
       ocall_dispatch_untrusted_call(&ret, untrusted_selector, sgx_params));
-  if (sgx_params->output) {
+
+  // Read the results once, since untrusted memory may change concurrently.
+  const uint64_t pending_signals = sgx_params->pending_signals;
+  void *const output_data = sgx_params->output;
+  const size_t output_size = sgx_params->output_size;
+  if (output_data) {
+    if (!TrustedPrimitives::IsOutsideEnclave(output_data, output_size)) {
+      TrustedPrimitives::BestEffortAbort(
+          "UntrustedCall output should lie within untrusted memory.");
+    }
     // For the results obtained in |output_buffer|, copy them to |output|
     // before freeing the buffer.
-    output->Deserialize(sgx_params->output, sgx_params->output_size);
-    TrustedPrimitives::UntrustedLocalFree(sgx_params->output);
+    output->Deserialize(output_data, output_size);
+    if (output_data != output_area) {
+      TrustedPrimitives::UntrustedLocalFree(output_data);
+    }
+  }
+  if (buffer) {
+    buffer->output_reserve = std::max(
+        buffer->output_reserve,
+        std::min(output_size, kMaxUntrustedCallBufferSize / 2));
+    buffer->in_use = false;
+  } else {
+    // The host frees |input| when no output buffer is provided.
+    TrustedPrimitives::UntrustedLocalFree(sgx_params);
   }
+  DeliverPendingSignals(pending_signals);
   return PrimitiveStatus::OkStatus();
 }
 
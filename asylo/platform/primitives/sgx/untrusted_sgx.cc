@@ -18,12 +18,15 @@
 
 #include "asylo/platform/primitives/sgx/untrusted_sgx.h"
 
+#include <signal.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
 #include <cstdlib>
 #include <string>
 
+#include "absl/synchronization/mutex.h"
+#include "asylo/platform/primitives/primitives.h"
 #include "asylo/platform/primitives/sgx/exit_handlers.h"
 #include "asylo/platform/primitives/sgx/sgx_error_space.h"
 #include "asylo/platform/primitives/sgx/sgx_params.h"
@@ -58,6 +61,32 @@ constexpr absl::string_view kCallingProcessBinaryFile = "/proc/self/exe";
 
 constexpr int kMaxEnclaveCreateAttempts = 5;
 
+// Returns a reader over the binary of the calling process. The binary is
+// mapped and its section index is built on first use only, and both are kept
+// for the lifetime of the process so that loading several embedded enclaves,
+// possibly from several threads, does not repeatedly map and parse the binary.
+// A failure is not cached and is retried by the next call.
+StatusOr<const ElfReader *> GetCallingProcessBinaryReader() {
+  static absl::Mutex *mu = new absl::Mutex;
+  static FileMapping *self_binary_mapping = nullptr;
+  static ElfReader *self_binary_reader = nullptr;
+
+  absl::MutexLock lock(mu);
+  if (self_binary_reader) {
+    return self_binary_reader;
+  }
+
+  FileMapping mapping;
+  ASYLO_ASSIGN_OR_RETURN(mapping,
+                         FileMapping::CreateFromFile(kCallingProcessBinaryFile));
+  ElfReader reader;
+  ASYLO_ASSIGN_OR_RETURN(reader, ElfReader::CreateFromSpan(mapping.buffer()));
+
+  self_binary_mapping = new FileMapping(std::move(mapping));
+  self_binary_reader = new ElfReader(std::move(reader));
+  return self_binary_reader;
+}
+
 // Edger8r-generated primitives ecall marshalling struct.
 struct ms_ecall_dispatch_trusted_call_t {
   // Return value from the trusted call.
@@ -251,17 +280,12 @@ StatusOr<std::shared_ptr<Client>> SgxEmbeddedBackend::Load(
                   "Failed to reserve enclave memory");
   }
 
-  FileMapping self_binary_mapping;
-  ASYLO_ASSIGN_OR_RETURN(self_binary_mapping, FileMapping::CreateFromFile(
-                                                  kCallingProcessBinaryFile));
-
-  ElfReader self_binary_reader;
-  ASYLO_ASSIGN_OR_RETURN(self_binary_reader, ElfReader::CreateFromSpan(
-                                                 self_binary_mapping.buffer()));
+  const ElfReader *self_binary_reader;
+  ASYLO_ASSIGN_OR_RETURN(self_binary_reader, GetCallingProcessBinaryReader());
 
   absl::Span<const uint8_t> enclave_buffer;
   ASYLO_ASSIGN_OR_RETURN(enclave_buffer,
-                         self_binary_reader.GetSectionData(section_name));
+                         self_binary_reader->GetSectionData(section_name));
 
   if (base_address && enclave_size > 0 &&
       munmap(base_address, enclave_size) < 0) {
@@ -340,6 +364,9 @@ Status SgxEnclaveClient::EnclaveCallInternal(uint64_t selector,
   params.input = nullptr;
   params.output = nullptr;
   params.output_size = 0;
+  params.pending_signals = TakePendingSignals();
+  params.output_buffer = nullptr;
+  params.output_capacity = 0;
   Cleanup clean_up([&params] {
     if (params.input) {
       free(const_cast<void *>(params.input));
@@ -402,6 +429,45 @@ int SgxEnclaveClient::EnterAndHandleSignal(const EnclaveSignal signal) {
   return 0;
 }
 
+bool SgxEnclaveClient::QueueSignal(int signum) {
+  if (!queue_signals_ || signum < 1 || signum > 64) {
+    return false;
+  }
+  switch (signum) {
+    // Fault signals describe the state of the faulting thread and must be
+    // handled before it resumes.
+    case SIGABRT:
+    case SIGBUS:
+    case SIGFPE:
+    case SIGILL:
+    case SIGSEGV:
+    case SIGSYS:
+    case SIGTRAP:
+      return false;
+    default:
+      break;
+  }
+  pending_signals_.fetch_or(uint64_t{1} << (signum - 1));
+  return true;
+}
+
+uint64_t SgxEnclaveClient::TakePendingSignals() {
+  // Avoid the read-modify-write in the common case where nothing is pending.
+  if (pending_signals_.load(std::memory_order_relaxed) == 0) {
+    return 0;
+  }
+  return pending_signals_.exchange(0);
+}
+
+Status SgxEnclaveClient::DeliverPendingSignals() {
+  if (pending_signals_.load() == 0) {
+    return Status::OkStatus();
+  }
+  MessageWriter input;
+  MessageReader output;
+  return EnclaveCall(kSelectorAsyloDeliverPendingSignals, &input, &output);
+}
+
 Status SgxEnclaveClient::EnterAndTakeSnapshot(SnapshotLayout *snapshot_layout) {
   char *output_buf = nullptr;
   size_t output_len = 0;
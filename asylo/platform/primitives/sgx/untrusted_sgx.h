@@ -19,7 +19,9 @@
 #ifndef ASYLO_PLATFORM_PRIMITIVES_SGX_UNTRUSTED_SGX_H_
 #define ASYLO_PLATFORM_PRIMITIVES_SGX_UNTRUSTED_SGX_H_
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 
 #include "absl/strings/string_view.h"
@@ -99,6 +101,26 @@ class SgxEnclaveClient : public Client {
 
   int EnterAndHandleSignal(const EnclaveSignal enclave_signal);
 
+  // Queues asynchronous signals for this enclave from now on instead of
+  // entering the enclave to deliver each of them. Queued signals are delivered
+  // at the next enclave entry or on return from the next host call made by the
+  // enclave. Must be called before the enclave registers any signal handlers.
+  void EnableSignalQueue() { queue_signals_ = true; }
+
+  // Marks host signal |signum| as pending delivery to the enclave. Returns
+  // false if the signal must be delivered synchronously instead, either because
+  // signal queuing is not enabled or because |signum| is a fault signal. This
+  // method is async-signal-safe.
+  bool QueueSignal(int signum);
+
+  // Removes all pending signals and returns them as a bitmap in which bit
+  // (n - 1) is set if host signal number n was pending.
+  uint64_t TakePendingSignals();
+
+  // Enters the enclave to deliver any pending signals. Callers may use this
+  // to deliver queued signals to an enclave that is otherwise idle.
+  Status DeliverPendingSignals();
+
   // Returns true when a TCS is active in simulation mode. Always returns false
   // in hardware mode, since TCS active/inactive state is only set and used in
   // simulation mode.
@@ -126,6 +148,11 @@ class SgxEnclaveClient : public Client {
   void *base_address_;              // Enclave base address.
   size_t size_;                     // Enclave size.
   bool is_destroyed_ = true;        // Whether enclave is destroyed.
+  bool queue_signals_ = false;      // Whether signals are queued.
+
+  // Signals queued for delivery at the next enclave transition. See
+  // TakePendingSignals() for the layout.
+  std::atomic<uint64_t> pending_signals_{0};
 };
 
 }  // namespace primitives
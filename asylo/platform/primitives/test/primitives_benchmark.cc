@@ -0,0 +1,109 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/platform/primitives/test/test_backend.h"
+#include "asylo/platform/primitives/test/test_selectors.h"
+#include "asylo/platform/primitives/untrusted_primitives.h"
+#include "asylo/platform/primitives/util/dispatch_table.h"
+#include "asylo/platform/primitives/util/message.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/status.h"
+
+using ::testing::SizeIs;
+
+namespace asylo {
+namespace primitives {
+namespace {
+
+class PrimitivesBenchmark : public ::testing::Test {
+ protected:
+  // Loads the test enclave, answering its initialization exit call.
+  std::shared_ptr<Client> LoadTestEnclaveOrDie() {
+    auto exit_call_provider = absl::make_unique<DispatchTable>();
+    ASYLO_EXPECT_OK(exit_call_provider->RegisterExitHandler(
+        kUntrustedInit,
+        ExitHandler{[](std::shared_ptr<Client> enclave, void *context,
+                       MessageReader *in, MessageWriter *out) {
+          while (in->hasNext()) {
+            out->PushByCopy(in->next());
+          }
+          return Status::OkStatus();
+        }}));
+    return test::TestBackend::Get()->LoadTestEnclaveOrDie(
+        /*enclave_name=*/"primitives_benchmark", std::move(exit_call_provider));
+  }
+
+  static void TearDownTestSuite() {
+    // Clean up the backend.
+    delete test::TestBackend::Get();
+  }
+};
+
+// Compare the call rate of batched enclave calls against single calls for
+// several batch sizes.
+TEST_F(PrimitivesBenchmark, BatchCallRate) {
+  constexpr int kNumCalls = 4096;
+  auto client = LoadTestEnclaveOrDie();
+
+  absl::Time start = absl::Now();
+  for (int i = 0; i < kNumCalls; i++) {
+    MessageWriter in;
+    in.Push<int32_t>(i);
+    MessageReader out;
+    ASYLO_ASSERT_OK(client->EnclaveCall(kTimesTwoSelector, &in, &out));
+  }
+  absl::Duration single = absl::Now() - start;
+  LOG(INFO) << "single calls: "
+            << kNumCalls / absl::ToDoubleSeconds(single) << " calls/s";
+
+  for (int batch_size : {1, 16, 256}) {
+    std::vector<MessageWriter> inputs(batch_size);
+    std::vector<std::pair<uint64_t, MessageWriter *>> calls;
+    for (int i = 0; i < batch_size; i++) {
+      inputs[i].Push<int32_t>(i);
+      calls.emplace_back(kTimesTwoSelector, &inputs[i]);
+    }
+
+    std::vector<Client::BatchCallResult> results;
+    start = absl::Now();
+    for (int i = 0; i < kNumCalls / batch_size; i++) {
+      ASYLO_ASSERT_OK(client->EnclaveCallBatch(calls, &results));
+      ASSERT_THAT(results, SizeIs(batch_size));
+    }
+    absl::Duration batched = absl::Now() - start;
+    LOG(INFO) << "batches of " << batch_size << ": "
+              << kNumCalls / absl::ToDoubleSeconds(batched) << " calls/s, "
+              << absl::ToDoubleSeconds(single) / absl::ToDoubleSeconds(batched)
+              << "x single calls";
+  }
+}
+
+}  // namespace
+}  // namespace primitives
+}  // namespace asylo
@@ -21,6 +21,7 @@
 #include <memory>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -288,6 +289,43 @@ TEST_F(PrimitivesTest, CallChain) {
   EXPECT_THAT(trusted_fibonacci(20), Eq(6765));
 }
 
+// Ensure a batch of calls is dispatched in a single entry, in order, and that
+// the failure of one call does not affect the others.
+TEST_F(PrimitivesTest, BatchCall) {
+  auto client = LoadTestEnclaveOrDie(/*reload=*/false);
+
+  constexpr int kNumCalls = 8;
+  std::vector<MessageWriter> inputs(kNumCalls);
+  std::vector<std::pair<uint64_t, MessageWriter *>> calls;
+  for (int i = 0; i < kNumCalls; i++) {
+    inputs[i].Push<int32_t>(i);
+    calls.emplace_back(kTimesTwoSelector, &inputs[i]);
+  }
+  calls[2].first = kNotRegisteredSelector;
+  calls[4].first = kSelectorAsyloFini;
+  calls[6].second = nullptr;
+
+  std::vector<Client::BatchCallResult> results;
+  ASYLO_ASSERT_OK(client->EnclaveCallBatch(calls, &results));
+  ASSERT_THAT(results, SizeIs(kNumCalls));
+  for (int i = 0; i < kNumCalls; i++) {
+    if (i == 2 || i == 4 || i == 6) {
+      EXPECT_THAT(results[i].status, Not(IsOk()));
+      EXPECT_THAT(results[i].output, SizeIs(0));
+      continue;
+    }
+    ASYLO_EXPECT_OK(results[i].status);
+    ASSERT_THAT(results[i].output, SizeIs(1));
+    EXPECT_THAT(results[i].output.next<int32_t>(), Eq(2 * i));
+  }
+
+  // The enclave is still usable after the batch.
+  EXPECT_THAT(MultiplyByTwoOrDie(client, 21), Eq(42));
+
+  ASYLO_EXPECT_OK(client->EnclaveCallBatch({}, &results));
+  EXPECT_THAT(results, SizeIs(0));
+}
+
 // Ensure many threads can attempt enter the enclave simultaneously.
 TEST_F(PrimitivesTest, ThreadedTest) {
   constexpr int kNumThreads = 64;
@@ -23,13 +23,18 @@
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/types/span.h"
 #include "asylo/platform/primitives/extent.h"
 #include "asylo/platform/primitives/primitive_status.h"
 #include "asylo/platform/primitives/primitives.h"
 #include "asylo/platform/primitives/util/status_conversions.h"
 #include "asylo/util/asylo_macros.h"
 #include "asylo/util/status.h"
+#include "asylo/util/status_macros.h"
 #include "asylo/util/statusor.h"
 
 namespace asylo {
@@ -56,18 +61,114 @@ Status Client::EnclaveCall(uint64_t selector, MessageWriter *input,
                   "Cannot make an enclave call to a closed enclave."};
   }
   ScopedCurrentClient scoped_client(this);
-  return EnclaveCallInternal(selector, input, output);
+  if (!telemetry_) {
+    return EnclaveCallInternal(selector, input, output);
+  }
+
+  telemetry_->BeginEntry();
+  absl::Time start = absl::Now();
+  Status status = EnclaveCallInternal(selector, input, output);
+  telemetry_->EndEntry(selector, input ? input->MessageSize() : 0,
+                       output ? output->MessageSize() : 0, absl::Now() - start);
+  return status;
+}
+
+Status Client::EnclaveCallBatch(
+    absl::Span<const std::pair<uint64_t, MessageWriter *>> calls,
+    std::vector<BatchCallResult> *results) {
+  results->clear();
+  if (calls.empty()) {
+    return Status::OkStatus();
+  }
+
+  // The call headers are pushed by reference from |headers|, which is sized up
+  // front so that its elements do not move, and the input extents are pushed
+  // by reference from the callers' writers.
+  uint64_t count = calls.size();
+  std::vector<BatchCallHeader> headers(calls.size());
+  MessageWriter input;
+  input.PushByReference(Extent{&count});
+  for (size_t i = 0; i < calls.size(); ++i) {
+    MessageWriter *call_input = calls[i].second;
+    headers[i].selector = calls[i].first;
+    headers[i].extent_count = call_input ? call_input->size() : 0;
+    input.PushByReference(Extent{&headers[i]});
+    if (call_input) {
+      call_input->Serialize(
+          [&input](Extent extent) { input.PushByReference(extent); });
+    }
+  }
+
+  MessageReader output;
+  ASYLO_RETURN_IF_ERROR(EnclaveCall(kSelectorAsyloBatchCall, &input, &output));
+
+  const Status malformed{error::GoogleError::INTERNAL,
+                         "Malformed batched enclave call response."};
+  if (!output.hasNext() || output.peek().size() != sizeof(uint64_t) ||
+      output.next<uint64_t>() != calls.size()) {
+    return malformed;
+  }
+  results->reserve(calls.size());
+  for (size_t i = 0; i < calls.size(); ++i) {
+    if (!output.hasNext() ||
+        output.peek().size() != sizeof(BatchCallResultHeader)) {
+      results->clear();
+      return malformed;
+    }
+    BatchCallResultHeader header = output.next<BatchCallResultHeader>();
+    if (!output.hasNext() || header.extent_count > output.size()) {
+      results->clear();
+      return malformed;
+    }
+    Extent message = output.next();
+
+    BatchCallResult result;
+    result.status = MakeStatus(PrimitiveStatus{
+        static_cast<int>(header.status_code),
+        reinterpret_cast<const char *>(message.data()), message.size()});
+    bool truncated = false;
+    result.output.Deserialize(
+        header.extent_count, [&output, &truncated](size_t) {
+          if (!output.hasNext()) {
+            truncated = true;
+            return Extent{};
+          }
+          return output.next();
+        });
+    if (truncated) {
+      results->clear();
+      return malformed;
+    }
+    results->push_back(std::move(result));
+  }
+  return Status::OkStatus();
 }
 
 PrimitiveStatus Client::ExitCallback(uint64_t untrusted_selector,
                                      MessageReader *in, MessageWriter *out) {
-  if (!current_client_->exit_call_provider()) {
+  Client *client = current_client_;
+  if (!client->exit_call_provider()) {
     return PrimitiveStatus{error::GoogleError::FAILED_PRECONDITION,
                            "Exit call provider not set yet"};
   }
-  return MakePrimitiveStatus(
-      current_client_->exit_call_provider()->InvokeExitHandler(
-          untrusted_selector, in, out, current_client_));
+  if (!client->telemetry_) {
+    return MakePrimitiveStatus(client->exit_call_provider()->InvokeExitHandler(
+        untrusted_selector, in, out, client));
+  }
+
+  absl::Time start = absl::Now();
+  Status status = client->exit_call_provider()->InvokeExitHandler(
+      untrusted_selector, in, out, client);
+  client->telemetry_->RecordExit(
+      untrusted_selector, in ? in->MessageSize() : 0,
+      out ? out->MessageSize() : 0, absl::Now() - start);
+  return MakePrimitiveStatus(status);
+}
+
+void Client::EnableTelemetry() {
+  if (!telemetry_) {
+    telemetry_ = absl::make_unique<EnclaveTelemetry>();
+  }
 }
 
 // This provides a default, no-op implementation if this function is not
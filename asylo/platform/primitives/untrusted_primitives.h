@@ -24,10 +24,13 @@
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "asylo/platform/primitives/extent.h"
 #include "asylo/platform/primitives/primitive_status.h"
 #include "asylo/platform/primitives/primitives.h"
+#include "asylo/platform/primitives/util/enclave_telemetry.h"
 #include "asylo/platform/primitives/util/message.h"
 #include "asylo/util/asylo_macros.h"
 #include "asylo/util/status.h"
@@ -155,6 +158,30 @@ class Client : public std::enable_shared_from_this<Client> {
   Status EnclaveCall(uint64_t selector, MessageWriter *input,
                      MessageReader *output) ASYLO_MUST_USE_RESULT;
 
+  // Result of a single call made through EnclaveCallBatch.
+  struct BatchCallResult {
+    // Status returned by the entry handler.
+    Status status;
+
+    // Output of the entry handler. Empty unless |status| is OK.
+    MessageReader output;
+  };
+
+  // Enters the enclave once and invokes the entry point designated by the
+  // selector of each (selector, input) pair in `calls`, in order. A null input
+  // is passed to its entry handler as an empty message. Only selectors of
+  // `kSelectorUser` and above may be batched. Returns an error if the enclave
+  // could not be entered; otherwise `results` holds one result per call, in
+  // the order of `calls`, and the failure of one call does not prevent the
+  // following calls from being made.
+  Status EnclaveCallBatch(
+      absl::Span<const std::pair<uint64_t, MessageWriter *>> calls,
+      std::vector<BatchCallResult> *results) ASYLO_MUST_USE_RESULT;
+
+  // Returns the enclave client the calling thread most recently entered an
+  // enclave through, or nullptr if there is none.
+  static Client *current_client() { return current_client_; }
+
   // Enclave exit callback function shared with the enclave.
   static PrimitiveStatus ExitCallback(uint64_t untrusted_selector,
                                       MessageReader *in, MessageWriter *out);
@@ -162,6 +189,14 @@ class Client : public std::enable_shared_from_this<Client> {
   // Accessor to exit call provider.
   ExitCallProvider *exit_call_provider() { return exit_call_provider_.get(); }
 
+  // Starts collecting entry and exit telemetry for this enclave. Must not be
+  // called while other threads may be entering the enclave.
+  void EnableTelemetry();
+
+  // Returns the telemetry collected for this enclave, or nullptr if telemetry
+  // collection has not been enabled.
+  const EnclaveTelemetry *telemetry() const { return telemetry_.get(); }
+
  protected:
   Client(const absl::string_view name,
          std::unique_ptr<ExitCallProvider> exit_call_provider)
@@ -176,6 +211,9 @@ class Client : public std::enable_shared_from_this<Client> {
   // Exit call provider for the enclave.
   const std::unique_ptr<ExitCallProvider> exit_call_provider_;
 
+  // Entry and exit telemetry for the enclave, if enabled.
+  std::unique_ptr<EnclaveTelemetry> telemetry_;
+
   // Thread-local reference to the enclave that makes exit call.
   // Can be set by EnclaveCall, enclave loader.
   static thread_local Client *current_client_;
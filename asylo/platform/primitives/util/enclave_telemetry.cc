@@ -0,0 +1,112 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/primitives/util/enclave_telemetry.h"
+
+#include <string>
+
+namespace asylo {
+namespace primitives {
+namespace {
+
+// Returns the histogram bucket for a transition that took |duration|.
+int HistogramBucket(absl::Duration duration) {
+  int64_t micros = absl::ToInt64Microseconds(duration);
+  int bucket = 0;
+  while (micros > 0 && bucket < EnclaveTelemetry::kHistogramBuckets - 1) {
+    micros >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+constexpr int EnclaveTelemetry::kHistogramBuckets;
+
+void EnclaveTelemetry::Stats::Add(size_t input, size_t output,
+                                  absl::Duration duration) {
+  ++count;
+  input_bytes += input;
+  output_bytes += output;
+  total_duration += duration;
+  ++duration_histogram[HistogramBucket(duration)];
+}
+
+void EnclaveTelemetry::Stats::CopyTo(uint64_t selector,
+                                     TransitionStats *stats) const {
+  stats->set_selector(selector);
+  stats->set_count(count);
+  stats->set_input_bytes(input_bytes);
+  stats->set_output_bytes(output_bytes);
+  stats->set_total_duration_ns(absl::ToInt64Nanoseconds(total_duration));
+  for (uint64_t bucket_count : duration_histogram) {
+    stats->add_duration_histogram(bucket_count);
+  }
+}
+
+void EnclaveTelemetry::BeginEntry() {
+  uint64_t inside = threads_inside_.fetch_add(1) + 1;
+  uint64_t max_inside = max_threads_inside_.load();
+  while (inside > max_inside &&
+         !max_threads_inside_.compare_exchange_weak(max_inside, inside)) {
+  }
+}
+
+void EnclaveTelemetry::EndEntry(uint64_t selector, size_t input_bytes,
+                                size_t output_bytes, absl::Duration duration) {
+  threads_inside_.fetch_sub(1);
+  absl::MutexLock lock(&mu_);
+  entries_[selector].Add(input_bytes, output_bytes, duration);
+}
+
+void EnclaveTelemetry::RecordExit(uint64_t selector, size_t input_bytes,
+                                  size_t output_bytes,
+                                  absl::Duration duration) {
+  absl::MutexLock lock(&mu_);
+  exits_[selector].Add(input_bytes, output_bytes, duration);
+}
+
+EnclaveTelemetrySnapshot EnclaveTelemetry::Snapshot(
+    absl::string_view enclave_name) const {
+  EnclaveTelemetrySnapshot snapshot;
+  snapshot.set_enclave_name(std::string(enclave_name));
+  snapshot.set_threads_inside(threads_inside_.load());
+  snapshot.set_max_threads_inside(max_threads_inside_.load());
+
+  absl::Duration time_in_entries;
+  absl::Duration time_in_exits;
+  absl::MutexLock lock(&mu_);
+  for (const auto &entry : entries_) {
+    entry.second.CopyTo(entry.first, snapshot.add_entries());
+    time_in_entries += entry.second.total_duration;
+  }
+  for (const auto &exit : exits_) {
+    exit.second.CopyTo(exit.first, snapshot.add_exits());
+    time_in_exits += exit.second.total_duration;
+  }
+  // Exits are handled while an entry is in progress, so time spent handling
+  // them is included in the duration of the enclosing entry.
+  snapshot.set_time_inside_ns(
+      absl::ToInt64Nanoseconds(time_in_entries - time_in_exits));
+  snapshot.set_time_in_exits_ns(absl::ToInt64Nanoseconds(time_in_exits));
+  return snapshot;
+}
+
+}  // namespace primitives
+}  // namespace asylo
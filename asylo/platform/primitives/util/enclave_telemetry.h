@@ -0,0 +1,93 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_PRIMITIVES_UTIL_ENCLAVE_TELEMETRY_H_
+#define ASYLO_PLATFORM_PRIMITIVES_UTIL_ENCLAVE_TELEMETRY_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "asylo/platform/primitives/util/enclave_telemetry.pb.h"
+
+namespace asylo {
+namespace primitives {
+
+// Collects entry and exit statistics for a single enclave. An instance is owned
+// by the untrusted Client of the enclave it describes and is updated from every
+// host thread that enters or exits that enclave. All methods are thread-safe.
+class EnclaveTelemetry {
+ public:
+  // Number of buckets in each duration histogram. See TransitionStats for the
+  // bucket boundaries.
+  static constexpr int kHistogramBuckets = 24;
+
+  EnclaveTelemetry() = default;
+  EnclaveTelemetry(const EnclaveTelemetry &other) = delete;
+  EnclaveTelemetry &operator=(const EnclaveTelemetry &other) = delete;
+
+  // Records that the calling thread is entering the enclave. Must be paired
+  // with a call to EndEntry().
+  void BeginEntry();
+
+  // Records that the calling thread has returned from an enclave entry through
+  // |selector|, which marshalled |input_bytes| into and |output_bytes| out of
+  // the enclave and took |duration| in total.
+  void EndEntry(uint64_t selector, size_t input_bytes, size_t output_bytes,
+                absl::Duration duration) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Records an enclave exit through |selector|, which marshalled |input_bytes|
+  // out of and |output_bytes| into the enclave and was handled by untrusted
+  // code in |duration|.
+  void RecordExit(uint64_t selector, size_t input_bytes, size_t output_bytes,
+                  absl::Duration duration) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the statistics collected so far, labelled with |enclave_name|.
+  EnclaveTelemetrySnapshot Snapshot(absl::string_view enclave_name) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Running totals for the transitions made through a single selector.
+  struct Stats {
+    uint64_t count = 0;
+    uint64_t input_bytes = 0;
+    uint64_t output_bytes = 0;
+    absl::Duration total_duration;
+    std::array<uint64_t, kHistogramBuckets> duration_histogram = {};
+
+    void Add(size_t input, size_t output, absl::Duration duration);
+    void CopyTo(uint64_t selector, TransitionStats *stats) const;
+  };
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<uint64_t, Stats> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64_t, Stats> exits_ ABSL_GUARDED_BY(mu_);
+
+  std::atomic<uint64_t> threads_inside_{0};
+  std::atomic<uint64_t> max_threads_inside_{0};
+};
+
+}  // namespace primitives
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_PRIMITIVES_UTIL_ENCLAVE_TELEMETRY_H_
@@ -0,0 +1,109 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/primitives/util/enclave_telemetry.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+#include "asylo/platform/primitives/util/enclave_telemetry.pb.h"
+
+namespace asylo {
+namespace primitives {
+namespace {
+
+using ::testing::Eq;
+using ::testing::SizeIs;
+
+TEST(EnclaveTelemetryTest, EmptySnapshot) {
+  EnclaveTelemetry telemetry;
+  EnclaveTelemetrySnapshot snapshot = telemetry.Snapshot("enclave");
+  EXPECT_THAT(snapshot.enclave_name(), Eq("enclave"));
+  EXPECT_THAT(snapshot.entries(), SizeIs(0));
+  EXPECT_THAT(snapshot.exits(), SizeIs(0));
+  EXPECT_THAT(snapshot.threads_inside(), Eq(0));
+  EXPECT_THAT(snapshot.time_inside_ns(), Eq(0));
+}
+
+TEST(EnclaveTelemetryTest, EntriesAndExitsAreAggregatedBySelector) {
+  EnclaveTelemetry telemetry;
+  telemetry.BeginEntry();
+  telemetry.RecordExit(/*selector=*/88, /*input_bytes=*/16,
+                       /*output_bytes=*/8, absl::Microseconds(3));
+  telemetry.RecordExit(/*selector=*/88, /*input_bytes=*/16,
+                       /*output_bytes=*/8, absl::Microseconds(3));
+  telemetry.EndEntry(/*selector=*/129, /*input_bytes=*/100,
+                     /*output_bytes=*/10, absl::Microseconds(10));
+
+  EnclaveTelemetrySnapshot snapshot = telemetry.Snapshot("enclave");
+  ASSERT_THAT(snapshot.entries(), SizeIs(1));
+  const TransitionStats &entry = snapshot.entries(0);
+  EXPECT_THAT(entry.selector(), Eq(129));
+  EXPECT_THAT(entry.count(), Eq(1));
+  EXPECT_THAT(entry.input_bytes(), Eq(100));
+  EXPECT_THAT(entry.output_bytes(), Eq(10));
+
+  ASSERT_THAT(snapshot.exits(), SizeIs(1));
+  const TransitionStats &exit = snapshot.exits(0);
+  EXPECT_THAT(exit.selector(), Eq(88));
+  EXPECT_THAT(exit.count(), Eq(2));
+  EXPECT_THAT(exit.input_bytes(), Eq(32));
+  EXPECT_THAT(exit.output_bytes(), Eq(16));
+
+  EXPECT_THAT(snapshot.time_in_exits_ns(), Eq(6000));
+  EXPECT_THAT(snapshot.time_inside_ns(), Eq(4000));
+  EXPECT_THAT(snapshot.threads_inside(), Eq(0));
+  EXPECT_THAT(snapshot.max_threads_inside(), Eq(1));
+}
+
+TEST(EnclaveTelemetryTest, DurationsAreBucketedByPowersOfTwo) {
+  EnclaveTelemetry telemetry;
+  telemetry.RecordExit(1, 0, 0, absl::Nanoseconds(500));
+  telemetry.RecordExit(1, 0, 0, absl::Microseconds(1));
+  telemetry.RecordExit(1, 0, 0, absl::Microseconds(3));
+  telemetry.RecordExit(1, 0, 0, absl::Hours(1));
+
+  EnclaveTelemetrySnapshot snapshot = telemetry.Snapshot("enclave");
+  ASSERT_THAT(snapshot.exits(), SizeIs(1));
+  const TransitionStats &exit = snapshot.exits(0);
+  ASSERT_THAT(exit.duration_histogram(),
+              SizeIs(EnclaveTelemetry::kHistogramBuckets));
+  EXPECT_THAT(exit.duration_histogram(0), Eq(1));
+  EXPECT_THAT(exit.duration_histogram(1), Eq(1));
+  EXPECT_THAT(exit.duration_histogram(2), Eq(1));
+  EXPECT_THAT(
+      exit.duration_histogram(EnclaveTelemetry::kHistogramBuckets - 1),
+      Eq(1));
+}
+
+TEST(EnclaveTelemetryTest, TracksConcurrentThreads) {
+  EnclaveTelemetry telemetry;
+  telemetry.BeginEntry();
+  telemetry.BeginEntry();
+  EXPECT_THAT(telemetry.Snapshot("enclave").threads_inside(), Eq(2));
+  telemetry.EndEntry(129, 0, 0, absl::ZeroDuration());
+  telemetry.EndEntry(129, 0, 0, absl::ZeroDuration());
+
+  EnclaveTelemetrySnapshot snapshot = telemetry.Snapshot("enclave");
+  EXPECT_THAT(snapshot.threads_inside(), Eq(0));
+  EXPECT_THAT(snapshot.max_threads_inside(), Eq(2));
+}
+
+}  // namespace
+}  // namespace primitives
+}  // namespace asylo
@@ -24,12 +24,14 @@
 #include <sys/un.h>
 
 #include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "asylo/platform/primitives/extent.h"
@@ -49,9 +51,18 @@ namespace primitives {
 // The message writer only allows pushing extents or values to it; reading data
 // from the writer is disallowed. The message writer does not perform memory
 // allocation for the serialized message. Extents can be pushed by reference or
-// by copy, in which case they are owned by the MessageWriter.
+// by copy, in which case they are owned by the MessageWriter. A writer holding
+// up to kInlineExtents extents, whose copied data fits in kInlineDataSize
+// bytes, does not allocate memory at all.
 class MessageWriter {
  public:
+  // Number of extents a writer holds without allocating memory.
+  static constexpr size_t kInlineExtents = 8;
+
+  // Number of bytes of data pushed by copy a writer holds without allocating
+  // memory.
+  static constexpr size_t kInlineDataSize = 128;
+
   MessageWriter() = default;
 
   // Disallow copying.
@@ -59,8 +70,13 @@ class MessageWriter {
   MessageWriter operator=(const MessageWriter &other) = delete;
 
   // Allow moving.
-  MessageWriter(MessageWriter &&other) noexcept = default;
-  MessageWriter &operator=(MessageWriter &&other) = default;
+  MessageWriter(MessageWriter &&other) noexcept { MoveFrom(&other); }
+  MessageWriter &operator=(MessageWriter &&other) noexcept {
+    if (this != &other) {
+      MoveFrom(&other);
+    }
+    return *this;
+  }
 
   // Returns true if no output has been written to the MessageWriter.
   bool empty() const { return extents_.empty(); }
@@ -106,9 +122,10 @@ class MessageWriter {
   // Pushes an extent to the MessageWriter by copy. Data is copied and owned by
   // the MessageWriter.
   void PushByCopy(Extent extent) {
-    char *extent_data = new char[extent.size()];
-    copied_data_owner_.emplace_back(extent_data);
-    memcpy(extent_data, extent.data(), extent.size());
+    char *extent_data = AllocateCopy(extent.size());
+    if (extent.size() > 0) {
+      memcpy(extent_data, extent.data(), extent.size());
+    }
     PushByReference(Extent{extent_data, extent.size()});
   }
 
@@ -171,8 +188,44 @@ class MessageWriter {
   }
 
  private:
-  std::vector<Extent> extents_;
+  // Returns storage for |size| bytes of data pushed by copy, which is carved
+  // from |inline_data_| when it fits and allocated on the heap otherwise.
+  char *AllocateCopy(size_t size) {
+    size_t offset = (inline_data_used_ + 7) & ~size_t{7};
+    if (offset < kInlineDataSize && size <= kInlineDataSize - offset) {
+      inline_data_used_ = offset + size;
+      return inline_data_ + offset;
+    }
+    char *data = new char[size];
+    copied_data_owner_.emplace_back(data);
+    return data;
+  }
+
+  // Takes the contents of |other|, rebasing the extents which refer to its
+  // inline storage, and leaves |other| empty.
+  void MoveFrom(MessageWriter *other) {
+    extents_ = std::move(other->extents_);
+    copied_data_owner_ = std::move(other->copied_data_owner_);
+    inline_data_used_ = other->inline_data_used_;
+    memcpy(inline_data_, other->inline_data_, inline_data_used_);
+    const char *begin = other->inline_data_;
+    const char *end = begin + inline_data_used_;
+    for (auto &extent : extents_) {
+      const char *data = reinterpret_cast<const char *>(extent.data());
+      if (std::less_equal<const char *>()(begin, data) &&
+          std::less<const char *>()(data, end)) {
+        extent = Extent{inline_data_ + (data - begin), extent.size()};
+      }
+    }
+    other->extents_.clear();
+    other->copied_data_owner_.clear();
+    other->inline_data_used_ = 0;
+  }
+
+  absl::InlinedVector<Extent, kInlineExtents> extents_;
   std::vector<std::unique_ptr<char[]>> copied_data_owner_;
+  size_t inline_data_used_ = 0;
+  alignas(8) char inline_data_[kInlineDataSize];
 };
 
 // A message reader that consumes a serialized message and generates extents.
@@ -180,15 +233,26 @@ class MessageWriter {
 // Extents can be read from the MessageReader only once, and never written.
 class MessageReader {
  public:
+  // Number of extents a reader holds without allocating memory.
+  static constexpr size_t kInlineExtents = 8;
+
+  // Number of bytes of extent data a reader holds without allocating memory.
+  static constexpr size_t kInlineDataSize = 256;
+
   MessageReader() = default;
 
   // Disallow copying.
   MessageReader(const MessageReader &other) = delete;
   MessageReader operator=(const MessageReader &other) = delete;
 
-  // Allow moving.
-  MessageReader(MessageReader &&other) noexcept = default;
-  MessageReader &operator=(MessageReader &&other) = default;
+  // Allow moving. Extents previously returned by |other| are invalidated.
+  MessageReader(MessageReader &&other) noexcept { MoveFrom(&other); }
+  MessageReader &operator=(MessageReader &&other) noexcept {
+    if (this != &other) {
+      MoveFrom(&other);
+    }
+    return *this;
+  }
 
   // Deserializes a data buffer of provided size into owned extents. |buffer| is
   // the serialized buffer originally written by the MessageWriter, and is owned
@@ -197,17 +261,36 @@ class MessageReader {
   // trusted memory is non-trivial, since trusted memory would then need to
   // remotely manage untrusted memory. This necessitates deserializing and
   // copying |buffer| into new owned extents, since MessageReader is expected
-  // to own its memory.
+  // to own its memory. The extents are copied into a single contiguous store,
+  // so deserializing further data may invalidate extents previously returned
+  // by the reader. A truncated trailing extent is discarded.
   void Deserialize(const void *buffer, size_t size) {
-    const char *ptr = reinterpret_cast<const char *>(buffer);
-    const char *end_ptr = ptr + size;
-    while (ptr < end_ptr) {
+    const char *begin = reinterpret_cast<const char *>(buffer);
+    const char *end_ptr = begin + size;
+
+    // Measure the extents first so that storage is grown at most once.
+    size_t count = 0;
+    size_t data_size = 0;
+    for (const char *ptr = begin;
+         static_cast<size_t>(end_ptr - ptr) >= sizeof(uint64_t);) {
+      uint64_t extent_len;
+      memcpy(&extent_len, ptr, sizeof(uint64_t));
+      ptr += sizeof(uint64_t);
+      if (extent_len > static_cast<uint64_t>(end_ptr - ptr)) {
+        break;
+      }
+      ptr += extent_len;
+      data_size += AlignedSize(extent_len);
+      ++count;
+    }
+    Reserve(count, data_size);
+
+    const char *ptr = begin;
+    for (size_t i = 0; i < count; ++i) {
       uint64_t extent_len;
       memcpy(&extent_len, ptr, sizeof(uint64_t));
       ptr += sizeof(uint64_t);
-      char *extent_data = new char[extent_len];
-      extents_.emplace_back(std::unique_ptr<char[]>(extent_data), extent_len);
-      memcpy(extent_data, ptr, extent_len);
+      Append(ptr, extent_len);
       ptr += extent_len;
     }
   }
@@ -215,20 +298,32 @@ class MessageReader {
   // Deserializes data using a given deserializer.
   void Deserialize(const size_t size,
                    const std::function<Extent(size_t i)> &deserializer) {
-    extents_.reserve(size);
+    absl::InlinedVector<Extent, kInlineExtents> extents;
+    extents.reserve(size);
+    size_t data_size = 0;
     for (size_t i = 0; i < size; ++i) {
-      auto extent = deserializer(i);
-      extents_.emplace_back(absl::make_unique<char[]>(extent.size()),
-                            extent.size());
-      if (extent.size() > 0) {
-        memcpy(extents_.back().first.get(), extent.data(), extent.size());
-      }
+      extents.push_back(deserializer(i));
+      data_size += AlignedSize(extents.back().size());
+    }
+    Reserve(size, data_size);
+    for (const Extent &extent : extents) {
+      Append(extent.data(), extent.size());
     }
   }
 
   // Returns the number of extents read.
   size_t size() const { return extents_.size(); }
 
+  // Returns the size of the serialized message the extents were read from, as
+  // computed by MessageWriter::MessageSize().
+  size_t MessageSize() const {
+    size_t result = sizeof(uint64_t) * extents_.size();
+    for (const auto &extent : extents_) {
+      result += extent.size;
+    }
+    return result;
+  }
+
   // Returns the next extent in the MessageReader. The MessageReader may only be
   // traversed once. The returned extent remains owned by the MessageReader and
   // its lifetime is the lifetime of the MessageReader.
@@ -250,7 +345,7 @@ class MessageReader {
   // return the same extent. The extent remains owned by the MessageReader and
   // its lifetime is the lifetime of the MessageReader.
   Extent peek() {
-    return Extent{extents_[pos_].first.get(), extents_[pos_].second};
+    return Extent{data() + extents_[pos_].offset, extents_[pos_].size};
   }
 
   // Interprets the peek item in the MessageReader as a pointer to a value of
@@ -302,8 +397,69 @@ class MessageReader {
   } while (false)
 
  private:
-  std::vector<std::pair<std::unique_ptr<char[]>, size_t>> extents_;
+  // Location of an extent within the reader's data store.
+  struct ExtentLocation {
+    size_t offset;
+    size_t size;
+  };
+
+  // Alignment of each extent within the data store, matching the alignment of
+  // a heap allocation.
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+  static size_t AlignedSize(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  char *data() { return heap_data_ ? heap_data_.get() : inline_data_; }
+
+  // Ensures room for |count| more extents holding |data_size| bytes in total,
+  // including alignment padding.
+  void Reserve(size_t count, size_t data_size) {
+    extents_.reserve(extents_.size() + count);
+    size_t capacity = heap_data_ ? heap_capacity_ : kInlineDataSize;
+    if (data_size <= capacity - data_used_) {
+      return;
+    }
+    size_t new_capacity = std::max(2 * capacity, data_used_ + data_size);
+    std::unique_ptr<char[]> new_data(new char[new_capacity]);
+    memcpy(new_data.get(), data(), data_used_);
+    heap_data_ = std::move(new_data);
+    heap_capacity_ = new_capacity;
+  }
+
+  // Copies |size| bytes at |source| into the data store as a new extent.
+  // Storage must have been reserved by a preceding call to Reserve().
+  void Append(const void *source, size_t size) {
+    extents_.push_back(ExtentLocation{data_used_, size});
+    if (size > 0) {
+      memcpy(data() + data_used_, source, size);
+    }
+    data_used_ += AlignedSize(size);
+  }
+
+  // Takes the contents of |other| and leaves it empty.
+  void MoveFrom(MessageReader *other) {
+    extents_ = std::move(other->extents_);
+    heap_data_ = std::move(other->heap_data_);
+    heap_capacity_ = other->heap_capacity_;
+    data_used_ = other->data_used_;
+    pos_ = other->pos_;
+    if (!heap_data_) {
+      memcpy(inline_data_, other->inline_data_, data_used_);
+    }
+    other->extents_.clear();
+    other->heap_capacity_ = 0;
+    other->data_used_ = 0;
+    other->pos_ = 0;
+  }
+
+  absl::InlinedVector<ExtentLocation, kInlineExtents> extents_;
+  std::unique_ptr<char[]> heap_data_;
+  size_t heap_capacity_ = 0;
+  size_t data_used_ = 0;
   size_t pos_ = 0;
+  alignas(kAlignment) char inline_data_[kInlineDataSize];
 };
 
 }  // namespace primitives
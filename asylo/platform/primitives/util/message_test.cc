@@ -20,6 +20,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -190,6 +191,72 @@ TEST(MessageTest, PushPopStrings) {
   EXPECT_THAT(reader.next().As<char>(), StrEq("moon"));
 }
 
+// Ensure that extents pushed by copy survive moving the writer, whether they
+// are held in its inline storage or on the heap.
+TEST(MessageTest, MoveWriterPreservesCopiedExtents) {
+  const std::string small = "small";
+  const std::string large(MessageWriter::kInlineDataSize * 2, 'x');
+  MessageWriter source;
+  source.PushByCopy(Extent{small.data(), small.size() + 1});
+  source.PushByCopy(Extent{large.data(), large.size() + 1});
+  for (size_t i = 0; i < 2 * MessageWriter::kInlineExtents; ++i) {
+    source.Push(i);
+  }
+
+  MessageWriter writer(std::move(source));
+  EXPECT_THAT(source, IsEmpty());
+  MessageWriter assigned;
+  assigned = std::move(writer);
+
+  MessageReader reader = BuildMessageReader(assigned);
+  ASSERT_THAT(reader, SizeIs(2 + 2 * MessageWriter::kInlineExtents));
+  EXPECT_THAT(reader.next().As<char>(), StrEq(small));
+  EXPECT_THAT(reader.next().As<char>(), StrEq(large));
+  for (size_t i = 0; i < 2 * MessageWriter::kInlineExtents; ++i) {
+    EXPECT_THAT(reader.next<size_t>(), Eq(i));
+  }
+}
+
+// Ensure that a reader grows its storage past the inline capacity, and that
+// moving it preserves both its extents and its traversal position.
+TEST(MessageTest, MoveReaderPreservesExtents) {
+  for (size_t length : {size_t{8}, MessageReader::kInlineDataSize * 4}) {
+    const std::string value(length, 'y');
+    MessageWriter writer;
+    writer.Push<uint64_t>(1);
+    writer.PushString(value);
+    writer.Push<uint64_t>(2);
+
+    MessageReader source = BuildMessageReader(writer);
+    EXPECT_THAT(source.next<uint64_t>(), Eq(1));
+    MessageReader reader;
+    reader = std::move(source);
+    EXPECT_THAT(source, IsEmpty());
+
+    ASSERT_THAT(reader, SizeIs(3));
+    EXPECT_THAT(reader.MessageSize(), Eq(writer.MessageSize()));
+    EXPECT_THAT(reader.next().As<char>(), StrEq(value));
+    EXPECT_THAT(reader.next<uint64_t>(), Eq(2));
+    EXPECT_FALSE(reader.hasNext());
+  }
+}
+
+// Ensure that a truncated trailing extent is not read past the end of the
+// serialized buffer.
+TEST(MessageTest, TruncatedMessageIsDiscarded) {
+  MessageWriter writer;
+  writer.Push<uint64_t>(7);
+  writer.PushString("truncated");
+  const size_t size = writer.MessageSize();
+  const auto buffer = absl::make_unique<char[]>(size);
+  writer.Serialize(buffer.get());
+
+  MessageReader reader;
+  reader.Deserialize(buffer.get(), size - 1);
+  ASSERT_THAT(reader, SizeIs(1));
+  EXPECT_THAT(reader.next<uint64_t>(), Eq(7));
+}
+
 }  // namespace
 }  // namespace primitives
 }  // namespace asylo
@@ -0,0 +1,79 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/primitives/util/scratch_buffer.h"
+
+#include <cstdlib>
+
+#include "absl/base/attributes.h"
+
+namespace asylo {
+namespace primitives {
+namespace {
+
+// Smallest capacity allocated for a scratch buffer.
+constexpr size_t kMinScratchBufferSize = 256;
+
+struct ScratchBufferState {
+  void *data;
+  size_t capacity;
+  bool in_use;
+};
+
+// Thread-local state must be trivially destructible to be usable inside an
+// enclave, so the buffers are not freed on thread exit.
+ABSL_CONST_INIT thread_local ScratchBufferState scratch_buffers[2];
+
+ScratchBufferState *GetState(ScratchSlot slot) {
+  return &scratch_buffers[static_cast<int>(slot)];
+}
+
+}  // namespace
+
+void *AcquireScratchBuffer(ScratchSlot slot, size_t size) {
+  ScratchBufferState *state = GetState(slot);
+  if (state->in_use || size > kMaxScratchBufferSize) {
+    return malloc(size);
+  }
+  if (size > state->capacity) {
+    size_t capacity = kMinScratchBufferSize;
+    while (capacity < size) {
+      capacity *= 2;
+    }
+    free(state->data);
+    state->data = malloc(capacity);
+    state->capacity = state->data ? capacity : 0;
+    if (!state->data) {
+      return nullptr;
+    }
+  }
+  state->in_use = true;
+  return state->data;
+}
+
+void ReleaseScratchBuffer(ScratchSlot slot, void *buffer) {
+  ScratchBufferState *state = GetState(slot);
+  if (buffer != nullptr && buffer == state->data) {
+    state->in_use = false;
+  } else {
+    free(buffer);
+  }
+}
+
+}  // namespace primitives
+}  // namespace asylo
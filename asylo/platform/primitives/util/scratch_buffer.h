@@ -0,0 +1,56 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_PRIMITIVES_UTIL_SCRATCH_BUFFER_H_
+#define ASYLO_PLATFORM_PRIMITIVES_UTIL_SCRATCH_BUFFER_H_
+
+#include <cstddef>
+
+namespace asylo {
+namespace primitives {
+
+// Per-thread scratch buffers used to marshal host call messages without
+// allocating memory on every call. Each thread owns one buffer per slot. A
+// buffer grows to fit the largest message acquired from its slot, up to
+// kMaxScratchBufferSize, and is then reused by subsequent calls on the thread.
+// Buffers are retained for the lifetime of the thread.
+enum class ScratchSlot {
+  kRequest = 0,   // Serialized host call requests.
+  kResponse = 1,  // Host call responses copied into the enclave.
+};
+
+// Largest buffer retained by a scratch slot. Larger messages are allocated on
+// the heap.
+constexpr size_t kMaxScratchBufferSize = 64 * 1024;
+
+// Returns a buffer of at least |size| bytes, aligned like a malloc() result.
+// The buffer is the calling thread's scratch buffer for |slot| if that buffer
+// is not already in use, for instance by a host call issued from a signal
+// handler, and |size| does not exceed kMaxScratchBufferSize. Otherwise the
+// buffer is allocated with malloc(). Returns nullptr if memory is exhausted.
+void *AcquireScratchBuffer(ScratchSlot slot, size_t size);
+
+// Releases |buffer|, which must have been returned by AcquireScratchBuffer()
+// for |slot| on the calling thread, or allocated with malloc(). A scratch
+// buffer is returned to its slot and any other buffer is freed.
+void ReleaseScratchBuffer(ScratchSlot slot, void *buffer);
+
+}  // namespace primitives
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_PRIMITIVES_UTIL_SCRATCH_BUFFER_H_
@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <cstring>
 
+#include "asylo/platform/primitives/extent.h"
 #include "asylo/platform/primitives/primitive_status.h"
 #include "asylo/platform/primitives/primitives.h"
 #include "asylo/platform/primitives/trusted_primitives.h"
@@ -73,12 +74,93 @@ PrimitiveStatus ReservedEntry(void *context, MessageReader *in,
   return {error::GoogleError::INTERNAL, "Invalid call to reserved selector."};
 }
 
+// Invokes the user entry handler registered for |selector| with |in|.
+PrimitiveStatus InvokeBatchedCall(uint64_t selector, MessageReader *in,
+                                  MessageWriter *out) {
+  if (selector < kSelectorUser || selector >= kEntryPointMax ||
+      enclave_state.entry_table[selector].IsNull()) {
+    return {error::GoogleError::OUT_OF_RANGE,
+            "Invalid selector passed in batched enclave call."};
+  }
+  if (enclave_state.flags & Flag::kAborted) {
+    return {error::GoogleError::ABORTED, "Invalid call to aborted enclave."};
+  }
+  auto &handler = enclave_state.entry_table[selector];
+  return handler.callback(handler.context, in, out);
+}
+
+// Entry handler installed by the runtime to dispatch a batch of entry calls in
+// a single enclave entry. Calls are dispatched in order on the entering thread,
+// and the failure of one call does not prevent the following ones from
+// running. See kSelectorAsyloBatchCall for the message layout.
+PrimitiveStatus BatchCall(void *context, MessageReader *in,
+                          MessageWriter *out) {
+  const PrimitiveStatus malformed{error::GoogleError::INVALID_ARGUMENT,
+                                  "Malformed batched enclave call."};
+  if (!in->hasNext() || in->peek().size() != sizeof(uint64_t)) {
+    return malformed;
+  }
+  uint64_t count = in->next<uint64_t>();
+  out->Push(count);
+
+  for (uint64_t i = 0; i < count; ++i) {
+    if (!in->hasNext() || in->peek().size() != sizeof(BatchCallHeader)) {
+      return malformed;
+    }
+    BatchCallHeader header = in->next<BatchCallHeader>();
+    if (header.extent_count > in->size()) {
+      return malformed;
+    }
+
+    bool truncated = false;
+    MessageReader call_in;
+    call_in.Deserialize(header.extent_count, [in, &truncated](size_t) {
+      if (!in->hasNext()) {
+        truncated = true;
+        return Extent{};
+      }
+      return in->next();
+    });
+    if (truncated) {
+      return malformed;
+    }
+
+    MessageWriter call_out;
+    PrimitiveStatus status =
+        InvokeBatchedCall(header.selector, &call_in, &call_out);
+
+    BatchCallResultHeader result{status.error_code(),
+                                 status.ok() ? call_out.size() : 0};
+    out->Push(result);
+    size_t message_size = strlen(status.error_message());
+    if (message_size > 0) {
+      out->PushString(status.error_message(), message_size);
+    } else {
+      out->PushByReference(Extent{});
+    }
+    if (status.ok()) {
+      out->Extend(call_out);
+    }
+  }
+  ASYLO_RETURN_IF_READER_HAS_NEXT(*in);
+  return PrimitiveStatus::OkStatus();
+}
+
 // Initializes the enclave if it has not been initialized already.
 void EnsureInitialized() {
   SpinLockGuard lock(&enclave_state.initialization_lock);
   if (!(enclave_state.flags & Flag::kInitialized)) {
-    // Register placeholder handlers for reserved entry points.
-    for (uint64_t i = kSelectorAsyloFini + 1; i < kSelectorUser; i++) {
+    // Register the batched call dispatcher, which is shared by all backends.
+    if (!TrustedPrimitives::RegisterEntryHandler(kSelectorAsyloBatchCall,
+                                                 EntryHandler{BatchCall})
+             .ok()) {
+      TrustedPrimitives::BestEffortAbort(
+          "Could not register entry handler: BatchCall.");
+    }
+
+    // Register placeholder handlers for reserved entry points. Selectors below
+    // kSelectorAsyloBatchCall are left to backend-specific runtime handlers.
+    for (uint64_t i = kSelectorAsyloBatchCall + 1; i < kSelectorUser; i++) {
       EntryHandler handler{ReservedEntry};
       if (!TrustedPrimitives::RegisterEntryHandler(i, handler).ok()) {
         TrustedPrimitives::BestEffortAbort("Could not register entry handler");
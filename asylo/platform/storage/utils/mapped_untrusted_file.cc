@@ -0,0 +1,190 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/storage/utils/mapped_untrusted_file.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "absl/memory/memory.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/posix_error_space.h"
+#include "asylo/util/status_macros.h"
+
+#ifdef __ASYLO__
+#include "asylo/platform/host_call/trusted/host_calls.h"
+#include "asylo/platform/posix/io/io_manager.h"
+#else  // __ASYLO__
+#include <sys/mman.h>
+#endif  // __ASYLO__
+
+namespace asylo {
+namespace {
+
+constexpr size_t kPageSize = 4096;
+
+// Maps the first |length| bytes of |fd| into untrusted memory, read-write and
+// shared with the file. Returns nullptr on failure. Inside an enclave |fd| is
+// an enclave file descriptor, and the host maps the host file descriptor it
+// delegates to; files without one fail with EBADF.
+void *MapShared(int fd, size_t length) {
+#ifdef __ASYLO__
+  int host_fd = io::IOManager::GetInstance().GetHostFileDescriptor(fd);
+  if (host_fd < 0) {
+    return nullptr;
+  }
+  return enc_untrusted_mmap_shared(host_fd, length);
+#else   // __ASYLO__
+  void *address =
+      mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  return address == MAP_FAILED ? nullptr : address;
+#endif  // __ASYLO__
+}
+
+int SyncShared(void *address, size_t length) {
+#ifdef __ASYLO__
+  return enc_untrusted_msync(address, length);
+#else   // __ASYLO__
+  return msync(address, length, MS_SYNC);
+#endif  // __ASYLO__
+}
+
+int Unmap(void *address, size_t length) {
+#ifdef __ASYLO__
+  return enc_untrusted_munmap(address, length);
+#else   // __ASYLO__
+  return munmap(address, length);
+#endif  // __ASYLO__
+}
+
+// Returns true if the range of |size| bytes at |offset| ends at or before
+// |limit|.
+bool InBounds(off_t offset, size_t size, size_t limit) {
+  return offset >= 0 && static_cast<size_t>(offset) <= limit &&
+         size <= limit - static_cast<size_t>(offset);
+}
+
+}  // namespace
+
+constexpr size_t MappedUntrustedFile::kMinMappingSize;
+
+StatusOr<std::unique_ptr<MappedUntrustedFile>> MappedUntrustedFile::Create(
+    int fd) {
+  off_t size = lseek(fd, 0, SEEK_END);
+  if (size == -1) {
+    return Status{static_cast<error::PosixError>(errno),
+                  "lseek() failed in MappedUntrustedFile::Create()"};
+  }
+  auto file = absl::WrapUnique(new MappedUntrustedFile(fd, size));
+  ASYLO_RETURN_IF_ERROR(file->Remap(size));
+  return std::move(file);
+}
+
+MappedUntrustedFile::MappedUntrustedFile(int fd, size_t size)
+    : fd_(fd), size_(size) {}
+
+MappedUntrustedFile::~MappedUntrustedFile() {
+  if (!mapping_) {
+    return;
+  }
+  Status result = Sync();
+  if (!result.ok()) {
+    LOG(ERROR) << "Unexpected failure in Sync() when closing a "
+                  "MappedUntrustedFile: "
+               << result;
+  }
+  if (Unmap(mapping_, mapping_size_) != 0) {
+    LOG(ERROR) << "munmap() failed when closing a MappedUntrustedFile: "
+               << strerror(errno);
+  }
+}
+
+StatusOr<size_t> MappedUntrustedFile::Size() const { return size_; }
+
+Status MappedUntrustedFile::Read(void *buffer, off_t offset, size_t size) {
+  if (!InBounds(offset, size, size_)) {
+    return Status{error::NOT_FOUND,
+                  "Read past the end of file in MappedUntrustedFile::Read()"};
+  }
+  memcpy(buffer, mapping_ + offset, size);
+  return Status::OkStatus();
+}
+
+Status MappedUntrustedFile::Write(const void *buffer, off_t offset,
+                                  size_t size) {
+  if (!InBounds(offset, size, std::numeric_limits<off_t>::max())) {
+    return Status{error::INVALID_ARGUMENT,
+                  "Invalid range in MappedUntrustedFile::Write()"};
+  }
+  if (offset + size > size_) {
+    ASYLO_RETURN_IF_ERROR(Resize(offset + size));
+  }
+  memcpy(mapping_ + offset, buffer, size);
+  return Status::OkStatus();
+}
+
+Status MappedUntrustedFile::Sync() {
+  if (size_ > 0 && SyncShared(mapping_, size_) != 0) {
+    return Status{static_cast<error::PosixError>(errno),
+                  "msync() failed in MappedUntrustedFile::Sync()"};
+  }
+  return Status::OkStatus();
+}
+
+Status MappedUntrustedFile::Truncate(size_t size) { return Resize(size); }
+
+Status MappedUntrustedFile::Resize(size_t size) {
+  // Grow the mapping before the file, so that a failure leaves the file at
+  // |size_|. Mapping pages past the end of the file is harmless as long as they
+  // are not accessed.
+  if (size > mapping_size_) {
+    ASYLO_RETURN_IF_ERROR(Remap(size));
+  }
+  if (ftruncate(fd_, size) != 0) {
+    return Status{static_cast<error::PosixError>(errno),
+                  "ftruncate() failed in MappedUntrustedFile::Resize()"};
+  }
+  size_ = size;
+  return Status::OkStatus();
+}
+
+Status MappedUntrustedFile::Remap(size_t size) {
+  // Reserve room for the file to double in size before it has to be remapped.
+  // Pages of the mapping beyond the end of the file are never accessed.
+  size_t mapping_size = std::max({size, 2 * mapping_size_, kMinMappingSize});
+  mapping_size = (mapping_size + kPageSize - 1) / kPageSize * kPageSize;
+
+  void *mapping = MapShared(fd_, mapping_size);
+  if (!mapping) {
+    return Status{static_cast<error::PosixError>(errno),
+                  "mmap() failed in MappedUntrustedFile::Remap()"};
+  }
+  if (mapping_ && Unmap(mapping_, mapping_size_) != 0) {
+    LOG(ERROR) << "munmap() failed in MappedUntrustedFile::Remap(): "
+               << strerror(errno);
+  }
+  mapping_ = static_cast<uint8_t *>(mapping);
+  mapping_size_ = mapping_size;
+  return Status::OkStatus();
+}
+
+}  // namespace asylo
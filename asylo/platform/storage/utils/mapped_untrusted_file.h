@@ -0,0 +1,83 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_STORAGE_UTILS_MAPPED_UNTRUSTED_FILE_H_
+#define ASYLO_PLATFORM_STORAGE_UTILS_MAPPED_UNTRUSTED_FILE_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "asylo/platform/storage/utils/random_access_storage.h"
+#include "asylo/util/status.h"
+#include "asylo/util/statusor.h"
+
+namespace asylo {
+
+// An implementation of RandomAccessStorage backed by a file which is mapped
+// once into untrusted memory by the host. Reads and writes are bounds-checked
+// copies to and from the mapping, so they only leave the enclave when the file
+// has to be extended. The mapping is reserved with room to grow, and is only
+// replaced when a write or Truncate() extends the file beyond it.
+//
+// The size of the file is tracked by the MappedUntrustedFile instance, and the
+// file must not be resized by other means while it is mapped.
+class MappedUntrustedFile : public RandomAccessStorage {
+ public:
+  // Minimum length in bytes of the mapping reserved for a file.
+  static constexpr size_t kMinMappingSize = 1 << 20;
+
+  // Maps an open file descriptor, which must be open for reading and writing
+  // and support lseek(2), ftruncate(2) and mmap(2). |fd| remains owned by the
+  // caller and must remain open for the lifetime of the returned object.
+  static StatusOr<std::unique_ptr<MappedUntrustedFile>> Create(int fd);
+
+  // Synchronizes and unmaps the file.
+  ~MappedUntrustedFile() override;
+
+  StatusOr<size_t> Size() const override;
+
+  Status Read(void *buffer, off_t offset, size_t size) override;
+
+  Status Write(const void *buffer, off_t offset, size_t size) override;
+
+  // Synchronously writes back modified pages of the mapping via msync(2).
+  Status Sync() override;
+
+  Status Truncate(size_t size) override;
+
+ private:
+  MappedUntrustedFile(int fd, size_t size);
+
+  // Replaces the mapping with one covering at least |size| bytes.
+  Status Remap(size_t size);
+
+  // Resizes the file to |size| bytes, remapping it if necessary.
+  Status Resize(size_t size);
+
+  const int fd_;
+  size_t size_;                 // Size of the file in bytes.
+  uint8_t *mapping_ = nullptr;  // Base address of the mapping.
+  size_t mapping_size_ = 0;     // Length of the mapping in bytes.
+};
+
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_STORAGE_UTILS_MAPPED_UNTRUSTED_FILE_H_
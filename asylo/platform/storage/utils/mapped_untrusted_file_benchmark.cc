@@ -0,0 +1,94 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/platform/storage/utils/fd_closer.h"
+#include "asylo/platform/storage/utils/mapped_untrusted_file.h"
+#include "asylo/platform/storage/utils/random_access_storage.h"
+#include "asylo/platform/storage/utils/test_utils.h"
+#include "asylo/platform/storage/utils/untrusted_file.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace {
+
+// Logs the throughput of random block reads and writes through UntrustedFile
+// and MappedUntrustedFile.
+TEST(MappedUntrustedFileBenchmark, RandomBlockAccess) {
+  constexpr size_t kBlockSize = 512;
+  constexpr size_t kBlockCount = 4096;
+  constexpr size_t kOperations = 1 << 16;
+
+  std::vector<size_t> blocks(kOperations);
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<size_t> distribution(0, kBlockCount - 1);
+  for (size_t &block : blocks) {
+    block = distribution(generator);
+  }
+
+  auto run = [&blocks](const char *label, RandomAccessStorage *storage) {
+    std::vector<uint8_t> buffer(kBlockSize, 0xa5);
+    ASYLO_ASSERT_OK(storage->Truncate(kBlockSize * kBlockCount));
+
+    absl::Time start = absl::Now();
+    for (size_t block : blocks) {
+      ASYLO_ASSERT_OK(
+          storage->Write(buffer.data(), block * kBlockSize, kBlockSize));
+    }
+    absl::Duration write_time = absl::Now() - start;
+
+    start = absl::Now();
+    for (size_t block : blocks) {
+      ASYLO_ASSERT_OK(
+          storage->Read(buffer.data(), block * kBlockSize, kBlockSize));
+    }
+    absl::Duration read_time = absl::Now() - start;
+
+    double megabytes =
+        static_cast<double>(kOperations * kBlockSize) / (1 << 20);
+    LOG(INFO) << label << ": write "
+              << megabytes / absl::ToDoubleSeconds(write_time) << " MB/s, read "
+              << megabytes / absl::ToDoubleSeconds(read_time) << " MB/s";
+  };
+
+  int fd = CreateEmptyTempFileOrDie("benchmark_untrusted.tmp");
+  platform::storage::FdCloser closer(fd);
+  {
+    UntrustedFile file(fd);
+    run("UntrustedFile", &file);
+  }
+
+  int mapped_fd = CreateEmptyTempFileOrDie("benchmark_mapped.tmp");
+  platform::storage::FdCloser mapped_closer(mapped_fd);
+  std::unique_ptr<MappedUntrustedFile> mapped_file;
+  ASYLO_ASSERT_OK_AND_ASSIGN(mapped_file,
+                             MappedUntrustedFile::Create(mapped_fd));
+  run("MappedUntrustedFile", mapped_file.get());
+}
+
+}  // namespace
+}  // namespace asylo
@@ -0,0 +1,163 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/storage/utils/mapped_untrusted_file.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "asylo/platform/storage/utils/fd_closer.h"
+#include "asylo/platform/storage/utils/random_access_storage.h"
+#include "asylo/platform/storage/utils/test_utils.h"
+#include "asylo/platform/storage/utils/untrusted_file.h"
+#include "asylo/test/util/status_matchers.h"
+
+namespace asylo {
+namespace {
+
+TEST(MappedUntrustedFileTest, WriteRead) {
+  int fd = CreateEmptyTempFileOrDie("mapped_write_read.tmp");
+  platform::storage::FdCloser closer(fd);
+
+  std::unique_ptr<MappedUntrustedFile> file;
+  ASYLO_ASSERT_OK_AND_ASSIGN(file, MappedUntrustedFile::Create(fd));
+  EXPECT_THAT(file->Size(), IsOkAndHolds(0));
+
+  constexpr int kCount = 1024;
+  for (int i = 0; i < kCount; i++) {
+    ASYLO_EXPECT_OK(file->Write(&i, i * sizeof(int), sizeof(int)));
+  }
+  ASYLO_EXPECT_OK(file->Sync());
+
+  for (int i = 0; i < kCount; i++) {
+    int record;
+    ASYLO_EXPECT_OK(file->Read(&record, i * sizeof(int), sizeof(int)));
+    EXPECT_EQ(record, i);
+  }
+  EXPECT_THAT(file->Size(), IsOkAndHolds(kCount * sizeof(int)));
+
+  int record;
+  EXPECT_THAT(file->Read(&record, kCount * sizeof(int), sizeof(int)),
+              StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(file->Read(&record, -1, sizeof(int)),
+              StatusIs(error::NOT_FOUND));
+}
+
+// Ensure that writes are visible through the file once synchronized, and that
+// a file with existing contents is mapped with them.
+TEST(MappedUntrustedFileTest, SharedWithFile) {
+  int fd = CreateEmptyTempFileOrDie("mapped_shared.tmp");
+  platform::storage::FdCloser closer(fd);
+  UntrustedFile untrusted_file(fd);
+
+  constexpr uint64_t kValue = 0x0123456789abcdef;
+  ASYLO_ASSERT_OK(untrusted_file.Write(&kValue, 0, sizeof(kValue)));
+
+  std::unique_ptr<MappedUntrustedFile> file;
+  ASYLO_ASSERT_OK_AND_ASSIGN(file, MappedUntrustedFile::Create(fd));
+  EXPECT_THAT(file->Size(), IsOkAndHolds(sizeof(kValue)));
+  uint64_t value;
+  ASYLO_ASSERT_OK(file->Read(&value, 0, sizeof(value)));
+  EXPECT_EQ(value, kValue);
+
+  ASYLO_ASSERT_OK(file->Write(&kValue, sizeof(kValue), sizeof(kValue)));
+  ASYLO_ASSERT_OK(file->Sync());
+  EXPECT_THAT(untrusted_file.Size(), IsOkAndHolds(2 * sizeof(kValue)));
+  ASYLO_ASSERT_OK(untrusted_file.Read(&value, sizeof(kValue), sizeof(value)));
+  EXPECT_EQ(value, kValue);
+}
+
+// Ensure that a file can be mapped through a descriptor whose number differs
+// from the one the host knows the file by. Inside an enclave, the duplicate is
+// an enclave file descriptor sharing the original's host file descriptor.
+TEST(MappedUntrustedFileTest, MapsDuplicatedFileDescriptor) {
+  int fd = CreateEmptyTempFileOrDie("mapped_dup.tmp");
+  platform::storage::FdCloser closer(fd);
+  int dup_fd = dup2(fd, fd + 100);
+  ASSERT_EQ(dup_fd, fd + 100) << strerror(errno);
+  platform::storage::FdCloser dup_closer(dup_fd);
+  UntrustedFile untrusted_file(fd);
+
+  constexpr uint64_t kValue = 0xfedcba9876543210;
+  std::unique_ptr<MappedUntrustedFile> file;
+  ASYLO_ASSERT_OK_AND_ASSIGN(file, MappedUntrustedFile::Create(dup_fd));
+  ASYLO_ASSERT_OK(file->Write(&kValue, 0, sizeof(kValue)));
+
+  // Growing the file beyond the initial mapping remaps it through |dup_fd|.
+  ASYLO_ASSERT_OK(file->Write(&kValue, MappedUntrustedFile::kMinMappingSize,
+                              sizeof(kValue)));
+  ASYLO_ASSERT_OK(file->Sync());
+
+  uint64_t value;
+  ASYLO_ASSERT_OK(untrusted_file.Read(&value, 0, sizeof(value)));
+  EXPECT_EQ(value, kValue);
+  ASYLO_ASSERT_OK(untrusted_file.Read(
+      &value, MappedUntrustedFile::kMinMappingSize, sizeof(value)));
+  EXPECT_EQ(value, kValue);
+}
+
+// Ensure that the file is remapped as it grows beyond the initial mapping, and
+// that the contents of the file are preserved across truncation.
+TEST(MappedUntrustedFileTest, GrowAndTruncate) {
+  int fd = CreateEmptyTempFileOrDie("mapped_grow.tmp");
+  platform::storage::FdCloser closer(fd);
+
+  std::unique_ptr<MappedUntrustedFile> file;
+  ASYLO_ASSERT_OK_AND_ASSIGN(file, MappedUntrustedFile::Create(fd));
+
+  // Write a byte every kBlockSize bytes across several remappings.
+  constexpr size_t kBlockSize = 4096;
+  constexpr size_t kCount =
+      4 * MappedUntrustedFile::kMinMappingSize / kBlockSize;
+  for (size_t i = 0; i < kCount; i++) {
+    uint8_t ch = i % 256;
+    ASYLO_ASSERT_OK(file->Write(&ch, i * kBlockSize, sizeof(ch)));
+  }
+  EXPECT_THAT(file->Size(), IsOkAndHolds((kCount - 1) * kBlockSize + 1));
+
+  for (size_t i = 0; i < kCount - 1; i++) {
+    uint8_t buf[kBlockSize];
+    ASYLO_ASSERT_OK(file->Read(buf, i * kBlockSize, kBlockSize));
+    EXPECT_EQ(buf[0], i % 256);
+    for (size_t j = 1; j < kBlockSize; j++) {
+      ASSERT_EQ(buf[j], 0);
+    }
+  }
+
+  ASYLO_ASSERT_OK(file->Truncate(kBlockSize));
+  EXPECT_THAT(file->Size(), IsOkAndHolds(kBlockSize));
+  uint8_t ch;
+  EXPECT_THAT(file->Read(&ch, kBlockSize, sizeof(ch)),
+              StatusIs(error::NOT_FOUND));
+
+  // Extending the file again exposes zeros, not the truncated contents.
+  ASYLO_ASSERT_OK(file->Truncate(2 * kBlockSize));
+  ASYLO_ASSERT_OK(file->Read(&ch, kBlockSize, sizeof(ch)));
+  EXPECT_EQ(ch, 0);
+  ASYLO_ASSERT_OK(file->Read(&ch, 0, sizeof(ch)));
+  EXPECT_EQ(ch, 0);
+}
+
+}  // namespace
+}  // namespace asylo
@@ -20,9 +20,10 @@
 #define ASYLO_PLATFORM_STORAGE_UTILS_RECORD_STORE_H_
 
 #include <algorithm>
-#include <iterator>
-#include <list>
+#include <cstdint>
+#include <cstring>
 #include <type_traits>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "asylo/util/logging.h"
@@ -50,6 +51,18 @@ namespace asylo {
 // via Flush(), and is automatically flushed when the RecordStore passes out of
 // scope.
 //
+// Accesses to the storage resource are batched where records are adjacent:
+//
+//   * When cache misses follow a sequential pattern, records are prefetched
+//     from storage into a read-ahead window with a single read, and subsequent
+//     misses inside the window are served without accessing storage. Records
+//     in the read-ahead window do not occupy the cache until they are accessed.
+//
+//   * When a modified record is evicted, every modified record adjacent to it
+//     in the cache is written back with it as a single contiguous write.
+//     Flush() likewise writes back each run of adjacent modified records with
+//     a single write.
+//
 // This class is not thread-safe. It is the responsibility of the caller to
 // ensure that its methods are not called concurrently.
 template <typename T>
@@ -61,12 +74,19 @@ class RecordStore {
   static_assert(std::is_trivially_copy_assignable<T>::value,
                 "T must satisfy std::is_trivially_copy_assignable");
 
+  // Size in bytes of the read-ahead window, unless records are so large that
+  // fewer than kMinReadAheadRecords would fit.
+  static constexpr size_t kReadAheadSize = 8192;
+
+  // Minimum number of records prefetched by a read-ahead.
+  static constexpr size_t kMinReadAheadRecords = 4;
+
   // Initializes a RecordStore backed by a storage resource |io| and configures
   // a cache with a |capacity| specified as a count of elements of type T. The
   // RecordStore does not take ownership of |io| and it is the responsibility of
   // the caller to ensure it remains valid over the lifetime of the RecordStore.
   RecordStore(size_t capacity, RandomAccessStorage *io)
-      : capacity_(std::max<size_t>(capacity, 1)), count_(0), io_(io) {}
+      : capacity_(std::max<size_t>(capacity, 1)), io_(io) {}
 
   RecordStore(const RecordStore<T> &) = delete;
 
@@ -87,8 +107,27 @@ class RecordStore {
   // Flushes the cache to persistent storage and ensures the underlying storage
   // resource has been synchronized. Returns an error status on failure.
   ASYLO_MUST_USE_RESULT Status Flush() {
-    for (auto it = cache_.begin(); it != cache_.end(); it++) {
-      ASYLO_RETURN_IF_ERROR(Commit(it));
+    run_.clear();
+    for (size_t slot = 0; slot < entries_.size(); slot++) {
+      if (entries_[slot].dirty) {
+        run_.push_back(slot);
+      }
+    }
+    std::sort(run_.begin(), run_.end(), [this](size_t lhs, size_t rhs) {
+      return entries_[lhs].offset < entries_[rhs].offset;
+    });
+
+    // Write back each run of adjacent records with a single write.
+    size_t begin = 0;
+    while (begin < run_.size()) {
+      size_t end = begin + 1;
+      while (end < run_.size() &&
+             entries_[run_[end]].offset ==
+                 entries_[run_[end - 1]].offset + RecordSize()) {
+        end++;
+      }
+      ASYLO_RETURN_IF_ERROR(Commit(run_.data() + begin, end - begin));
+      begin = end;
     }
     ASYLO_RETURN_IF_ERROR(io_->Sync());
     return Status::OkStatus();
@@ -103,28 +142,19 @@ class RecordStore {
     auto it = index_.find(offset);
     if (it != index_.end()) {
       MoveToFront(it->second);
-    } else {
-      if (count_ < capacity_) {
-        cache_.emplace_front();
-        count_++;
-      } else {
-        ASYLO_RETURN_IF_ERROR(Evict());
-      }
-      auto first = cache_.begin();
-      Status status = io_->Read(&first->value, offset, sizeof(T));
-      if (!status.ok()) {
-        // On read failure, the contents of the head node are undefined. Discard
-        // the cache head node to ensure garbage data is not evicted and written
-        // back to disk.
-        cache_.pop_front();
-        count_--;
-        return status;
-      }
-      first->offset = offset;
-      first->dirty = false;
-      index_[offset] = first;
+      *item = entries_[it->second].value;
+      return Status::OkStatus();
     }
-    *item = cache_.begin()->value;
+
+    // Fetch the record before allocating a cache entry for it, so that a read
+    // failure leaves the cache unchanged.
+    T value;
+    ASYLO_RETURN_IF_ERROR(Fetch(offset, &value));
+    size_t slot;
+    ASYLO_ASSIGN_OR_RETURN(slot, Allocate(offset));
+    entries_[slot].value = value;
+    entries_[slot].dirty = false;
+    *item = value;
     return Status::OkStatus();
   }
 
@@ -135,87 +165,251 @@ class RecordStore {
   // RecordStore. Writes are cached and may not be persisted to storage until
   // Flush() is called or the RecordStore is destroyed.
   ASYLO_MUST_USE_RESULT Status Write(off_t offset, const T &item) {
+    size_t slot;
     auto it = index_.find(offset);
     if (it != index_.end()) {
-      MoveToFront(it->second);
+      slot = it->second;
+      MoveToFront(slot);
     } else {
-      if (count_ < capacity_) {
-        // Allocate a new cache entry. Note that existing iterators into cache_
-        // are not invalidated.
-        cache_.emplace_front();
-        count_++;
-      } else {
-        ASYLO_RETURN_IF_ERROR(Evict());
-      }
-      cache_.begin()->offset = offset;
-      index_[offset] = cache_.begin();
+      ASYLO_ASSIGN_OR_RETURN(slot, Allocate(offset));
     }
-    auto first = cache_.begin();
-    first->value = item;
-    first->dirty = true;
+    entries_[slot].value = item;
+    entries_[slot].dirty = true;
     return Status::OkStatus();
   }
 
   // Returns true if a record specified by its byte-offset is present in the
-  // cache.
+  // cache. Records held only in the read-ahead window are not considered
+  // cached.
   bool IsCached(off_t offset) const { return index_.contains(offset); }
 
  private:
+  // Sentinel slot index terminating the LRU list.
+  static constexpr size_t kNoSlot = SIZE_MAX;
+
+  // A cache entry, linked into an intrusive LRU list by slot index.
   struct CacheEntry {
     off_t offset;  // Byte offset of this record.
     T value;       // Cached record value.
     bool dirty;    // True if this entry has been modified.
+    size_t prev;   // Slot of the next more-recently-used entry.
+    size_t next;   // Slot of the next less-recently-used entry.
   };
 
-  using NodeRef = typename std::list<CacheEntry>::iterator;
-  using ConstNodeRef = typename std::list<CacheEntry>::const_iterator;
+  static constexpr off_t RecordSize() { return static_cast<off_t>(sizeof(T)); }
 
-  // Writes a cache entry to storage, returning an error status on failure.
-  ASYLO_MUST_USE_RESULT Status Commit(NodeRef entry) {
-    ASYLO_RETURN_IF_ERROR(io_->Write(&entry->value, entry->offset, sizeof(T)));
-    entry->dirty = false;
-    return Status::OkStatus();
+  // Reads the record at |offset| from the read-ahead window or from storage.
+  ASYLO_MUST_USE_RESULT Status Fetch(off_t offset, T *value) {
+    bool sequential = offset == next_sequential_offset_;
+    next_sequential_offset_ = offset + RecordSize();
+
+    if (ReadAheadContains(offset)) {
+      memcpy(value, read_ahead_.data() + (offset - read_ahead_offset_),
+             sizeof(T));
+      return Status::OkStatus();
+    }
+
+    if (sequential && ReadAhead(offset)) {
+      memcpy(value, read_ahead_.data(), sizeof(T));
+      return Status::OkStatus();
+    }
+
+    return io_->Read(value, offset, sizeof(T));
+  }
+
+  // Returns true if the record at |offset| lies within the read-ahead window.
+  bool ReadAheadContains(off_t offset) const {
+    return read_ahead_size_ > 0 && offset >= read_ahead_offset_ &&
+           offset + RecordSize() <=
+               read_ahead_offset_ + static_cast<off_t>(read_ahead_size_);
+  }
+
+  // Fills the read-ahead window with the records starting at |offset|.
+  // Returns false if at most one record could be prefetched, in which case the
+  // window is left empty.
+  bool ReadAhead(off_t offset) {
+    if (read_ahead_.empty()) {
+      read_ahead_.resize(
+          std::max(kReadAheadSize, kMinReadAheadRecords * sizeof(T)) /
+          sizeof(T) * sizeof(T));
+    }
+    read_ahead_size_ = 0;
+
+    size_t size = read_ahead_.size();
+    if (!io_->Read(read_ahead_.data(), offset, size).ok()) {
+      // The window most likely extends past the end of storage. Retry with the
+      // window clamped to the records which remain.
+      StatusOr<size_t> storage_size = io_->Size();
+      if (!storage_size.ok() ||
+          storage_size.ValueOrDie() < offset + 2 * sizeof(T)) {
+        return false;
+      }
+      size = std::min(size, (storage_size.ValueOrDie() - offset) / sizeof(T) *
+                                sizeof(T));
+      if (!io_->Read(read_ahead_.data(), offset, size).ok()) {
+        return false;
+      }
+    }
+    read_ahead_offset_ = offset;
+    read_ahead_size_ = size;
+    return true;
+  }
+
+  // Returns a cache slot for a record at |offset| and moves it to the front of
+  // the LRU list, evicting the least-recently-used entry if the cache is full.
+  // Returns an error status if an evicted entry could not be written back.
+  ASYLO_MUST_USE_RESULT StatusOr<size_t> Allocate(off_t offset) {
+    size_t slot;
+    if (entries_.size() < capacity_) {
+      // Slots are allocated lazily as they are first referenced, so a cache
+      // that is never filled does not reserve its full capacity.
+      entries_.emplace_back();
+      slot = entries_.size() - 1;
+    } else {
+      slot = tail_;
+      if (entries_[slot].dirty) {
+        ASYLO_RETURN_IF_ERROR(CommitAdjacent(slot));
+      }
+      index_.erase(entries_[slot].offset);
+      Unlink(slot);
+    }
+    entries_[slot].offset = offset;
+    index_[offset] = slot;
+    PushFront(slot);
+    return slot;
   }
 
-  // Evicts an entry from the cache and moves the evicted cache node to the
-  // front of the LRU list. Returns an error status on failure.
-  ASYLO_MUST_USE_RESULT Status Evict() {
-    auto last = std::prev(cache_.end());
-    ASYLO_RETURN_IF_ERROR(Commit(last));
-    index_.erase(last->offset);
-    MoveToFront(last);
+  // Writes back the modified entry in |slot| along with each modified entry
+  // adjacent to it in storage, as a single write.
+  ASYLO_MUST_USE_RESULT Status CommitAdjacent(size_t slot) {
+    off_t first = entries_[slot].offset;
+    while (first >= RecordSize() && IsDirty(first - RecordSize())) {
+      first -= RecordSize();
+    }
+    off_t last = entries_[slot].offset;
+    while (IsDirty(last + RecordSize())) {
+      last += RecordSize();
+    }
+
+    run_.clear();
+    for (off_t offset = first; offset <= last; offset += RecordSize()) {
+      run_.push_back(index_.find(offset)->second);
+    }
+    return Commit(run_.data(), run_.size());
+  }
+
+  // Returns true if the record at |offset| is cached and has been modified.
+  bool IsDirty(off_t offset) const {
+    auto it = index_.find(offset);
+    return it != index_.end() && entries_[it->second].dirty;
+  }
+
+  // Writes a run of |count| cache entries occupying adjacent records in
+  // storage, ordered by offset, with a single write. Returns an error status on
+  // failure.
+  ASYLO_MUST_USE_RESULT Status Commit(const size_t *slots, size_t count) {
+    off_t offset = entries_[slots[0]].offset;
+    size_t size = count * sizeof(T);
+    const void *buffer;
+    if (count == 1) {
+      buffer = &entries_[slots[0]].value;
+    } else {
+      write_buffer_.resize(size);
+      for (size_t i = 0; i < count; i++) {
+        memcpy(write_buffer_.data() + i * sizeof(T), &entries_[slots[i]].value,
+               sizeof(T));
+      }
+      buffer = write_buffer_.data();
+    }
+    ASYLO_RETURN_IF_ERROR(io_->Write(buffer, offset, size));
+    for (size_t i = 0; i < count; i++) {
+      entries_[slots[i]].dirty = false;
+    }
+
+    // Keep the read-ahead window coherent with the records written back.
+    off_t begin = std::max(offset, read_ahead_offset_);
+    off_t end = std::min<off_t>(offset + size,
+                                read_ahead_offset_ + read_ahead_size_);
+    if (read_ahead_size_ > 0 && begin < end) {
+      memcpy(read_ahead_.data() + (begin - read_ahead_offset_),
+             reinterpret_cast<const uint8_t *>(buffer) + (begin - offset),
+             end - begin);
+    }
     return Status::OkStatus();
   }
 
-  // Moves an LRU list node to the front of the list.
-  void MoveToFront(ConstNodeRef node) {
-    if (node != cache_.begin()) {
-      // Splice node onto the front of the list. Note that splice does not
-      // invalidate existing iterators into cache_.
-      cache_.splice(cache_.begin(), cache_, node);
+  // Links an unlinked slot at the front of the LRU list.
+  void PushFront(size_t slot) {
+    entries_[slot].prev = kNoSlot;
+    entries_[slot].next = head_;
+    if (head_ != kNoSlot) {
+      entries_[head_].prev = slot;
+    } else {
+      tail_ = slot;
     }
+    head_ = slot;
   }
 
-  size_t capacity_;  // Size of the cache in items of type T.
+  // Removes a slot from the LRU list.
+  void Unlink(size_t slot) {
+    CacheEntry &entry = entries_[slot];
+    if (entry.prev != kNoSlot) {
+      entries_[entry.prev].next = entry.next;
+    } else {
+      head_ = entry.next;
+    }
+    if (entry.next != kNoSlot) {
+      entries_[entry.next].prev = entry.prev;
+    } else {
+      tail_ = entry.prev;
+    }
+  }
 
-  // Number of items present in the cache. Although std::list::size() is
-  // required to have constant time complexity since C++11, not all library
-  // implementions conform to this requirement. In particular, libstdc++
-  // versions <= 4.8 implement size() as std::distance(head, tail).
-  size_t count_;
+  // Moves a slot to the front of the LRU list.
+  void MoveToFront(size_t slot) {
+    if (slot != head_) {
+      Unlink(slot);
+      PushFront(slot);
+    }
+  }
+
+  size_t capacity_;  // Size of the cache in items of type T.
 
   RandomAccessStorage *io_;  // Record backing store.
 
-  // Entries in the cache, maintained in LRU order. This implementation does not
-  // preallocate the cache at the time it is created, opting instead to allocate
-  // entries and add them to a list lazily as they are referenced. This enables
-  // overcommitment of heap capacity at the cost of greater overhead incurred
-  // by the default allocator.
-  std::list<CacheEntry> cache_;
+  // Cache entries, addressed by slot index and linked into an LRU list running
+  // from |head_| (most recently used) to |tail_| (least recently used). Once
+  // the cache is full, entries are recycled in place so that cache operations
+  // do not allocate.
+  std::vector<CacheEntry> entries_;
+  size_t head_ = kNoSlot;
+  size_t tail_ = kNoSlot;
+
+  absl::flat_hash_map<off_t, size_t> index_;  // Slot index by record offset.
 
-  absl::flat_hash_map<off_t, ConstNodeRef> index_;  // Index by record offset.
+  // Read-ahead window holding |read_ahead_size_| bytes of storage starting at
+  // |read_ahead_offset_|.
+  std::vector<uint8_t> read_ahead_;
+  off_t read_ahead_offset_ = 0;
+  size_t read_ahead_size_ = 0;
+
+  // Offset of the record which would continue a sequential run of misses.
+  off_t next_sequential_offset_ = -1;
+
+  // Scratch space for write-back, retained to avoid per-write allocations.
+  std::vector<size_t> run_;
+  std::vector<uint8_t> write_buffer_;
 };
 
+template <typename T>
+constexpr size_t RecordStore<T>::kReadAheadSize;
+
+template <typename T>
+constexpr size_t RecordStore<T>::kMinReadAheadRecords;
+
+template <typename T>
+constexpr size_t RecordStore<T>::kNoSlot;
+
 }  // namespace asylo
 
 #endif  // ASYLO_PLATFORM_STORAGE_UTILS_RECORD_STORE_H_
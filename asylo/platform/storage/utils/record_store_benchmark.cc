@@ -0,0 +1,87 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/platform/storage/utils/fd_closer.h"
+#include "asylo/platform/storage/utils/record_store.h"
+#include "asylo/platform/storage/utils/test_utils.h"
+#include "asylo/platform/storage/utils/untrusted_file.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace {
+
+// Logs the number of storage operations and elapsed time for sequential and
+// random access patterns. Before read-ahead and coalesced write-back, every
+// cache miss and every eviction of a modified record cost one storage
+// operation.
+TEST(RecordStoreBenchmark, AccessPatterns) {
+  int fd = CreateEmptyTempFileOrDie("benchmark.tmp");
+  platform::storage::FdCloser closer(fd);
+  UntrustedFile file(fd);
+  CountingStorage counting(&file);
+
+  constexpr size_t kCapacity = 64;
+  constexpr size_t kRecordCount = 1 << 16;
+
+  std::vector<size_t> sequential(kRecordCount);
+  for (size_t i = 0; i < kRecordCount; i++) {
+    sequential[i] = i;
+  }
+  std::vector<size_t> random = sequential;
+  std::shuffle(random.begin(), random.end(), std::mt19937(0));
+
+  for (const auto *order : {&sequential, &random}) {
+    const char *label = order == &sequential ? "sequential" : "random";
+
+    counting.Reset();
+    absl::Time start = absl::Now();
+    {
+      RecordStore<size_t> records(kCapacity, &counting);
+      for (size_t i : *order) {
+        ASYLO_ASSERT_OK(records.Write(i * sizeof(size_t), i));
+      }
+    }
+    LOG(INFO) << label << " write: " << kRecordCount << " records, "
+              << counting.writes() << " writes, " << absl::Now() - start;
+
+    counting.Reset();
+    start = absl::Now();
+    {
+      RecordStore<size_t> records(kCapacity, &counting);
+      for (size_t i : *order) {
+        size_t record;
+        ASYLO_ASSERT_OK(records.Read(i * sizeof(size_t), &record));
+        ASSERT_EQ(record, i);
+      }
+    }
+    LOG(INFO) << label << " read: " << kRecordCount << " records, "
+              << counting.reads() << " reads, " << absl::Now() - start;
+  }
+}
+
+}  // namespace
+}  // namespace asylo
@@ -119,5 +119,105 @@ TEST(RecordStoreTest, Flush) {
   }
 }
 
+// Ensure that sequential reads are served by read-ahead rather than by a read
+// per record, including when the read-ahead window reaches the end of storage.
+TEST(RecordStoreTest, SequentialReadAhead) {
+  int fd = CreateEmptyTempFileOrDie("read_ahead.tmp");
+  platform::storage::FdCloser closer(fd);
+  UntrustedFile file(fd);
+
+  constexpr size_t kCapacity = 16;
+  constexpr size_t kRecordCount = 3000;
+  std::vector<size_t> values(kRecordCount);
+  for (size_t i = 0; i < kRecordCount; i++) {
+    values[i] = i;
+  }
+  ASYLO_ASSERT_OK(file.Write(values.data(), 0, kRecordCount * sizeof(size_t)));
+
+  CountingStorage counting(&file);
+  RecordStore<size_t> records(kCapacity, &counting);
+  for (size_t i = 0; i < kRecordCount; i++) {
+    size_t record;
+    ASYLO_ASSERT_OK(records.Read(i * sizeof(size_t), &record));
+    EXPECT_EQ(record, i);
+  }
+  EXPECT_LT(counting.reads(), kRecordCount / 64);
+
+  // Reading past the end of storage still fails.
+  size_t record;
+  EXPECT_FALSE(records.Read(kRecordCount * sizeof(size_t), &record).ok());
+  EXPECT_FALSE(records.IsCached(kRecordCount * sizeof(size_t)));
+}
+
+// Ensure that records written back to storage are visible through the
+// read-ahead window.
+TEST(RecordStoreTest, ReadAheadCoherence) {
+  int fd = CreateEmptyTempFileOrDie("read_ahead_coherence.tmp");
+  platform::storage::FdCloser closer(fd);
+  UntrustedFile file(fd);
+
+  constexpr size_t kCapacity = 4;
+  constexpr size_t kRecordCount = 64;
+  std::vector<size_t> values(kRecordCount, 0);
+  ASYLO_ASSERT_OK(file.Write(values.data(), 0, kRecordCount * sizeof(size_t)));
+
+  RecordStore<size_t> records(kCapacity, &file);
+  size_t record;
+  for (size_t i = 0; i < kCapacity; i++) {
+    ASYLO_ASSERT_OK(records.Read(i * sizeof(size_t), &record));
+  }
+
+  // Modify records which have been prefetched but not yet read, then write
+  // them back by evicting them.
+  for (size_t i = kCapacity; i < 3 * kCapacity; i++) {
+    ASYLO_ASSERT_OK(records.Write(i * sizeof(size_t), i));
+  }
+  for (size_t i = kCapacity; i < 2 * kCapacity; i++) {
+    EXPECT_FALSE(records.IsCached(i * sizeof(size_t)));
+    ASYLO_ASSERT_OK(records.Read(i * sizeof(size_t), &record));
+    EXPECT_EQ(record, i);
+  }
+}
+
+// Ensure that adjacent modified records are written back together, both on
+// eviction and on Flush().
+TEST(RecordStoreTest, CoalescedWriteBack) {
+  int fd = CreateEmptyTempFileOrDie("write_back.tmp");
+  platform::storage::FdCloser closer(fd);
+  UntrustedFile file(fd);
+  CountingStorage counting(&file);
+
+  constexpr size_t kCapacity = 16;
+  constexpr size_t kRecordCount = 256;
+
+  {
+    RecordStore<size_t> records(kCapacity, &counting);
+    for (size_t i = 0; i < kRecordCount; i++) {
+      ASYLO_EXPECT_OK(records.Write(i * sizeof(size_t), i));
+    }
+    EXPECT_EQ(counting.writes(), kRecordCount / kCapacity - 1);
+
+    // Modify two separate runs of records in reverse order.
+    counting.Reset();
+    for (size_t i = kRecordCount; i > kRecordCount - kCapacity / 2; i--) {
+      ASYLO_EXPECT_OK(
+          records.Write((i - 1) * sizeof(size_t), i - 1 + kRecordCount));
+    }
+    for (size_t i = 0; i < kCapacity / 2; i++) {
+      ASYLO_EXPECT_OK(records.Write(i * sizeof(size_t), i + kRecordCount));
+    }
+    ASYLO_ASSERT_OK(records.Flush());
+    EXPECT_EQ(counting.writes(), 2);
+  }
+
+  for (size_t i = 0; i < kRecordCount; i++) {
+    size_t record;
+    ASYLO_EXPECT_OK(file.Read(&record, i * sizeof(size_t), sizeof(size_t)));
+    bool modified =
+        i < kCapacity / 2 || i >= kRecordCount - kCapacity / 2;
+    EXPECT_EQ(record, modified ? i + kRecordCount : i);
+  }
+}
+
 }  // namespace
 }  // namespace asylo
@@ -19,7 +19,14 @@
 #ifndef ASYLO_PLATFORM_STORAGE_UTILS_TEST_UTILS_H_
 #define ASYLO_PLATFORM_STORAGE_UTILS_TEST_UTILS_H_
 
+#include <sys/types.h>
+
+#include <cstddef>
+
 #include "absl/strings/string_view.h"
+#include "asylo/platform/storage/utils/random_access_storage.h"
+#include "asylo/util/status.h"
+#include "asylo/util/statusor.h"
 
 // Common utility functions shared across multiple storage tests.
 namespace asylo {
@@ -27,6 +34,42 @@ namespace asylo {
 // Creates and opens an empty temporary file, returning a file descriptor.
 int CreateEmptyTempFileOrDie(absl::string_view basename);
 
+// A RandomAccessStorage wrapper counting the read and write operations issued
+// to an underlying storage resource.
+class CountingStorage : public RandomAccessStorage {
+ public:
+  explicit CountingStorage(RandomAccessStorage *io) : io_(io) {}
+
+  StatusOr<size_t> Size() const override { return io_->Size(); }
+
+  Status Read(void *buffer, off_t offset, size_t size) override {
+    reads_++;
+    return io_->Read(buffer, offset, size);
+  }
+
+  Status Write(const void *buffer, off_t offset, size_t size) override {
+    writes_++;
+    return io_->Write(buffer, offset, size);
+  }
+
+  Status Sync() override { return io_->Sync(); }
+
+  Status Truncate(size_t size) override { return io_->Truncate(size); }
+
+  size_t reads() const { return reads_; }
+  size_t writes() const { return writes_; }
+
+  void Reset() {
+    reads_ = 0;
+    writes_ = 0;
+  }
+
+ private:
+  RandomAccessStorage *io_;
+  size_t reads_ = 0;
+  size_t writes_ = 0;
+};
+
 }  // namespace asylo
 
 #endif  // ASYLO_PLATFORM_STORAGE_UTILS_TEST_UTILS_H_
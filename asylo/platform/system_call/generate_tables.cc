@@ -16,6 +16,8 @@
  *
  */
 
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <string>
@@ -24,9 +26,13 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "asylo/platform/system_call/syscalls.inc"
 
 // This file implements a code generation tool built with a native Linux
@@ -339,7 +345,434 @@ void EmitParameterTable(std::ostream *os) {
   *os << "};\n";
 }
 
+// Returns the list of system calls for which specialized marshalling routines
+// are generated.
+std::vector<std::string> *SpecializedSystemCalls() {
+  static auto *specialized_system_calls =
+      new std::vector<std::string>{SPECIALIZED_SYSTEM_CALLS_INIT};
+  return specialized_system_calls;
+}
+
+// Returns true if the flags expression of a parameter includes |flag|.
+bool HasFlag(const ParameterDescription &desc, absl::string_view flag) {
+  for (absl::string_view value : absl::StrSplit(desc.flags, " | ")) {
+    if (value == flag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the smallest multiple of 8 greater than or equal to |value|.
+size_t RoundUpToMultipleOf8(size_t value) { return (value + 7) / 8 * 8; }
+
+// Returns a system call name as an upper camel case identifier, for instance
+// "clock_gettime" => "ClockGettime".
+std::string CamelCaseName(const std::string &name) {
+  std::string result;
+  for (absl::string_view part : absl::StrSplit(name, '_')) {
+    std::string word(part);
+    if (!word.empty()) {
+      word[0] = absl::ascii_toupper(word[0]);
+    }
+    absl::StrAppend(&result, word);
+  }
+  return result;
+}
+
+// A system call parameter as it appears in generated marshalling code.
+struct SpecializedParameter {
+  const ParameterDescription *desc;
+  int index;         // Index into the system call parameter list.
+  std::string type;  // C++ type of the parameter in generated signatures.
+};
+
+// Returns the C++ type used to pass a parameter to generated marshalling
+// routines. Scalars are passed as fixed-width integers matching the host
+// encoding, and pointers are passed as untyped buffers since the layout of the
+// pointee is defined by the host rather than the enclave.
+std::string SpecializedType(const ParameterDescription &desc) {
+  if (!HasFlag(desc, "kPointer")) {
+    if (desc.size != 1 && desc.size != 2 && desc.size != 4 && desc.size != 8) {
+      std::cerr << absl::StreamFormat(
+                       "Error: Unsupported scalar size %d for parameter \"%s\" "
+                       "of system call \"%s\".",
+                       desc.size, desc.name, desc.syscall)
+                << std::endl;
+      exit(1);
+    }
+    return absl::StrCat(HasFlag(desc, "kSigned") ? "int" : "uint",
+                        desc.size * 8, "_t");
+  }
+  if (HasFlag(desc, "kString")) {
+    return "const char *";
+  }
+  if (HasFlag(desc, "kFixed") || HasFlag(desc, "kBounded")) {
+    return HasFlag(desc, "kOut") ? "void *" : "const void *";
+  }
+  std::cerr << absl::StreamFormat(
+                   "Error: Parameter \"%s\" of system call \"%s\" cannot be "
+                   "specialized.",
+                   desc.name, desc.syscall)
+            << std::endl;
+  exit(1);
+}
+
+// Returns the expression used to convert an entry of a ParameterList to the
+// type of a specialized parameter.
+std::string ParameterCast(const SpecializedParameter &param) {
+  return absl::StrFormat("%s<%s>(parameters[%d])",
+                         HasFlag(*param.desc, "kPointer") ? "reinterpret_cast"
+                                                          : "static_cast",
+                         param.type, param.index);
+}
+
+// Returns the expression computing the number of elements of a bounded buffer.
+std::string BoundExpression(const std::vector<SpecializedParameter> &params,
+                            const SpecializedParameter &param) {
+  return absl::StrCat("static_cast<uint64_t>(",
+                      params[param.desc->size].desc->name, ")");
+}
+
+// Returns a comma-separated list of |leading|, followed by |params|, followed
+// by |trailing|, skipping empty lists.
+std::string ArgumentList(std::vector<std::string> leading,
+                         const std::vector<std::string> &params,
+                         const std::vector<std::string> &trailing = {}) {
+  leading.insert(leading.end(), params.begin(), params.end());
+  leading.insert(leading.end(), trailing.begin(), trailing.end());
+  return absl::StrJoin(leading, ", ");
+}
+
+// Returns the typed declarations of a list of specialized parameters.
+std::vector<std::string> Declarations(
+    const std::vector<SpecializedParameter> &params) {
+  std::vector<std::string> result;
+  for (const SpecializedParameter &param : params) {
+    absl::string_view separator = absl::EndsWith(param.type, "*") ? "" : " ";
+    result.push_back(absl::StrCat(param.type, separator, param.desc->name));
+  }
+  return result;
+}
+
+// Emits a routine computing the size of a request or response message.
+void EmitSizeRoutine(std::ostream *os, const std::string &syscall,
+                     const std::string &name, const std::string &direction,
+                     const std::string &flag,
+                     const std::vector<SpecializedParameter> &params) {
+  size_t fixed_size = 0;
+  std::string body;
+  for (const SpecializedParameter &param : params) {
+    const ParameterDescription &desc = *param.desc;
+    if (!HasFlag(desc, flag)) {
+      continue;
+    }
+    if (HasFlag(desc, "kString")) {
+      absl::StrAppend(&body, "  if (!AddStringSize(", desc.name,
+                      ", message_size)) return false;\n");
+    } else if (HasFlag(desc, "kBounded")) {
+      absl::StrAppend(&body, "  if (!AddBoundedSize(", desc.name, ", ",
+                      BoundExpression(params, param), ", ", desc.element_size,
+                      ", message_size)) {\n    return false;\n  }\n");
+    } else if (HasFlag(desc, "kFixed")) {
+      fixed_size += RoundUpToMultipleOf8(desc.size);
+      absl::StrAppend(&body, "  if (", desc.name,
+                      " == nullptr) *message_size -= ",
+                      RoundUpToMultipleOf8(desc.size), ";\n");
+    } else {
+      fixed_size += sizeof(uint64_t);
+    }
+  }
+
+  *os << absl::StreamFormat(
+      "// Size of a %s() %s with non-null fixed-size parameters, excluding\n"
+      "// bounded buffers and strings.\n"
+      "constexpr size_t k%s%sFixedSize = sizeof(MessageHeader) + %d;\n\n",
+      syscall, absl::AsciiStrToLower(direction), name, direction, fixed_size);
+  *os << absl::StreamFormat(
+      "inline bool %s%sSize(%s) {\n"
+      "  *message_size = k%s%sFixedSize;\n"
+      "%s"
+      "  return true;\n"
+      "}\n\n",
+      name, direction,
+      ArgumentList({}, Declarations(params), {"size_t *message_size"}), name,
+      direction, body);
+}
+
+// Emits a routine writing a request or response message.
+void EmitWriteRoutine(std::ostream *os, int sysno, const std::string &name,
+                      const std::string &direction, const std::string &flag,
+                      const std::vector<SpecializedParameter> &params) {
+  std::string body;
+  for (const SpecializedParameter &param : params) {
+    const ParameterDescription &desc = *param.desc;
+    if (!HasFlag(desc, flag)) {
+      continue;
+    }
+    if (HasFlag(desc, "kString")) {
+      absl::StrAppend(&body, "  WriteString(message, ", param.index, ", ",
+                      desc.name, ", &message_offset);\n");
+    } else if (HasFlag(desc, "kBounded")) {
+      absl::StrAppend(&body, "  WriteBuffer(message, ", param.index, ", ",
+                      desc.name, ", ", BoundExpression(params, param), " * ",
+                      desc.element_size, ", &message_offset);\n");
+    } else if (HasFlag(desc, "kFixed")) {
+      absl::StrAppend(&body, "  WriteBuffer(message, ", param.index, ", ",
+                      desc.name, ", ", desc.size, ", &message_offset);\n");
+    } else {
+      absl::StrAppend(&body, "  WriteScalar(message, ", param.index,
+                      ", static_cast<uint64_t>(", desc.name,
+                      "), &message_offset);\n");
+    }
+  }
+
+  // Only bind the running offset when at least one parameter is written.
+  std::string offset_declaration =
+      body.empty() ? "" : "size_t message_offset = ";
+  if (direction == "Request") {
+    *os << absl::StreamFormat(
+        "inline void Write%sRequest(%s) {\n"
+        "  %sInitializeRequest(message, %d);\n"
+        "%s"
+        "}\n\n",
+        name, ArgumentList({"uint8_t *message"}, Declarations(params)),
+        offset_declaration, sysno, body);
+  } else {
+    *os << absl::StreamFormat(
+        "inline void Write%sResponse(%s) {\n"
+        "  %sInitializeResponse(message, %d, result, error_number);\n"
+        "%s"
+        "}\n\n",
+        name,
+        ArgumentList(
+            {"uint8_t *message", "uint64_t result", "uint64_t error_number"},
+            Declarations(params)),
+        offset_declaration, sysno, body);
+  }
+}
+
+// Emits a routine validating a response message and copying its output
+// parameters to their destination buffers.
+void EmitParseRoutine(std::ostream *os, int sysno, const std::string &name,
+                      const std::vector<SpecializedParameter> &params) {
+  std::string body;
+  for (const SpecializedParameter &param : params) {
+    const ParameterDescription &desc = *param.desc;
+    if (!HasFlag(desc, "kOut")) {
+      continue;
+    }
+    if (HasFlag(desc, "kBounded")) {
+      absl::StrAppend(&body, "  if (!ReadBoundedBuffer(response, ",
+                      param.index, ", ", desc.name, ", ",
+                      BoundExpression(params, param), ", ", desc.element_size,
+                      ", &message_offset)) {\n    return false;\n  }\n");
+    } else {
+      absl::StrAppend(&body, "  if (!ReadBuffer(response, ", param.index, ", ",
+                      desc.name, ", ", desc.size,
+                      ", &message_offset)) return false;\n");
+    }
+  }
+
+  *os << absl::StreamFormat(
+      "inline bool Parse%sResponse(%s) {\n"
+      "  size_t message_offset;\n"
+      "  if (!CheckResponseHeader(response, %d, &message_offset)) {\n"
+      "    return false;\n"
+      "  }\n"
+      "%s"
+      "  return true;\n"
+      "}\n\n",
+      name,
+      ArgumentList({"primitives::Extent response"}, Declarations(params)),
+      sysno, body);
+}
+
+// Returns the specialized parameters of a system call, or exits with an error
+// if the system call cannot be specialized.
+std::vector<SpecializedParameter> SpecializedParameters(
+    const SystemCallDescription &syscall) {
+  std::vector<SpecializedParameter> params;
+  for (int i = 0; i < syscall.parameter_count; i++) {
+    const ParameterDescription &desc =
+        (*ParameterTable())[syscall.parameter_index + i];
+    if (HasFlag(desc, "kPointer") && HasFlag(desc, "kIn") &&
+        HasFlag(desc, "kOut")) {
+      std::cerr << absl::StreamFormat(
+                       "Error: In/out parameter \"%s\" of system call \"%s\" "
+                       "cannot be specialized.",
+                       desc.name, desc.syscall)
+                << std::endl;
+      exit(1);
+    }
+    for (const char *reserved :
+         {"error_number", "message", "message_offset", "message_size",
+          "parameters", "response", "result"}) {
+      if (desc.name == reserved) {
+        std::cerr << absl::StreamFormat(
+                         "Error: Parameter \"%s\" of system call \"%s\" "
+                         "collides with an identifier used by generated code.",
+                         desc.name, desc.syscall)
+                  << std::endl;
+        exit(1);
+      }
+    }
+    params.push_back({&desc, i, SpecializedType(desc)});
+  }
+  return params;
+}
+
+// Emits the typed marshalling routines for a single system call.
+void EmitSpecializedSystemCall(
+    std::ostream *os, int sysno, const SystemCallDescription &syscall,
+    const std::vector<SpecializedParameter> &params) {
+  std::vector<std::string> declaration;
+  for (const SpecializedParameter &param : params) {
+    declaration.push_back(absl::StrCat(
+        absl::StripAsciiWhitespace(param.desc->type), " ", param.desc->name));
+  }
+
+  std::string name = CamelCaseName(syscall.name);
+  *os << absl::StreamFormat("// %s(%s)\n\n", syscall.name,
+                            absl::StrJoin(declaration, ", "));
+  EmitSizeRoutine(os, syscall.name, name, "Request", "kIn", params);
+  EmitWriteRoutine(os, sysno, name, "Request", "kIn", params);
+  EmitSizeRoutine(os, syscall.name, name, "Response", "kOut", params);
+  EmitWriteRoutine(os, sysno, name, "Response", "kOut", params);
+  EmitParseRoutine(os, sysno, name, params);
+}
+
+// Emits a switch statement dispatching on a system call number to one
+// statement per specialized system call. |statement| is passed the camel case
+// name of each system call and its parameters converted from a ParameterList.
+void EmitDispatch(
+    std::ostream *os,
+    const std::map<int, std::vector<SpecializedParameter>> &specialized,
+    const std::function<std::string(const std::string &,
+                                    const std::vector<std::string> &)>
+        &statement,
+    const std::string &fallback) {
+  *os << "  switch (sysno) {\n";
+  for (const auto &entry : specialized) {
+    const SystemCallDescription &syscall = SystemCallTable()->at(entry.first);
+    std::vector<std::string> casts;
+    for (const SpecializedParameter &param : entry.second) {
+      casts.push_back(ParameterCast(param));
+    }
+    *os << absl::StreamFormat("    case %d:  // %s\n", entry.first,
+                              syscall.name);
+    *os << "      " << statement(CamelCaseName(syscall.name), casts) << "\n";
+  }
+  *os << "    default:\n";
+  *os << "      " << fallback << "\n";
+  *os << "  }\n";
+}
+
+// Emits typed marshalling routines for each specialized system call, along
+// with entry points dispatching on a system call number.
+void EmitMarshallers(std::ostream *os) {
+  std::map<int, std::vector<SpecializedParameter>> specialized;
+  for (const std::string &name : *SpecializedSystemCalls()) {
+    auto it = SystemCallTable()->begin();
+    while (it != SystemCallTable()->end() && it->second.name != name) {
+      ++it;
+    }
+    if (it == SystemCallTable()->end()) {
+      std::cerr << "Error: Unknown specialized system call \"" << name << "\"."
+                << std::endl;
+      exit(1);
+    }
+    specialized[it->first] = SpecializedParameters(it->second);
+  }
+
+  *os << "namespace {\n\n";
+  for (const auto &entry : specialized) {
+    EmitSpecializedSystemCall(os, entry.first,
+                              SystemCallTable()->at(entry.first),
+                              entry.second);
+  }
+  *os << "}  // namespace\n\n";
+
+  using Arguments = std::vector<std::string>;
+
+  *os << "bool IsSpecializedSystemCall(int sysno) {\n";
+  EmitDispatch(
+      os, specialized,
+      [](const std::string &name, const Arguments &casts) {
+        return "return true;";
+      },
+      "return false;");
+  *os << "}\n\n";
+
+  *os << "bool SpecializedRequestSize(int sysno, const ParameterList "
+         "&parameters,\n"
+         "                            size_t *size) {\n";
+  EmitDispatch(
+      os, specialized,
+      [](const std::string &name, const Arguments &casts) {
+        return absl::StrCat("return ", name, "RequestSize(",
+                            ArgumentList({}, casts, {"size"}), ");");
+      },
+      "return false;");
+  *os << "}\n\n";
+
+  *os << "void WriteSpecializedRequest(int sysno, const ParameterList "
+         "&parameters,\n"
+         "                             uint8_t *message) {\n";
+  EmitDispatch(
+      os, specialized,
+      [](const std::string &name, const Arguments &casts) {
+        return absl::StrCat("return Write", name, "Request(",
+                            ArgumentList({"message"}, casts), ");");
+      },
+      "abort();");
+  *os << "}\n\n";
+
+  *os << "bool SpecializedResponseSize(int sysno, const ParameterList "
+         "&parameters,\n"
+         "                             size_t *size) {\n";
+  EmitDispatch(
+      os, specialized,
+      [](const std::string &name, const Arguments &casts) {
+        return absl::StrCat("return ", name, "ResponseSize(",
+                            ArgumentList({}, casts, {"size"}), ");");
+      },
+      "return false;");
+  *os << "}\n\n";
+
+  *os << "void WriteSpecializedResponse(int sysno, uint64_t result,\n"
+         "                              uint64_t error_number,\n"
+         "                              const ParameterList &parameters,\n"
+         "                              uint8_t *message) {\n";
+  EmitDispatch(
+      os, specialized,
+      [](const std::string &name, const Arguments &casts) {
+        return absl::StrCat(
+            "return Write", name, "Response(",
+            ArgumentList({"message", "result", "error_number"}, casts), ");");
+      },
+      "abort();");
+  *os << "}\n\n";
+
+  *os << "bool ParseSpecializedResponse(int sysno, const ParameterList "
+         "&parameters,\n"
+         "                              primitives::Extent response) {\n";
+  EmitDispatch(
+      os, specialized,
+      [](const std::string &name, const Arguments &casts) {
+        return absl::StrCat("return Parse", name, "Response(",
+                            ArgumentList({"response"}, casts), ");");
+      },
+      "return false;");
+  *os << "}\n";
+}
+
 int main(int argc, char **argv) {
+  if (argc > 1 && strcmp(argv[1], "--marshallers") == 0) {
+    EmitMarshallers(&std::cout);
+    return 0;
+  }
+
   EmitSystemCallTable(&std::cout);
   std::cout << std::endl;
   EmitParameterTable(&std::cout);
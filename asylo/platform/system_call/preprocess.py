@@ -92,6 +92,7 @@ class SystemCallTable(object):
     self.parse_includes()
     self.parse_defines()
     self.parse_parameters()
+    self.parse_specializations()
 
   def parse_includes(self):
     """Collect each 'INCLUDE' directive in the input stream."""
@@ -99,6 +100,15 @@ class SystemCallTable(object):
     pattern = re.compile(r'INCLUDE\(\s*\"([^)]*)\"\s*\)')
     self.includes = re.findall(pattern, self.declarations)
 
+  def parse_specializations(self):
+    """Collect each 'SPECIALIZE' directive in the input stream."""
+
+    pattern = re.compile(r'SPECIALIZE\(\s*(\w+)\s*\)')
+    self.specializations = re.findall(pattern, self.declarations)
+    for syscall in self.specializations:
+      if syscall not in self.parameter_count:
+        raise ValueError('Cannot specialize undefined system call: ' + syscall)
+
   def parse_defines(self):
     """Parse each 'SYSCALL_DEFINE' directive in the input stream."""
 
@@ -151,7 +161,7 @@ class SystemCallTable(object):
           self.annotation_list.append((syscall, parameter_name, parameter_type,
                                        annotation[0], annotation[1]))
 
-        self.parameter_table[(syscall, i / 2)] = (parameter_name,
+        self.parameter_table[(syscall, i // 2)] = (parameter_name,
                                                   parameter_type)
 
   def write_includes(self):
@@ -170,13 +180,13 @@ class SystemCallTable(object):
       key = '{{"{}", "{}"}}'.format(syscall, param_name)
       if annotation_name == 'bound':
         bind_param_index = self.parameter_list[syscall].index(
-            annotation_value) / 2
+            annotation_value) // 2
         bounds.append('{{{}, {}}}'.format(key, bind_param_index))
       if annotation_name == 'count':
         counts.append('{{{}, {}}}'.format(key, annotation_value))
       if annotation_name == 'length':
         bind_param_index = self.parameter_list[syscall].index(
-            annotation_value) / 2
+            annotation_value) // 2
         element_size = 'sizeof({})'.format(param_type.strip('* '))
         index_and_size = '{{{}, {}}}'.format(bind_param_index, element_size)
         lengths.append('{{{}, {}}}'.format(key, index_and_size))
@@ -254,6 +264,12 @@ class SystemCallTable(object):
 
     print(',  \\\n'.join(lines))
 
+  def write_specializations(self):
+    """Writes the list of system calls with generated marshalling code."""
+    print('#define SPECIALIZED_SYSTEM_CALLS_INIT \\\n  ', end='')
+    names = ['"{}"'.format(name) for name in self.specializations]
+    print(', \\\n  '.join(names))
+
   def write_tables(self):
     self.write_includes()
     print()
@@ -264,6 +280,8 @@ class SystemCallTable(object):
     self.write_syscalls()
     print()
     self.write_parameters()
+    print()
+    self.write_specializations()
 
 
 syscalls = SystemCallTable(sys.stdin)
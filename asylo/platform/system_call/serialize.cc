@@ -25,6 +25,7 @@
 #include "absl/strings/str_cat.h"
 #include "asylo/platform/system_call/message.h"
 #include "asylo/platform/system_call/metadata.h"
+#include "asylo/platform/system_call/specialized_serialize.h"
 
 namespace asylo {
 namespace system_call {
@@ -49,8 +50,15 @@ primitives::PrimitiveStatus SerializeRequest(
                      sysno, ") provided.")};
   }
 
+  size_t size;
+  if (SpecializedRequestSize(sysno, parameters, &size)) {
+    *request = {reinterpret_cast<uint8_t *>(malloc(size)), size};
+    WriteSpecializedRequest(sysno, parameters, request->As<uint8_t>());
+    return primitives::PrimitiveStatus::OkStatus();
+  }
+
   auto writer = MessageWriter::RequestWriter(sysno, parameters);
-  size_t size = writer.MessageSize();
+  size = writer.MessageSize();
 
   *request = {reinterpret_cast<uint8_t *>(malloc(size)), size};
 
@@ -71,9 +79,17 @@ primitives::PrimitiveStatus SerializeResponse(
                      sysno, ") provided.")};
   }
 
+  size_t size;
+  if (SpecializedResponseSize(sysno, parameters, &size)) {
+    *response = {reinterpret_cast<uint8_t *>(malloc(size)), size};
+    WriteSpecializedResponse(sysno, result, error_number, parameters,
+                             response->As<uint8_t>());
+    return primitives::PrimitiveStatus::OkStatus();
+  }
+
   auto writer =
       MessageWriter::ResponseWriter(sysno, result, error_number, parameters);
-  size_t size = writer.MessageSize();
+  size = writer.MessageSize();
 
   *response = {reinterpret_cast<uint8_t *>(malloc(size)), size};
 
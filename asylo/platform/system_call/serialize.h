@@ -33,7 +33,9 @@ using ParameterList = std::array<uint64_t, kParameterMax>;
 
 // Serializes a system call request specified by a system call number and a list
 // of parameters into a buffer. On success, `request` is populated with a buffer
-// allocated by malloc and owned by the caller.
+// allocated by malloc and owned by the caller. System calls with generated
+// marshalling routines (see specialized_serialize.h) are serialized by those
+// routines, and all others are interpreted from the metadata tables.
 primitives::PrimitiveStatus SerializeRequest(int sysno,
                                              const ParameterList &parameters,
                                              primitives::Extent *request);
@@ -0,0 +1,181 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/system_call/specialized_serialize.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "asylo/platform/system_call/message.h"
+
+namespace asylo {
+namespace system_call {
+
+namespace {
+
+// Returns the smallest multiple of 8 greater than or equal to |value|.
+constexpr size_t RoundUpToMultipleOf8(size_t value) {
+  return (value + 7) / 8 * 8;
+}
+
+// Adds |size| bytes, padded to a multiple of 8, to |*message_size|. Returns
+// false if the result overflows.
+bool AddSize(size_t size, size_t *message_size) {
+  if (*message_size > SIZE_MAX - 7 || size > SIZE_MAX - 7 - *message_size) {
+    return false;
+  }
+  *message_size += RoundUpToMultipleOf8(size);
+  return true;
+}
+
+// Adds the encoded size of a buffer of |count| elements of |element_size| bytes
+// to |*message_size|. Null buffers are encoded with a size of zero.
+bool AddBoundedSize(const void *value, uint64_t count, size_t element_size,
+                    size_t *message_size) {
+  if (value == nullptr) {
+    return true;
+  }
+  if (element_size != 0 && count > SIZE_MAX / element_size) {
+    return false;
+  }
+  return AddSize(count * element_size, message_size);
+}
+
+// Adds the encoded size of a null-terminated string to |*message_size|.
+bool AddStringSize(const char *value, size_t *message_size) {
+  return value == nullptr || AddSize(strlen(value) + 1, message_size);
+}
+
+// Writes a message header and returns the offset of the first parameter.
+size_t InitializeMessage(uint8_t *message, int sysno, uint32_t flags,
+                         uint64_t result, uint64_t error_number) {
+  auto *header = reinterpret_cast<MessageHeader *>(message);
+  memset(header, 0, sizeof(MessageHeader));
+  header->magic = kMessageMagic;
+  header->flags = flags;
+  header->sysno = sysno;
+  header->result = result;
+  header->error_number = error_number;
+  return sizeof(MessageHeader);
+}
+
+size_t InitializeRequest(uint8_t *message, int sysno) {
+  return InitializeMessage(message, sysno, kSystemCallRequest, 0, 0);
+}
+
+size_t InitializeResponse(uint8_t *message, int sysno, uint64_t result,
+                          uint64_t error_number) {
+  return InitializeMessage(message, sysno, kSystemCallResponse, result,
+                           error_number);
+}
+
+// Writes a scalar parameter at |*offset| and advances |*offset| past it.
+void WriteScalar(uint8_t *message, int index, uint64_t value, size_t *offset) {
+  auto *header = reinterpret_cast<MessageHeader *>(message);
+  memcpy(message + *offset, &value, sizeof(value));
+  header->offset[index] = *offset;
+  header->size[index] = sizeof(value);
+  *offset += sizeof(value);
+}
+
+// Writes |size| bytes of a pointer parameter at |*offset| and advances
+// |*offset| past it. Null pointers are encoded with a size of zero.
+void WriteBuffer(uint8_t *message, int index, const void *value, size_t size,
+                 size_t *offset) {
+  auto *header = reinterpret_cast<MessageHeader *>(message);
+  if (value == nullptr) {
+    size = 0;
+  }
+  size_t padded_size = RoundUpToMultipleOf8(size);
+  if (size > 0) {
+    // Clear the trailing padding so no stale bytes are copied out of the
+    // enclave when the message buffer is reused.
+    memset(message + *offset + padded_size - sizeof(uint64_t), 0,
+           sizeof(uint64_t));
+    memcpy(message + *offset, value, size);
+  }
+  header->offset[index] = *offset;
+  header->size[index] = size;
+  *offset += padded_size;
+}
+
+// Writes a null-terminated string parameter at |*offset| and advances |*offset|
+// past it.
+void WriteString(uint8_t *message, int index, const char *value,
+                 size_t *offset) {
+  WriteBuffer(message, index, value, value ? strlen(value) + 1 : 0, offset);
+}
+
+// Checks that |response| carries a response header for |sysno| and sets
+// |*offset| to the offset of its first parameter.
+bool CheckResponseHeader(primitives::Extent response, int sysno,
+                         size_t *offset) {
+  if (response.size() < sizeof(MessageHeader)) {
+    return false;
+  }
+  const auto *header = reinterpret_cast<const MessageHeader *>(response.data());
+  if (header->magic != kMessageMagic ||
+      header->flags != kSystemCallResponse ||
+      header->sysno != static_cast<uint32_t>(sysno)) {
+    return false;
+  }
+  *offset = sizeof(MessageHeader);
+  return true;
+}
+
+// Checks that the parameter at |index| is encoded at |*offset| with exactly
+// |size| bytes, copies it to |value| if non-null, and advances |*offset| past
+// it. A null |value| is expected to be encoded with a size of zero, matching
+// WriteBuffer().
+bool ReadBuffer(primitives::Extent response, int index, void *value,
+                size_t size, size_t *offset) {
+  if (value == nullptr) {
+    size = 0;
+  }
+  const auto *header = reinterpret_cast<const MessageHeader *>(response.data());
+  if (header->offset[index] != *offset || header->size[index] != size ||
+      *offset > response.size() || size > response.size() - *offset) {
+    return false;
+  }
+  if (size > 0) {
+    memcpy(value, response.As<uint8_t>() + *offset, size);
+  }
+  *offset += RoundUpToMultipleOf8(size);
+  return true;
+}
+
+// As ReadBuffer(), for a buffer of |count| elements of |element_size| bytes.
+bool ReadBoundedBuffer(primitives::Extent response, int index, void *value,
+                       uint64_t count, size_t element_size, size_t *offset) {
+  if (value == nullptr) {
+    return ReadBuffer(response, index, value, 0, offset);
+  }
+  if (element_size != 0 && count > SIZE_MAX / element_size) {
+    return false;
+  }
+  return ReadBuffer(response, index, value, count * element_size, offset);
+}
+
+}  // namespace
+
+// Include the marshalling routines generated at build time.
+#include "asylo/platform/system_call/generated_marshallers.inc"
+
+}  // namespace system_call
+}  // namespace asylo
@@ -0,0 +1,75 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ASYLO_PLATFORM_SYSTEM_CALL_SPECIALIZED_SERIALIZE_H_
+#define ASYLO_PLATFORM_SYSTEM_CALL_SPECIALIZED_SERIALIZE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "asylo/platform/primitives/extent.h"
+#include "asylo/platform/system_call/serialize.h"
+
+namespace asylo {
+namespace system_call {
+
+// This file declares entry points into marshalling routines generated at build
+// time for each system call named by a SPECIALIZE directive in syscalls.txt.
+// The generated routines produce and consume the same wire format as
+// MessageWriter and MessageReader, but with the message layout of each system
+// call resolved at build time rather than interpreted from the metadata tables.
+
+// Returns true if generated marshalling routines are available for `sysno`.
+bool IsSpecializedSystemCall(int sysno);
+
+// Computes the size of a request message for the system call `sysno` invoked
+// with `parameters`. Returns false if `sysno` is not specialized or the size of
+// the message is not representable, in which case the caller should fall back
+// to the table-driven serializer.
+bool SpecializedRequestSize(int sysno, const ParameterList &parameters,
+                            size_t *size);
+
+// Writes a request message for the system call `sysno` invoked with
+// `parameters` into `message`, which must be 8-byte aligned and at least as
+// large as the size reported by SpecializedRequestSize().
+void WriteSpecializedRequest(int sysno, const ParameterList &parameters,
+                             uint8_t *message);
+
+// As SpecializedRequestSize(), but for a response message.
+bool SpecializedResponseSize(int sysno, const ParameterList &parameters,
+                             size_t *size);
+
+// As WriteSpecializedRequest(), but writes a response message carrying `result`
+// and `error_number`.
+void WriteSpecializedResponse(int sysno, uint64_t result,
+                              uint64_t error_number,
+                              const ParameterList &parameters,
+                              uint8_t *message);
+
+// Validates `response` as a response to the system call `sysno` invoked with
+// `parameters`, and copies each output parameter from the response into the
+// buffer it was passed in. Returns false if `sysno` is not specialized or if
+// `response` is malformed, in which case no guarantee is made about the
+// contents of the output buffers.
+bool ParseSpecializedResponse(int sysno, const ParameterList &parameters,
+                              primitives::Extent response);
+
+}  // namespace system_call
+}  // namespace asylo
+
+#endif  // ASYLO_PLATFORM_SYSTEM_CALL_SPECIALIZED_SERIALIZE_H_
@@ -0,0 +1,160 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/platform/system_call/message.h"
+#include "asylo/platform/system_call/metadata.h"
+#include "asylo/platform/system_call/serialize.h"
+#include "asylo/platform/system_call/specialized_serialize.h"
+#include "asylo/util/logging.h"
+
+namespace asylo {
+namespace system_call {
+namespace {
+
+// Number of messages marshalled by each measurement.
+constexpr int kBenchmarkIterations = 100000;
+
+// Buffers referenced by the parameters of the test cases below.
+char io_buffer[512];
+const char kWriteData[] = "Specialized system call marshalling";
+struct stat stat_buffer;
+struct timespec timespec_buffer;
+struct epoll_event epoll_events[16];
+
+// A system call invocation exercising a specialized marshaller.
+struct SystemCallCase {
+  std::string name;
+  int sysno;
+  ParameterList parameters;
+};
+
+std::vector<SystemCallCase> SystemCallCases() {
+  return {
+      {"read", SYS_read, {3, reinterpret_cast<uint64_t>(io_buffer), 512}},
+      {"write",
+       SYS_write,
+       {1, reinterpret_cast<uint64_t>(kWriteData), sizeof(kWriteData)}},
+      {"pread64",
+       SYS_pread64,
+       {3, reinterpret_cast<uint64_t>(io_buffer), 512, 4096}},
+      {"fstat", SYS_fstat, {0, reinterpret_cast<uint64_t>(&stat_buffer)}},
+      {"clock_gettime",
+       SYS_clock_gettime,
+       {CLOCK_MONOTONIC, reinterpret_cast<uint64_t>(&timespec_buffer)}},
+      {"epoll_wait",
+       SYS_epoll_wait,
+       {5, reinterpret_cast<uint64_t>(epoll_events), 16,
+        static_cast<uint64_t>(-1)}},
+  };
+}
+
+// Encodes a message with the table-driven MessageWriter into a zero-filled
+// buffer.
+std::vector<uint8_t> TableDrivenEncoding(const MessageWriter &writer) {
+  std::vector<uint8_t> message(writer.MessageSize());
+  primitives::Extent extent{message.data(), message.size()};
+  writer.Write(&extent);
+  return message;
+}
+
+// Copies the output parameters of a validated response message into their
+// destination buffers, as enc_untrusted_syscall does for system calls without
+// a specialized marshaller.
+void CopyOutputParameters(int sysno, const ParameterList &parameters,
+                          const MessageReader &reader) {
+  SystemCallDescriptor descriptor(sysno);
+  for (int i = 0; i < kParameterMax; i++) {
+    ParameterDescriptor parameter = descriptor.parameter(i);
+    if (parameter.is_out() && parameters[i] != 0) {
+      size_t size = parameter.is_fixed() ? parameter.size()
+                                         : parameters[parameter.size()] *
+                                               parameter.element_size();
+      memcpy(reinterpret_cast<void *>(parameters[i]),
+             reader.parameter_address(i), size);
+    }
+  }
+}
+
+class SpecializedSerializeBenchmark
+    : public ::testing::TestWithParam<SystemCallCase> {};
+
+// Compares the cost of marshalling a request and unmarshalling its response
+// with the table-driven serializer against the generated marshaller.
+TEST_P(SpecializedSerializeBenchmark, MarshallingCost) {
+  const SystemCallCase &test_case = GetParam();
+  const int sysno = test_case.sysno;
+  const ParameterList &parameters = test_case.parameters;
+  std::vector<uint8_t> response = TableDrivenEncoding(
+      MessageWriter::ResponseWriter(sysno, 0, 0, parameters));
+  primitives::Extent response_extent{response.data(), response.size()};
+
+  absl::Time start = absl::Now();
+  for (int i = 0; i < kBenchmarkIterations; i++) {
+    MessageWriter writer = MessageWriter::RequestWriter(sysno, parameters);
+    primitives::Extent request{
+        reinterpret_cast<uint8_t *>(malloc(writer.MessageSize())),
+        writer.MessageSize()};
+    writer.Write(&request);
+    free(request.data());
+
+    MessageReader reader(response_extent);
+    ASSERT_TRUE(reader.Validate().ok());
+    CopyOutputParameters(sysno, parameters, reader);
+  }
+  absl::Duration table_driven = (absl::Now() - start) / kBenchmarkIterations;
+
+  alignas(8) uint8_t request_buffer[2048];
+  start = absl::Now();
+  for (int i = 0; i < kBenchmarkIterations; i++) {
+    size_t size;
+    ASSERT_TRUE(SpecializedRequestSize(sysno, parameters, &size));
+    ASSERT_LE(size, sizeof(request_buffer));
+    WriteSpecializedRequest(sysno, parameters, request_buffer);
+
+    ASSERT_TRUE(ParseSpecializedResponse(sysno, parameters, response_extent));
+  }
+  absl::Duration specialized = (absl::Now() - start) / kBenchmarkIterations;
+
+  LOG(INFO) << test_case.name << ": table-driven " << table_driven
+            << " per call, specialized " << specialized << " per call";
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllSpecializedSystemCalls, SpecializedSerializeBenchmark,
+    ::testing::ValuesIn(SystemCallCases()),
+    [](const ::testing::TestParamInfo<SystemCallCase> &info) {
+      return info.param.name;
+    });
+
+}  // namespace
+}  // namespace system_call
+}  // namespace asylo
@@ -0,0 +1,241 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "asylo/platform/system_call/specialized_serialize.h"
+
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "asylo/platform/system_call/message.h"
+#include "asylo/platform/system_call/metadata.h"
+#include "asylo/platform/system_call/serialize.h"
+
+namespace asylo {
+namespace system_call {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::Eq;
+
+// Buffers referenced by the parameters of the test cases below.
+char io_buffer[512];
+const char kWriteData[] = "Specialized system call marshalling";
+struct stat stat_buffer;
+struct timespec timespec_buffer;
+struct epoll_event epoll_events[16];
+
+// A system call invocation exercising a specialized marshaller.
+struct SystemCallCase {
+  std::string name;
+  int sysno;
+  ParameterList parameters;
+};
+
+std::vector<SystemCallCase> SystemCallCases() {
+  return {
+      {"read", SYS_read, {3, reinterpret_cast<uint64_t>(io_buffer), 512}},
+      {"write",
+       SYS_write,
+       {1, reinterpret_cast<uint64_t>(kWriteData), sizeof(kWriteData)}},
+      {"pread64",
+       SYS_pread64,
+       {3, reinterpret_cast<uint64_t>(io_buffer), 512, 4096}},
+      {"fstat", SYS_fstat, {0, reinterpret_cast<uint64_t>(&stat_buffer)}},
+      {"clock_gettime",
+       SYS_clock_gettime,
+       {CLOCK_MONOTONIC, reinterpret_cast<uint64_t>(&timespec_buffer)}},
+      {"epoll_wait",
+       SYS_epoll_wait,
+       {5, reinterpret_cast<uint64_t>(epoll_events), 16,
+        static_cast<uint64_t>(-1)}},
+  };
+}
+
+// Encodes a message with the table-driven MessageWriter into a zero-filled
+// buffer.
+std::vector<uint8_t> TableDrivenEncoding(const MessageWriter &writer) {
+  std::vector<uint8_t> message(writer.MessageSize());
+  primitives::Extent extent{message.data(), message.size()};
+  writer.Write(&extent);
+  return message;
+}
+
+class SpecializedSerializeTest
+    : public ::testing::TestWithParam<SystemCallCase> {};
+
+TEST_P(SpecializedSerializeTest, RequestMatchesTableDrivenEncoding) {
+  const SystemCallCase &test_case = GetParam();
+  ASSERT_TRUE(IsSpecializedSystemCall(test_case.sysno));
+
+  size_t size;
+  ASSERT_TRUE(
+      SpecializedRequestSize(test_case.sysno, test_case.parameters, &size));
+  std::vector<uint8_t> message(size);
+  WriteSpecializedRequest(test_case.sysno, test_case.parameters,
+                          message.data());
+
+  EXPECT_TRUE(MessageReader({message.data(), message.size()}).Validate().ok());
+  EXPECT_THAT(message,
+              ElementsAreArray(TableDrivenEncoding(MessageWriter::RequestWriter(
+                  test_case.sysno, test_case.parameters))));
+}
+
+TEST_P(SpecializedSerializeTest, ResponseMatchesTableDrivenEncoding) {
+  const SystemCallCase &test_case = GetParam();
+
+  size_t size;
+  ASSERT_TRUE(
+      SpecializedResponseSize(test_case.sysno, test_case.parameters, &size));
+  std::vector<uint8_t> message(size);
+  WriteSpecializedResponse(test_case.sysno, /*result=*/7, /*error_number=*/0,
+                           test_case.parameters, message.data());
+
+  EXPECT_TRUE(MessageReader({message.data(), message.size()}).Validate().ok());
+  EXPECT_THAT(message, ElementsAreArray(TableDrivenEncoding(
+                           MessageWriter::ResponseWriter(
+                               test_case.sysno, /*result=*/7,
+                               /*error_number=*/0, test_case.parameters))));
+}
+
+TEST_P(SpecializedSerializeTest, ParsesTableDrivenResponse) {
+  const SystemCallCase &test_case = GetParam();
+  std::vector<uint8_t> response =
+      TableDrivenEncoding(MessageWriter::ResponseWriter(
+          test_case.sysno, /*result=*/0, /*error_number=*/0,
+          test_case.parameters));
+  EXPECT_TRUE(ParseSpecializedResponse(test_case.sysno, test_case.parameters,
+                                       {response.data(), response.size()}));
+}
+
+TEST_P(SpecializedSerializeTest, RejectsMalformedResponses) {
+  const SystemCallCase &test_case = GetParam();
+  std::vector<uint8_t> response =
+      TableDrivenEncoding(MessageWriter::ResponseWriter(
+          test_case.sysno, /*result=*/0, /*error_number=*/0,
+          test_case.parameters));
+
+  // Truncated header.
+  EXPECT_FALSE(ParseSpecializedResponse(
+      test_case.sysno, test_case.parameters,
+      {response.data(), sizeof(MessageHeader) - 1}));
+
+  // Response to a different system call.
+  auto *header = reinterpret_cast<MessageHeader *>(response.data());
+  header->sysno = SYS_getpid;
+  EXPECT_FALSE(ParseSpecializedResponse(test_case.sysno, test_case.parameters,
+                                        {response.data(), response.size()}));
+  header->sysno = test_case.sysno;
+
+  // Request rather than a response.
+  header->flags = kSystemCallRequest;
+  EXPECT_FALSE(ParseSpecializedResponse(test_case.sysno, test_case.parameters,
+                                        {response.data(), response.size()}));
+  header->flags = kSystemCallResponse;
+
+  // Output parameter extending past the end of the message.
+  if (response.size() > sizeof(MessageHeader)) {
+    EXPECT_FALSE(ParseSpecializedResponse(
+        test_case.sysno, test_case.parameters,
+        {response.data(), response.size() - 8}));
+    header->size[1] += 8;
+    EXPECT_FALSE(ParseSpecializedResponse(test_case.sysno,
+                                          test_case.parameters,
+                                          {response.data(), response.size()}));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllSpecializedSystemCalls, SpecializedSerializeTest,
+    ::testing::ValuesIn(SystemCallCases()),
+    [](const ::testing::TestParamInfo<SystemCallCase> &info) {
+      return info.param.name;
+    });
+
+TEST(SpecializedSerializeTest, OnlySpecializedSystemCallsAreHandled) {
+  ParameterList parameters = {};
+  size_t size;
+  EXPECT_FALSE(IsSpecializedSystemCall(SYS_getpid));
+  EXPECT_FALSE(SpecializedRequestSize(SYS_getpid, parameters, &size));
+  EXPECT_FALSE(SpecializedResponseSize(SYS_getpid, parameters, &size));
+  EXPECT_FALSE(ParseSpecializedResponse(SYS_getpid, parameters, {}));
+}
+
+TEST(SpecializedSerializeTest, RejectsOverflowingRequestSize) {
+  ParameterList parameters = {1, reinterpret_cast<uint64_t>(kWriteData),
+                              UINT64_MAX};
+  size_t size;
+  EXPECT_FALSE(SpecializedRequestSize(SYS_write, parameters, &size));
+}
+
+TEST(SpecializedSerializeTest, NullBuffersAreEncodedWithZeroSize) {
+  ParameterList parameters = {1, 0, 0};
+  size_t size;
+  ASSERT_TRUE(SpecializedRequestSize(SYS_write, parameters, &size));
+  EXPECT_THAT(size, Eq(sizeof(MessageHeader) + 2 * sizeof(uint64_t)));
+
+  std::vector<uint8_t> message(size);
+  WriteSpecializedRequest(SYS_write, parameters, message.data());
+  MessageReader reader({message.data(), message.size()});
+  EXPECT_TRUE(reader.Validate().ok());
+  EXPECT_THAT(reader.parameter_size(1), Eq(0));
+}
+
+TEST(SpecializedSerializeTest, ParsesResponseWithNullOutputBuffers) {
+  std::vector<SystemCallCase> test_cases = {
+      {"read", SYS_read, {3, 0, 512}},
+      {"read", SYS_read, {3, 0, 0}},
+      {"fstat", SYS_fstat, {0, 0}},
+      {"clock_gettime", SYS_clock_gettime, {CLOCK_MONOTONIC, 0}},
+      {"epoll_wait", SYS_epoll_wait, {5, 0, 16, 0}},
+  };
+  for (const SystemCallCase &test_case : test_cases) {
+    std::vector<uint8_t> response =
+        TableDrivenEncoding(MessageWriter::ResponseWriter(
+            test_case.sysno, -1, EFAULT, test_case.parameters));
+    auto *header = reinterpret_cast<MessageHeader *>(response.data());
+    EXPECT_THAT(header->size[1], Eq(0)) << test_case.name;
+
+    size_t size;
+    ASSERT_TRUE(SpecializedResponseSize(test_case.sysno, test_case.parameters,
+                                        &size))
+        << test_case.name;
+    EXPECT_THAT(size, Eq(response.size())) << test_case.name;
+    EXPECT_TRUE(ParseSpecializedResponse(test_case.sysno, test_case.parameters,
+                                         {response.data(), response.size()}))
+        << test_case.name;
+
+    // A null destination does not accept a non-empty encoding.
+    header->size[1] = 8;
+    EXPECT_FALSE(ParseSpecializedResponse(test_case.sysno,
+                                          test_case.parameters,
+                                          {response.data(), response.size()}))
+        << test_case.name;
+  }
+}
+
+}  // namespace
+}  // namespace system_call
+}  // namespace asylo
@@ -23,18 +23,38 @@
 #include <array>
 #include <cstdarg>
 #include <cstdint>
-#include <memory>
 
+#include "asylo/platform/primitives/util/scratch_buffer.h"
 #include "asylo/platform/system_call/metadata.h"
 #include "asylo/platform/system_call/serialize.h"
+#include "asylo/platform/system_call/specialized_serialize.h"
 #include "asylo/platform/system_call/type_conversions/types_functions.h"
 
 namespace {
 
-// Deleter object for malloc() allocated buffers.
-struct MallocDeleter {
-  void operator()(uint8_t *buffer) { free(buffer); }
-};
+// Copies the output parameters of a validated response message back into the
+// buffers passed to the system call.
+void CopyOutputParameters(
+    const asylo::system_call::SystemCallDescriptor &descriptor,
+    const asylo::system_call::ParameterList &parameters,
+    const asylo::system_call::MessageReader &response_reader) {
+  for (int i = 0; i < asylo::system_call::kParameterMax; i++) {
+    asylo::system_call::ParameterDescriptor parameter = descriptor.parameter(i);
+    if (parameter.is_out()) {
+      size_t size;
+      if (parameter.is_fixed()) {
+        size = parameter.size();
+      } else {
+        size = parameters[parameter.size()] * parameter.element_size();
+      }
+      const void *src = response_reader.parameter_address(i);
+      void *dst = reinterpret_cast<void *>(parameters[i]);
+      if (dst != nullptr) {
+        memcpy(dst, src, size);
+      }
+    }
+  }
+}
 
 // Default abort handler if none provided.
 void default_error_handler(const char *message) { abort(); }
@@ -78,18 +98,35 @@ extern "C" int64_t enc_untrusted_syscall(int sysno, ...) {
   }
   va_end(args);
 
-  // Allocate a buffer for the serialized request.
-  asylo::primitives::Extent request;
-  asylo::primitives::PrimitiveStatus status;
-  status = asylo::system_call::SerializeRequest(sysno, parameters, &request);
-  if (!status.ok()) {
+  // Serialize the request into the per-thread scratch buffer, which is reused
+  // across system calls so that the steady state performs no allocation.
+  bool specialized = asylo::system_call::IsSpecializedSystemCall(sysno);
+  size_t request_size;
+  if (!specialized || !asylo::system_call::SpecializedRequestSize(
+                          sysno, parameters, &request_size)) {
+    specialized = false;
+    request_size =
+        asylo::system_call::MessageWriter::RequestWriter(sysno, parameters)
+            .MessageSize();
+  }
+  asylo::primitives::Extent request{
+      asylo::primitives::AcquireScratchBuffer(
+          asylo::primitives::ScratchSlot::kRequest, request_size),
+      request_size};
+  if (request.data() == nullptr) {
+    error_handler("system_call.cc: Failed to allocate the request buffer.");
+  }
+  if (specialized) {
+    asylo::system_call::WriteSpecializedRequest(sysno, parameters,
+                                                request.As<uint8_t>());
+  } else if (!asylo::system_call::MessageWriter::RequestWriter(sysno,
+                                                               parameters)
+                  .Write(&request)) {
     error_handler(
         "system_call.cc: Encountered serialization error when serializing "
         "syscall parameters.");
   }
 
-  std::unique_ptr<uint8_t, MallocDeleter> request_owner(request.As<uint8_t>());
-
   // Invoke the system call dispatch callback to execute the system call.
   uint8_t *response_buffer;
   size_t response_size;
@@ -97,15 +134,16 @@ extern "C" int64_t enc_untrusted_syscall(int sysno, ...) {
   if (!enc_is_syscall_dispatcher_set()) {
     error_handler("system_.cc: system call dispatcher not set.");
   }
-  status = global_syscall_callback(request.As<uint8_t>(), request.size(),
-                                   &response_buffer, &response_size);
+  asylo::primitives::PrimitiveStatus status =
+      global_syscall_callback(request.As<uint8_t>(), request.size(),
+                              &response_buffer, &response_size);
+  asylo::primitives::ReleaseScratchBuffer(
+      asylo::primitives::ScratchSlot::kRequest, request.data());
   if (!status.ok()) {
     error_handler(
         "system_call.cc: Callback from syscall dispatcher was unsuccessful.");
   }
 
-  std::unique_ptr<uint8_t, MallocDeleter> response_owner(response_buffer);
-
   if (!response_buffer) {
     error_handler(
         "system_call.cc: null response buffer received for the syscall.");
@@ -114,34 +152,29 @@ extern "C" int64_t enc_untrusted_syscall(int sysno, ...) {
   // Copy outputs back into pointer parameters.
   auto response_reader =
       asylo::system_call::MessageReader({response_buffer, response_size});
-  const asylo::primitives::PrimitiveStatus response_status =
-      response_reader.Validate();
-  if (!response_status.ok()) {
-    error_handler(
-        "system_call.cc: Error deserializing response buffer into response "
-        "reader.");
-  }
-
-  for (int i = 0; i < asylo::system_call::kParameterMax; i++) {
-    asylo::system_call::ParameterDescriptor parameter = descriptor.parameter(i);
-    if (parameter.is_out()) {
-      size_t size;
-      if (parameter.is_fixed()) {
-        size = parameter.size();
-      } else {
-        size = parameters[parameter.size()] * parameter.element_size();
-      }
-      const void *src = response_reader.parameter_address(i);
-      void *dst = reinterpret_cast<void *>(parameters[i]);
-      if (dst != nullptr) {
-        memcpy(dst, src, size);
-      }
+  if (specialized) {
+    if (!asylo::system_call::ParseSpecializedResponse(
+            sysno, parameters, {response_buffer, response_size})) {
+      error_handler(
+          "system_call.cc: Error deserializing response buffer for "
+          "specialized syscall.");
+    }
+  } else {
+    const asylo::primitives::PrimitiveStatus response_status =
+        response_reader.Validate();
+    if (!response_status.ok()) {
+      error_handler(
+          "system_call.cc: Error deserializing response buffer into response "
+          "reader.");
     }
+    CopyOutputParameters(descriptor, parameters, response_reader);
   }
 
   uint64_t result = response_reader.header()->result;
+  int klinux_errno = response_reader.header()->error_number;
+  asylo::primitives::ReleaseScratchBuffer(
+      asylo::primitives::ScratchSlot::kResponse, response_buffer);
   if (static_cast<int64_t>(result) == -1) {
-    int klinux_errno = response_reader.header()->error_number;
 
     // Simply having a return value of -1 from a syscall is not a necessary
     // condition that the syscall failed. Some syscalls can return -1 when
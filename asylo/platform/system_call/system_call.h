@@ -31,8 +31,10 @@ extern "C" {
 // Callback type installed at runtime to dispatch a system call across the
 // enclave boundary. `request_buffer` and `request_size` designate a system call
 // request owned by the caller, and on success `response_buffer` and
-// `response_size` are populated with a response allocated by malloc() on the
-// trusted heap.
+// `response_size` are populated with a response on the trusted heap, either
+// acquired with asylo::primitives::AcquireScratchBuffer() for the kResponse
+// slot or allocated by malloc(). The response is released with
+// asylo::primitives::ReleaseScratchBuffer().
 typedef asylo::primitives::PrimitiveStatus (*syscall_dispatch_callback)(
     const uint8_t *request_buffer, size_t request_size,
     uint8_t **response_buffer, size_t *response_size);
@@ -178,6 +178,16 @@ struct klinux_epoll_event {
   klinux_epoll_data_t data;
 } ABSL_ATTRIBUTE_PACKED;
 
+// Layout of an event read from an inotify file descriptor, followed by
+// klinux_len bytes of null-padded name.
+struct klinux_inotify_event {
+  int32_t klinux_wd;
+  uint32_t klinux_mask;
+  uint32_t klinux_cookie;
+  uint32_t klinux_len;
+  char klinux_name[];
+};
+
 struct klinux_rusage {
   struct kLinux_timeval ru_utime;
   struct kLinux_timeval ru_stime;
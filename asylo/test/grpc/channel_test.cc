@@ -39,6 +39,15 @@ constexpr char kInput[] = "foobar";
 constexpr char kAddress[] = "[::1]";
 const int64_t kDeadlineMicros = absl::Seconds(10) / absl::Microseconds(1);
 
+// Size of the payload of each RPC in the bulk-transfer test.
+constexpr size_t kBulkPayloadSize = 1 << 20;
+
+// Number of RPCs made by the bulk-transfer test.
+constexpr int kBulkTransferCount = 4;
+
+// Maximum record frame size used by the large-frame enclave credentials.
+constexpr size_t kLargeRecordFrameSize = 1 << 20;
+
 struct CredentialsConfig {
   std::shared_ptr<::grpc::ChannelCredentials> channel_credentials;
   std::shared_ptr<::grpc::ServerCredentials> server_credentials;
@@ -60,6 +69,15 @@ struct EnclaveCredentialsConfig : public CredentialsConfig {
   }
 };
 
+struct EnclaveLargeFrameCredentialsConfig : public CredentialsConfig {
+  EnclaveLargeFrameCredentialsConfig() {
+    EnclaveCredentialsOptions options = BidirectionalNullCredentialsOptions();
+    options.max_record_frame_size = kLargeRecordFrameSize;
+    channel_credentials = EnclaveChannelCredentials(options);
+    server_credentials = EnclaveServerCredentials(options);
+  }
+};
+
 // A test fixture is required for typed tests.
 template <typename ConfigT>
 class ChannelTest : public ::testing::Test {
@@ -78,7 +96,8 @@ class ChannelTest : public ::testing::Test {
 };
 
 using TestTypes =
-    ::testing::Types<InsecureCredentialsConfig, EnclaveCredentialsConfig>;
+    ::testing::Types<InsecureCredentialsConfig, EnclaveCredentialsConfig,
+                     EnclaveLargeFrameCredentialsConfig>;
 TYPED_TEST_SUITE(ChannelTest, TestTypes);
 
 TYPED_TEST(ChannelTest, EndToEnd) {
@@ -119,5 +138,48 @@ TYPED_TEST(ChannelTest, EndToEnd) {
   ASSERT_THAT(launcher.Shutdown(), IsOk());
 }
 
+// Verifies that RPCs with payloads spanning many record frames are delivered
+// intact over each type of credentials.
+TYPED_TEST(ChannelTest, BulkTransfer) {
+  GrpcServerLauncher launcher("ChannelTest");
+  TypeParam config = TypeParam();
+  int port = 0;
+  std::string server_address = absl::StrCat(kAddress, ":", port);
+
+  ASSERT_THAT(
+      launcher.RegisterService(absl::make_unique<test::MessengerServer1>()),
+      IsOk());
+  ASSERT_THAT(launcher.AddListeningPort(server_address,
+                                        config.server_credentials, &port),
+              IsOk());
+  ASSERT_THAT(launcher.Start(), IsOk());
+  ASSERT_NE(port, 0);
+  server_address = absl::StrCat(kAddress, ":", port);
+
+  std::shared_ptr<::grpc::Channel> channel =
+      ::grpc::CreateChannel(server_address, config.channel_credentials);
+  gpr_timespec absolute_deadline =
+      gpr_time_add(gpr_now(GPR_CLOCK_REALTIME),
+                   gpr_time_from_micros(kDeadlineMicros, GPR_TIMESPAN));
+  ASSERT_TRUE(channel->WaitForConnected(absolute_deadline));
+
+  // Use the stub directly, since MessengerClient logs every response.
+  std::unique_ptr<test::Messenger1::Stub> stub =
+      test::Messenger1::NewStub(channel);
+  test::HelloRequest request;
+  request.set_name(std::string(kBulkPayloadSize, 'x'));
+
+  for (int i = 0; i < kBulkTransferCount; ++i) {
+    ::grpc::ClientContext context;
+    test::HelloResponse response;
+    ::grpc::Status status = stub->Hello(&context, request, &response);
+    ASSERT_TRUE(status.ok()) << status.error_message();
+    EXPECT_EQ(response.message(),
+              test::MessengerServer1::ResponseString(request.name()));
+  }
+
+  ASSERT_THAT(launcher.Shutdown(), IsOk());
+}
+
 }  // namespace
 }  // namespace asylo
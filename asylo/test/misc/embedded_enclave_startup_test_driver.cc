@@ -0,0 +1,139 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/client.h"
+#include "asylo/enclave.pb.h"
+#include "asylo/enclave_manager.h"
+#include "asylo/platform/primitives/sgx/loader.pb.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+
+ABSL_FLAG(std::string, enclave_sections, "",
+          "Comma-separated list of the ELF sections enclaves are located in");
+
+namespace asylo {
+namespace {
+
+class EmbeddedEnclaveStartupTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    EnclaveManager::Configure(EnclaveManagerOptions());
+    StatusOr<EnclaveManager *> manager_result = EnclaveManager::Instance();
+    if (!manager_result.ok()) {
+      LOG(FATAL) << manager_result.status();
+    }
+    manager_ = manager_result.ValueOrDie();
+  }
+
+  // Returns one load config per embedded enclave section, with names prefixed
+  // by |prefix|.
+  std::vector<EnclaveLoadConfig> MakeLoadConfigs(const std::string &prefix) {
+    std::vector<EnclaveLoadConfig> load_configs;
+    for (absl::string_view section :
+         absl::StrSplit(absl::GetFlag(FLAGS_enclave_sections), ',')) {
+      EnclaveLoadConfig load_config;
+      load_config.set_name(absl::StrCat(prefix, section));
+      SgxLoadConfig *sgx_config =
+          load_config.MutableExtension(sgx_load_config);
+      sgx_config->mutable_embedded_enclave_config()->set_section_name(
+          std::string(section));
+      sgx_config->set_debug(true);
+      load_configs.push_back(load_config);
+    }
+    return load_configs;
+  }
+
+  void DestroyEnclaves(const std::vector<EnclaveLoadConfig> &load_configs) {
+    for (const EnclaveLoadConfig &load_config : load_configs) {
+      EnclaveClient *client = manager_->GetClient(load_config.name());
+      ASSERT_NE(client, nullptr);
+      EXPECT_THAT(client->EnterAndRun(EnclaveInput(), nullptr), IsOk());
+      EXPECT_THAT(manager_->DestroyEnclave(client, EnclaveFinal()), IsOk());
+    }
+  }
+
+  static EnclaveManager *manager_;
+};
+
+EnclaveManager *EmbeddedEnclaveStartupTest::manager_ = nullptr;
+
+TEST_F(EmbeddedEnclaveStartupTest, AsyncLoadInvokesCallback) {
+  std::vector<EnclaveLoadConfig> load_configs = MakeLoadConfigs("/async_");
+  ASSERT_FALSE(load_configs.empty());
+
+  absl::Notification loaded;
+  Status load_status;
+  manager_->LoadEnclaveAsync(load_configs.front(),
+                             [&loaded, &load_status](const Status &status) {
+                               load_status = status;
+                               loaded.Notify();
+                             });
+  loaded.WaitForNotification();
+  ASSERT_THAT(load_status, IsOk());
+  DestroyEnclaves({load_configs.front()});
+}
+
+TEST_F(EmbeddedEnclaveStartupTest, ConcurrentLoadRejectsDuplicateNames) {
+  std::vector<EnclaveLoadConfig> load_configs = MakeLoadConfigs("/duplicate_");
+  load_configs.resize(1);
+  load_configs.push_back(load_configs.front());
+
+  std::vector<Status> statuses = manager_->LoadEnclaves(load_configs);
+  ASSERT_EQ(statuses.size(), 2);
+  EXPECT_NE(statuses[0].ok(), statuses[1].ok());
+  DestroyEnclaves({load_configs.front()});
+}
+
+// Reports the time taken to start every embedded enclave one after the other,
+// and concurrently through EnclaveManager::LoadEnclaves.
+TEST_F(EmbeddedEnclaveStartupTest, StartupTime) {
+  std::vector<EnclaveLoadConfig> sequential_configs =
+      MakeLoadConfigs("/sequential_");
+  absl::Time start = absl::Now();
+  for (const EnclaveLoadConfig &load_config : sequential_configs) {
+    ASSERT_THAT(manager_->LoadEnclave(load_config), IsOk());
+  }
+  absl::Duration sequential_time = absl::Now() - start;
+  DestroyEnclaves(sequential_configs);
+
+  std::vector<EnclaveLoadConfig> concurrent_configs =
+      MakeLoadConfigs("/concurrent_");
+  start = absl::Now();
+  for (const Status &status : manager_->LoadEnclaves(concurrent_configs)) {
+    ASSERT_THAT(status, IsOk());
+  }
+  absl::Duration concurrent_time = absl::Now() - start;
+  DestroyEnclaves(concurrent_configs);
+
+  LOG(INFO) << "Started " << sequential_configs.size()
+            << " embedded enclaves: sequential=" << sequential_time
+            << " concurrent=" << concurrent_time;
+}
+
+}  // namespace
+}  // namespace asylo
@@ -0,0 +1,154 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <signal.h>
+#include <sys/time.h>
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/flags/flag.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "asylo/client.h"
+#include "asylo/enclave.pb.h"
+#include "asylo/enclave_manager.h"
+#include "asylo/platform/primitives/sgx/loader.pb.h"
+#include "asylo/test/misc/signal_test.pb.h"
+#include "asylo/test/util/status_matchers.h"
+#include "asylo/util/logging.h"
+#include "asylo/util/status.h"
+#include "asylo/util/status_macros.h"
+#include "asylo/util/statusor.h"
+
+ABSL_FLAG(std::string, enclave_path, "", "Path to enclave");
+
+namespace asylo {
+namespace {
+
+// Interval between SIGALRM signals in the timer benchmark.
+constexpr absl::Duration kTimerInterval = absl::Microseconds(100);
+
+// Duration of each run of the timer benchmark.
+constexpr absl::Duration kBenchmarkDuration = absl::Seconds(1);
+
+// Arms ITIMER_REAL to fire every |interval|, or disarms it if |interval| is
+// zero.
+void SetTimer(absl::Duration interval) {
+  struct itimerval timer = {};
+  timer.it_interval = absl::ToTimeval(interval);
+  timer.it_value = timer.it_interval;
+  CHECK_EQ(setitimer(ITIMER_REAL, &timer, nullptr), 0);
+}
+
+class SignalQueueTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    EnclaveManager::Configure(EnclaveManagerOptions());
+    StatusOr<EnclaveManager *> manager_result = EnclaveManager::Instance();
+    if (!manager_result.ok()) {
+      LOG(FATAL) << manager_result.status();
+    }
+    manager_ = manager_result.ValueOrDie();
+  }
+
+  // Loads the test enclave as |name| and registers its SIGALRM handler.
+  EnclaveClient *LoadEnclave(const std::string &name, bool queue_signals) {
+    EnclaveLoadConfig load_config;
+    load_config.set_name(name);
+    SgxLoadConfig *sgx_config = load_config.MutableExtension(sgx_load_config);
+    sgx_config->mutable_file_enclave_config()->set_enclave_path(
+        absl::GetFlag(FLAGS_enclave_path));
+    sgx_config->set_debug(true);
+    sgx_config->set_queue_signals(queue_signals);
+    EXPECT_THAT(manager_->LoadEnclave(load_config), IsOk());
+
+    EnclaveClient *client = manager_->GetClient(name);
+    EXPECT_NE(client, nullptr);
+    EXPECT_THAT(SignalCount(client), IsOk());
+    return client;
+  }
+
+  // Enters |client| and returns the number of signals it has handled.
+  StatusOr<uint64_t> SignalCount(EnclaveClient *client) {
+    EnclaveOutput output;
+    ASYLO_RETURN_IF_ERROR(client->EnterAndRun(EnclaveInput(), &output));
+    return output.GetExtension(signal_count);
+  }
+
+  // Enters |client| repeatedly for kBenchmarkDuration while SIGALRM is raised
+  // every kTimerInterval, and logs the achieved enclave entry and signal
+  // rates.
+  void RunTimerBenchmark(EnclaveClient *client, const std::string &label) {
+    uint64_t entries = 0;
+    SetTimer(kTimerInterval);
+    absl::Time start = absl::Now();
+    while (absl::Now() - start < kBenchmarkDuration) {
+      ASSERT_THAT(client->EnterAndRun(EnclaveInput(), nullptr), IsOk());
+      ++entries;
+    }
+    SetTimer(absl::ZeroDuration());
+    absl::Duration elapsed = absl::Now() - start;
+
+    uint64_t signals;
+    ASYLO_ASSERT_OK_AND_ASSIGN(signals, SignalCount(client));
+    EXPECT_GT(signals, uint64_t{0});
+    LOG(INFO) << label << ": " << entries / absl::ToDoubleSeconds(elapsed)
+              << " entries/s, " << signals / absl::ToDoubleSeconds(elapsed)
+              << " signals/s handled";
+  }
+
+  static EnclaveManager *manager_;
+};
+
+EnclaveManager *SignalQueueTest::manager_ = nullptr;
+
+// Verifies that queued signals are delivered on the next enclave entry, and
+// that repeated instances of a pending signal are coalesced.
+TEST_F(SignalQueueTest, QueuedSignalsAreCoalesced) {
+  EnclaveClient *client = LoadEnclave("/coalesce", /*queue_signals=*/true);
+  ASSERT_NE(client, nullptr);
+
+  raise(SIGALRM);
+  raise(SIGALRM);
+  raise(SIGALRM);
+  EXPECT_THAT(SignalCount(client), IsOkAndHolds(1));
+
+  raise(SIGALRM);
+  EXPECT_THAT(SignalCount(client), IsOkAndHolds(2));
+
+  EXPECT_THAT(manager_->DestroyEnclave(client, EnclaveFinal()), IsOk());
+}
+
+// Compares the enclave entry throughput under a high-rate timer signal with
+// synchronous and queued signal delivery.
+TEST_F(SignalQueueTest, TimerSignalRate) {
+  EnclaveClient *client = LoadEnclave("/synchronous", /*queue_signals=*/false);
+  ASSERT_NE(client, nullptr);
+  RunTimerBenchmark(client, "synchronous");
+  EXPECT_THAT(manager_->DestroyEnclave(client, EnclaveFinal()), IsOk());
+
+  client = LoadEnclave("/queued", /*queue_signals=*/true);
+  ASSERT_NE(client, nullptr);
+  RunTimerBenchmark(client, "queued");
+  EXPECT_THAT(manager_->DestroyEnclave(client, EnclaveFinal()), IsOk());
+}
+
+}  // namespace
+}  // namespace asylo
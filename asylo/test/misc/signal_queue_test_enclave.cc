@@ -0,0 +1,65 @@
+/*
+ *
+ * Copyright 2019 Asylo authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <signal.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "asylo/test/misc/signal_test.pb.h"
+#include "asylo/test/util/enclave_test_application.h"
+#include "asylo/util/status.h"
+
+namespace asylo {
+
+static std::atomic<uint64_t> handled_signals(0);
+
+void CountSignal(int signum) {
+  if (signum == SIGALRM) {
+    handled_signals.fetch_add(1);
+  }
+}
+
+// Registers a SIGALRM handler on the first run, and reports the number of
+// SIGALRM signals handled so far on every run.
+class SignalQueueTest : public EnclaveTestCase {
+ public:
+  SignalQueueTest() = default;
+
+  Status Run(const EnclaveInput &input, EnclaveOutput *output) {
+    if (!handler_registered_) {
+      struct sigaction act = {};
+      act.sa_handler = &CountSignal;
+      struct sigaction oldact;
+      if (sigaction(SIGALRM, &act, &oldact) != 0) {
+        return Status(error::GoogleError::INTERNAL,
+                      "Failed to register SIGALRM handler");
+      }
+      handler_registered_ = true;
+    }
+    output->SetExtension(signal_count, handled_signals.load());
+    return Status::OkStatus();
+  }
+
+ private:
+  bool handler_registered_ = false;
+};
+
+TrustedApplication *BuildTrustedApplication() { return new SignalQueueTest; }
+
+}  // namespace asylo